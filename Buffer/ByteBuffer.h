@@ -4,9 +4,11 @@
 
 #include <vector>
 #include <array>
+#include <cstdint>
 #include <cstring>
 #include <string>
 #include <iterator>
+#include <type_traits>
 
 #include <iostream>
 
@@ -17,6 +19,20 @@ namespace DAQ
 
     using ByteBuffer = std::vector<std::uint8_t>;
 
+    /*!
+     * \brief Append the bytes of a contiguous range of elements
+     *
+     * The range is inserted at once so that the buffer grows geometrically,
+     * instead of reserving the exact size of every insertion.
+     */
+    template<class T>
+    void appendBytes(ByteBuffer& buffer, const T* beg, const T* end)
+    {
+      const std::uint8_t* pBeg = reinterpret_cast<const std::uint8_t*>(beg);
+      const std::uint8_t* pEnd = reinterpret_cast<const std::uint8_t*>(end);
+      buffer.insert(buffer.end(), pBeg, pEnd);
+    }
+
   }  // end of Buffer
 } // end of DAQ
 
@@ -27,16 +43,7 @@ template<class T>
 DAQ::Buffer::ByteBuffer& operator<<(DAQ::Buffer::ByteBuffer& buffer,
                                     const T& value)
 {
-  // the char* can always refer to another type
-  const char* beg = reinterpret_cast<const char*>(&value);
-  const char* end = beg + sizeof(value);
-
-  // make sure we only allocate once the memory we need
-  buffer.reserve(buffer.size() + (end - beg));
-
-  // copy the data using a back_inserter (calls push_back when assigning),
-  // so that the buffer is properly sized when the copy is completed.
-  std::copy(beg, end, std::back_inserter(buffer));
+  DAQ::Buffer::appendBytes(buffer, &value, &value + 1);
 
   return buffer;
 }
@@ -67,18 +74,7 @@ template<class T>
 DAQ::Buffer::ByteBuffer& operator<<(DAQ::Buffer::ByteBuffer& buffer,
                                     const std::vector<T>& data) {
 
-  std::size_t nBytes = data.size() * sizeof(T);
-
-  // the char* can always refer to another type
-  const char* beg = reinterpret_cast<const char*>(data.data());
-  const char* end = beg + nBytes;
-
-  // make sure we only allocate once the memory we need
-  buffer.reserve(buffer.size() + nBytes);
-
-  // copy the data using a back_inserter (calls push_back when assigning),
-  // so that the buffer is properly sized when the copy is completed.
-  std::copy(beg, end, std::back_inserter(buffer));
+  DAQ::Buffer::appendBytes(buffer, data.data(), data.data() + data.size());
 
   return buffer;
 }
@@ -98,12 +94,33 @@ inline DAQ::Buffer::ByteBuffer& operator<<(DAQ::Buffer::ByteBuffer& buffer,
   return buffer;
 }
 
+namespace DAQ {
+  namespace Buffer {
+
+    // arrays of plain data are copied in bulk, anything else (e.g. strings)
+    // element by element
+    template<class T>
+    void appendElements(ByteBuffer& buffer, const T* beg, const T* end, std::true_type)
+    {
+      appendBytes(buffer, beg, end);
+    }
+
+    template<class T>
+    void appendElements(ByteBuffer& buffer, const T* beg, const T* end, std::false_type)
+    {
+      while (beg != end) {
+        buffer << *beg++;
+      }
+    }
+
+  } // end of Buffer
+} // end of DAQ
+
 template<class T, std::size_t N>
 DAQ::Buffer::ByteBuffer& operator<<(DAQ::Buffer::ByteBuffer& buffer,
                                     const T (&arr)[N]) {
-  for (std::size_t i=0; i<N; ++i) {
-    buffer << arr[i];
-  }
+  DAQ::Buffer::appendElements(buffer, arr, arr + N,
+                              std::is_trivially_copyable<T>());
 
   return buffer;
 }
@@ -111,9 +128,8 @@ DAQ::Buffer::ByteBuffer& operator<<(DAQ::Buffer::ByteBuffer& buffer,
 template<class T, std::size_t N>
 DAQ::Buffer::ByteBuffer& operator<<(DAQ::Buffer::ByteBuffer& buffer,
                                     const std::array<T,N>& array) {
-  for (auto & element : array) {
-    buffer << element;
-  }
+  DAQ::Buffer::appendElements(buffer, array.data(), array.data() + N,
+                              std::is_trivially_copyable<T>());
 
   return buffer;
 }
@@ -0,0 +1,142 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_BUFFER_BYTEWRITER_H
+#define DAQ_BUFFER_BYTEWRITER_H
+
+#include <ByteBuffer.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace DAQ {
+namespace Buffer {
+
+/*!
+ * \brief Writes data into a ByteBuffer whose size is known in advance
+ *
+ * The insertion operators of ByteBuffer grow the buffer on every insertion.
+ * The ByteWriter instead resizes the buffer once at construction and then
+ * writes each value by pointer, which reduces serializing a fixed layout
+ * to a series of memcpy calls. Arrays and vectors of plain data are written
+ * in bulk.
+ *
+ * \code
+ * ByteBuffer body;
+ * ByteWriter writer(body, 3*sizeof(uint32_t) + scalers.size()*sizeof(uint32_t));
+ * writer << start << end << uint32_t(scalers.size()) << scalers;
+ * \endcode
+ *
+ * Any bytes reserved at construction but not written are removed from the
+ * buffer when the writer is destroyed, so an upper bound of the size is
+ * acceptable. The buffer must not be modified by other means while the
+ * writer exists.
+ */
+class ByteWriter
+{
+private:
+    ByteBuffer&   m_buffer;
+    std::size_t   m_begin;
+    std::size_t   m_pos;
+    std::size_t   m_end;
+
+public:
+    /*!
+     * \param buffer  the buffer to append to
+     * \param nBytes  number of bytes that will be written
+     */
+    ByteWriter(ByteBuffer& buffer, std::size_t nBytes)
+        : m_buffer(buffer), m_begin(buffer.size()), m_pos(m_begin),
+          m_end(m_begin + nBytes)
+    {
+        m_buffer.resize(m_end);
+    }
+
+    ByteWriter(const ByteWriter&) = delete;
+    ByteWriter& operator=(const ByteWriter&) = delete;
+
+    ~ByteWriter()
+    {
+        m_buffer.resize(m_pos);
+    }
+
+    /*!
+     * \brief Copy raw bytes
+     *
+     * \throws std::length_error if more bytes are written than were reserved
+     */
+    ByteWriter& write(const void* data, std::size_t nBytes)
+    {
+        if (nBytes > m_end - m_pos) {
+            throw std::length_error("ByteWriter::write() more data than reserved space");
+        }
+        if (nBytes) {
+            std::memcpy(m_buffer.data() + m_pos, data, nBytes);
+            m_pos += nBytes;
+        }
+        return *this;
+    }
+
+    /*! \return number of reserved bytes not yet written */
+    std::size_t remaining() const { return m_end - m_pos; }
+
+    /*! \return number of bytes written so far */
+    std::size_t written() const { return m_pos - m_begin; }
+};
+
+
+/*! \brief Write a plain data value */
+template<class T>
+ByteWriter& operator<<(ByteWriter& writer, const T& value)
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "ByteWriter can only write plain data");
+    return writer.write(&value, sizeof(value));
+}
+
+/*! \brief Write the elements of a vector of plain data in bulk */
+template<class T>
+ByteWriter& operator<<(ByteWriter& writer, const std::vector<T>& data)
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "ByteWriter can only write plain data");
+    return writer.write(data.data(), data.size()*sizeof(T));
+}
+
+/*! \brief Write the elements of an array of plain data in bulk */
+template<class T, std::size_t N>
+ByteWriter& operator<<(ByteWriter& writer, const std::array<T,N>& data)
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "ByteWriter can only write plain data");
+    return writer.write(data.data(), N*sizeof(T));
+}
+
+/*! \brief Write the characters of a string, without length or terminator */
+inline ByteWriter& operator<<(ByteWriter& writer, const std::string& value)
+{
+    return writer.write(value.data(), value.size());
+}
+
+} // end Buffer
+} // end DAQ
+
+#endif // DAQ_BUFFER_BYTEWRITER_H
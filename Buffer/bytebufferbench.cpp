@@ -0,0 +1,122 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+/*
+ * Compares the ways of serializing a body field by field into a ByteBuffer:
+ *
+ *  - exact-reserve  : reserve(size()+sizeof(T)) then a back_inserter copy per
+ *                     field, i.e. what the ByteBuffer insertion operator used
+ *                     to do
+ *  - operator<<     : the ByteBuffer insertion operators
+ *  - ByteWriter     : resize once, then write by pointer
+ *
+ * Usage: bytebufferbench [nFields [nRepetitions]]
+ */
+
+#include <ByteBuffer.h>
+#include <ByteWriter.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace DAQ::Buffer;
+
+template<class T>
+static void exactReserveInsert(ByteBuffer& buffer, const T& value)
+{
+    const char* beg = reinterpret_cast<const char*>(&value);
+    buffer.reserve(buffer.size() + sizeof(value));
+    std::copy(beg, beg + sizeof(value), std::back_inserter(buffer));
+}
+
+static void exactReserve(ByteBuffer& buffer, const std::vector<std::uint32_t>& fields)
+{
+    buffer.clear();
+    buffer.shrink_to_fit();
+    for (auto field : fields) {
+        exactReserveInsert(buffer, field);
+    }
+}
+
+static void insertionOperator(ByteBuffer& buffer, const std::vector<std::uint32_t>& fields)
+{
+    buffer.clear();
+    buffer.shrink_to_fit();
+    for (auto field : fields) {
+        buffer << field;
+    }
+}
+
+static void byteWriter(ByteBuffer& buffer, const std::vector<std::uint32_t>& fields)
+{
+    buffer.clear();
+    buffer.shrink_to_fit();
+    ByteWriter writer(buffer, fields.size()*sizeof(std::uint32_t));
+    for (auto field : fields) {
+        writer << field;
+    }
+}
+
+template<class Serializer>
+static double measure(Serializer serialize, const std::vector<std::uint32_t>& fields,
+                      std::size_t nRepetitions, std::size_t& checksum)
+{
+    ByteBuffer buffer;
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i=0; i<nRepetitions; ++i) {
+        serialize(buffer, fields);
+        checksum += buffer.size() + buffer.back();
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::micro>(stop - start).count() / nRepetitions;
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t nFields      = (argc > 1) ? std::strtoul(argv[1], nullptr, 0) : 4096;
+    std::size_t nRepetitions = (argc > 2) ? std::strtoul(argv[2], nullptr, 0) : 200;
+
+    if (nFields == 0 || nRepetitions == 0) {
+        std::cerr << "Usage: bytebufferbench [nFields [nRepetitions]]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::uint32_t> fields(nFields);
+    for (std::size_t i=0; i<nFields; ++i) {
+        fields[i] = i;
+    }
+
+    std::size_t checksum = 0;
+    double exact     = measure(exactReserve, fields, nRepetitions, checksum);
+    double insertion = measure(insertionOperator, fields, nRepetitions, checksum);
+    double writer    = measure(byteWriter, fields, nRepetitions, checksum);
+
+    std::cout << nFields << " 32-bit fields, " << nRepetitions << " repetitions\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::setw(16) << "exact-reserve" << std::setw(12) << exact     << " us/body\n";
+    std::cout << std::setw(16) << "operator<<"    << std::setw(12) << insertion << " us/body\n";
+    std::cout << std::setw(16) << "ByteWriter"    << std::setw(12) << writer    << " us/body\n";
+    std::cout << "(checksum " << checksum << ")" << std::endl;
+
+    return EXIT_SUCCESS;
+}
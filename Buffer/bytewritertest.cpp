@@ -0,0 +1,113 @@
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+
+#include <ByteBuffer.h>
+#include <ByteWriter.h>
+#include <DebugUtils.h>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+using namespace DAQ::Buffer;
+
+class bytewritertest : public CppUnit::TestFixture {
+  public:
+  CPPUNIT_TEST_SUITE(bytewritertest);
+  CPPUNIT_TEST(write_0);
+  CPPUNIT_TEST(write_1);
+  CPPUNIT_TEST(bulk_0);
+  CPPUNIT_TEST(overflow_0);
+  CPPUNIT_TEST(shrink_0);
+  CPPUNIT_TEST(insertArr_0);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {
+  }
+  void tearDown() {
+  }
+
+  void write_0() {
+    ByteBuffer expected;
+    expected << uint8_t(1) << uint16_t(0x0203) << uint32_t(0x04050607)
+             << uint64_t(0x08090a0b0c0d0e0f);
+
+    ByteBuffer buffer;
+    {
+      ByteWriter writer(buffer, 15);
+      writer << uint8_t(1) << uint16_t(0x0203) << uint32_t(0x04050607)
+             << uint64_t(0x08090a0b0c0d0e0f);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("nothing remains", size_t(0), writer.remaining());
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("written", size_t(15), writer.written());
+    }
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("same bytes as insertion operators",
+                                 expected, buffer);
+  }
+
+  void write_1() {
+    ByteBuffer buffer = {0xff};
+    {
+      ByteWriter writer(buffer, 2);
+      writer << uint16_t(0x0102);
+    }
+
+    ByteBuffer expected = {0xff, 0x02, 0x01};
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("existing data is preserved",
+                                 expected, buffer);
+  }
+
+  void bulk_0() {
+    vector<uint16_t> data = {1, 2};
+    array<uint16_t, 2> arr = {{3, 4}};
+    string text("ab");
+
+    ByteBuffer buffer;
+    {
+      ByteWriter writer(buffer, 10);
+      writer << data << arr << text;
+    }
+
+    ByteBuffer expected = {1, 0, 2, 0, 3, 0, 4, 0, 'a', 'b'};
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("vectors, arrays, strings written in bulk",
+                                 expected, buffer);
+  }
+
+  void overflow_0() {
+    ByteBuffer buffer;
+    ByteWriter writer(buffer, 3);
+    writer << uint16_t(1);
+    CPPUNIT_ASSERT_THROW_MESSAGE("writing past the reserved space fails",
+                                 writer << uint16_t(2),
+                                 std::length_error);
+  }
+
+  void shrink_0() {
+    ByteBuffer buffer;
+    {
+      ByteWriter writer(buffer, 100);
+      writer << uint32_t(1);
+    }
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("unwritten space is released",
+                                 size_t(4), buffer.size());
+  }
+
+  void insertArr_0() {
+    std::string strings[2] = {"a", "bc"};
+
+    ByteBuffer buffer;
+    buffer << strings;
+
+    ByteBuffer expected = {1, 0, 'a', 2, 0, 'b', 'c'};
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("arrays of non-plain data insert each element",
+                                 expected, buffer);
+  }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(bytewritertest);
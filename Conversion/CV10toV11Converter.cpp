@@ -0,0 +1,490 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CV10toV11Converter.h"
+#include "ConversionUtils.h"
+
+#include <V10/CRingItem.h>
+#include <V10/DataFormat.h>
+#include <V11/DataFormat.h>
+#include <ByteOrder.h>
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace DAQ {
+  namespace Conversion {
+
+    namespace {
+
+      const std::size_t HeaderSize         = 2*sizeof(std::uint32_t);
+      const std::size_t V11BodyHeaderSize  = sizeof(V11::BodyHeader);
+      const std::size_t TitleSize          = V11_TITLE_MAXSIZE + 1;
+
+      // V10 body sizes (in bytes, excluding variable length data)
+      const std::size_t StateChangeFixedSize  = 3*sizeof(std::uint32_t);
+      const std::size_t TextFixedSize         = 3*sizeof(std::uint32_t);
+      const std::size_t ScalerFixedSize       = 4*sizeof(std::uint32_t);
+      const std::size_t TSScalerFixedSize     = sizeof(std::uint64_t) + 5*sizeof(std::uint32_t);
+      const std::size_t PhysicsCountBodySize  = 2*sizeof(std::uint32_t) + sizeof(std::uint64_t);
+      const std::size_t FragmentFixedSize     = sizeof(std::uint64_t) + 3*sizeof(std::uint32_t);
+
+      struct BodyHeaderFields {
+        std::uint64_t s_timestamp;
+        std::uint32_t s_sourceId;
+        std::uint32_t s_barrier;
+      };
+
+      // grow the output by one V11 item of the given body size, fill in the
+      // header and body header (or the zero that stands in for it), and return
+      // a pointer to the start of the body
+      std::uint8_t* appendItem(Buffer::ByteBuffer& output, std::uint32_t type,
+                               std::size_t bodySize, const BodyHeaderFields* pBodyHeader,
+                               bool swap = false)
+      {
+        std::size_t offset = output.size();
+        std::size_t itemSize = HeaderSize + bodySize
+                + (pBodyHeader ? V11BodyHeaderSize : sizeof(std::uint32_t));
+        output.resize(offset + itemSize);
+
+        std::uint8_t* pos = output.data() + offset;
+        pos = put(pos, std::uint32_t(itemSize), swap);
+        pos = put(pos, type, swap);
+        if (pBodyHeader) {
+          pos = put(pos, std::uint32_t(V11BodyHeaderSize), swap);
+          pos = put(pos, pBodyHeader->s_timestamp, swap);
+          pos = put(pos, pBodyHeader->s_sourceId, swap);
+          pos = put(pos, pBodyHeader->s_barrier, swap);
+        } else {
+          pos = put(pos, std::uint32_t(0));
+        }
+        return pos;
+      }
+
+      void throwMalformed(const std::string& where, const std::string& what)
+      {
+        throwConversionError("CV10toV11Converter", where, what);
+      }
+
+    } // end anonymous namespace
+
+
+    // A V10 item located in memory with its header decoded, along with the
+    // body header to give the V11 item, if any
+    struct CV10toV11Converter::Item {
+      std::uint32_t       s_type;
+      bool                s_swap;
+      const std::uint8_t* s_body;
+      const std::uint8_t* s_end;
+      bool                s_hasBodyHeader;
+      BodyHeaderFields    s_bodyHeader;
+
+      const BodyHeaderFields* bodyHeader() const {
+        return s_hasBodyHeader ? &s_bodyHeader : nullptr;
+      }
+    };
+
+
+    //
+    CV10toV11Converter::CV10toV11Converter(std::uint32_t sourceId)
+      : m_sourceId(sourceId),
+        m_nThreads(0),
+        m_batchSize(8*1024*1024)
+    {}
+
+
+    //
+    void CV10toV11Converter::convertItem(const V10::CRingItem& item,
+                                         Buffer::ByteBuffer& output) const
+    {
+      auto beg = reinterpret_cast<const std::uint8_t*>(item.getItemPointer());
+      convertItem(beg, beg + item.size(), output);
+    }
+
+
+    //
+    void CV10toV11Converter::convertItem(const std::uint8_t* beg, const std::uint8_t* end,
+                                         Buffer::ByteBuffer& output) const
+    {
+      convertItem(parseItem(beg, end), output);
+    }
+
+
+    //
+    void CV10toV11Converter::convertItem(const Item& item, Buffer::ByteBuffer& output) const
+    {
+      switch (item.s_type) {
+        case V10::BEGIN_RUN:
+        case V10::END_RUN:
+        case V10::PAUSE_RUN:
+        case V10::RESUME_RUN:
+          convertStateChange(item, output);
+          break;
+        case V10::PACKET_TYPES:
+        case V10::MONITORED_VARIABLES:
+          convertText(item, output);
+          break;
+        case V10::INCREMENTAL_SCALERS:
+          convertScalers(item, output);
+          break;
+        case V10::TIMESTAMPED_NONINCR_SCALERS:
+          convertTimestampedScalers(item, output);
+          break;
+        case V10::PHYSICS_EVENT_COUNT:
+          convertPhysicsEventCount(item, output);
+          break;
+        case V10::EVB_FRAGMENT:
+        case V10::EVB_UNKNOWN_PAYLOAD:
+          convertFragment(item, output);
+          break;
+        default:
+          // physics events, user items and anything else unknown
+          convertVerbatim(item, output);
+          break;
+      }
+    }
+
+
+    //
+    std::size_t CV10toV11Converter::convert(std::istream& input, std::ostream& output)
+    {
+      // every V11 stream begins with the format
+      Buffer::ByteBuffer formatItem;
+      std::uint8_t* pFormat = appendItem(formatItem, V11::RING_FORMAT,
+                                         2*sizeof(std::uint16_t), nullptr);
+      pFormat = put(pFormat, V11::FORMAT_MAJOR);
+      pFormat = put(pFormat, V11::FORMAT_MINOR);
+      output.write(reinterpret_cast<const char*>(formatItem.data()), formatItem.size());
+
+      ItemFraming framing = {"CV10toV11Converter", "V10",
+                             HeaderSize, HeaderSize, typeNeedsSwap};
+
+      auto convert = [this](const std::uint8_t* beg, const std::uint8_t* end,
+                            Buffer::ByteBuffer& converted) {
+        convertItem(beg, end, converted);
+      };
+
+      return convertItemStream(input, output, framing, m_batchSize, getThreadCount(), convert);
+    }
+
+
+    //
+    void CV10toV11Converter::setThreadCount(unsigned nThreads)
+    {
+      m_nThreads = nThreads;
+    }
+
+
+    //
+    unsigned CV10toV11Converter::getThreadCount() const
+    {
+      return resolveThreadCount(m_nThreads);
+    }
+
+
+    //
+    void CV10toV11Converter::setBatchSize(std::size_t nBytes)
+    {
+      if (nBytes == 0) {
+        throw std::invalid_argument("DAQ::Conversion::CV10toV11Converter::setBatchSize() batch size must be nonzero.");
+      }
+      m_batchSize = nBytes;
+    }
+
+
+    //
+    CV10toV11Converter::Item
+    CV10toV11Converter::parseItem(const std::uint8_t* beg, const std::uint8_t* end) const
+    {
+      std::size_t available = end - beg;
+      if (available < HeaderSize) {
+        throwMalformed("parseItem", "Item is smaller than a V10 header.");
+      }
+
+      Item item;
+      item.s_swap = typeNeedsSwap(beg);
+      BO::CByteSwapper swapper(item.s_swap);
+
+      std::uint32_t size = swapper.copyAs<std::uint32_t>(beg);
+      if ((size < HeaderSize) || (size > available)) {
+        throwMalformed("parseItem", "Item size is inconsistent with the data present.");
+      }
+      item.s_type = swapper.copyAs<std::uint32_t>(beg + sizeof(std::uint32_t));
+      item.s_body = beg + HeaderSize;
+      item.s_end  = beg + size;
+      item.s_hasBodyHeader = false;
+      item.s_bodyHeader = BodyHeaderFields();
+
+      return item;
+    }
+
+
+    //
+    void CV10toV11Converter::convertStateChange(const Item& item,
+                                                Buffer::ByteBuffer& output) const
+    {
+      std::size_t bodySize = item.s_end - item.s_body;
+      if (bodySize < StateChangeFixedSize) {
+        throwMalformed("convertStateChange", "Item is too small for a state change.");
+      }
+
+      BO::CByteSwapper swapper(item.s_swap);
+      const std::uint8_t* pos = item.s_body;
+      std::uint32_t run, offset, timestamp;
+      pos = swapper.interpretAs(pos, run);
+      pos = swapper.interpretAs(pos, offset);
+      pos = swapper.interpretAs(pos, timestamp);
+
+      // both versions keep the title in a fixed size, null padded field
+      const char* titleBeg = reinterpret_cast<const char*>(pos);
+      std::size_t titleMax = std::min<std::size_t>(V10_TITLE_MAXSIZE + 1, item.s_end - pos);
+      titleMax = std::min(titleMax, TitleSize - 1);
+      std::size_t titleSize = std::find(titleBeg, titleBeg + titleMax, '\0') - titleBeg;
+
+      std::uint8_t* body = appendItem(output, item.s_type,
+                                      4*sizeof(std::uint32_t) + TitleSize,
+                                      item.bodyHeader());
+      body = put(body, run);
+      body = put(body, offset);
+      body = put(body, timestamp);
+      body = put(body, std::uint32_t(1));   // divisor
+      body = std::copy(titleBeg, titleBeg + titleSize, body);
+      std::fill(body, body + (TitleSize - titleSize), 0);
+    }
+
+
+    //
+    void CV10toV11Converter::convertText(const Item& item, Buffer::ByteBuffer& output) const
+    {
+      std::size_t bodySize = item.s_end - item.s_body;
+      if (bodySize < TextFixedSize) {
+        throwMalformed("convertText", "Item is too small for a text item.");
+      }
+
+      BO::CByteSwapper swapper(item.s_swap);
+      const std::uint8_t* pos = item.s_body;
+      std::uint32_t offset, timestamp, nStrings;
+      pos = swapper.interpretAs(pos, offset);
+      pos = swapper.interpretAs(pos, timestamp);
+      pos = swapper.interpretAs(pos, nStrings);
+
+      // only the first nStrings strings are kept. A last string without a null
+      // terminator is given one.
+      const std::uint8_t* stringsEnd = pos;
+      std::uint32_t nFound = 0;
+      while ((nFound < nStrings) && (stringsEnd != item.s_end)) {
+        stringsEnd = std::find(stringsEnd, item.s_end, '\0');
+        if (stringsEnd != item.s_end) {
+          ++stringsEnd;
+        }
+        ++nFound;
+      }
+      bool terminated = (stringsEnd == pos) || (*(stringsEnd-1) == '\0');
+      std::size_t nChars = (stringsEnd - pos) + (terminated ? 0 : 1);
+
+      std::uint8_t* body = appendItem(output, item.s_type,
+                                      4*sizeof(std::uint32_t) + nChars,
+                                      item.bodyHeader());
+      body = put(body, offset);
+      body = put(body, timestamp);
+      body = put(body, nFound);
+      body = put(body, std::uint32_t(1));   // divisor
+      body = std::copy(pos, stringsEnd, body);
+      if (!terminated) {
+        *body = '\0';
+      }
+    }
+
+
+    //
+    void CV10toV11Converter::convertScalers(const Item& item, Buffer::ByteBuffer& output) const
+    {
+      std::size_t bodySize = item.s_end - item.s_body;
+      if (bodySize < ScalerFixedSize) {
+        throwMalformed("convertScalers", "Item is too small for a scaler item.");
+      }
+
+      BO::CByteSwapper swapper(item.s_swap);
+      const std::uint8_t* pos = item.s_body;
+      std::uint32_t startOffset, endOffset, timestamp, nScalers;
+      pos = swapper.interpretAs(pos, startOffset);
+      pos = swapper.interpretAs(pos, endOffset);
+      pos = swapper.interpretAs(pos, timestamp);
+      pos = swapper.interpretAs(pos, nScalers);
+
+      if (ScalerFixedSize + std::size_t(nScalers)*sizeof(std::uint32_t) > bodySize) {
+        throwMalformed("convertScalers", "Scaler count exceeds the item size.");
+      }
+
+      std::uint8_t* body = appendItem(output, V11::PERIODIC_SCALERS,
+                                      6*sizeof(std::uint32_t) + nScalers*sizeof(std::uint32_t),
+                                      item.bodyHeader());
+      body = put(body, startOffset);
+      body = put(body, endOffset);
+      body = put(body, timestamp);
+      body = put(body, std::uint32_t(1));   // divisor
+      body = put(body, nScalers);
+      body = put(body, std::uint32_t(1));   // incremental
+
+      for (std::uint32_t i=0; i<nScalers; ++i) {
+        body = put(body, swapper.copyAs<std::uint32_t>(pos));
+        pos += sizeof(std::uint32_t);
+      }
+    }
+
+
+    /*
+     * Nonincremental timestamped scalers carry an event timestamp, which
+     * becomes the body header unless the scalers are the payload of a
+     * fragment that already supplied one.
+     */
+    void CV10toV11Converter::convertTimestampedScalers(const Item& item,
+                                                       Buffer::ByteBuffer& output) const
+    {
+      std::size_t bodySize = item.s_end - item.s_body;
+      if (bodySize < TSScalerFixedSize) {
+        throwMalformed("convertTimestampedScalers",
+                       "Item is too small for a timestamped scaler item.");
+      }
+
+      BO::CByteSwapper swapper(item.s_swap);
+      const std::uint8_t* pos = item.s_body;
+      std::uint64_t eventTimestamp;
+      std::uint32_t startOffset, endOffset, divisor, timestamp, nScalers;
+      pos = swapper.interpretAs(pos, eventTimestamp);
+      pos = swapper.interpretAs(pos, startOffset);
+      pos = swapper.interpretAs(pos, endOffset);
+      pos = swapper.interpretAs(pos, divisor);
+      pos = swapper.interpretAs(pos, timestamp);
+      pos = swapper.interpretAs(pos, nScalers);
+
+      if (TSScalerFixedSize + std::size_t(nScalers)*sizeof(std::uint32_t) > bodySize) {
+        throwMalformed("convertTimestampedScalers", "Scaler count exceeds the item size.");
+      }
+
+      BodyHeaderFields bodyHeader = {eventTimestamp, m_sourceId, 0};
+      if (item.s_hasBodyHeader) {
+        bodyHeader = item.s_bodyHeader;
+      }
+
+      std::uint8_t* body = appendItem(output, V11::PERIODIC_SCALERS,
+                                      6*sizeof(std::uint32_t) + nScalers*sizeof(std::uint32_t),
+                                      &bodyHeader);
+      body = put(body, startOffset);
+      body = put(body, endOffset);
+      body = put(body, timestamp);
+      body = put(body, divisor);
+      body = put(body, nScalers);
+      body = put(body, std::uint32_t(0));   // not incremental
+
+      for (std::uint32_t i=0; i<nScalers; ++i) {
+        body = put(body, swapper.copyAs<std::uint32_t>(pos));
+        pos += sizeof(std::uint32_t);
+      }
+    }
+
+
+    //
+    void CV10toV11Converter::convertPhysicsEventCount(const Item& item,
+                                                      Buffer::ByteBuffer& output) const
+    {
+      if (std::size_t(item.s_end - item.s_body) < PhysicsCountBodySize) {
+        throwMalformed("convertPhysicsEventCount", "Item is too small for an event count item.");
+      }
+
+      BO::CByteSwapper swapper(item.s_swap);
+      const std::uint8_t* pos = item.s_body;
+      std::uint32_t offset, timestamp;
+      std::uint64_t count;
+      pos = swapper.interpretAs(pos, offset);
+      pos = swapper.interpretAs(pos, timestamp);
+      pos = swapper.interpretAs(pos, count);
+
+      std::uint8_t* body = appendItem(output, V11::PHYSICS_EVENT_COUNT,
+                                      3*sizeof(std::uint32_t) + sizeof(std::uint64_t),
+                                      item.bodyHeader());
+      body = put(body, offset);
+      body = put(body, std::uint32_t(1));   // divisor
+      body = put(body, timestamp);
+      body = put(body, count);
+    }
+
+
+    /*
+     * The fragment header of the V10 item becomes the body header of the V11
+     * item. The payload of an EVB_FRAGMENT is converted in turn and given the
+     * same body header; that of an EVB_UNKNOWN_PAYLOAD is copied verbatim.
+     */
+    void CV10toV11Converter::convertFragment(const Item& item,
+                                             Buffer::ByteBuffer& output) const
+    {
+      std::size_t bodySize = item.s_end - item.s_body;
+      if (bodySize < FragmentFixedSize) {
+        throwMalformed("convertFragment", "Item is too small for a fragment.");
+      }
+
+      BO::CByteSwapper swapper(item.s_swap);
+      const std::uint8_t* pos = item.s_body;
+      BodyHeaderFields bodyHeader;
+      std::uint32_t payloadSize;
+      pos = swapper.interpretAs(pos, bodyHeader.s_timestamp);
+      pos = swapper.interpretAs(pos, bodyHeader.s_sourceId);
+      pos = swapper.interpretAs(pos, payloadSize);
+      pos = swapper.interpretAs(pos, bodyHeader.s_barrier);
+
+      if (payloadSize > std::size_t(item.s_end - pos)) {
+        throwMalformed("convertFragment", "Fragment payload extends past the end of the item.");
+      }
+
+      if (item.s_type == V10::EVB_UNKNOWN_PAYLOAD) {
+        std::uint8_t* body = appendItem(output, V11::EVB_UNKNOWN_PAYLOAD, payloadSize,
+                                        &bodyHeader);
+        std::memcpy(body, pos, payloadSize);
+        return;
+      }
+
+      // the size of the converted payload is not known until it is written, so
+      // the size of the fragment is filled in afterwards
+      std::size_t offset = output.size();
+      appendItem(output, V11::EVB_FRAGMENT, 0, &bodyHeader);
+
+      Item payload = parseItem(pos, pos + payloadSize);
+      payload.s_hasBodyHeader = true;
+      payload.s_bodyHeader = bodyHeader;
+      convertItem(payload, output);
+
+      put(output.data() + offset, std::uint32_t(output.size() - offset));
+    }
+
+
+    //
+    void CV10toV11Converter::convertVerbatim(const Item& item, Buffer::ByteBuffer& output) const
+    {
+      // the header is written in the byte order of the V10 data so that
+      // consumers of the V11 item know to swap the verbatim body
+      std::size_t bodySize = item.s_end - item.s_body;
+      std::uint8_t* body = appendItem(output, item.s_type, bodySize,
+                                      item.bodyHeader(), item.s_swap);
+      std::memcpy(body, item.s_body, bodySize);
+    }
+
+  } // end Conversion
+} // end DAQ
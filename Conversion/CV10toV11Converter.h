@@ -0,0 +1,179 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CONVERSION_CV10TOV11CONVERTER_H
+#define DAQ_CONVERSION_CV10TOV11CONVERTER_H
+
+#include <ByteBuffer.h>
+
+#include <cstdint>
+#include <iosfwd>
+
+namespace DAQ {
+
+  namespace V10 {
+    class CRingItem;
+  }
+
+  namespace Conversion {
+
+    /*!
+     * \brief Streaming converter from version 10 ring items to version 11 ring items
+     *
+     * Like the other converters, this works directly on the bytes of the V10
+     * items and writes the V11 items in wire format into a byte buffer. No
+     * V10::CRingItem or V11::CRingItem objects are created along the way. The
+     * mapping is:
+     *
+     * +-----------------------------------------+-----------------------------------+
+     * | V10 item type                           | V11 item type                     |
+     * +-----------------------------------------+-----------------------------------+
+     * | BEGIN_RUN, END_RUN, PAUSE_RUN, ...      | BEGIN_RUN, END_RUN, ...           |
+     * | PACKET_TYPES, MONITORED_VARIABLES       | PACKET_TYPES, ...                 |
+     * | INCREMENTAL_SCALERS                     | PERIODIC_SCALERS (incremental)    |
+     * | TIMESTAMPED_NONINCR_SCALERS             | PERIODIC_SCALERS (nonincremental) |
+     * | PHYSICS_EVENT                           | PHYSICS_EVENT                     |
+     * | PHYSICS_EVENT_COUNT                     | PHYSICS_EVENT_COUNT               |
+     * | EVB_FRAGMENT                            | EVB_FRAGMENT                      |
+     * | EVB_UNKNOWN_PAYLOAD                     | EVB_UNKNOWN_PAYLOAD               |
+     * | user items, anything else               | same type, body verbatim          |
+     * +-----------------------------------------+-----------------------------------+
+     *
+     * V10 items carry no body header. One is synthesized wherever V10 has an
+     * event timestamp:
+     *
+     *  - TIMESTAMPED_NONINCR_SCALERS get the event timestamp of the scaler item
+     *    and the source id that the converter was constructed with.
+     *  - EVB_FRAGMENT and EVB_UNKNOWN_PAYLOAD items get the timestamp, source id
+     *    and barrier type of the fragment. The payload of an EVB_FRAGMENT is a
+     *    V10 item; it is converted as well and given the same body header.
+     *
+     * All other items are written without a body header. The time divisor that
+     * V11 added to state changes, text, scalers and event counts is set to 1.
+     *
+     * The bodies of physics events and unrecognized items are copied verbatim
+     * and their V11 headers are written in the byte order of the V10 item, so
+     * that readers know to swap the body. All other items are written in native
+     * byte order.
+     *
+     * The stream conversion reads the input in large batches, locates the item
+     * boundaries, and converts the items of each batch on several threads
+     * while the next batch is read. Output order is always identical to the
+     * input order.
+     *
+     * \code
+     * #include <CV10toV11Converter.h>
+     * #include <fstream>
+     *
+     * using namespace DAQ;
+     *
+     * std::ifstream input("run-0012-00.evt", std::ios::binary);
+     * std::ofstream output("run-0012-00.v11.evt", std::ios::binary);
+     *
+     * Conversion::CV10toV11Converter converter;
+     * converter.convert(input, output);
+     * \endcode
+     */
+    class CV10toV11Converter
+    {
+    private:
+      std::uint32_t     m_sourceId;
+      unsigned          m_nThreads;
+      std::size_t       m_batchSize;
+
+    public:
+      /*!
+       * \brief Constructor
+       *
+       * \param sourceId  the source id of synthesized body headers that have
+       *                  no fragment to take one from
+       */
+      CV10toV11Converter(std::uint32_t sourceId = 0);
+
+      /*!
+       * \brief Convert a single item
+       *
+       * The V11 item produced is appended to the output buffer.
+       *
+       * \param item    the V10 item
+       * \param output  the buffer to append V11 data to
+       *
+       * \throws std::runtime_error if the item is malformed
+       */
+      void convertItem(const V10::CRingItem& item, Buffer::ByteBuffer& output) const;
+
+      /*!
+       * \brief Convert a single item of raw bytes
+       *
+       * Same as the CRingItem overload except that the data is taken directly
+       * from a range of bytes [beg, end) that begins with one V10 item.
+       */
+      void convertItem(const std::uint8_t* beg, const std::uint8_t* end,
+                       Buffer::ByteBuffer& output) const;
+
+      /*!
+       * \brief Convert a stream of V10 items to a stream of V11 items
+       *
+       * The first item of the output is a V11 RING_FORMAT item.
+       *
+       * \param input   the stream to read V10 data from
+       * \param output  the stream to write V11 data to
+       *
+       * \return the number of V10 items read
+       *
+       * \throws std::runtime_error if any item is malformed or the input ends
+       *                            in the middle of an item
+       */
+      std::size_t convert(std::istream& input, std::ostream& output);
+
+      /*!
+       * \brief Set the number of worker threads used by convert()
+       *
+       * A value of 0 selects std::thread::hardware_concurrency().
+       */
+      void setThreadCount(unsigned nThreads);
+      unsigned getThreadCount() const;
+
+      /*!
+       * \brief Set the number of bytes read per batch in convert()
+       *
+       * Items larger than a batch are still converted; the batch grows to hold them.
+       */
+      void setBatchSize(std::size_t nBytes);
+      std::size_t getBatchSize() const { return m_batchSize; }
+
+      std::uint32_t getSourceId() const { return m_sourceId; }
+      void setSourceId(std::uint32_t id) { m_sourceId = id; }
+
+    private:
+      struct Item;
+
+      Item parseItem(const std::uint8_t* beg, const std::uint8_t* end) const;
+      void convertItem(const Item& item, Buffer::ByteBuffer& output) const;
+
+      void convertStateChange(const Item& item, Buffer::ByteBuffer& output) const;
+      void convertText(const Item& item, Buffer::ByteBuffer& output) const;
+      void convertScalers(const Item& item, Buffer::ByteBuffer& output) const;
+      void convertTimestampedScalers(const Item& item, Buffer::ByteBuffer& output) const;
+      void convertPhysicsEventCount(const Item& item, Buffer::ByteBuffer& output) const;
+      void convertFragment(const Item& item, Buffer::ByteBuffer& output) const;
+      void convertVerbatim(const Item& item, Buffer::ByteBuffer& output) const;
+    };
+
+  } // end Conversion
+} // end DAQ
+
+#endif // DAQ_CONVERSION_CV10TOV11CONVERTER_H
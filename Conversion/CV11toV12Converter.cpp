@@ -0,0 +1,479 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CV11toV12Converter.h"
+#include "ConversionUtils.h"
+
+#include <V11/CRingItem.h>
+#include <V11/CFragmentIterator.h>
+#include <V11/DataFormat.h>
+#include <V12/DataFormat.h>
+#include <ByteOrder.h>
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace DAQ {
+  namespace Conversion {
+
+    namespace {
+
+      const std::size_t V11HeaderSize      = 2*sizeof(std::uint32_t);
+      const std::size_t V11MinItemSize     = V11HeaderSize + sizeof(std::uint32_t);
+      const std::size_t V11BodyHeaderSize  = sizeof(V11::BodyHeader);
+      const std::uint32_t V12CompositeBit  = 0x8000;
+
+      // V11 body sizes (in bytes, excluding variable length data)
+      const std::size_t StateChangeFixedSize  = 4*sizeof(std::uint32_t);
+      const std::size_t TextFixedSize         = 4*sizeof(std::uint32_t);
+      const std::size_t ScalerFixedSize       = 6*sizeof(std::uint32_t);
+      const std::size_t PhysicsCountBodySize  = 3*sizeof(std::uint32_t) + sizeof(std::uint64_t);
+      const std::size_t GlomBodySize          = sizeof(std::uint64_t) + 2*sizeof(std::uint16_t);
+
+      void throwMalformed(const std::string& where, const std::string& what)
+      {
+        throwConversionError("CV11toV12Converter", where, what);
+      }
+
+    } // end anonymous namespace
+
+
+    // A V11 item located in memory with its header decoded
+    struct CV11toV12Converter::Item {
+      std::uint32_t       s_type;
+      std::uint64_t       s_timestamp;
+      std::uint32_t       s_sourceId;
+      bool                s_swap;
+      const std::uint8_t* s_body;
+      const std::uint8_t* s_end;
+    };
+
+
+    //
+    CV11toV12Converter::CV11toV12Converter(std::uint32_t sourceId,
+                                           BuiltEventPolicy builtPolicy)
+      : m_sourceId(sourceId),
+        m_builtPolicy(builtPolicy),
+        m_nThreads(0),
+        m_batchSize(8*1024*1024)
+    {}
+
+
+    //
+    void CV11toV12Converter::convertItem(const V11::CRingItem& item,
+                                         Buffer::ByteBuffer& output) const
+    {
+      auto beg = reinterpret_cast<const std::uint8_t*>(item.getItemPointer());
+      convertItem(beg, beg + item.size(), output);
+    }
+
+
+    //
+    void CV11toV12Converter::convertItem(const std::uint8_t* beg, const std::uint8_t* end,
+                                         Buffer::ByteBuffer& output) const
+    {
+      Item item = parseItem(beg, end);
+
+      switch (item.s_type) {
+        case V11::BEGIN_RUN:
+        case V11::END_RUN:
+        case V11::PAUSE_RUN:
+        case V11::RESUME_RUN:
+          convertStateChange(item, output);
+          break;
+        case V11::ABNORMAL_ENDRUN:
+          appendV12Item(output, V12::ABNORMAL_ENDRUN, 0, item.s_timestamp, item.s_sourceId);
+          break;
+        case V11::PACKET_TYPES:
+        case V11::MONITORED_VARIABLES:
+          convertText(item, output);
+          break;
+        case V11::RING_FORMAT:
+          appendV12FormatItem(output, m_sourceId);
+          break;
+        case V11::PERIODIC_SCALERS:
+          convertScalers(item, output);
+          break;
+        case V11::PHYSICS_EVENT:
+          if ((m_builtPolicy == NeverBuilt) || !convertBuiltEvent(item, output)) {
+            convertVerbatim(item, V12::PHYSICS_EVENT, output);
+          }
+          break;
+        case V11::PHYSICS_EVENT_COUNT:
+          convertPhysicsEventCount(item, output);
+          break;
+        case V11::EVB_GLOM_INFO:
+          convertGlomParameters(item, output);
+          break;
+        default:
+          // user items keep their offset from the first user code. V11 user
+          // codes that would land in the V12 composite range are dropped, as are
+          // fragments, which have no V12 equivalent.
+          if ((item.s_type >= V11::FIRST_USER_ITEM_CODE)
+              && (item.s_type - V11::FIRST_USER_ITEM_CODE
+                  < V12CompositeBit - V12::FIRST_USER_ITEM_CODE)) {
+            convertVerbatim(item,
+                            V12::FIRST_USER_ITEM_CODE + (item.s_type - V11::FIRST_USER_ITEM_CODE),
+                            output);
+          }
+          break;
+      }
+    }
+
+
+    //
+    std::size_t CV11toV12Converter::convert(std::istream& input, std::ostream& output)
+    {
+      ItemFraming framing = {"CV11toV12Converter", "V11",
+                             V11HeaderSize, V11MinItemSize, typeNeedsSwap};
+
+      // every V12 stream begins with the format
+      auto onFirstItem = [this, &output](const std::uint8_t* beg, const std::uint8_t* end) {
+        if (parseItem(beg, end).s_type != V11::RING_FORMAT) {
+          Buffer::ByteBuffer formatItem;
+          appendV12FormatItem(formatItem, m_sourceId);
+          output.write(reinterpret_cast<const char*>(formatItem.data()), formatItem.size());
+        }
+      };
+
+      auto convert = [this](const std::uint8_t* beg, const std::uint8_t* end,
+                            Buffer::ByteBuffer& converted) {
+        convertItem(beg, end, converted);
+      };
+
+      return convertItemStream(input, output, framing, m_batchSize, getThreadCount(),
+                               convert, onFirstItem);
+    }
+
+
+    //
+    void CV11toV12Converter::setThreadCount(unsigned nThreads)
+    {
+      m_nThreads = nThreads;
+    }
+
+
+    //
+    unsigned CV11toV12Converter::getThreadCount() const
+    {
+      return resolveThreadCount(m_nThreads);
+    }
+
+
+    //
+    void CV11toV12Converter::setBatchSize(std::size_t nBytes)
+    {
+      if (nBytes == 0) {
+        throw std::invalid_argument("DAQ::Conversion::CV11toV12Converter::setBatchSize() batch size must be nonzero.");
+      }
+      m_batchSize = nBytes;
+    }
+
+
+    //
+    CV11toV12Converter::Item
+    CV11toV12Converter::parseItem(const std::uint8_t* beg, const std::uint8_t* end) const
+    {
+      std::size_t available = end - beg;
+      if (available < V11MinItemSize) {
+        throwMalformed("parseItem", "Item is smaller than a V11 header.");
+      }
+
+      Item item;
+      item.s_swap = typeNeedsSwap(beg);
+      BO::CByteSwapper swapper(item.s_swap);
+
+      std::uint32_t size = swapper.copyAs<std::uint32_t>(beg);
+      if ((size < V11MinItemSize) || (size > available)) {
+        throwMalformed("parseItem", "Item size is inconsistent with the data present.");
+      }
+      item.s_type = swapper.copyAs<std::uint32_t>(beg + sizeof(std::uint32_t));
+      item.s_end  = beg + size;
+
+      std::uint32_t bodyHeaderSize = swapper.copyAs<std::uint32_t>(beg + V11HeaderSize);
+      if (bodyHeaderSize == 0) {
+        item.s_timestamp = V12::NULL_TIMESTAMP;
+        item.s_sourceId  = m_sourceId;
+        item.s_body      = beg + V11MinItemSize;
+      } else {
+        if ((bodyHeaderSize < V11BodyHeaderSize) || (V11HeaderSize + bodyHeaderSize > size)) {
+          throwMalformed("parseItem", "Body header size is inconsistent with the item size.");
+        }
+        const std::uint8_t* pBodyHeader = beg + V11HeaderSize;
+        item.s_timestamp = swapper.copyAs<std::uint64_t>(pBodyHeader + sizeof(std::uint32_t));
+        item.s_sourceId  = swapper.copyAs<std::uint32_t>(pBodyHeader + 3*sizeof(std::uint32_t));
+        item.s_body      = pBodyHeader + bodyHeaderSize;
+      }
+
+      return item;
+    }
+
+
+    //
+    void CV11toV12Converter::convertStateChange(const Item& item,
+                                                Buffer::ByteBuffer& output) const
+    {
+      std::size_t bodySize = item.s_end - item.s_body;
+      if (bodySize < StateChangeFixedSize) {
+        throwMalformed("convertStateChange", "Item is too small for a state change.");
+      }
+
+      BO::CByteSwapper swapper(item.s_swap);
+      const std::uint8_t* pos = item.s_body;
+      std::uint32_t run, offset, timestamp, divisor;
+      pos = swapper.interpretAs(pos, run);
+      pos = swapper.interpretAs(pos, offset);
+      pos = swapper.interpretAs(pos, timestamp);
+      pos = swapper.interpretAs(pos, divisor);
+
+      // the V11 title is a null terminated string in a fixed size field
+      const char* titleBeg = reinterpret_cast<const char*>(pos);
+      std::size_t titleMax = std::min<std::size_t>(V11_TITLE_MAXSIZE + 1, item.s_end - pos);
+      std::uint32_t titleSize = std::find(titleBeg, titleBeg + titleMax, '\0') - titleBeg;
+
+      std::uint8_t* body = appendV12Item(output, item.s_type,
+                                         5*sizeof(std::uint32_t) + titleSize,
+                                         item.s_timestamp, item.s_sourceId);
+      body = put(body, run);
+      body = put(body, offset);
+      body = put(body, timestamp);
+      body = put(body, divisor);
+      body = put(body, titleSize);
+      std::copy(titleBeg, titleBeg + titleSize, body);
+    }
+
+
+    //
+    void CV11toV12Converter::convertText(const Item& item, Buffer::ByteBuffer& output) const
+    {
+      std::size_t bodySize = item.s_end - item.s_body;
+      if (bodySize < TextFixedSize) {
+        throwMalformed("convertText", "Item is too small for a text item.");
+      }
+
+      BO::CByteSwapper swapper(item.s_swap);
+      const std::uint8_t* pos = item.s_body;
+      std::uint32_t offset, timestamp, nStrings, divisor;
+      pos = swapper.interpretAs(pos, offset);
+      pos = swapper.interpretAs(pos, timestamp);
+      pos = swapper.interpretAs(pos, nStrings);
+      pos = swapper.interpretAs(pos, divisor);
+
+      // the strings are identical in both versions, but only the first
+      // nStrings of them are kept. A last string without a null terminator is
+      // given one.
+      const std::uint8_t* stringsEnd = pos;
+      std::uint32_t nFound = 0;
+      while ((nFound < nStrings) && (stringsEnd != item.s_end)) {
+        stringsEnd = std::find(stringsEnd, item.s_end, '\0');
+        if (stringsEnd != item.s_end) {
+          ++stringsEnd;
+        }
+        ++nFound;
+      }
+      bool terminated = (stringsEnd == pos) || (*(stringsEnd-1) == '\0');
+      std::size_t nChars = (stringsEnd - pos) + (terminated ? 0 : 1);
+
+      std::uint8_t* body = appendV12Item(output, item.s_type, TextFixedSize + nChars,
+                                         item.s_timestamp, item.s_sourceId);
+      body = put(body, offset);
+      body = put(body, timestamp);
+      body = put(body, nFound);
+      body = put(body, divisor);
+      body = std::copy(pos, stringsEnd, body);
+      if (!terminated) {
+        *body = '\0';
+      }
+    }
+
+
+    //
+    void CV11toV12Converter::convertScalers(const Item& item, Buffer::ByteBuffer& output) const
+    {
+      std::size_t bodySize = item.s_end - item.s_body;
+      if (bodySize < ScalerFixedSize) {
+        throwMalformed("convertScalers", "Item is too small for a scaler item.");
+      }
+
+      BO::CByteSwapper swapper(item.s_swap);
+      const std::uint8_t* pos = item.s_body;
+      std::uint32_t startOffset, endOffset, timestamp, divisor, nScalers, isIncremental;
+      pos = swapper.interpretAs(pos, startOffset);
+      pos = swapper.interpretAs(pos, endOffset);
+      pos = swapper.interpretAs(pos, timestamp);
+      pos = swapper.interpretAs(pos, divisor);
+      pos = swapper.interpretAs(pos, nScalers);
+      pos = swapper.interpretAs(pos, isIncremental);
+
+      if (ScalerFixedSize + std::size_t(nScalers)*sizeof(std::uint32_t) > bodySize) {
+        throwMalformed("convertScalers", "Scaler count exceeds the item size.");
+      }
+
+      std::uint8_t* body = appendV12Item(output, V12::PERIODIC_SCALERS,
+                                         7*sizeof(std::uint32_t) + nScalers*sizeof(std::uint32_t),
+                                         item.s_timestamp, item.s_sourceId);
+      body = put(body, startOffset);
+      body = put(body, endOffset);
+      body = put(body, timestamp);
+      body = put(body, divisor);
+      body = put(body, nScalers);
+      body = put(body, isIncremental);
+      body = put(body, std::uint32_t(32));    // scaler width
+
+      if (item.s_swap) {
+        for (std::uint32_t i=0; i<nScalers; ++i) {
+          body = put(body, swapper.copyAs<std::uint32_t>(pos));
+          pos += sizeof(std::uint32_t);
+        }
+      } else {
+        std::memcpy(body, pos, nScalers*sizeof(std::uint32_t));
+      }
+    }
+
+
+    //
+    void CV11toV12Converter::convertPhysicsEventCount(const Item& item,
+                                                      Buffer::ByteBuffer& output) const
+    {
+      if (std::size_t(item.s_end - item.s_body) < PhysicsCountBodySize) {
+        throwMalformed("convertPhysicsEventCount", "Item is too small for an event count item.");
+      }
+
+      BO::CByteSwapper swapper(item.s_swap);
+      const std::uint8_t* pos = item.s_body;
+      std::uint32_t offset, divisor, timestamp;
+      std::uint64_t count;
+      pos = swapper.interpretAs(pos, offset);
+      pos = swapper.interpretAs(pos, divisor);
+      pos = swapper.interpretAs(pos, timestamp);
+      pos = swapper.interpretAs(pos, count);
+
+      // V12 moves the unix timestamp ahead of the divisor
+      std::uint8_t* body = appendV12Item(output, V12::PHYSICS_EVENT_COUNT, PhysicsCountBodySize,
+                                         item.s_timestamp, item.s_sourceId);
+      body = put(body, offset);
+      body = put(body, timestamp);
+      body = put(body, divisor);
+      body = put(body, count);
+    }
+
+
+    //
+    void CV11toV12Converter::convertGlomParameters(const Item& item,
+                                                   Buffer::ByteBuffer& output) const
+    {
+      if (std::size_t(item.s_end - item.s_body) < GlomBodySize) {
+        throwMalformed("convertGlomParameters", "Item is too small for a glom parameters item.");
+      }
+
+      BO::CByteSwapper swapper(item.s_swap);
+      const std::uint8_t* pos = item.s_body;
+      std::uint64_t ticks;
+      std::uint16_t isBuilding, policy;
+      pos = swapper.interpretAs(pos, ticks);
+      pos = swapper.interpretAs(pos, isBuilding);
+      pos = swapper.interpretAs(pos, policy);
+
+      std::uint8_t* body = appendV12Item(output, V12::EVB_GLOM_INFO, GlomBodySize,
+                                         item.s_timestamp, item.s_sourceId);
+      body = put(body, ticks);
+      body = put(body, isBuilding);
+      body = put(body, policy);
+    }
+
+
+    //
+    void CV11toV12Converter::convertVerbatim(const Item& item, std::uint32_t type,
+                                             Buffer::ByteBuffer& output) const
+    {
+      // the header is written in the byte order of the V11 data so that
+      // consumers of the V12 item know to swap the verbatim body
+      std::size_t bodySize = item.s_end - item.s_body;
+      std::uint8_t* body = appendV12Item(output, type, bodySize,
+                                         item.s_timestamp, item.s_sourceId, item.s_swap);
+      std::memcpy(body, item.s_body, bodySize);
+    }
+
+
+    /*
+     * Convert a built physics event to a COMP_PHYSICS_EVENT with one
+     * PHYSICS_EVENT child per fragment.
+     *
+     * Returns false if the event was not recognized as built, in which case
+     * nothing is appended to the output.
+     */
+    bool CV11toV12Converter::convertBuiltEvent(const Item& item,
+                                               Buffer::ByteBuffer& output) const
+    {
+      std::size_t bodySize = item.s_end - item.s_body;
+
+      // the first pass validates the fragments and sizes the composite
+      std::size_t compositeBodySize = 0;
+      try {
+        V11::CFragmentRange fragments(item.s_body, bodySize, item.s_swap);
+
+        std::size_t nFragments = 0;
+        for (const V11::FragmentRef& frag : fragments) {
+          const std::uint8_t* payloadEnd = frag.s_pPayload + frag.s_payloadSize;
+          Item payload = parseItem(frag.s_pPayload, payloadEnd);
+          if (payload.s_end != payloadEnd) {
+            throwMalformed("convertBuiltEvent", "Fragment payload size differs from the size of its item.");
+          }
+          if (payload.s_type != V11::PHYSICS_EVENT) {
+            throwMalformed("convertBuiltEvent", "Fragment payload is not a physics event.");
+          }
+          compositeBodySize += V12HeaderSize + (payload.s_end - payload.s_body);
+          ++nFragments;
+        }
+
+        // without being told, only a body that is entirely fragments is built
+        if (m_builtPolicy == DetectBuiltEvents) {
+          BO::CByteSwapper swapper(item.s_swap);
+          if ((nFragments == 0) || (swapper.copyAs<std::uint32_t>(item.s_body) != bodySize)) {
+            return false;
+          }
+        }
+      }
+      catch (std::runtime_error&) {
+        if (m_builtPolicy == AlwaysBuilt) {
+          throw;
+        }
+        return false;
+      }
+
+      std::uint8_t* pos = appendV12Item(output, V12::COMP_PHYSICS_EVENT, compositeBodySize,
+                                        item.s_timestamp, item.s_sourceId, item.s_swap);
+
+      for (const V11::FragmentRef& frag : V11::CFragmentRange(item.s_body, bodySize, item.s_swap)) {
+        Item payload = parseItem(frag.s_pPayload, frag.s_pPayload + frag.s_payloadSize);
+        std::size_t payloadBodySize = payload.s_end - payload.s_body;
+
+        pos = V12::Encoder::encodeHeader(pos, std::uint32_t(V12HeaderSize + payloadBodySize),
+                                         V12::PHYSICS_EVENT, frag.s_timestamp, frag.s_sourceId,
+                                         payload.s_swap);
+        pos = std::copy(payload.s_body, payload.s_end, pos);
+      }
+
+      return true;
+    }
+
+  } // end Conversion
+} // end DAQ
@@ -0,0 +1,195 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CONVERSION_CV11TOV12CONVERTER_H
+#define DAQ_CONVERSION_CV11TOV12CONVERTER_H
+
+#include <ByteBuffer.h>
+
+#include <cstdint>
+#include <iosfwd>
+
+namespace DAQ {
+
+  namespace V11 {
+    class CRingItem;
+  }
+
+  namespace Conversion {
+
+    /*!
+     * \brief Streaming converter from version 11 ring items to version 12 ring items
+     *
+     * Like CV8toV12Converter, the converter works directly on the bytes of the
+     * V11 items and writes the V12 items in wire format into a byte buffer. No
+     * V11::CRingItem or V12::CRingItem objects are created along the way. The
+     * mapping is:
+     *
+     * +----------------------------------------+--------------------------------+
+     * | V11 item type                          | V12 item type                  |
+     * +----------------------------------------+--------------------------------+
+     * | BEGIN_RUN, END_RUN, PAUSE_RUN, ...     | BEGIN_RUN, END_RUN, ...        |
+     * | ABNORMAL_ENDRUN                        | ABNORMAL_ENDRUN                |
+     * | PACKET_TYPES, MONITORED_VARIABLES      | PACKET_TYPES, ...              |
+     * | RING_FORMAT                            | RING_FORMAT (12.0)             |
+     * | PERIODIC_SCALERS                       | PERIODIC_SCALERS (32-bit)      |
+     * | PHYSICS_EVENT (built)                  | COMP_PHYSICS_EVENT             |
+     * | PHYSICS_EVENT (not built)              | PHYSICS_EVENT                  |
+     * | PHYSICS_EVENT_COUNT                    | PHYSICS_EVENT_COUNT            |
+     * | EVB_GLOM_INFO                          | EVB_GLOM_INFO                  |
+     * | FIRST_USER_ITEM_CODE + n (n < 0x4000)  | V12 FIRST_USER_ITEM_CODE + n   |
+     * | EVB_FRAGMENT, anything else            | dropped                        |
+     * +----------------------------------------+--------------------------------+
+     *
+     * The timestamp and source id of the body header become the timestamp and
+     * source id of the V12 header. Items without a body header are given a
+     * NULL_TIMESTAMP and the source id that the converter was constructed with.
+     *
+     * A built physics event is a sequence of event builder fragments (see
+     * V11::CFragmentRange). Each fragment becomes a PHYSICS_EVENT child of a
+     * COMP_PHYSICS_EVENT whose timestamp and source id are those of the
+     * fragment header. The body of the child is the body of the fragment's
+     * payload item. Whether a physics event is built is controlled by the
+     * BuiltEventPolicy.
+     *
+     * The bodies of physics events and user items are copied verbatim and their
+     * V12 headers are written in the byte order of the V11 item, so that readers
+     * know to swap the body. All other items are written in native byte order.
+     *
+     * The stream conversion reads the input in large batches, locates the item
+     * boundaries, and converts the items of each batch on several threads.
+     * Output order is always identical to the input order.
+     *
+     * \code
+     * #include <CV11toV12Converter.h>
+     * #include <fstream>
+     *
+     * using namespace DAQ;
+     *
+     * std::ifstream input("run-0012-00.evt", std::ios::binary);
+     * std::ofstream output("run-0012-00.v12.evt", std::ios::binary);
+     *
+     * Conversion::CV11toV12Converter converter;
+     * converter.convert(input, output);
+     * \endcode
+     */
+    class CV11toV12Converter
+    {
+    public:
+      /*!
+       * \brief How to recognize physics events that were output by the event builder
+       */
+      enum BuiltEventPolicy {
+        DetectBuiltEvents,  //!< built if the body parses exactly as fragments of physics events
+        AlwaysBuilt,        //!< all physics events are built. Malformed events are an error.
+        NeverBuilt          //!< physics events are converted verbatim
+      };
+
+    private:
+      std::uint32_t     m_sourceId;
+      BuiltEventPolicy  m_builtPolicy;
+      unsigned          m_nThreads;
+      std::size_t       m_batchSize;
+
+    public:
+      /*!
+       * \brief Constructor
+       *
+       * \param sourceId     the source id to assign to items without a body header
+       * \param builtPolicy  how to recognize built physics events
+       */
+      CV11toV12Converter(std::uint32_t sourceId = 0,
+                         BuiltEventPolicy builtPolicy = DetectBuiltEvents);
+
+      /*!
+       * \brief Convert a single item
+       *
+       * The V12 item produced, if any, is appended to the output buffer.
+       *
+       * \param item    the V11 item
+       * \param output  the buffer to append V12 data to
+       *
+       * \throws std::runtime_error if the item is malformed
+       */
+      void convertItem(const V11::CRingItem& item, Buffer::ByteBuffer& output) const;
+
+      /*!
+       * \brief Convert a single item of raw bytes
+       *
+       * Same as the CRingItem overload except that the data is taken directly
+       * from a range of bytes [beg, end) that begins with one V11 item.
+       */
+      void convertItem(const std::uint8_t* beg, const std::uint8_t* end,
+                       Buffer::ByteBuffer& output) const;
+
+      /*!
+       * \brief Convert a stream of V11 items to a stream of V12 items
+       *
+       * The first item of the output is always a V12 RING_FORMAT item, either
+       * converted from the first input item or, if the input does not begin
+       * with one, added by the converter.
+       *
+       * \param input   the stream to read V11 data from
+       * \param output  the stream to write V12 data to
+       *
+       * \return the number of V11 items read
+       *
+       * \throws std::runtime_error if any item is malformed or the input ends
+       *                            in the middle of an item
+       */
+      std::size_t convert(std::istream& input, std::ostream& output);
+
+      /*!
+       * \brief Set the number of worker threads used by convert()
+       *
+       * A value of 0 selects std::thread::hardware_concurrency().
+       */
+      void setThreadCount(unsigned nThreads);
+      unsigned getThreadCount() const;
+
+      /*!
+       * \brief Set the number of bytes read per batch in convert()
+       *
+       * Items larger than a batch are still converted; the batch grows to hold them.
+       */
+      void setBatchSize(std::size_t nBytes);
+      std::size_t getBatchSize() const { return m_batchSize; }
+
+      std::uint32_t getSourceId() const { return m_sourceId; }
+      void setSourceId(std::uint32_t id) { m_sourceId = id; }
+
+      BuiltEventPolicy getBuiltEventPolicy() const { return m_builtPolicy; }
+      void setBuiltEventPolicy(BuiltEventPolicy policy) { m_builtPolicy = policy; }
+
+    private:
+      struct Item;
+
+      Item parseItem(const std::uint8_t* beg, const std::uint8_t* end) const;
+
+      void convertStateChange(const Item& item, Buffer::ByteBuffer& output) const;
+      void convertText(const Item& item, Buffer::ByteBuffer& output) const;
+      void convertScalers(const Item& item, Buffer::ByteBuffer& output) const;
+      void convertPhysicsEventCount(const Item& item, Buffer::ByteBuffer& output) const;
+      void convertGlomParameters(const Item& item, Buffer::ByteBuffer& output) const;
+      void convertVerbatim(const Item& item, std::uint32_t type,
+                           Buffer::ByteBuffer& output) const;
+      bool convertBuiltEvent(const Item& item, Buffer::ByteBuffer& output) const;
+    };
+
+  } // end Conversion
+} // end DAQ
+
+#endif // DAQ_CONVERSION_CV11TOV12CONVERTER_H
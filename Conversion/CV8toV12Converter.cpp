@@ -0,0 +1,470 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CV8toV12Converter.h"
+#include "ConversionUtils.h"
+
+#include <V8/CRawBuffer.h>
+#include <V8/bheader.h>
+#include <V12/DataFormat.h>
+#include <ByteOrder.h>
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace DAQ {
+  namespace Conversion {
+
+    namespace {
+
+      const std::size_t V8HeaderSize   = 16*sizeof(std::uint16_t);
+
+      // V8 body offsets (in bytes from the start of the buffer)
+      const std::size_t ScalerEndOffsetPos    = 32;
+      const std::size_t ScalerBeginOffsetPos  = 42;
+      const std::size_t ScalerValuesPos       = 52;
+      const std::size_t ControlTitlePos       = 32;
+      const std::size_t ControlTitleSize      = 80;
+      const std::size_t ControlOffsetPos      = 112;
+      const std::size_t ControlTimePos        = 116;
+      const std::size_t ControlBodyEnd        = ControlTimePos + 7*sizeof(std::uint16_t);
+      const std::size_t TextTotalShortsPos    = 32;
+      const std::size_t TextStringsPos        = 34;
+
+      // grow the output by one item of the given body size, fill in the V12
+      // header, and return a pointer to the start of the body. V8 has no
+      // timestamps.
+      std::uint8_t* appendItem(Buffer::ByteBuffer& output, std::uint32_t type,
+                               std::size_t bodySize, std::uint32_t sourceId,
+                               bool swap = false)
+      {
+        return appendV12Item(output, type, bodySize, V12::NULL_TIMESTAMP, sourceId, swap);
+      }
+
+      void throwMalformed(const std::string& where, const std::string& what)
+      {
+        throwConversionError("CV8toV12Converter", where, what);
+      }
+
+      std::uint32_t mapControlType(std::uint16_t type)
+      {
+        switch (type) {
+          case V8::BEGRUNBF: return V12::BEGIN_RUN;
+          case V8::ENDRUNBF: return V12::END_RUN;
+          case V8::PAUSEBF:  return V12::PAUSE_RUN;
+          default:           return V12::RESUME_RUN;
+        }
+      }
+
+      std::time_t readControlTime(const std::uint8_t* beg, const BO::CByteSwapper& swapper)
+      {
+        V8::bftime time;
+        const std::uint8_t* pos = beg + ControlTimePos;
+        pos = swapper.interpretAs(pos, time.month);
+        pos = swapper.interpretAs(pos, time.day);
+        pos = swapper.interpretAs(pos, time.year);
+        pos = swapper.interpretAs(pos, time.hours);
+        pos = swapper.interpretAs(pos, time.min);
+        pos = swapper.interpretAs(pos, time.sec);
+        pos = swapper.interpretAs(pos, time.tenths);
+
+        return V8::to_time_t(time);
+      }
+
+      // the V8 byte order is flagged by the 32-bit signature in the header
+      bool bufferNeedsSwap(const std::uint8_t* beg)
+      {
+        std::uint32_t lsig;
+        std::memcpy(&lsig, beg + 24, sizeof(lsig));
+        return (lsig != V8::BOM32);
+      }
+
+    } // end anonymous namespace
+
+
+    //
+    CV8toV12Converter::CV8toV12Converter(std::uint32_t sourceId,
+                                         V8::PhysicsEventSizePolicy sizePolicy)
+      : m_sourceId(sourceId),
+        m_sizePolicy(sizePolicy),
+        m_runStartTime(0),
+        m_nThreads(0),
+        m_batchSize(64)
+    {}
+
+
+    //
+    void CV8toV12Converter::convertBuffer(const V8::CRawBuffer& buffer,
+                                          Buffer::ByteBuffer& output)
+    {
+      auto& bytes = buffer.getBuffer();
+      convertBuffer(bytes.data(), bytes.data() + bytes.size(), output);
+    }
+
+
+    //
+    void CV8toV12Converter::convertBuffer(const std::uint8_t* beg, const std::uint8_t* end,
+                                          Buffer::ByteBuffer& output)
+    {
+      convertBuffer(beg, end, output, m_runStartTime);
+      m_runStartTime = updateRunStartTime(beg, end, m_runStartTime);
+    }
+
+
+    //
+    void CV8toV12Converter::convertBuffer(const std::uint8_t* beg, const std::uint8_t* end,
+                                          Buffer::ByteBuffer& output,
+                                          std::time_t runStart) const
+    {
+      if (std::size_t(end - beg) < V8HeaderSize) {
+        throwMalformed("convertBuffer", "Buffer is smaller than a V8 header.");
+      }
+
+      bool swap = bufferNeedsSwap(beg);
+      BO::CByteSwapper swapper(swap);
+
+      std::uint16_t type = swapper.copyAs<std::uint16_t>(beg + 2);
+      std::uint16_t run  = swapper.copyAs<std::uint16_t>(beg + 6);
+      std::uint16_t nevt = swapper.copyAs<std::uint16_t>(beg + 12);
+
+      switch (type) {
+        case V8::DATABF:
+          convertPhysicsEvents(beg, end, nevt, swap, output);
+          break;
+        case V8::SCALERBF:
+        case V8::SNAPSCBF:
+          convertScalers(beg, end, type, nevt, swap, runStart, output);
+          break;
+        case V8::BEGRUNBF:
+        case V8::ENDRUNBF:
+        case V8::PAUSEBF:
+        case V8::RESUMEBF:
+          convertControl(beg, end, type, run, swap, output);
+          break;
+        case V8::STATEVARBF:
+        case V8::RUNVARBF:
+        case V8::PARAMDESCRIP:
+        case V8::PKTDOCBF:
+          convertText(beg, end, type, swap, runStart, output);
+          break;
+        default:
+          // no V12 equivalent... drop it
+          break;
+      }
+    }
+
+
+    //
+    std::size_t CV8toV12Converter::convert(std::istream& input, std::ostream& output)
+    {
+      // every V12 stream begins with the format
+      Buffer::ByteBuffer formatItem;
+      appendV12FormatItem(formatItem, m_sourceId);
+      output.write(reinterpret_cast<const char*>(formatItem.data()), formatItem.size());
+
+      auto readBatch = [&input, this](Buffer::ByteBuffer& batch) {
+        batch.resize(m_batchSize*V8::gBufferSize);
+        input.read(reinterpret_cast<char*>(batch.data()), batch.size());
+        std::size_t nRead = input.gcount();
+
+        // round up to whole buffers, zero filling a trailing partial buffer
+        std::size_t nBuffers = (nRead + V8::gBufferSize - 1)/V8::gBufferSize;
+        std::fill(batch.begin() + nRead, batch.end(), 0);
+        batch.resize(nBuffers*V8::gBufferSize);
+      };
+
+      unsigned nThreads = getThreadCount();
+      std::size_t nConverted = 0;
+
+      Buffer::ByteBuffer batch, nextBatch;
+      readBatch(batch);
+
+      while (!batch.empty()) {
+        std::size_t nBuffers = batch.size()/V8::gBufferSize;
+
+        // the run start time is the only state carried between buffers. Resolve
+        // it sequentially so that the buffers can be converted independently.
+        std::vector<std::time_t> runStarts(nBuffers);
+        for (std::size_t i=0; i<nBuffers; ++i) {
+          const std::uint8_t* pBuf = batch.data() + i*V8::gBufferSize;
+          runStarts[i] = m_runStartTime;
+          m_runStartTime = updateRunStartTime(pBuf, pBuf + V8::gBufferSize, m_runStartTime);
+        }
+
+        std::vector<const std::uint8_t*> bounds(nBuffers + 1);
+        for (std::size_t i=0; i<=nBuffers; ++i) {
+          bounds[i] = batch.data() + i*V8::gBufferSize;
+        }
+
+        const std::uint8_t* pBatch = batch.data();
+        auto convert = [this, pBatch, &runStarts](const std::uint8_t* beg, const std::uint8_t* end,
+                                                  Buffer::ByteBuffer& converted) {
+          convertBuffer(beg, end, converted, runStarts[(beg - pBatch)/V8::gBufferSize]);
+        };
+        auto results = startConversion(bounds, nThreads, convert);
+
+        // overlap reading the next batch with the conversion of this one
+        readBatch(nextBatch);
+        writeConversion(results, output);
+
+        nConverted += nBuffers;
+        batch.swap(nextBatch);
+      }
+
+      return nConverted;
+    }
+
+
+    //
+    void CV8toV12Converter::setThreadCount(unsigned nThreads)
+    {
+      m_nThreads = nThreads;
+    }
+
+
+    //
+    unsigned CV8toV12Converter::getThreadCount() const
+    {
+      return resolveThreadCount(m_nThreads);
+    }
+
+
+    //
+    void CV8toV12Converter::setBatchSize(std::size_t nBuffers)
+    {
+      if (nBuffers == 0) {
+        throw std::invalid_argument("DAQ::Conversion::CV8toV12Converter::setBatchSize() batch size must be nonzero.");
+      }
+      m_batchSize = nBuffers;
+    }
+
+
+    //
+    void CV8toV12Converter::convertPhysicsEvents(const std::uint8_t* beg,
+                                                 const std::uint8_t* end,
+                                                 std::uint16_t nEvents, bool swap,
+                                                 Buffer::ByteBuffer& output) const
+    {
+      const std::uint8_t* pos = beg + V8HeaderSize;
+
+      for (std::size_t index=0; (pos<end) && (index<nEvents); ++index) {
+        std::size_t nBytes = computeEventSize(pos, end, swap);
+
+        // the header is written in the byte order of the V8 data so that
+        // consumers of the V12 item know to swap the verbatim body
+        std::uint8_t* body = appendItem(output, V12::PHYSICS_EVENT, nBytes,
+                                        m_sourceId, swap);
+        std::memcpy(body, pos, nBytes);
+
+        pos += nBytes;
+      }
+    }
+
+
+    //
+    void CV8toV12Converter::convertScalers(const std::uint8_t* beg,
+                                           const std::uint8_t* end,
+                                           std::uint16_t type, std::uint16_t nScalers,
+                                           bool swap, std::time_t runStart,
+                                           Buffer::ByteBuffer& output) const
+    {
+      if (ScalerValuesPos + nScalers*sizeof(std::uint32_t) > std::size_t(end - beg)) {
+        throwMalformed("convertScalers", "Scaler count exceeds the buffer size.");
+      }
+
+      BO::CByteSwapper swapper(swap);
+      std::uint32_t offsetEnd   = swapper.copyAs<std::uint32_t>(beg + ScalerEndOffsetPos);
+      std::uint32_t offsetBegin = swapper.copyAs<std::uint32_t>(beg + ScalerBeginOffsetPos);
+
+      std::size_t bodySize = 7*sizeof(std::uint32_t) + nScalers*sizeof(std::uint32_t);
+      std::uint8_t* pos = appendItem(output, V12::PERIODIC_SCALERS, bodySize, m_sourceId);
+
+      pos = put(pos, offsetBegin);
+      pos = put(pos, offsetEnd);
+      pos = put(pos, std::uint32_t(runStart + offsetEnd));
+      pos = put(pos, std::uint32_t(1));                           // divisor
+      pos = put(pos, std::uint32_t(nScalers));
+      pos = put(pos, std::uint32_t(type == V8::SCALERBF ? 1 : 0)); // incremental?
+      pos = put(pos, std::uint32_t(32));                          // scaler width
+
+      const std::uint8_t* pScaler = beg + ScalerValuesPos;
+      for (std::size_t i=0; i<nScalers; ++i) {
+        pos = put(pos, swapper.copyAs<std::uint32_t>(pScaler));
+        pScaler += sizeof(std::uint32_t);
+      }
+    }
+
+
+    //
+    void CV8toV12Converter::convertControl(const std::uint8_t* beg,
+                                           const std::uint8_t* end,
+                                           std::uint16_t type, std::uint16_t run,
+                                           bool swap,
+                                           Buffer::ByteBuffer& output) const
+    {
+      if (ControlBodyEnd > std::size_t(end - beg)) {
+        throwMalformed("convertControl", "Buffer is too small for a control buffer.");
+      }
+
+      BO::CByteSwapper swapper(swap);
+      std::uint32_t offset = swapper.copyAs<std::uint32_t>(beg + ControlOffsetPos);
+      std::time_t   time   = readControlTime(beg, swapper);
+
+      // V8 titles are padded with spaces to fill the 80 characters
+      const char* titleBeg = reinterpret_cast<const char*>(beg + ControlTitlePos);
+      const char* titleEnd = titleBeg + ControlTitleSize;
+      titleEnd = std::find(titleBeg, titleEnd, '\0');
+      while ((titleEnd != titleBeg) && (*(titleEnd-1) == ' ')) {
+        --titleEnd;
+      }
+      std::uint32_t titleSize = titleEnd - titleBeg;
+
+      std::size_t bodySize = 5*sizeof(std::uint32_t) + titleSize;
+      std::uint8_t* pos = appendItem(output, mapControlType(type), bodySize, m_sourceId);
+
+      pos = put(pos, std::uint32_t(run));
+      pos = put(pos, offset);
+      pos = put(pos, std::uint32_t(time));
+      pos = put(pos, std::uint32_t(1));   // divisor
+      pos = put(pos, titleSize);
+      std::copy(titleBeg, titleEnd, pos);
+    }
+
+
+    //
+    void CV8toV12Converter::convertText(const std::uint8_t* beg,
+                                        const std::uint8_t* end,
+                                        std::uint16_t type, bool swap,
+                                        std::time_t runStart,
+                                        Buffer::ByteBuffer& output) const
+    {
+      if (TextStringsPos > std::size_t(end - beg)) {
+        throwMalformed("convertText", "Buffer is too small for a text buffer.");
+      }
+
+      BO::CByteSwapper swapper(swap);
+      std::uint16_t totalShorts = swapper.copyAs<std::uint16_t>(beg + TextTotalShortsPos);
+
+      const std::uint8_t* deadEnd = beg + TextTotalShortsPos + totalShorts*sizeof(std::uint16_t);
+      if (deadEnd > end) {
+        throwMalformed("convertText", "Text buffer states more data exists than is present.");
+      }
+
+      // first pass locates the strings so that the item can be sized exactly.
+      // Strings are null terminated and padded to an even number of bytes.
+      std::vector<std::pair<const std::uint8_t*, const std::uint8_t*> > strings;
+      const std::uint8_t* pos = beg + TextStringsPos;
+      std::size_t totalChars = 0;
+      while (pos < deadEnd) {
+        const std::uint8_t* strEnd = std::find(pos, deadEnd, '\0');
+        strings.push_back(std::make_pair(pos, strEnd));
+        totalChars += (strEnd - pos) + 1;
+
+        pos = strEnd + (((strEnd - pos)%2 == 0) ? 2 : 1);
+      }
+
+      std::uint32_t itemType = (type == V8::PKTDOCBF) ? V12::PACKET_TYPES
+                                                     : V12::MONITORED_VARIABLES;
+      std::size_t bodySize = 4*sizeof(std::uint32_t) + totalChars;
+      std::uint8_t* body = appendItem(output, itemType, bodySize, m_sourceId);
+
+      body = put(body, std::uint32_t(0));         // time offset
+      body = put(body, std::uint32_t(runStart));
+      body = put(body, std::uint32_t(strings.size()));
+      body = put(body, std::uint32_t(1));         // divisor
+      for (auto& str : strings) {
+        body = std::copy(str.first, str.second, body);
+        *body++ = '\0';
+      }
+    }
+
+
+    //
+    std::size_t CV8toV12Converter::computeEventSize(const std::uint8_t* pos,
+                                                    const std::uint8_t* end,
+                                                    bool swap) const
+    {
+      BO::CByteSwapper swapper(swap);
+      std::size_t available = end - pos;
+      std::size_t nWords = 0;
+
+      // sizes are expressed in 16-bit words to match V8::CGenericBodyParser
+      switch (m_sizePolicy) {
+        case V8::Inclusive16BitWords:
+        case V8::Exclusive16BitWords:
+          if (available < sizeof(std::uint16_t)) {
+            throwMalformed("computeEventSize", "Incomplete 16-bit integer for size provided");
+          }
+          nWords = swapper.copyAs<std::uint16_t>(pos);
+          if (m_sizePolicy == V8::Exclusive16BitWords) {
+            nWords += 1;
+          }
+          break;
+        case V8::Inclusive32BitWords:
+        case V8::Inclusive32BitBytes:
+          if (available < sizeof(std::uint32_t)) {
+            throwMalformed("computeEventSize", "Incomplete 32-bit integer for size provided");
+          }
+          nWords = swapper.copyAs<std::uint32_t>(pos);
+          if (m_sizePolicy == V8::Inclusive32BitBytes) {
+            if ((nWords%2) == 1) {
+              throwMalformed("computeEventSize",
+                             "Odd number of bytes found. Only parsing of an even number of bytes supported.");
+            }
+            nWords /= 2;
+          }
+          break;
+        default:
+          throwMalformed("computeEventSize", "invalid size policy");
+      }
+
+      if (nWords == 0) {
+        throwMalformed("computeEventSize", "Zero event size is invalid.");
+      }
+
+      std::size_t nBytes = nWords*sizeof(std::uint16_t);
+      if (nBytes > available) {
+        throwMalformed("computeEventSize", "Size of event states more data exists than is present");
+      }
+
+      return nBytes;
+    }
+
+
+    //
+    std::time_t CV8toV12Converter::updateRunStartTime(const std::uint8_t* beg,
+                                                      const std::uint8_t* end,
+                                                      std::time_t current) const
+    {
+      if (std::size_t(end - beg) < ControlBodyEnd) {
+        return current;
+      }
+
+      BO::CByteSwapper swapper(bufferNeedsSwap(beg));
+      if (swapper.copyAs<std::uint16_t>(beg + 2) != V8::BEGRUNBF) {
+        return current;
+      }
+
+      return readControlTime(beg, swapper);
+    }
+
+  } // end Conversion
+} // end DAQ
@@ -0,0 +1,185 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CONVERSION_CV8TOV12CONVERTER_H
+#define DAQ_CONVERSION_CV8TOV12CONVERTER_H
+
+#include <V8/DataFormat.h>
+#include <ByteBuffer.h>
+
+#include <cstdint>
+#include <ctime>
+#include <iosfwd>
+
+namespace DAQ {
+
+  namespace V8 {
+    class CRawBuffer;
+  }
+
+  namespace Conversion {
+
+    /*!
+     * \brief Streaming converter from version 8 buffers to version 12 ring items
+     *
+     * The converter works directly on the bytes of the V8 buffers and writes the
+     * V12 items in their serialized form (i.e. wire format) into a byte buffer.
+     * No V8::CV8Buffer or V12::CRingItem objects are created along the way. The
+     * mapping is:
+     *
+     * +--------------------------------------+----------------------+
+     * | V8 buffer type                       | V12 item type(s)     |
+     * +--------------------------------------+----------------------+
+     * | DATABF                               | PHYSICS_EVENT (1/evt)|
+     * | SCALERBF, SNAPSCBF                   | PERIODIC_SCALERS     |
+     * | BEGRUNBF, ENDRUNBF, PAUSEBF, RESUMEBF| BEGIN_RUN, ...       |
+     * | STATEVARBF, RUNVARBF, PARAMDESCRIP   | MONITORED_VARIABLES  |
+     * | PKTDOCBF                             | PACKET_TYPES         |
+     * | anything else                        | dropped              |
+     * +--------------------------------------+----------------------+
+     *
+     * All items are given a NULL_TIMESTAMP event timestamp and the source id
+     * that the converter was constructed with. The bodies of physics events are
+     * copied verbatim (including the V8 event size word). If the V8 buffer was
+     * not in native byte order, the header of the V12 physics event is written
+     * in the same foreign byte order so that readers will know to swap the body.
+     * All other items are written in native byte order.
+     *
+     * V8 scaler and text buffers have no absolute time. Their V12 counterparts
+     * use the time of the most recent BEGRUNBF as a reference point. For scalers,
+     * the unix timestamp is that reference plus the end of the counting interval.
+     *
+     * The stream conversion reads the input in large batches of buffers and
+     * converts each batch on several threads. Output order is always
+     * identical to the input order.
+     *
+     * \code
+     * #include <CV8toV12Converter.h>
+     * #include <fstream>
+     *
+     * using namespace DAQ;
+     *
+     * std::ifstream input("run-0012-00.evt", std::ios::binary);
+     * std::ofstream output("run-0012-00.v12.evt", std::ios::binary);
+     *
+     * Conversion::CV8toV12Converter converter;
+     * converter.convert(input, output);
+     * \endcode
+     */
+    class CV8toV12Converter
+    {
+    private:
+      std::uint32_t               m_sourceId;
+      V8::PhysicsEventSizePolicy  m_sizePolicy;
+      std::time_t                 m_runStartTime;
+      unsigned                    m_nThreads;
+      std::size_t                 m_batchSize;
+
+    public:
+      /*!
+       * \brief Constructor
+       *
+       * \param sourceId    the source id to assign to all V12 items
+       * \param sizePolicy  how to interpret the size of events in DATABF buffers
+       */
+      CV8toV12Converter(std::uint32_t sourceId = 0,
+                        V8::PhysicsEventSizePolicy sizePolicy = V8::Inclusive16BitWords);
+
+      /*!
+       * \brief Convert a single buffer
+       *
+       * The V12 items produced are appended to the output buffer. If the buffer
+       * is a BEGRUNBF, the reference time for subsequent scaler and text
+       * buffers is updated.
+       *
+       * \param buffer  the V8 buffer
+       * \param output  the buffer to append V12 data to
+       *
+       * \throws std::runtime_error if the buffer is malformed
+       */
+      void convertBuffer(const V8::CRawBuffer& buffer, Buffer::ByteBuffer& output);
+
+      /*!
+       * \brief Convert a single buffer of raw bytes
+       *
+       * Same as the CRawBuffer overload except that the data is taken
+       * directly from a range of bytes [beg, end) that represent one V8 buffer.
+       */
+      void convertBuffer(const std::uint8_t* beg, const std::uint8_t* end,
+                         Buffer::ByteBuffer& output);
+
+      /*!
+       * \brief Convert a stream of V8 buffers to a stream of V12 items
+       *
+       * Buffers are read in blocks of V8::gBufferSize bytes until the input
+       * is exhausted. A trailing partial buffer is zero padded. The first item
+       * of the output is a V12 RING_FORMAT item.
+       *
+       * \param input   the stream to read V8 data from
+       * \param output  the stream to write V12 data to
+       *
+       * \return the number of V8 buffers converted
+       *
+       * \throws std::runtime_error if any buffer is malformed
+       */
+      std::size_t convert(std::istream& input, std::ostream& output);
+
+      /*!
+       * \brief Set the number of worker threads used by convert()
+       *
+       * A value of 0 selects std::thread::hardware_concurrency().
+       */
+      void setThreadCount(unsigned nThreads);
+      unsigned getThreadCount() const;
+
+      /*! \brief Set the number of V8 buffers read per batch in convert() */
+      void setBatchSize(std::size_t nBuffers);
+      std::size_t getBatchSize() const { return m_batchSize; }
+
+      std::uint32_t getSourceId() const { return m_sourceId; }
+      void setSourceId(std::uint32_t id) { m_sourceId = id; }
+
+      std::time_t getRunStartTime() const { return m_runStartTime; }
+      void setRunStartTime(std::time_t time) { m_runStartTime = time; }
+
+    private:
+      void convertBuffer(const std::uint8_t* beg, const std::uint8_t* end,
+                         Buffer::ByteBuffer& output, std::time_t runStart) const;
+
+      void convertPhysicsEvents(const std::uint8_t* beg, const std::uint8_t* end,
+                                std::uint16_t nEvents, bool swap,
+                                Buffer::ByteBuffer& output) const;
+      void convertScalers(const std::uint8_t* beg, const std::uint8_t* end,
+                          std::uint16_t type, std::uint16_t nScalers, bool swap,
+                          std::time_t runStart, Buffer::ByteBuffer& output) const;
+      void convertControl(const std::uint8_t* beg, const std::uint8_t* end,
+                          std::uint16_t type, std::uint16_t run, bool swap,
+                          Buffer::ByteBuffer& output) const;
+      void convertText(const std::uint8_t* beg, const std::uint8_t* end,
+                       std::uint16_t type, bool swap, std::time_t runStart,
+                       Buffer::ByteBuffer& output) const;
+
+      std::size_t computeEventSize(const std::uint8_t* pos, const std::uint8_t* end,
+                                   bool swap) const;
+
+      std::time_t updateRunStartTime(const std::uint8_t* beg, const std::uint8_t* end,
+                                     std::time_t current) const;
+    };
+
+  } // end Conversion
+} // end DAQ
+
+#endif // DAQ_CONVERSION_CV8TOV12CONVERTER_H
@@ -0,0 +1,203 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "ConversionUtils.h"
+
+#include <V12/DataFormat.h>
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+
+namespace DAQ {
+  namespace Conversion {
+
+    //
+    void throwConversionError(const std::string& className,
+                              const std::string& where, const std::string& what)
+    {
+      std::string errmsg("DAQ::Conversion::");
+      errmsg += className + "::" + where + "() " + what;
+      throw std::runtime_error(errmsg);
+    }
+
+
+    //
+    bool typeNeedsSwap(const std::uint8_t* item)
+    {
+      std::uint32_t type;
+      std::memcpy(&type, item + sizeof(std::uint32_t), sizeof(type));
+      return ((type & 0xffff0000) != 0);
+    }
+
+
+    //
+    std::uint8_t* appendV12Item(Buffer::ByteBuffer& output, std::uint32_t type,
+                                std::size_t bodySize, std::uint64_t timestamp,
+                                std::uint32_t sourceId, bool swap)
+    {
+      std::size_t offset = output.size();
+      std::size_t itemSize = V12HeaderSize + bodySize;
+      output.resize(offset + itemSize);
+
+      return V12::Encoder::encodeHeader(output.data() + offset, std::uint32_t(itemSize),
+                                        type, timestamp, sourceId, swap);
+    }
+
+
+    //
+    void appendV12FormatItem(Buffer::ByteBuffer& output, std::uint32_t sourceId)
+    {
+      std::uint8_t* pos = appendV12Item(output, V12::RING_FORMAT, 2*sizeof(std::uint16_t),
+                                        V12::NULL_TIMESTAMP, sourceId);
+      pos = put(pos, V12::FORMAT_MAJOR);
+      pos = put(pos, V12::FORMAT_MINOR);
+    }
+
+
+    //
+    unsigned resolveThreadCount(unsigned nThreads)
+    {
+      if (nThreads == 0) {
+        nThreads = std::max(1u, std::thread::hardware_concurrency());
+      }
+      return nThreads;
+    }
+
+
+    //
+    std::vector<std::future<Buffer::ByteBuffer> >
+    startConversion(const std::vector<const std::uint8_t*>& bounds, unsigned nThreads,
+                    const UnitConverter& convert)
+    {
+      std::vector<std::future<Buffer::ByteBuffer> > results;
+      if (bounds.size() < 2) {
+        return results;
+      }
+
+      std::size_t nUnits = bounds.size() - 1;
+      std::size_t nWorkers = std::max<std::size_t>(1, std::min<std::size_t>(nThreads, nUnits));
+      std::size_t perWorker = (nUnits + nWorkers - 1)/nWorkers;
+
+      for (std::size_t first=0; first<nUnits; first += perWorker) {
+        std::size_t last = std::min(first + perWorker, nUnits);
+
+        results.push_back(std::async(std::launch::async,
+                                     [&bounds, convert, first, last]() {
+          Buffer::ByteBuffer converted;
+          converted.reserve((bounds[last] - bounds[first]) + 64);
+          for (std::size_t i=first; i<last; ++i) {
+            convert(bounds[i], bounds[i+1], converted);
+          }
+          return converted;
+        }));
+      }
+
+      return results;
+    }
+
+
+    //
+    void writeConversion(std::vector<std::future<Buffer::ByteBuffer> >& results,
+                         std::ostream& output)
+    {
+      for (auto& result : results) {
+        Buffer::ByteBuffer converted = result.get();
+        output.write(reinterpret_cast<const char*>(converted.data()), converted.size());
+      }
+    }
+
+
+    //
+    std::size_t convertItemStream(std::istream& input, std::ostream& output,
+                                  const ItemFraming& framing,
+                                  std::size_t batchSize, unsigned nThreads,
+                                  const UnitConverter& convert,
+                                  const std::function<void(const std::uint8_t*,
+                                                           const std::uint8_t*)>& onFirstItem)
+    {
+      // append up to one batch of bytes to whatever the buffer already holds
+      auto readBatch = [&input, batchSize](Buffer::ByteBuffer& batch) {
+        std::size_t kept = batch.size();
+        batch.resize(kept + batchSize);
+        input.read(reinterpret_cast<char*>(batch.data() + kept), batchSize);
+        batch.resize(kept + input.gcount());
+      };
+
+      std::size_t nConverted = 0;
+      bool first = true;
+
+      Buffer::ByteBuffer batch, nextBatch;
+      readBatch(batch);
+
+      while (!batch.empty()) {
+
+        // locate the complete items. The boundaries are the start of each item
+        // followed by the end of the last one.
+        std::vector<const std::uint8_t*> bounds;
+        const std::uint8_t* pos = batch.data();
+        const std::uint8_t* end = batch.data() + batch.size();
+        while (std::size_t(end - pos) >= framing.s_headerSize) {
+          BO::CByteSwapper swapper(framing.s_needsSwap(pos));
+          std::uint32_t size = swapper.copyAs<std::uint32_t>(pos);
+          if (size < framing.s_minItemSize) {
+            throwConversionError(framing.s_className, "convert",
+                                 std::string("Item is smaller than a ") + framing.s_version + " header.");
+          }
+          if (size > std::size_t(end - pos)) {
+            break;
+          }
+          bounds.push_back(pos);
+          pos += size;
+        }
+
+        if (bounds.empty()) {
+          // the first item is larger than what has been read so far
+          if (!input) {
+            throwConversionError(framing.s_className, "convert",
+                                 "Input ends in the middle of an item.");
+          }
+          readBatch(batch);
+          continue;
+        }
+        bounds.push_back(pos);
+
+        if (first && onFirstItem) {
+          onFirstItem(bounds[0], bounds[1]);
+        }
+        first = false;
+
+        // a partial item at the end of the batch starts the next one
+        nextBatch.assign(pos, end);
+
+        auto results = startConversion(bounds, nThreads, convert);
+
+        // overlap reading the next batch with the conversion of this one
+        readBatch(nextBatch);
+        writeConversion(results, output);
+
+        nConverted += bounds.size() - 1;
+        batch.swap(nextBatch);
+        nextBatch.clear();
+      }
+
+      return nConverted;
+    }
+
+  } // end Conversion
+} // end DAQ
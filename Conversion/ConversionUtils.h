@@ -0,0 +1,142 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CONVERSION_CONVERSIONUTILS_H
+#define DAQ_CONVERSION_CONVERSIONUTILS_H
+
+#include <V12/CRingItemEncoder.h>
+#include <ByteBuffer.h>
+#include <ByteOrder.h>
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/*
+ * Pieces shared by the streaming converters. These are not installed; they
+ * are only used by the converter implementations.
+ */
+
+namespace DAQ {
+  namespace Conversion {
+
+    const std::size_t V12HeaderSize = 20;
+
+    // the converters write their output fields through the V12 encoder
+    using V12::Encoder::put;
+
+    /*!
+     * \brief Throw a std::runtime_error for malformed input
+     *
+     * The message is "DAQ::Conversion::<className>::<where>() <what>".
+     */
+    void throwConversionError(const std::string& className,
+                              const std::string& where, const std::string& what);
+
+    /*!
+     * \brief Whether a V10 or V11 item is in the foreign byte order
+     *
+     * The type codes of those versions fit in the low 16 bits, so the type
+     * doubles as a byte order mark.
+     */
+    bool typeNeedsSwap(const std::uint8_t* item);
+
+    /*!
+     * \brief Grow the output by one V12 item
+     *
+     * The V12 header is filled in for a body of the given size.
+     *
+     * \return a pointer to the start of the body
+     */
+    std::uint8_t* appendV12Item(Buffer::ByteBuffer& output, std::uint32_t type,
+                                std::size_t bodySize, std::uint64_t timestamp,
+                                std::uint32_t sourceId, bool swap = false);
+
+    /*! \brief Append the V12 RING_FORMAT item that begins every V12 stream */
+    void appendV12FormatItem(Buffer::ByteBuffer& output, std::uint32_t sourceId);
+
+
+    /*! \brief The number of worker threads to use, 0 meaning one per core */
+    unsigned resolveThreadCount(unsigned nThreads);
+
+
+    /*!
+     * \brief Converts one unit of input, [beg, end), appending to the output
+     *
+     * This is called from several threads at once.
+     */
+    using UnitConverter = std::function<void(const std::uint8_t* beg,
+                                             const std::uint8_t* end,
+                                             Buffer::ByteBuffer& output)>;
+
+    /*!
+     * \brief Start converting a batch of units on worker threads
+     *
+     * The units are [bounds[i], bounds[i+1]). They are divided into at most
+     * nThreads contiguous runs, and each run is converted by its own task.
+     * Pass the result to writeConversion() to collect it in order. The bounds
+     * and the data they point into must outlive the conversion.
+     */
+    std::vector<std::future<Buffer::ByteBuffer> >
+    startConversion(const std::vector<const std::uint8_t*>& bounds, unsigned nThreads,
+                    const UnitConverter& convert);
+
+    /*! \brief Wait for the tasks of startConversion() and write their output in order */
+    void writeConversion(std::vector<std::future<Buffer::ByteBuffer> >& results,
+                         std::ostream& output);
+
+
+    /*! \brief How the items of a size prefixed stream are framed */
+    struct ItemFraming {
+      const char*   s_className;      // of the converter, for error messages
+      const char*   s_version;        // e.g. "V11", for error messages
+      std::size_t   s_headerSize;     // bytes needed to read the size
+      std::size_t   s_minItemSize;    // smallest valid size
+      bool        (*s_needsSwap)(const std::uint8_t* item);
+    };
+
+    /*!
+     * \brief The batched driver of the item stream converters
+     *
+     * The input is read in batches of batchSize bytes. Each batch is split
+     * into complete items by their 32-bit size field, the items are converted
+     * on nThreads threads, and the results are written in input order while
+     * the next batch is read. A partial item at the end of a batch is carried
+     * into the next one.
+     *
+     * \param onFirstItem  if set, called with the first complete item before
+     *                     anything else is written
+     *
+     * \return the number of items converted
+     *
+     * \throws std::runtime_error if an item is smaller than the framing allows
+     *                            or the input ends in the middle of an item
+     */
+    std::size_t convertItemStream(std::istream& input, std::ostream& output,
+                                  const ItemFraming& framing,
+                                  std::size_t batchSize, unsigned nThreads,
+                                  const UnitConverter& convert,
+                                  const std::function<void(const std::uint8_t*,
+                                                           const std::uint8_t*)>& onFirstItem = nullptr);
+
+  } // end Conversion
+} // end DAQ
+
+#endif // DAQ_CONVERSION_CONVERSIONUTILS_H
@@ -0,0 +1,351 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include <Asserts.h>
+
+#include <CV10toV11Converter.h>
+
+#include <V10/DataFormat.h>
+#include <V10/CRingStateChangeItem.h>
+#include <V10/CRingScalerItem.h>
+#include <V10/CRingTimestampedRunningScalerItem.h>
+#include <V10/CRingTextItem.h>
+#include <V10/CPhysicsEventItem.h>
+#include <V10/CRingPhysicsEventCountItem.h>
+#include <V10/CRingFragmentItem.h>
+
+#include <V11/DataFormat.h>
+#include <V11/CRingItemFactory.h>
+#include <V11/CRingStateChangeItem.h>
+#include <V11/CRingScalerItem.h>
+#include <V11/CRingTextItem.h>
+#include <V11/CPhysicsEventItem.h>
+#include <V11/CRingPhysicsEventCountItem.h>
+#include <V11/CRingFragmentItem.h>
+#include <V11/CDataFormatItem.h>
+
+#include <ByteBuffer.h>
+#include <ByteOrder.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace DAQ;
+
+class v10tov11tests : public CppUnit::TestFixture {
+public:
+  CPPUNIT_TEST_SUITE(v10tov11tests);
+  CPPUNIT_TEST(stateChange_0);
+  CPPUNIT_TEST(text_0);
+  CPPUNIT_TEST(scaler_0);
+  CPPUNIT_TEST(timestampedScaler_0);
+  CPPUNIT_TEST(physicsCount_0);
+  CPPUNIT_TEST(physics_0);
+  CPPUNIT_TEST(fragment_0);
+  CPPUNIT_TEST(fragment_1);
+  CPPUNIT_TEST(unknownPayload_0);
+  CPPUNIT_TEST(swapped_0);
+  CPPUNIT_TEST(malformed_0);
+  CPPUNIT_TEST(stream_0);
+  CPPUNIT_TEST(stream_1);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {}
+  void tearDown() {}
+
+  Buffer::ByteBuffer bytesOf(const V10::CRingItem& item) {
+    auto p = reinterpret_cast<const uint8_t*>(item.getItemPointer());
+    return Buffer::ByteBuffer(p, p + item.size());
+  }
+
+  // split a V11 byte stream into its constituent items
+  vector<Buffer::ByteBuffer> splitItems(const Buffer::ByteBuffer& data) {
+    vector<Buffer::ByteBuffer> items;
+    auto pos = data.begin();
+    while (pos != data.end()) {
+      uint32_t size;
+      std::memcpy(&size, &(*pos), sizeof(size));
+      items.push_back(Buffer::ByteBuffer(pos, pos + size));
+      pos += size;
+    }
+    return items;
+  }
+
+  vector<Buffer::ByteBuffer> convertOne(const V10::CRingItem& item) {
+    Conversion::CV10toV11Converter converter(7);
+    Buffer::ByteBuffer output;
+    converter.convertItem(item, output);
+    return splitItems(output);
+  }
+
+  unique_ptr<V11::CRingItem> v11Item(const Buffer::ByteBuffer& bytes) {
+    return unique_ptr<V11::CRingItem>(V11::CRingItemFactory::createRingItem(bytes.data()));
+  }
+
+  void stateChange_0() {
+    V10::CRingStateChangeItem item(V10::BEGIN_RUN, 56, 78, 1234567, "a title");
+    auto items = convertOne(item);
+
+    EQMSG("one item", size_t(1), items.size());
+    V11::CRingStateChangeItem v11(*v11Item(items[0]));
+    EQMSG("type", V11::BEGIN_RUN, v11.type());
+    EQMSG("no body header", false, v11.hasBodyHeader());
+    EQMSG("run", uint32_t(56), v11.getRunNumber());
+    EQMSG("offset", uint32_t(78), v11.getElapsedTime());
+    EQMSG("divisor", uint32_t(1), v11.getOffsetDivisor());
+    EQMSG("time", time_t(1234567), v11.getTimestamp());
+    EQMSG("title", string("a title"), v11.getTitle());
+  }
+
+  void text_0() {
+    V10::CRingTextItem item(V10::PACKET_TYPES, {"abc", "", "de"}, 3, 4);
+    auto items = convertOne(item);
+
+    V11::CRingTextItem v11(*v11Item(items[0]));
+    EQMSG("type", V11::PACKET_TYPES, v11.type());
+    EQMSG("strings", vector<string>({"abc", "", "de"}), v11.getStrings());
+    EQMSG("offset", uint32_t(3), v11.getTimeOffset());
+    EQMSG("divisor", uint32_t(1), v11.getTimeDivisor());
+    EQMSG("time", time_t(4), v11.getTimestamp());
+  }
+
+  void scaler_0() {
+    V10::CRingScalerItem item(10, 20, 1234, {1, 2, 3});
+    auto items = convertOne(item);
+
+    V11::CRingScalerItem v11(*v11Item(items[0]));
+    EQMSG("type", V11::PERIODIC_SCALERS, v11.type());
+    EQMSG("no body header", false, v11.hasBodyHeader());
+    EQMSG("start", uint32_t(10), v11.getStartTime());
+    EQMSG("end", uint32_t(20), v11.getEndTime());
+    EQMSG("divisor", uint32_t(1), v11.getTimeDivisor());
+    EQMSG("time", time_t(1234), v11.getTimestamp());
+    EQMSG("incremental", true, v11.isIncremental());
+    EQMSG("scalers", vector<uint32_t>({1, 2, 3}), v11.getScalers());
+  }
+
+  void timestampedScaler_0() {
+    V10::CRingTimestampedRunningScalerItem item(0x123456789aULL, 10, 20, 2, 1234, {4, 5});
+    auto items = convertOne(item);
+
+    V11::CRingScalerItem v11(*v11Item(items[0]));
+    EQMSG("type", V11::PERIODIC_SCALERS, v11.type());
+    EQMSG("body header", true, v11.hasBodyHeader());
+    EQMSG("timestamp", uint64_t(0x123456789aULL), v11.getEventTimestamp());
+    EQMSG("source id", uint32_t(7), v11.getSourceId());
+    EQMSG("barrier", uint32_t(0), v11.getBarrierType());
+    EQMSG("start", uint32_t(10), v11.getStartTime());
+    EQMSG("end", uint32_t(20), v11.getEndTime());
+    EQMSG("divisor", uint32_t(2), v11.getTimeDivisor());
+    EQMSG("time", time_t(1234), v11.getTimestamp());
+    EQMSG("not incremental", false, v11.isIncremental());
+    EQMSG("scalers", vector<uint32_t>({4, 5}), v11.getScalers());
+  }
+
+  void physicsCount_0() {
+    V10::CRingPhysicsEventCountItem item(123456789012LL, 7, 8);
+    auto items = convertOne(item);
+
+    V11::CRingPhysicsEventCountItem v11(*v11Item(items[0]));
+    EQMSG("type", V11::PHYSICS_EVENT_COUNT, v11.type());
+    EQMSG("count", uint64_t(123456789012LL), v11.getEventCount());
+    EQMSG("offset", uint32_t(7), v11.getTimeOffset());
+    EQMSG("divisor", uint32_t(1), v11.getTimeDivisor());
+    EQMSG("time", time_t(8), v11.getTimestamp());
+  }
+
+  V10::CPhysicsEventItem makeEvent(const vector<uint16_t>& data) {
+    V10::CPhysicsEventItem event(V10::PHYSICS_EVENT);
+    uint16_t* p = reinterpret_cast<uint16_t*>(event.getBodyCursor());
+    p = std::copy(data.begin(), data.end(), p);
+    event.setBodyCursor(p);
+    event.updateSize();
+    return event;
+  }
+
+  void physics_0() {
+    auto item = makeEvent({1, 2, 3, 4});
+    auto items = convertOne(item);
+
+    auto v11 = v11Item(items[0]);
+    EQMSG("type", V11::PHYSICS_EVENT, v11->type());
+    EQMSG("no body header", false, v11->hasBodyHeader());
+    EQMSG("size", size_t(item.size() + sizeof(uint32_t)), size_t(v11->size()));
+
+    auto p = reinterpret_cast<const uint16_t*>(v11->getBodyPointer());
+    EQMSG("body", vector<uint16_t>({1, 2, 3, 4}), vector<uint16_t>(p, p + 4));
+  }
+
+  void fragment_0() {
+    auto event = makeEvent({5, 6});
+    auto eventBytes = bytesOf(event);
+    V10::CRingFragmentItem item(0xabcdef, 3, eventBytes.size(), eventBytes.data(), 1);
+    auto items = convertOne(item);
+
+    EQMSG("one item", size_t(1), items.size());
+    V11::CRingFragmentItem v11(*v11Item(items[0]));
+    EQMSG("type", V11::EVB_FRAGMENT, v11.type());
+    EQMSG("timestamp", uint64_t(0xabcdef), v11.timestamp());
+    EQMSG("source id", uint32_t(3), v11.source());
+    EQMSG("barrier", uint32_t(1), v11.barrierType());
+
+    // the payload is now a V11 physics event with the same body header
+    Buffer::ByteBuffer payloadBytes(reinterpret_cast<uint8_t*>(v11.payloadPointer()),
+                                    reinterpret_cast<uint8_t*>(v11.payloadPointer())
+                                      + v11.payloadSize());
+    auto payload = v11Item(payloadBytes);
+    EQMSG("payload size", size_t(v11.payloadSize()), size_t(payload->size()));
+    EQMSG("payload type", V11::PHYSICS_EVENT, payload->type());
+    EQMSG("payload timestamp", uint64_t(0xabcdef), payload->getEventTimestamp());
+    EQMSG("payload source id", uint32_t(3), payload->getSourceId());
+    EQMSG("payload barrier", uint32_t(1), payload->getBarrierType());
+
+    auto p = reinterpret_cast<const uint16_t*>(payload->getBodyPointer());
+    EQMSG("payload body", vector<uint16_t>({5, 6}), vector<uint16_t>(p, p + 2));
+  }
+
+  void fragment_1() {
+    // the fragment header wins over the timestamp of the scaler item
+    V10::CRingTimestampedRunningScalerItem scaler(999, 1, 2, 1, 3, {8});
+    auto scalerBytes = bytesOf(scaler);
+    V10::CRingFragmentItem item(1000, 4, scalerBytes.size(), scalerBytes.data());
+    auto items = convertOne(item);
+
+    V11::CRingFragmentItem v11(*v11Item(items[0]));
+    Buffer::ByteBuffer payloadBytes(reinterpret_cast<uint8_t*>(v11.payloadPointer()),
+                                    reinterpret_cast<uint8_t*>(v11.payloadPointer())
+                                      + v11.payloadSize());
+    V11::CRingScalerItem payload(*v11Item(payloadBytes));
+    EQMSG("payload timestamp", uint64_t(1000), payload.getEventTimestamp());
+    EQMSG("payload source id", uint32_t(4), payload.getSourceId());
+    EQMSG("scalers", vector<uint32_t>({8}), payload.getScalers());
+  }
+
+  void unknownPayload_0() {
+    vector<uint8_t> data = {1, 2, 3, 4, 5};
+    V10::CRingFragmentItem item(55, 6, data.size(), data.data());
+    item.getItemPointer()->s_header.s_type = V10::EVB_UNKNOWN_PAYLOAD;
+    auto items = convertOne(item);
+
+    auto v11 = v11Item(items[0]);
+    EQMSG("type", V11::EVB_UNKNOWN_PAYLOAD, v11->type());
+    EQMSG("timestamp", uint64_t(55), v11->getEventTimestamp());
+    EQMSG("source id", uint32_t(6), v11->getSourceId());
+
+    auto p = reinterpret_cast<const uint8_t*>(v11->getBodyPointer());
+    EQMSG("payload", data, vector<uint8_t>(p, p + data.size()));
+  }
+
+  void swapped_0() {
+    // every field of a scaler item is 32 bits wide, so swapping each word
+    // produces the item as a machine of the other byte order would write it
+    V10::CRingScalerItem item(10, 20, 1234, {1, 2, 3});
+    auto bytes = bytesOf(item);
+    for (auto p = bytes.begin(); p != bytes.end(); p += sizeof(uint32_t)) {
+      std::reverse(p, p + sizeof(uint32_t));
+    }
+
+    Conversion::CV10toV11Converter converter;
+    Buffer::ByteBuffer output;
+    converter.convertItem(bytes.data(), bytes.data() + bytes.size(), output);
+
+    V11::CRingScalerItem v11(*v11Item(output));
+    EQMSG("type", V11::PERIODIC_SCALERS, v11.type());
+    EQMSG("start", uint32_t(10), v11.getStartTime());
+    EQMSG("end", uint32_t(20), v11.getEndTime());
+    EQMSG("time", time_t(1234), v11.getTimestamp());
+    EQMSG("scalers", vector<uint32_t>({1, 2, 3}), v11.getScalers());
+  }
+
+  void malformed_0() {
+    V10::CRingScalerItem item(10, 20, 1234, {1, 2, 3});
+    auto bytes = bytesOf(item);
+    uint32_t nScalers = 1000;
+    std::memcpy(bytes.data() + 8 + 3*sizeof(uint32_t), &nScalers, sizeof(nScalers));
+
+    Conversion::CV10toV11Converter converter;
+    Buffer::ByteBuffer output;
+    CPPUNIT_ASSERT_THROW_MESSAGE("scaler count beyond the item",
+                                 converter.convertItem(bytes.data(),
+                                                       bytes.data() + bytes.size(),
+                                                       output),
+                                 std::runtime_error);
+  }
+
+  void stream_0() {
+    // many items in small batches on several threads
+    Buffer::ByteBuffer input, expected;
+    Conversion::CV10toV11Converter converter(2);
+    for (uint32_t i=0; i<50; ++i) {
+      V10::CRingTimestampedRunningScalerItem scaler(i, i, i+1, 1, i, {i});
+      auto event = makeEvent({uint16_t(i), uint16_t(i+1)});
+      V10::CRingTextItem text(V10::MONITORED_VARIABLES, {"x", to_string(i)}, i, i);
+
+      for (auto pItem : {static_cast<V10::CRingItem*>(&scaler),
+                         static_cast<V10::CRingItem*>(&event),
+                         static_cast<V10::CRingItem*>(&text)}) {
+        auto bytes = bytesOf(*pItem);
+        input.insert(input.end(), bytes.begin(), bytes.end());
+        converter.convertItem(*pItem, expected);
+      }
+    }
+
+    converter.setBatchSize(100);
+    converter.setThreadCount(3);
+
+    std::stringstream in, out;
+    in.write(reinterpret_cast<const char*>(input.data()), input.size());
+
+    EQMSG("items read", size_t(150), converter.convert(in, out));
+
+    string result = out.str();
+    Buffer::ByteBuffer output(result.begin(), result.end());
+    auto items = splitItems(output);
+    EQMSG("format plus converted items", size_t(151), items.size());
+
+    V11::CDataFormatItem format(*v11Item(items[0]));
+    EQMSG("format major", V11::FORMAT_MAJOR, format.getMajor());
+    EQMSG("format minor", V11::FORMAT_MINOR, format.getMinor());
+
+    Buffer::ByteBuffer converted(output.begin() + items[0].size(), output.end());
+    CPPUNIT_ASSERT_MESSAGE("same as item by item conversion", expected == converted);
+  }
+
+  void stream_1() {
+    V10::CRingScalerItem item(10, 20, 1234, {1, 2, 3});
+    auto bytes = bytesOf(item);
+
+    std::stringstream in, out;
+    in.write(reinterpret_cast<const char*>(bytes.data()), bytes.size() - 2);
+
+    Conversion::CV10toV11Converter converter;
+    CPPUNIT_ASSERT_THROW_MESSAGE("truncated input",
+                                 converter.convert(in, out),
+                                 std::runtime_error);
+  }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(v10tov11tests);
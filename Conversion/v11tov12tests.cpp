@@ -0,0 +1,457 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include <Asserts.h>
+
+#include <CV11toV12Converter.h>
+
+#include <V11/DataFormat.h>
+#include <V11/CRingStateChangeItem.h>
+#include <V11/CRingScalerItem.h>
+#include <V11/CRingTextItem.h>
+#include <V11/CPhysicsEventItem.h>
+#include <V11/CRingPhysicsEventCountItem.h>
+#include <V11/CDataFormatItem.h>
+#include <V11/CGlomParameters.h>
+#include <V11/CAbnormalEndItem.h>
+
+#include <V12/DataFormat.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CRingItemParser.h>
+#include <V12/CRingStateChangeItem.h>
+#include <V12/CRingScalerItem.h>
+#include <V12/CRingTextItem.h>
+#include <V12/CRingPhysicsEventCountItem.h>
+#include <V12/CDataFormatItem.h>
+#include <V12/CGlomParameters.h>
+#include <V12/CCompositeRingItem.h>
+#include <V12/CPhysicsEventItem.h>
+#include <V12/CCodecRingItemFactory.h>
+
+#include <ByteBuffer.h>
+#include <ByteOrder.h>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace DAQ;
+
+class v11tov12tests : public CppUnit::TestFixture {
+public:
+  CPPUNIT_TEST_SUITE(v11tov12tests);
+  CPPUNIT_TEST(stateChange_0);
+  CPPUNIT_TEST(stateChange_1);
+  CPPUNIT_TEST(scaler_0);
+  CPPUNIT_TEST(text_0);
+  CPPUNIT_TEST(physicsCount_0);
+  CPPUNIT_TEST(format_0);
+  CPPUNIT_TEST(glom_0);
+  CPPUNIT_TEST(abnormalEnd_0);
+  CPPUNIT_TEST(physics_0);
+  CPPUNIT_TEST(physics_1);
+  CPPUNIT_TEST(built_0);
+  CPPUNIT_TEST(built_1);
+  CPPUNIT_TEST(built_2);
+  CPPUNIT_TEST(built_3);
+  CPPUNIT_TEST(user_0);
+  CPPUNIT_TEST(malformed_0);
+  CPPUNIT_TEST(stream_0);
+  CPPUNIT_TEST(stream_1);
+  CPPUNIT_TEST(stream_2);
+  CPPUNIT_TEST(stream_3);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {}
+  void tearDown() {}
+
+  Buffer::ByteBuffer bytesOf(const V11::CRingItem& item) {
+    auto p = reinterpret_cast<const uint8_t*>(item.getItemPointer());
+    return Buffer::ByteBuffer(p, p + item.size());
+  }
+
+  // split a V12 byte stream into its constituent items
+  vector<V12::CRawRingItem> splitItems(const Buffer::ByteBuffer& data) {
+    vector<V12::CRawRingItem> items;
+    auto pos = data.begin();
+    while (pos != data.end()) {
+      uint32_t size, type;
+      bool swap;
+      V12::Parser::parseSizeAndType(pos, data.end(), size, type, swap);
+      items.push_back(V12::CRawRingItem(pos, pos + size));
+      pos += size;
+    }
+    return items;
+  }
+
+  vector<V12::CRawRingItem> convertOne(const V11::CRingItem& item,
+                                       Conversion::CV11toV12Converter converter
+                                          = Conversion::CV11toV12Converter(7)) {
+    Buffer::ByteBuffer output;
+    converter.convertItem(item, output);
+    return splitItems(output);
+  }
+
+  V11::CPhysicsEventItem makeEvent(uint64_t tstamp, uint32_t sourceId,
+                                   const vector<uint16_t>& data) {
+    V11::CPhysicsEventItem event(tstamp, sourceId, 0);
+    uint16_t* p = reinterpret_cast<uint16_t*>(event.getBodyCursor());
+    p = std::copy(data.begin(), data.end(), p);
+    event.setBodyCursor(p);
+    event.updateSize();
+    return event;
+  }
+
+  // a built event whose fragments are the given events
+  V11::CPhysicsEventItem makeBuilt(const vector<V11::CPhysicsEventItem>& events) {
+    Buffer::ByteBuffer body;
+    body << uint32_t(0);
+    for (auto& event : events) {
+      body << event.getEventTimestamp() << event.getSourceId()
+           << uint32_t(event.size()) << uint32_t(0);
+      auto bytes = bytesOf(event);
+      body.insert(body.end(), bytes.begin(), bytes.end());
+    }
+    uint32_t size = body.size();
+    std::memcpy(body.data(), &size, sizeof(size));
+
+    V11::CPhysicsEventItem built(1000, 99, 0);
+    uint8_t* p = reinterpret_cast<uint8_t*>(built.getBodyCursor());
+    p = std::copy(body.begin(), body.end(), p);
+    built.setBodyCursor(p);
+    built.updateSize();
+    return built;
+  }
+
+  void stateChange_0() {
+    V11::CRingStateChangeItem item(123, 4, 0, V11::BEGIN_RUN, 56, 78, 1234567, "a title");
+    auto items = convertOne(item);
+
+    EQMSG("one item", size_t(1), items.size());
+    V12::CRingStateChangeItem v12(items[0]);
+    EQMSG("type", V12::BEGIN_RUN, v12.type());
+    EQMSG("timestamp", uint64_t(123), v12.getEventTimestamp());
+    EQMSG("source id", uint32_t(4), v12.getSourceId());
+    EQMSG("run", uint32_t(56), v12.getRunNumber());
+    EQMSG("offset", uint32_t(78), v12.getElapsedTime());
+    EQMSG("time", time_t(1234567), v12.getTimestamp());
+    EQMSG("title", string("a title"), v12.getTitle());
+  }
+
+  void stateChange_1() {
+    V11::CRingStateChangeItem item(V11::END_RUN, 56, 78, 1234567, "title");
+    auto items = convertOne(item);
+
+    EQMSG("type", V12::END_RUN, items[0].type());
+    EQMSG("no body header timestamp", V12::NULL_TIMESTAMP, items[0].getEventTimestamp());
+    EQMSG("no body header source id", uint32_t(7), items[0].getSourceId());
+  }
+
+  void scaler_0() {
+    V11::CRingScalerItem item(12, 3, 0, 10, 20, 1234, {1, 2, 3}, 2, false);
+    auto items = convertOne(item);
+
+    V12::CRingScalerItem v12(items[0]);
+    EQMSG("type", V12::PERIODIC_SCALERS, v12.type());
+    EQMSG("timestamp", uint64_t(12), v12.getEventTimestamp());
+    EQMSG("start", uint32_t(10), v12.getStartTime());
+    EQMSG("end", uint32_t(20), v12.getEndTime());
+    EQMSG("divisor", uint32_t(2), v12.getTimeDivisor());
+    EQMSG("time", time_t(1234), v12.getTimestamp());
+    EQMSG("incremental", false, v12.isIncremental());
+    EQMSG("width", uint32_t(32), v12.getScalerWidth());
+    EQMSG("scalers", vector<uint32_t>({1, 2, 3}), v12.getScalers());
+  }
+
+  void text_0() {
+    V11::CRingTextItem item(V11::MONITORED_VARIABLES, 1, 2, 0, {"abc", "", "de"}, 3, 4);
+    auto items = convertOne(item);
+
+    V12::CRingTextItem v12(items[0]);
+    EQMSG("type", V12::MONITORED_VARIABLES, v12.type());
+    EQMSG("strings", vector<string>({"abc", "", "de"}), v12.getStrings());
+    EQMSG("offset", uint32_t(3), v12.getTimeOffset());
+    EQMSG("time", time_t(4), v12.getTimestamp());
+  }
+
+  void physicsCount_0() {
+    V11::CRingPhysicsEventCountItem item(5, 6, 0, 123456789012LL, 7, 8, 2);
+    auto items = convertOne(item);
+
+    V12::CRingPhysicsEventCountItem v12(items[0]);
+    EQMSG("timestamp", uint64_t(5), v12.getEventTimestamp());
+    EQMSG("source", uint32_t(6), v12.getSourceId());
+    EQMSG("count", uint64_t(123456789012LL), v12.getEventCount());
+    EQMSG("offset", uint32_t(7), v12.getTimeOffset());
+    EQMSG("time", time_t(8), v12.getTimestamp());
+    EQMSG("divisor", uint32_t(2), v12.getTimeDivisor());
+  }
+
+  void format_0() {
+    auto items = convertOne(V11::CDataFormatItem());
+
+    V12::CDataFormatItem v12(items[0]);
+    EQMSG("major is V12", V12::FORMAT_MAJOR, v12.getMajor());
+    EQMSG("minor is V12", V12::FORMAT_MINOR, v12.getMinor());
+  }
+
+  void glom_0() {
+    auto items = convertOne(V11::CGlomParameters(123, true, V11::CGlomParameters::last));
+
+    V12::CGlomParameters v12(items[0]);
+    EQMSG("ticks", uint64_t(123), v12.coincidenceTicks());
+    EQMSG("building", true, v12.isBuilding());
+    EQMSG("policy", V12::CGlomParameters::last, v12.timestampPolicy());
+  }
+
+  void abnormalEnd_0() {
+    auto items = convertOne(V11::CAbnormalEndItem());
+    EQMSG("type", V12::ABNORMAL_ENDRUN, items[0].type());
+    EQMSG("size", uint32_t(20), items[0].size());
+  }
+
+  void physics_0() {
+    auto items = convertOne(makeEvent(10, 11, {3, 1, 2}));
+
+    EQMSG("type", V12::PHYSICS_EVENT, items[0].type());
+    EQMSG("timestamp", uint64_t(10), items[0].getEventTimestamp());
+    EQMSG("source", uint32_t(11), items[0].getSourceId());
+
+    Buffer::ByteBuffer expected;
+    expected << uint16_t(3) << uint16_t(1) << uint16_t(2);
+    EQMSG("body is verbatim", expected, items[0].getBody());
+  }
+
+  void physics_1() {
+    // a physics event in the opposite byte order without a body header
+    Buffer::ByteBuffer bytes;
+    bytes << uint32_t(0x10000000) << uint32_t(0x1e000000) << uint32_t(0)
+          << uint16_t(0x0200) << uint16_t(0x0500);
+
+    Conversion::CV11toV12Converter converter;
+    Buffer::ByteBuffer output;
+    converter.convertItem(bytes.data(), bytes.data() + bytes.size(), output);
+
+    auto items = splitItems(output);
+    EQMSG("foreign byte order is preserved", true, items[0].mustSwap());
+    EQMSG("type", V12::PHYSICS_EVENT, items[0].type());
+    EQMSG("size", uint32_t(24), items[0].size());
+
+    Buffer::ByteBuffer expected;
+    expected << uint16_t(0x0200) << uint16_t(0x0500);
+    EQMSG("body is verbatim", expected, items[0].getBody());
+  }
+
+  void built_0() {
+    auto first  = makeEvent(100, 1, {1, 2});
+    auto second = makeEvent(101, 2, {3});
+    auto items = convertOne(makeBuilt({first, second}));
+
+    EQMSG("one item", size_t(1), items.size());
+    EQMSG("composite", V12::COMP_PHYSICS_EVENT, items[0].type());
+    EQMSG("composite timestamp", uint64_t(1000), items[0].getEventTimestamp());
+    EQMSG("composite source", uint32_t(99), items[0].getSourceId());
+
+    V12::CCompositeRingItem composite(items[0]);
+    EQMSG("children", size_t(2), composite.count());
+
+    auto& child = dynamic_cast<V12::CPhysicsEventItem&>(*composite[0]);
+    EQMSG("child type", V12::PHYSICS_EVENT, child.type());
+    EQMSG("child timestamp", uint64_t(100), child.getEventTimestamp());
+    EQMSG("child source", uint32_t(1), child.getSourceId());
+    Buffer::ByteBuffer expected;
+    expected << uint16_t(1) << uint16_t(2);
+    EQMSG("child body", expected, child.getBody());
+
+    EQMSG("second child source", uint32_t(2), composite[1]->getSourceId());
+  }
+
+  void built_1() {
+    Conversion::CV11toV12Converter converter(0, Conversion::CV11toV12Converter::NeverBuilt);
+    auto items = convertOne(makeBuilt({makeEvent(100, 1, {1, 2})}), converter);
+
+    EQMSG("leaf", V12::PHYSICS_EVENT, items[0].type());
+  }
+
+  void built_2() {
+    // the leading byte count does not cover the body so it is not detected
+    auto event = makeEvent(100, 1, {2, 0, 0});
+    auto items = convertOne(event);
+    EQMSG("detection", V12::PHYSICS_EVENT, items[0].type());
+
+    Conversion::CV11toV12Converter converter(0, Conversion::CV11toV12Converter::AlwaysBuilt);
+    CPPUNIT_ASSERT_THROW_MESSAGE("malformed built event",
+                                 convertOne(event, converter),
+                                 std::runtime_error);
+  }
+
+  void built_3() {
+    // fragments whose payloads are not physics events are not built events
+    V11::CRingStateChangeItem begin(V11::BEGIN_RUN);
+    Buffer::ByteBuffer body;
+    auto bytes = bytesOf(begin);
+    body << uint32_t(4 + 20 + bytes.size()) << uint64_t(1) << uint32_t(2)
+         << uint32_t(bytes.size()) << uint32_t(0);
+    body.insert(body.end(), bytes.begin(), bytes.end());
+
+    V11::CPhysicsEventItem event(1, 2, 0);
+    uint8_t* p = reinterpret_cast<uint8_t*>(event.getBodyCursor());
+    p = std::copy(body.begin(), body.end(), p);
+    event.setBodyCursor(p);
+    event.updateSize();
+
+    auto items = convertOne(event);
+    EQMSG("leaf", V12::PHYSICS_EVENT, items[0].type());
+  }
+
+  void user_0() {
+    V11::CRingItem item(V11::FIRST_USER_ITEM_CODE + 3, 8, 9);
+    item.updateSize();
+    auto items = convertOne(item);
+    EQMSG("user type keeps its offset", V12::FIRST_USER_ITEM_CODE + 3, items[0].type());
+
+    // the user counterpart of PHYSICS_EVENT is not mistaken for a packed event
+    V11::CRingItem userEvent(V11::FIRST_USER_ITEM_CODE + V11::PHYSICS_EVENT, 8, 9);
+    userEvent.updateSize();
+    items = convertOne(userEvent);
+    V12::CRingItemUPtr pItem = V12::CCodecRingItemFactory::createRingItem(items[0]);
+    EQMSG("user event type", V12::FIRST_USER_ITEM_CODE + V12::PHYSICS_EVENT, pItem->type());
+    ASSERTMSG("user event is raw", dynamic_cast<V12::CRawRingItem*>(pItem.get()) != nullptr);
+
+    V11::CRingItem fragment(V11::EVB_FRAGMENT, 8, 9);
+    fragment.updateSize();
+    EQMSG("fragments are dropped", size_t(0), convertOne(fragment).size());
+  }
+
+  void malformed_0() {
+    V11::CRingScalerItem item(12, 3, 0, 10, 20, 1234, {1, 2, 3});
+    Buffer::ByteBuffer bytes = bytesOf(item);
+    uint32_t count = 4;
+    std::memcpy(bytes.data() + 8 + 20 + 16, &count, sizeof(count));
+
+    Conversion::CV11toV12Converter converter;
+    Buffer::ByteBuffer output;
+    CPPUNIT_ASSERT_THROW_MESSAGE("scaler count exceeds item",
+                                 converter.convertItem(bytes.data(), bytes.data() + bytes.size(), output),
+                                 std::runtime_error);
+    CPPUNIT_ASSERT_THROW_MESSAGE("item exceeds data",
+                                 converter.convertItem(bytes.data(), bytes.data() + 20, output),
+                                 std::runtime_error);
+  }
+
+  string makeStream(bool withFormat = true) {
+    vector<Buffer::ByteBuffer> items;
+    if (withFormat) {
+      items.push_back(bytesOf(V11::CDataFormatItem()));
+    }
+    items.push_back(bytesOf(V11::CRingStateChangeItem(V11::BEGIN_RUN)));
+    for (uint16_t i=0; i<20; ++i) {
+      items.push_back(bytesOf(makeEvent(i, 1, {i, 1})));
+      items.push_back(bytesOf(makeBuilt({makeEvent(i, 1, {i}), makeEvent(i, 2, {2})})));
+      items.push_back(bytesOf(V11::CRingScalerItem(i, 0, 0, 0, 0, 0, {i})));
+    }
+    items.push_back(bytesOf(V11::CRingStateChangeItem(V11::END_RUN)));
+
+    string data;
+    for (auto& item : items) {
+      data.append(item.begin(), item.end());
+    }
+    return data;
+  }
+
+  void stream_0() {
+    istringstream input(makeStream());
+    ostringstream output;
+
+    Conversion::CV11toV12Converter converter;
+    converter.setThreadCount(1);
+    EQMSG("item count", size_t(1+1+20*3+1), converter.convert(input, output));
+
+    string result = output.str();
+    auto items = splitItems(Buffer::ByteBuffer(result.begin(), result.end()));
+    EQMSG("converted items", size_t(1+1+20*3+1), items.size());
+    EQMSG("format", V12::RING_FORMAT, items[0].type());
+    EQMSG("begin run", V12::BEGIN_RUN, items[1].type());
+    EQMSG("physics", V12::PHYSICS_EVENT, items[2].type());
+    EQMSG("built", V12::COMP_PHYSICS_EVENT, items[3].type());
+    EQMSG("scalers", V12::PERIODIC_SCALERS, items[4].type());
+    EQMSG("end run", V12::END_RUN, items.back().type());
+  }
+
+  void stream_1() {
+    string data = makeStream();
+
+    Conversion::CV11toV12Converter serial;
+    serial.setThreadCount(1);
+    istringstream serialInput(data);
+    ostringstream serialOutput;
+    serial.convert(serialInput, serialOutput);
+
+    // batches smaller than an item force the batch to grow
+    Conversion::CV11toV12Converter parallel;
+    parallel.setThreadCount(4);
+    parallel.setBatchSize(7);
+    istringstream parallelInput(data);
+    ostringstream parallelOutput;
+    parallel.convert(parallelInput, parallelOutput);
+
+    parallel.setBatchSize(200);
+    istringstream mediumInput(data);
+    ostringstream mediumOutput;
+    parallel.convert(mediumInput, mediumOutput);
+
+    ASSERTMSG("small batches preserve order and content",
+              serialOutput.str() == parallelOutput.str());
+    ASSERTMSG("threaded conversion preserves order and content",
+              serialOutput.str() == mediumOutput.str());
+  }
+
+  void stream_2() {
+    string data = makeStream();
+    data.resize(data.size() - 3);
+
+    istringstream input(data);
+    ostringstream output;
+
+    Conversion::CV11toV12Converter converter;
+    CPPUNIT_ASSERT_THROW_MESSAGE("input ends inside an item",
+                                 converter.convert(input, output),
+                                 std::runtime_error);
+  }
+
+  void stream_3() {
+    istringstream input(makeStream(false));
+    ostringstream output;
+
+    Conversion::CV11toV12Converter converter;
+    EQMSG("item count", size_t(1+20*3+1), converter.convert(input, output));
+
+    string result = output.str();
+    auto items = splitItems(Buffer::ByteBuffer(result.begin(), result.end()));
+    EQMSG("format is added", V12::RING_FORMAT, items[0].type());
+    EQMSG("converted items", size_t(1+1+20*3+1), items.size());
+  }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(v11tov12tests);
@@ -0,0 +1,404 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include <Asserts.h>
+
+#include <CV8toV12Converter.h>
+
+#include <V8/CRawBuffer.h>
+#include <V8/CPhysicsEventBuffer.h>
+#include <V8/CScalerBuffer.h>
+#include <V8/CControlBuffer.h>
+#include <V8/CTextBuffer.h>
+#include <V8/bheader.h>
+
+#include <V12/DataFormat.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CRingItemParser.h>
+#include <V12/CRingStateChangeItem.h>
+#include <V12/CRingScalerItem.h>
+#include <V12/CRingTextItem.h>
+#include <V12/CDataFormatItem.h>
+
+#include <ByteBuffer.h>
+#include <ByteOrder.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace DAQ;
+
+class v8tov12tests : public CppUnit::TestFixture {
+private:
+  V8::bheader m_header;
+  V8::bftime  m_time;
+
+public:
+  CPPUNIT_TEST_SUITE(v8tov12tests);
+  CPPUNIT_TEST(physics_0);
+  CPPUNIT_TEST(physics_1);
+  CPPUNIT_TEST(physics_2);
+  CPPUNIT_TEST(physics_3);
+  CPPUNIT_TEST(scaler_0);
+  CPPUNIT_TEST(scaler_1);
+  CPPUNIT_TEST(control_0);
+  CPPUNIT_TEST(control_1);
+  CPPUNIT_TEST(text_0);
+  CPPUNIT_TEST(text_1);
+  CPPUNIT_TEST(unknown_0);
+  CPPUNIT_TEST(stream_0);
+  CPPUNIT_TEST(stream_1);
+  CPPUNIT_TEST(stream_2);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {
+    m_header.nwds = 0;
+    m_header.type = V8::DATABF;
+    m_header.cks  = 0;
+    m_header.run  = 23;
+    m_header.seq  = 2;
+    m_header.nevt = 0;
+    m_header.nlam = 0;
+    m_header.cpu  = 0;
+    m_header.nbit = 0;
+    m_header.buffmt = V8::StandardVsn;
+    m_header.ssignature = V8::BOM16;
+    m_header.lsignature = V8::BOM32;
+
+    m_time = V8::bftime({3, 14, 2017, 12, 30, 15, 0});
+  }
+
+  void tearDown() {}
+
+  V8::CRawBuffer toRaw(const V8::CV8Buffer& buffer) {
+    V8::CRawBuffer raw;
+    buffer.toRawBuffer(raw);
+    return raw;
+  }
+
+  V8::CRawBuffer makeControl(V8::BufferTypes type) {
+    V8::bheader header = m_header;
+    header.type = type;
+    return toRaw(V8::CControlBuffer(header, "a run title", 42, m_time));
+  }
+
+  V8::CRawBuffer makeScalers(V8::BufferTypes type) {
+    V8::bheader header = m_header;
+    header.type = type;
+    header.nevt = 3;
+    return toRaw(V8::CScalerBuffer(header, 10, 20, {1, 2, 3}));
+  }
+
+  V8::CRawBuffer makePhysics() {
+    V8::bheader header = m_header;
+    header.nevt = 2;
+    return toRaw(V8::CPhysicsEventBuffer(header, vector<uint16_t>({3, 1, 2, 2, 5})));
+  }
+
+  // split a V12 byte stream into its constituent items
+  vector<V12::CRawRingItem> splitItems(const Buffer::ByteBuffer& data) {
+    vector<V12::CRawRingItem> items;
+    auto pos = data.begin();
+    while (pos != data.end()) {
+      uint32_t size, type;
+      bool swap;
+      V12::Parser::parseSizeAndType(pos, data.end(), size, type, swap);
+      items.push_back(V12::CRawRingItem(pos, pos + size));
+      pos += size;
+    }
+    return items;
+  }
+
+  void physics_0() {
+    Conversion::CV8toV12Converter converter(5);
+    Buffer::ByteBuffer output;
+    converter.convertBuffer(makePhysics(), output);
+
+    auto items = splitItems(output);
+    EQMSG("one item per event", size_t(2), items.size());
+    EQMSG("type", V12::PHYSICS_EVENT, items[0].type());
+    EQMSG("source id", uint32_t(5), items[0].getSourceId());
+    EQMSG("timestamp", V12::NULL_TIMESTAMP, items[0].getEventTimestamp());
+    EQMSG("native byte order", false, items[0].mustSwap());
+
+    Buffer::ByteBuffer expected;
+    expected << uint16_t(3) << uint16_t(1) << uint16_t(2);
+    EQMSG("body of first event is verbatim", expected, items[0].getBody());
+
+    expected.clear();
+    expected << uint16_t(2) << uint16_t(5);
+    EQMSG("body of second event is verbatim", expected, items[1].getBody());
+  }
+
+  void physics_1() {
+    // build a DATABF in the opposite byte order
+    V8::bheader header = m_header;
+    header.type = V8::BufferTypes(0x0100);
+    header.nevt = 0x0100;
+    header.ssignature = 0x0201;
+    header.lsignature = 0x04030201;
+
+    Buffer::ByteBuffer bytes;
+    bytes << header;
+    bytes << uint16_t(0x0200) << uint16_t(0x0500);
+
+    V8::CRawBuffer raw;
+    raw.setBuffer(bytes);
+
+    Conversion::CV8toV12Converter converter;
+    Buffer::ByteBuffer output;
+    converter.convertBuffer(raw, output);
+
+    auto items = splitItems(output);
+    EQMSG("one event", size_t(1), items.size());
+    EQMSG("type", V12::PHYSICS_EVENT, items[0].type());
+    EQMSG("foreign byte order is preserved", true, items[0].mustSwap());
+    EQMSG("size", uint32_t(24), items[0].size());
+
+    Buffer::ByteBuffer expected;
+    expected << uint16_t(0x0200) << uint16_t(0x0500);
+    EQMSG("body is verbatim", expected, items[0].getBody());
+  }
+
+  void physics_2() {
+    V8::bheader header = m_header;
+    header.nevt = 1;
+
+    Buffer::ByteBuffer bytes;
+    bytes << header;
+    bytes << uint16_t(0);
+
+    V8::CRawBuffer raw;
+    raw.setBuffer(bytes);
+
+    Conversion::CV8toV12Converter converter;
+    Buffer::ByteBuffer output;
+    CPPUNIT_ASSERT_THROW_MESSAGE("zero size events are an error",
+                                 converter.convertBuffer(raw, output),
+                                 std::runtime_error);
+  }
+
+  void physics_3() {
+    V8::bheader header = m_header;
+    header.nevt = 2;
+
+    Buffer::ByteBuffer bytes;
+    bytes << header;
+    bytes << uint32_t(6) << uint16_t(0xabcd);
+    bytes << uint32_t(8) << uint16_t(1) << uint16_t(2);
+
+    V8::CRawBuffer raw;
+    raw.setBuffer(bytes);
+
+    Conversion::CV8toV12Converter converter(0, V8::Inclusive32BitBytes);
+    Buffer::ByteBuffer output;
+    converter.convertBuffer(raw, output);
+
+    auto items = splitItems(output);
+    EQMSG("two events", size_t(2), items.size());
+    EQMSG("first event size", size_t(6), items[0].getBody().size());
+    EQMSG("second event size", size_t(8), items[1].getBody().size());
+  }
+
+  void scaler_0() {
+    Conversion::CV8toV12Converter converter(2);
+    Buffer::ByteBuffer output;
+    converter.convertBuffer(makeControl(V8::BEGRUNBF), output);
+    output.clear();
+    converter.convertBuffer(makeScalers(V8::SCALERBF), output);
+
+    auto items = splitItems(output);
+    EQMSG("one item", size_t(1), items.size());
+
+    V12::CRingScalerItem item(items[0]);
+    EQMSG("start", uint32_t(10), item.getStartTime());
+    EQMSG("end", uint32_t(20), item.getEndTime());
+    EQMSG("timestamp is relative to begin run", V8::to_time_t(m_time)+20,
+          item.getTimestamp());
+    EQMSG("incremental", true, item.isIncremental());
+    EQMSG("width", uint32_t(32), item.getScalerWidth());
+    EQMSG("scalers", vector<uint32_t>({1, 2, 3}), item.getScalers());
+    EQMSG("source id", uint32_t(2), item.getSourceId());
+  }
+
+  void scaler_1() {
+    Conversion::CV8toV12Converter converter;
+    Buffer::ByteBuffer output;
+    converter.convertBuffer(makeScalers(V8::SNAPSCBF), output);
+
+    auto items = splitItems(output);
+    V12::CRingScalerItem item(items.at(0));
+    EQMSG("snapshot scalers are not incremental", false, item.isIncremental());
+  }
+
+  void control_0() {
+    Conversion::CV8toV12Converter converter;
+    Buffer::ByteBuffer output;
+    converter.convertBuffer(makeControl(V8::BEGRUNBF), output);
+
+    auto items = splitItems(output);
+    EQMSG("one item", size_t(1), items.size());
+    EQMSG("type", V12::BEGIN_RUN, items[0].type());
+
+    V12::CRingStateChangeItem item(items[0]);
+    EQMSG("run", uint32_t(23), item.getRunNumber());
+    EQMSG("offset", uint32_t(42), item.getElapsedTime());
+    EQMSG("title is trimmed", string("a run title"), item.getTitle());
+    EQMSG("time", V8::to_time_t(m_time), item.getTimestamp());
+    EQMSG("begin run time is remembered", V8::to_time_t(m_time),
+          converter.getRunStartTime());
+  }
+
+  void control_1() {
+    Conversion::CV8toV12Converter converter;
+    Buffer::ByteBuffer output;
+    converter.convertBuffer(makeControl(V8::ENDRUNBF), output);
+    converter.convertBuffer(makeControl(V8::PAUSEBF), output);
+    converter.convertBuffer(makeControl(V8::RESUMEBF), output);
+
+    auto items = splitItems(output);
+    EQMSG("three items", size_t(3), items.size());
+    EQMSG("end", V12::END_RUN, items[0].type());
+    EQMSG("pause", V12::PAUSE_RUN, items[1].type());
+    EQMSG("resume", V12::RESUME_RUN, items[2].type());
+    EQMSG("only begin runs set the reference time", std::time_t(0),
+          converter.getRunStartTime());
+  }
+
+  void text_0() {
+    V8::bheader header = m_header;
+    header.type = V8::RUNVARBF;
+
+    Conversion::CV8toV12Converter converter;
+    converter.setRunStartTime(1234);
+    Buffer::ByteBuffer output;
+    converter.convertBuffer(toRaw(V8::CTextBuffer(header, {"odd", "even", ""})), output);
+
+    auto items = splitItems(output);
+    EQMSG("one item", size_t(1), items.size());
+    EQMSG("type", V12::MONITORED_VARIABLES, items[0].type());
+
+    V12::CRingTextItem item(items[0]);
+    EQMSG("strings", vector<string>({"odd", "even", ""}), item.getStrings());
+    EQMSG("timestamp is run start", std::time_t(1234), item.getTimestamp());
+  }
+
+  void text_1() {
+    V8::bheader header = m_header;
+    header.type = V8::PKTDOCBF;
+
+    Conversion::CV8toV12Converter converter;
+    Buffer::ByteBuffer output;
+    converter.convertBuffer(toRaw(V8::CTextBuffer(header, {"packet"})), output);
+
+    auto items = splitItems(output);
+    EQMSG("type", V12::PACKET_TYPES, items.at(0).type());
+  }
+
+  void unknown_0() {
+    V8::bheader header = m_header;
+    header.type = V8::GENERIC;
+
+    Buffer::ByteBuffer bytes;
+    bytes << header;
+    V8::CRawBuffer raw;
+    raw.setBuffer(bytes);
+
+    Conversion::CV8toV12Converter converter;
+    Buffer::ByteBuffer output;
+    converter.convertBuffer(raw, output);
+    EQMSG("buffers without V12 equivalent are dropped", size_t(0), output.size());
+  }
+
+  string makeStream() {
+    vector<V8::CRawBuffer> buffers;
+    buffers.push_back(makeControl(V8::BEGRUNBF));
+    for (int i=0; i<5; ++i) {
+      buffers.push_back(makePhysics());
+      buffers.push_back(makeScalers(V8::SCALERBF));
+    }
+    buffers.push_back(makeControl(V8::ENDRUNBF));
+
+    string data;
+    for (auto& buffer : buffers) {
+      auto& bytes = buffer.getBuffer();
+      data.append(bytes.begin(), bytes.end());
+    }
+    return data;
+  }
+
+  void stream_0() {
+    istringstream input(makeStream());
+    ostringstream output;
+
+    Conversion::CV8toV12Converter converter;
+    converter.setThreadCount(1);
+    EQMSG("buffer count", size_t(12), converter.convert(input, output));
+
+    string result = output.str();
+    auto items = splitItems(Buffer::ByteBuffer(result.begin(), result.end()));
+    EQMSG("item count", size_t(1+1+5*3+1), items.size());
+
+    V12::CDataFormatItem format(items[0]);
+    EQMSG("format major", V12::FORMAT_MAJOR, format.getMajor());
+    EQMSG("begin run", V12::BEGIN_RUN, items[1].type());
+    EQMSG("physics", V12::PHYSICS_EVENT, items[2].type());
+    EQMSG("physics", V12::PHYSICS_EVENT, items[3].type());
+    EQMSG("scalers", V12::PERIODIC_SCALERS, items[4].type());
+    EQMSG("end run", V12::END_RUN, items.back().type());
+  }
+
+  void stream_1() {
+    string data = makeStream();
+
+    Conversion::CV8toV12Converter serial;
+    serial.setThreadCount(1);
+    istringstream serialInput(data);
+    ostringstream serialOutput;
+    serial.convert(serialInput, serialOutput);
+
+    Conversion::CV8toV12Converter parallel;
+    parallel.setThreadCount(4);
+    parallel.setBatchSize(5);
+    istringstream parallelInput(data);
+    ostringstream parallelOutput;
+    parallel.convert(parallelInput, parallelOutput);
+
+    ASSERTMSG("threaded conversion preserves order and content",
+              serialOutput.str() == parallelOutput.str());
+  }
+
+  void stream_2() {
+    // a partial trailing buffer is zero padded
+    string data = makeStream();
+    data.resize(data.size() - V8::gBufferSize/2);
+
+    istringstream input(data);
+    ostringstream output;
+
+    Conversion::CV8toV12Converter converter;
+    EQMSG("partial buffer counts", size_t(12), converter.convert(input, output));
+  }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(v8tov12tests);
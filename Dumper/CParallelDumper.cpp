@@ -0,0 +1,418 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CParallelDumper.h"
+
+#include <V8/DataFormat.h>
+#include <V8/CRawBuffer.h>
+#include <V8/bheader.h>
+#include <V10/DataFormat.h>
+#include <V10/CRingItem.h>
+#include <V10/CRingItemFactory.h>
+#include <V11/DataFormat.h>
+#include <V11/CRingItem.h>
+#include <V11/CRingItemFactory.h>
+#include <V12/DataFormat.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CRingItemFactory.h>
+#include <V12/TextFormat.h>
+#include <ByteOrder.h>
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+
+namespace DAQ {
+
+const char* const CParallelDumper::Separator = "----------------------------------\n";
+
+static const char* V8TypeName(std::uint16_t type)
+{
+    switch (type) {
+    case V8::DATABF:       return "DATABF";
+    case V8::SCALERBF:     return "SCALERBF";
+    case V8::SNAPSCBF:     return "SNAPSCBF";
+    case V8::STATEVARBF:   return "STATEVARBF";
+    case V8::RUNVARBF:     return "RUNVARBF";
+    case V8::PKTDOCBF:     return "PKTDOCBF";
+    case V8::BEGRUNBF:     return "BEGRUNBF";
+    case V8::ENDRUNBF:     return "ENDRUNBF";
+    case V8::PAUSEBF:      return "PAUSEBF";
+    case V8::RESUMEBF:     return "RESUMEBF";
+    case V8::PARAMDESCRIP: return "PARAMDESCRIP";
+    case V8::GENERIC:      return "GENERIC";
+    default:               return "UNDEFINED";
+    }
+}
+
+// Dump of an item that the factories do not understand
+static void formatUnknown(const std::uint8_t* beg, const std::uint8_t* end,
+                          std::uint32_t type, bool swap, std::string& out)
+{
+    out += "Size (bytes) : ";
+    V12::TextFormat::appendDecimal(out, end - beg);
+    out += "\nType         : Unknown (";
+    V12::TextFormat::appendDecimal(out, type);
+    out += ")\n";
+    if (swap) {
+        out += "** Data is NOT in native byte order **\n";
+    }
+    V12::TextFormat::appendHexWords(out, beg, end);
+}
+
+//
+CParallelDumper::CParallelDumper(Version version, unsigned nThreads)
+    : m_version(version),
+      m_nThreads(nThreads),
+      m_blockSize(8*1024*1024),
+      m_types(),
+      m_sources()
+{
+    // The V10 factory lazily fills a static set of known types on first use.
+    // Do that now, before any worker threads exist.
+    V10::RingItemHeader header10 = {sizeof(header10), V10::BEGIN_RUN};
+    V10::CRingItemFactory::isKnownItemType(&header10);
+}
+
+//
+std::size_t CParallelDumper::dump(std::istream& input, std::ostream& output)
+{
+    // Read more data into a block. The block starts with the bytes of the
+    // incomplete item left over at the end of the previous one.
+    auto readBlock = [this, &input](Buffer::ByteBuffer& block,
+                                    const std::uint8_t* leftBeg,
+                                    const std::uint8_t* leftEnd) {
+        std::size_t nLeft = leftEnd - leftBeg;
+        std::size_t nToRead = std::max(m_blockSize, pendingItemSize(leftBeg, leftEnd));
+
+        block.resize(nLeft + nToRead);
+        std::copy(leftBeg, leftEnd, block.begin());
+        input.read(reinterpret_cast<char*>(block.data()) + nLeft, nToRead);
+        std::size_t nRead = input.gcount();
+        block.resize(nLeft + nRead);
+
+        if (nRead == 0 && nLeft != 0) {
+            if (m_version != V8) {
+                throw std::runtime_error("DAQ::CParallelDumper::dump() stream ended with an incomplete item");
+            }
+            // V8 files may end with a partial buffer... zero pad it
+            block.resize(V8::gBufferSize, 0);
+        }
+        return nRead;
+    };
+
+    unsigned nThreads = getThreadCount();
+    std::size_t nDumped = 0;
+
+    Buffer::ByteBuffer block, nextBlock;
+    std::vector<Entry> entries;
+    std::vector<std::string> results(nThreads);
+
+    readBlock(block, nullptr, nullptr);
+
+    while (!block.empty()) {
+        entries.clear();
+        std::size_t nConsumed = splitBlock(block, block.size(), entries);
+
+        std::size_t nWorkers = std::max<std::size_t>(1, std::min<std::size_t>(nThreads, entries.size()));
+        std::size_t perWorker = (entries.size() + nWorkers - 1)/nWorkers;
+
+        // the result strings are reused from block to block
+        std::vector<std::future<void> > workers;
+        for (std::size_t i=0; i<nWorkers && i*perWorker < entries.size(); ++i) {
+            std::size_t first = i*perWorker;
+            std::size_t last  = std::min(first + perWorker, entries.size());
+            std::string& result = results[i];
+            result.clear();
+
+            workers.push_back(std::async(std::launch::async,
+                                         [this, &block, &entries, first, last, &result]() {
+                formatRange(block, entries, first, last, result);
+            }));
+        }
+
+        // overlap reading the next block with the formatting of this one
+        readBlock(nextBlock, block.data() + nConsumed,
+                  block.data() + block.size());
+
+        for (std::size_t i=0; i<workers.size(); ++i) {
+            workers[i].get();
+            output.write(results[i].data(), results[i].size());
+        }
+
+        nDumped += entries.size();
+        block.swap(nextBlock);
+    }
+
+    return nDumped;
+}
+
+//
+void CParallelDumper::format(const std::uint8_t* beg, const std::uint8_t* end,
+                             std::string& out) const
+{
+    switch (m_version) {
+    case V8:
+        formatV8(beg, end, out);
+        break;
+    case V10:
+        formatV10(beg, end, out);
+        break;
+    case V11:
+        formatV11(beg, end, out);
+        break;
+    case V12:
+        formatV12(beg, end, out);
+        break;
+    }
+}
+
+//
+void CParallelDumper::setTypeFilter(const std::vector<std::uint32_t>& types)
+{
+    m_types = std::set<std::uint32_t>(types.begin(), types.end());
+}
+
+//
+void CParallelDumper::setSourceFilter(const std::vector<std::uint32_t>& sourceIds)
+{
+    m_sources = std::set<std::uint32_t>(sourceIds.begin(), sourceIds.end());
+}
+
+//
+unsigned CParallelDumper::getThreadCount() const
+{
+    unsigned nThreads = m_nThreads;
+    if (nThreads == 0) {
+        nThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return nThreads;
+}
+
+//
+void CParallelDumper::setBlockSize(std::size_t nBytes)
+{
+    if (nBytes == 0) {
+        throw std::invalid_argument("DAQ::CParallelDumper::setBlockSize() block size must be nonzero.");
+    }
+    m_blockSize = nBytes;
+}
+
+//
+std::size_t CParallelDumper::splitBlock(const Buffer::ByteBuffer& block, std::size_t nBytes,
+                                        std::vector<Entry>& entries) const
+{
+    const std::uint8_t* beg = block.data();
+    const std::uint8_t* end = beg + nBytes;
+    const std::uint8_t* pos = beg;
+
+    Entry entry;
+    while (parseEntry(pos, end, entry)) {
+        entry.s_offset = pos - beg;
+        if (accept(pos, entry)) {
+            entries.push_back(entry);
+        }
+        pos += entry.s_size;
+    }
+
+    return pos - beg;
+}
+
+//
+std::size_t CParallelDumper::pendingItemSize(const std::uint8_t* beg,
+                                             const std::uint8_t* end) const
+{
+    if (m_version == V8) {
+        return V8::gBufferSize;
+    }
+
+    Entry entry;
+    if (end - beg < 8) {
+        return 0;
+    }
+    parseEntry(beg, beg + 8, entry);
+    return entry.s_size;
+}
+
+//
+bool CParallelDumper::parseEntry(const std::uint8_t* beg, const std::uint8_t* end,
+                                 Entry& entry) const
+{
+    std::size_t nBytes = end - beg;
+
+    if (m_version == V8) {
+        if (nBytes < V8::gBufferSize) {
+            return false;
+        }
+        V8::bheader header;
+        std::memcpy(&header, beg, sizeof(header));
+        entry.s_swap = (header.ssignature != V8::BOM16);
+        if (entry.s_swap) {
+            BO::swapBytes(header.type);
+        }
+        entry.s_size = V8::gBufferSize;
+        entry.s_type = header.type;
+        return true;
+    }
+
+    if (nBytes < 8) {
+        return false;
+    }
+
+    std::uint32_t size, type;
+    std::memcpy(&size, beg,   sizeof(size));
+    std::memcpy(&type, beg+4, sizeof(type));
+
+    // types occupy the lower 16 bits, so a foreign byte order leaves them 0
+    entry.s_swap = (((type & 0xffff) == 0) && (type != 0));
+    if (entry.s_swap) {
+        BO::swapBytes(size);
+        BO::swapBytes(type);
+    }
+    entry.s_size = size;
+    entry.s_type = type;
+
+    std::uint32_t minSize = (m_version == V12) ? 20 : 8;
+    if (size < minSize) {
+        std::string errmsg("DAQ::CParallelDumper encountered an item with a size (");
+        errmsg += std::to_string(size) + ") smaller than its header";
+        throw std::runtime_error(errmsg);
+    }
+
+    return (nBytes >= size);
+}
+
+//
+bool CParallelDumper::accept(const std::uint8_t* pItem, const Entry& entry) const
+{
+    if (!m_types.empty() && m_types.count(entry.s_type) == 0) {
+        return false;
+    }
+
+    if (m_sources.empty()) {
+        return true;
+    }
+
+    std::uint32_t sourceId;
+    if (m_version == V12) {
+        std::memcpy(&sourceId, pItem + 16, sizeof(sourceId));
+    } else if (m_version == V11 && entry.s_size >= 8 + sizeof(V11::BodyHeader)) {
+        std::uint32_t bodyHeaderSize;
+        std::memcpy(&bodyHeaderSize, pItem + 8, sizeof(bodyHeaderSize));
+        if (bodyHeaderSize == 0) {
+            return false;
+        }
+        std::memcpy(&sourceId, pItem + 8 + 12, sizeof(sourceId));
+    } else {
+        return false;
+    }
+
+    if (entry.s_swap) {
+        BO::swapBytes(sourceId);
+    }
+    return (m_sources.count(sourceId) != 0);
+}
+
+//
+void CParallelDumper::formatRange(const Buffer::ByteBuffer& block,
+                                  const std::vector<Entry>& entries,
+                                  std::size_t first, std::size_t last,
+                                  std::string& out) const
+{
+    for (std::size_t i=first; i<last; ++i) {
+        const Entry& entry = entries[i];
+        const std::uint8_t* beg = block.data() + entry.s_offset;
+
+        format(beg, beg + entry.s_size, out);
+        out += Separator;
+    }
+}
+
+//
+void CParallelDumper::formatV8(const std::uint8_t* beg, const std::uint8_t* end,
+                               std::string& out) const
+{
+    V8::CRawBuffer buffer(end - beg);
+    buffer.setBuffer(Buffer::ByteBuffer(beg, end));
+    V8::bheader header = buffer.getHeader();
+
+    out += "Buffer type  : ";
+    out += V8TypeName(header.type);
+    out += "\nSize (words) : ";
+    V12::TextFormat::appendDecimal(out, header.nwds);
+    out += "\nRun number   : ";
+    V12::TextFormat::appendDecimal(out, header.run);
+    out += "\nSequence     : ";
+    V12::TextFormat::appendDecimal(out, header.seq);
+    out += "\nEntities     : ";
+    V12::TextFormat::appendDecimal(out, header.nevt);
+    out += "\nRevision     : ";
+    V12::TextFormat::appendDecimal(out, header.buffmt);
+    out += '\n';
+    if (buffer.bufferNeedsSwap()) {
+        out += "** Data is NOT in native byte order **\n";
+    }
+
+    // only the used part of the body is printed
+    std::size_t nUsed = std::min<std::size_t>(header.nwds*sizeof(std::uint16_t), end - beg);
+    nUsed = std::max(nUsed, sizeof(V8::bheader));
+    V12::TextFormat::appendHexWords(out, beg + sizeof(V8::bheader), beg + nUsed);
+}
+
+//
+void CParallelDumper::formatV10(const std::uint8_t* beg, const std::uint8_t* end,
+                                std::string& out) const
+{
+    Entry entry;
+    parseEntry(beg, end, entry);
+    if (entry.s_swap || !V10::CRingItemFactory::isKnownItemType(beg)) {
+        formatUnknown(beg, end, entry.s_type, entry.s_swap, out);
+        return;
+    }
+
+    std::unique_ptr<V10::CRingItem> pItem(V10::CRingItemFactory::createRingItem(beg));
+    out += pItem->toString();
+}
+
+//
+void CParallelDumper::formatV11(const std::uint8_t* beg, const std::uint8_t* end,
+                                std::string& out) const
+{
+    Entry entry;
+    parseEntry(beg, end, entry);
+    if (entry.s_swap || !V11::CRingItemFactory::isKnownItemType(beg)) {
+        formatUnknown(beg, end, entry.s_type, entry.s_swap, out);
+        return;
+    }
+
+    std::unique_ptr<V11::CRingItem> pItem(V11::CRingItemFactory::createRingItem(beg));
+    out += pItem->toString();
+}
+
+//
+void CParallelDumper::formatV12(const std::uint8_t* beg, const std::uint8_t* end,
+                                std::string& out) const
+{
+    V12::CRawRingItem item(beg, end);
+    V12::CRingItemFactory::createRingItem(item)->appendString(out);
+}
+
+} // end DAQ
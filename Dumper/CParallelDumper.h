@@ -0,0 +1,154 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CPARALLELDUMPER_H
+#define DAQ_CPARALLELDUMPER_H
+
+#include <ByteBuffer.h>
+
+#include <cstdint>
+#include <iosfwd>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace DAQ {
+
+/*!
+ * \brief Multithreaded textual dump of a stream of V8, V10, V11, or V12 data
+ *
+ * The dumper reads the input in large blocks and splits each block into
+ * complete items (or buffers for V8). The items of a block are divided among
+ * a set of worker threads. Each worker formats its share into its own string.
+ * The strings are then written to the output in the original order, so the
+ * output is identical to a serial dump. Reading of the next block overlaps
+ * with the formatting of the current block.
+ *
+ * Every item that passes the filters is written as its toString() followed by
+ * a separator line. V8 buffers are not classes with a textual representation,
+ * so their header is summarized and the used part of the body is printed as
+ * hexadecimal words.
+ *
+ * The filters are applied before any formatting takes place:
+ *
+ * - The type filter selects items (or V8 buffers) by their type.
+ * - The source id filter selects items by source id. Only V12 items and V11
+ *   items with a body header have a source id. All other items are rejected
+ *   while a source id filter is in effect.
+ *
+ * An empty filter accepts everything.
+ *
+ * \code
+ * std::ifstream input("run-0012-00.evt", std::ios::binary);
+ *
+ * CParallelDumper dumper(CParallelDumper::V12);
+ * dumper.setTypeFilter({V12::PHYSICS_EVENT});
+ * dumper.dump(input, std::cout);
+ * \endcode
+ */
+class CParallelDumper
+{
+public:
+    enum Version { V8, V10, V11, V12 };
+
+    /*! The line that follows each item in the output */
+    static const char* const Separator;
+
+private:
+    /*! Location and properties of an item in the current block */
+    struct Entry {
+        std::size_t   s_offset;
+        std::uint32_t s_size;
+        std::uint32_t s_type;
+        bool          s_swap;
+    };
+
+    Version                  m_version;
+    unsigned                 m_nThreads;
+    std::size_t              m_blockSize;
+    std::set<std::uint32_t>  m_types;
+    std::set<std::uint32_t>  m_sources;
+
+public:
+    /*!
+     * \brief Constructor
+     *
+     * \param version   the format version of the input
+     * \param nThreads  the number of worker threads. 0 selects
+     *                  std::thread::hardware_concurrency()
+     */
+    CParallelDumper(Version version, unsigned nThreads = 0);
+
+    /*!
+     * \brief Dump an entire stream
+     *
+     * \param input   the stream to read from
+     * \param output  the stream to write text to
+     *
+     * \return the number of items written
+     *
+     * \throws std::runtime_error if the input ends in the middle of an item or an
+     *                            item has a size too small to hold its header
+     */
+    std::size_t dump(std::istream& input, std::ostream& output);
+
+    /*!
+     * \brief Format a single item or buffer
+     *
+     * The item is formatted regardless of the filters.
+     *
+     * \param beg  the first byte of the item
+     * \param end  one past the last byte of the item
+     * \param out  the string to append the text to
+     */
+    void format(const std::uint8_t* beg, const std::uint8_t* end, std::string& out) const;
+
+    void setTypeFilter(const std::vector<std::uint32_t>& types);
+    void setSourceFilter(const std::vector<std::uint32_t>& sourceIds);
+
+    void setThreadCount(unsigned nThreads) { m_nThreads = nThreads; }
+    unsigned getThreadCount() const;
+
+    /*!
+     * \brief Set the number of bytes read at once
+     *
+     * The block is grown as needed to hold a single item larger than this.
+     *
+     * \throws std::invalid_argument if the size is 0
+     */
+    void setBlockSize(std::size_t nBytes);
+    std::size_t getBlockSize() const { return m_blockSize; }
+
+private:
+    std::size_t splitBlock(const Buffer::ByteBuffer& block, std::size_t nBytes,
+                           std::vector<Entry>& entries) const;
+    std::size_t pendingItemSize(const std::uint8_t* beg, const std::uint8_t* end) const;
+    bool parseEntry(const std::uint8_t* beg, const std::uint8_t* end, Entry& entry) const;
+    bool accept(const std::uint8_t* pItem, const Entry& entry) const;
+    void formatRange(const Buffer::ByteBuffer& block,
+                     const std::vector<Entry>& entries,
+                     std::size_t first, std::size_t last,
+                     std::string& out) const;
+
+    void formatV8(const std::uint8_t* beg, const std::uint8_t* end, std::string& out) const;
+    void formatV10(const std::uint8_t* beg, const std::uint8_t* end, std::string& out) const;
+    void formatV11(const std::uint8_t* beg, const std::uint8_t* end, std::string& out) const;
+    void formatV12(const std::uint8_t* beg, const std::uint8_t* end, std::string& out) const;
+};
+
+} // end DAQ
+
+#endif // DAQ_CPARALLELDUMPER_H
@@ -0,0 +1,49 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+	     NSCL
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <string>
+#include <iostream>
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+  CppUnit::TextUi::TestRunner   
+               runner; // Control tests.
+  CppUnit::TestFactoryRegistry& 
+               registry(CppUnit::TestFactoryRegistry::getRegistry());
+
+  runner.addTest(registry.makeTest());
+
+  bool wasSucessful;
+  try {
+    wasSucessful = runner.run("",false);
+  } 
+  catch(string& rFailure) {
+    cerr << "Caught a string exception from test suites.: \n";
+    cerr << rFailure << endl;
+    wasSucessful = false;
+  }
+  return !wasSucessful;
+}
+
+namespace DAQ {
+  namespace V8 {
+    std::size_t gBufferSize = 8192;
+  }
+}
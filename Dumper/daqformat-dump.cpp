@@ -0,0 +1,177 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CParallelDumper.h"
+
+#include <V8/DataFormat.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <getopt.h>
+
+using namespace DAQ;
+
+namespace DAQ {
+  namespace V8 {
+    std::size_t gBufferSize = 8192;
+  }
+}
+
+static void usage(std::ostream& stream)
+{
+    stream << "Usage: daqformat-dump [options] [file]\n"
+           << "\n"
+           << "Writes a textual dump of every item in file (or stdin) to stdout.\n"
+           << "\n"
+           << "Options:\n"
+           << "  -f, --format=VERSION    data format version: 8, 10, 11, or 12 (default 12)\n"
+           << "  -t, --types=LIST        comma separated list of item types to dump\n"
+           << "  -s, --sources=LIST      comma separated list of source ids to dump\n"
+           << "  -j, --threads=N         number of formatting threads (default: all cores)\n"
+           << "  -b, --block-size=BYTES  number of bytes read at once (default 8388608)\n"
+           << "      --buffer-size=BYTES size of V8 buffers (default 8192)\n"
+           << "  -h, --help              print this message\n";
+}
+
+static unsigned long toUnsigned(const std::string& value, const std::string& option)
+{
+    try {
+        std::size_t nParsed;
+        unsigned long result = std::stoul(value, &nParsed, 0);
+        if (nParsed == value.size()) {
+            return result;
+        }
+    } catch (std::exception&) {
+    }
+    throw std::invalid_argument("invalid value '" + value + "' for " + option);
+}
+
+static std::vector<std::uint32_t> toList(const std::string& value, const std::string& option)
+{
+    std::vector<std::uint32_t> result;
+    std::istringstream stream(value);
+    std::string element;
+    while (std::getline(stream, element, ',')) {
+        result.push_back(toUnsigned(element, option));
+    }
+    return result;
+}
+
+static CParallelDumper::Version toVersion(const std::string& value)
+{
+    if (value == "8")  return CParallelDumper::V8;
+    if (value == "10") return CParallelDumper::V10;
+    if (value == "11") return CParallelDumper::V11;
+    if (value == "12") return CParallelDumper::V12;
+    throw std::invalid_argument("unsupported format version '" + value + "'");
+}
+
+int main(int argc, char** argv)
+{
+    enum { BufferSizeOption = 256 };
+
+    static const option options[] = {
+        {"format",      required_argument, nullptr, 'f'},
+        {"types",       required_argument, nullptr, 't'},
+        {"sources",     required_argument, nullptr, 's'},
+        {"threads",     required_argument, nullptr, 'j'},
+        {"block-size",  required_argument, nullptr, 'b'},
+        {"buffer-size", required_argument, nullptr, BufferSizeOption},
+        {"help",        no_argument,       nullptr, 'h'},
+        {nullptr,       0,                 nullptr, 0}
+    };
+
+    try {
+        CParallelDumper::Version version = CParallelDumper::V12;
+        std::vector<std::uint32_t> types, sources;
+        unsigned nThreads = 0;
+        std::size_t blockSize = 0;
+
+        int c;
+        while ((c = getopt_long(argc, argv, "f:t:s:j:b:h", options, nullptr)) != -1) {
+            switch (c) {
+            case 'f':
+                version = toVersion(optarg);
+                break;
+            case 't':
+                types = toList(optarg, "--types");
+                break;
+            case 's':
+                sources = toList(optarg, "--sources");
+                break;
+            case 'j':
+                nThreads = toUnsigned(optarg, "--threads");
+                break;
+            case 'b':
+                blockSize = toUnsigned(optarg, "--block-size");
+                break;
+            case BufferSizeOption:
+                V8::gBufferSize = toUnsigned(optarg, "--buffer-size");
+                break;
+            case 'h':
+                usage(std::cout);
+                return EXIT_SUCCESS;
+            default:
+                usage(std::cerr);
+                return EXIT_FAILURE;
+            }
+        }
+
+        if (argc - optind > 1) {
+            usage(std::cerr);
+            return EXIT_FAILURE;
+        }
+
+        CParallelDumper dumper(version, nThreads);
+        dumper.setTypeFilter(types);
+        dumper.setSourceFilter(sources);
+        if (blockSize != 0) {
+            dumper.setBlockSize(blockSize);
+        }
+
+        // the dumper does its own buffering, avoid a second copy through stdio
+        std::ios::sync_with_stdio(false);
+
+        if (optind < argc && std::string(argv[optind]) != "-") {
+            std::ifstream input(argv[optind], std::ios::binary);
+            if (!input) {
+                std::cerr << "daqformat-dump: unable to open " << argv[optind] << std::endl;
+                return EXIT_FAILURE;
+            }
+            dumper.dump(input, std::cout);
+        } else {
+            dumper.dump(std::cin, std::cout);
+        }
+        std::cout.flush();
+
+    } catch (std::exception& exc) {
+        std::cerr << "daqformat-dump: " << exc.what() << std::endl;
+        return EXIT_FAILURE;
+    } catch (std::string& msg) {
+        std::cerr << "daqformat-dump: " << msg << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,211 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+         NSCL
+         Michigan State University
+         East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <Asserts.h>
+
+#include <CParallelDumper.h>
+
+#include <V8/DataFormat.h>
+#include <V8/bheader.h>
+#include <V11/DataFormat.h>
+#include <V11/CPhysicsEventItem.h>
+#include <V12/DataFormat.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CRingItem.h>
+#include <V12/CRingStateChangeItem.h>
+#include <V12/CRingItemFactory.h>
+
+#include <ByteBuffer.h>
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace DAQ;
+
+class CParallelDumperTest : public CppUnit::TestFixture
+{
+private:
+    vector<V12::CRawRingItem> m_items;
+    string                    m_input;
+
+public:
+    CPPUNIT_TEST_SUITE( CParallelDumperTest );
+    CPPUNIT_TEST ( v12_0 );
+    CPPUNIT_TEST ( v12_1 );
+    CPPUNIT_TEST ( v12_2 );
+    CPPUNIT_TEST ( filter_0 );
+    CPPUNIT_TEST ( filter_1 );
+    CPPUNIT_TEST ( truncated_0 );
+    CPPUNIT_TEST ( v11_0 );
+    CPPUNIT_TEST ( v8_0 );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {
+        m_items.clear();
+        m_items.push_back(V12::CRawRingItem(
+                              V12::CRingStateChangeItem(V12::NULL_TIMESTAMP, 1, V12::BEGIN_RUN,
+                                                        12, 0, 1000000, "title")));
+        for (int i=0; i<50; ++i) {
+            V12::CRawRingItem item(V12::PHYSICS_EVENT, i, i%3);
+            for (int j=0; j<i; ++j) {
+                item.getBody().push_back(uint8_t(j));
+            }
+            m_items.push_back(item);
+        }
+        m_items.push_back(V12::CRawRingItem(
+                              V12::CRingStateChangeItem(V12::NULL_TIMESTAMP, 1, V12::END_RUN,
+                                                        12, 10, 1000010, "title")));
+
+        m_input.clear();
+        for (auto& item : m_items) {
+            Buffer::ByteBuffer data(20);
+            V12::serializeHeader(item, data.begin());
+            data.insert(data.end(), item.getBody().begin(), item.getBody().end());
+            m_input.append(reinterpret_cast<const char*>(data.data()), data.size());
+        }
+    }
+    void tearDown() {}
+
+    string serialDump(const vector<V12::CRawRingItem>& items) {
+        string result;
+        for (auto& item : items) {
+            result += V12::CRingItemFactory::createRingItem(item)->toString();
+            result += CParallelDumper::Separator;
+        }
+        return result;
+    }
+
+    string dump(CParallelDumper& dumper, const string& input) {
+        istringstream in(input);
+        ostringstream out;
+        dumper.dump(in, out);
+        return out.str();
+    }
+
+    void v12_0() {
+        CParallelDumper dumper(CParallelDumper::V12, 1);
+        istringstream in(m_input);
+        ostringstream out;
+        EQMSG("count", m_items.size(), dumper.dump(in, out));
+        EQMSG("single thread", serialDump(m_items), out.str());
+    }
+
+    void v12_1() {
+        // small blocks force items to straddle block boundaries
+        CParallelDumper dumper(CParallelDumper::V12, 4);
+        dumper.setBlockSize(97);
+        EQMSG("output order is preserved", serialDump(m_items), dump(dumper, m_input));
+    }
+
+    void v12_2() {
+        // items larger than the block size
+        CParallelDumper dumper(CParallelDumper::V12, 3);
+        dumper.setBlockSize(1);
+        EQMSG("block grows to fit item", serialDump(m_items), dump(dumper, m_input));
+    }
+
+    void filter_0() {
+        CParallelDumper dumper(CParallelDumper::V12, 2);
+        dumper.setTypeFilter({V12::BEGIN_RUN, V12::END_RUN});
+
+        vector<V12::CRawRingItem> expected = {m_items.front(), m_items.back()};
+        EQMSG("type filter", serialDump(expected), dump(dumper, m_input));
+    }
+
+    void filter_1() {
+        CParallelDumper dumper(CParallelDumper::V12, 2);
+        dumper.setTypeFilter({V12::PHYSICS_EVENT});
+        dumper.setSourceFilter({2});
+
+        vector<V12::CRawRingItem> expected;
+        for (auto& item : m_items) {
+            if (item.type() == V12::PHYSICS_EVENT && item.getSourceId() == 2) {
+                expected.push_back(item);
+            }
+        }
+        EQMSG("source filter", serialDump(expected), dump(dumper, m_input));
+    }
+
+    void truncated_0() {
+        CParallelDumper dumper(CParallelDumper::V12, 2);
+        string input = m_input.substr(0, m_input.size() - 1);
+        CPPUNIT_ASSERT_THROW_MESSAGE("incomplete items are an error",
+                                     dump(dumper, input),
+                                     std::runtime_error);
+    }
+
+    void v11_0() {
+        V11::CPhysicsEventItem item(123, 4, 0);
+        uint8_t* pCursor = reinterpret_cast<uint8_t*>(item.getBodyCursor());
+        for (uint8_t i=0; i<6; ++i) {
+            *pCursor++ = i;
+        }
+        item.setBodyCursor(pCursor);
+        item.updateSize();
+
+        string input(reinterpret_cast<const char*>(item.getItemPointer()), item.size());
+        input += input;
+
+        CParallelDumper dumper(CParallelDumper::V11, 2);
+        dumper.setSourceFilter({4});
+        string expected = item.toString() + CParallelDumper::Separator;
+        EQMSG("v11", expected + expected, dump(dumper, input));
+
+        dumper.setSourceFilter({5});
+        EQMSG("v11 source filter", string(), dump(dumper, input));
+    }
+
+    void v8_0() {
+        V8::bheader header;
+        header.type = V8::DATABF;
+        header.nwds = 18;
+        header.run  = 3;
+        header.nevt = 1;
+
+        string buffer(V8::gBufferSize, '\0');
+        memcpy(&buffer[0], &header, sizeof(header));
+        uint16_t body[2] = {0x1234, 0xabcd};
+        memcpy(&buffer[sizeof(header)], body, sizeof(body));
+
+        // the trailing partial buffer is zero padded (i.e. a VOID buffer)
+        string input = buffer + string(100, '\0');
+
+        CParallelDumper dumper(CParallelDumper::V8, 2);
+        dumper.setTypeFilter({V8::DATABF});
+
+        string expected;
+        expected += "Buffer type  : DATABF\n";
+        expected += "Size (words) : 18\n";
+        expected += "Run number   : 3\n";
+        expected += "Sequence     : 0\n";
+        expected += "Entities     : 1\n";
+        expected += "Revision     : 5\n";
+        expected += "1234 abcd \n";
+        expected += CParallelDumper::Separator;
+
+        EQMSG("v8", expected, dump(dumper, input));
+    }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CParallelDumperTest);
@@ -0,0 +1,240 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CAsyncFileReader.h"
+
+#include <V8/DataFormat.h>
+#include <V8/CRawBuffer.h>
+#include <V12/DataFormat.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CRingItemParser.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace DAQ {
+
+static const std::size_t HeaderSize = sizeof(V12::RingItemHeader);
+
+
+//
+CAsyncFileReader::CAsyncFileReader(const std::vector<std::string>& paths,
+                                   std::size_t blockSize, std::size_t nInFlight)
+    : m_fds(),
+      m_requests(),
+      m_nextRequest(0),
+      m_nInFlight(nInFlight),
+      m_inFlight(),
+      m_buffer(),
+      m_pos(0),
+      m_file(0)
+{
+    if (blockSize == 0 || nInFlight == 0) {
+        throw std::invalid_argument("DAQ::CAsyncFileReader::CAsyncFileReader() block size and number of reads in flight must be nonzero.");
+    }
+
+    for (std::size_t i=0; i<paths.size(); ++i) {
+        int fd = open(paths[i].c_str(), O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) < 0) {
+            std::string errmsg("DAQ::CAsyncFileReader::CAsyncFileReader() failed to open '");
+            errmsg += paths[i] + "' : " + std::strerror(errno);
+            if (fd >= 0) {
+                close(fd);
+            }
+            for (int opened : m_fds) {
+                close(opened);
+            }
+            throw std::runtime_error(errmsg);
+        }
+        m_fds.push_back(fd);
+
+        std::uint64_t fileSize = info.st_size;
+        for (std::uint64_t offset=0; offset<fileSize; offset += blockSize) {
+            std::size_t length = std::min<std::uint64_t>(blockSize, fileSize - offset);
+            m_requests.push_back({i, offset, length});
+        }
+    }
+
+    submit();
+}
+
+
+//
+CAsyncFileReader::~CAsyncFileReader()
+{
+    // outstanding reads must finish before their files are closed
+    for (auto& future : m_inFlight) {
+        future.wait();
+    }
+    m_inFlight.clear();
+
+    for (int fd : m_fds) {
+        close(fd);
+    }
+}
+
+
+//
+bool CAsyncFileReader::read(V12::CRawRingItem& item)
+{
+    if (!fill(HeaderSize)) {
+        if (m_pos != m_buffer.size()) {
+            throwTruncated("an item header");
+        }
+        return false;
+    }
+
+    std::uint32_t size, type, sourceId;
+    std::uint64_t tstamp;
+    bool swapNeeded;
+    const std::uint8_t* pItem = m_buffer.data() + m_pos;
+    V12::Parser::parseHeader(pItem, pItem + HeaderSize, size, type, tstamp, sourceId, swapNeeded);
+    if (size < HeaderSize) {
+        throw std::runtime_error("DAQ::CAsyncFileReader::read() item is smaller than its header.");
+    }
+
+    if (!fill(size)) {
+        throwTruncated("an item");
+    }
+
+    // fill() may have moved the data
+    pItem = m_buffer.data() + m_pos;
+    item.setType(type);
+    item.setEventTimestamp(tstamp);
+    item.setSourceId(sourceId);
+    item.setMustSwap(swapNeeded);
+    item.getBody().assign(pItem + HeaderSize, pItem + size);
+
+    m_pos += size;
+    return true;
+}
+
+
+//
+bool CAsyncFileReader::read(V8::CRawBuffer& buffer)
+{
+    if (!fill(V8::gBufferSize)) {
+        if (m_pos != m_buffer.size()) {
+            throwTruncated("a buffer");
+        }
+        return false;
+    }
+
+    const std::uint8_t* pBuffer = m_buffer.data() + m_pos;
+    buffer.setBuffer(Buffer::ByteBuffer(pBuffer, pBuffer + V8::gBufferSize));
+
+    m_pos += V8::gBufferSize;
+    return true;
+}
+
+
+/*!
+ * \brief Read one block with as many pread() calls as it takes
+ *
+ * This runs on a worker thread.
+ */
+Buffer::ByteBuffer CAsyncFileReader::readBlock(int fd, Request request)
+{
+    Buffer::ByteBuffer block(request.s_length);
+
+    std::size_t nRead = 0;
+    while (nRead < request.s_length) {
+        ssize_t status = pread(fd, block.data() + nRead, request.s_length - nRead,
+                               request.s_offset + nRead);
+        if (status < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::string errmsg("DAQ::CAsyncFileReader::readBlock() read failed : ");
+            errmsg += std::strerror(errno);
+            throw std::runtime_error(errmsg);
+        }
+        if (status == 0) {
+            break;      // the file was truncated after it was opened
+        }
+        nRead += status;
+    }
+    block.resize(nRead);
+
+    return block;
+}
+
+
+/*!
+ * \brief Start reads until m_nInFlight are outstanding or none remain
+ */
+void CAsyncFileReader::submit()
+{
+    while (m_inFlight.size() < m_nInFlight && m_nextRequest < m_requests.size()) {
+        const Request& request = m_requests[m_nextRequest++];
+        m_inFlight.push_back(std::async(std::launch::async, &CAsyncFileReader::readBlock,
+                                        m_fds[request.s_file], request));
+    }
+}
+
+
+/*!
+ * \brief Make sure that nBytes of the current file follow m_pos in m_buffer
+ *
+ * Moves on to the next file once the current one has been consumed.
+ *
+ * \return false if the files end first, or the current file ends with fewer
+ *         than nBytes left
+ */
+bool CAsyncFileReader::fill(std::size_t nBytes)
+{
+    while (m_buffer.size() - m_pos < nBytes) {
+        if (m_inFlight.empty()) {
+            return false;
+        }
+
+        std::size_t file = m_requests[m_nextRequest - m_inFlight.size()].s_file;
+        if (file != m_file) {
+            if (m_pos != m_buffer.size()) {
+                return false;
+            }
+            m_file = file;
+        }
+
+        // pop the read before get() so that a failed read is not waited on again
+        std::future<Buffer::ByteBuffer> read = std::move(m_inFlight.front());
+        m_inFlight.pop_front();
+        Buffer::ByteBuffer block = read.get();
+        submit();
+
+        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + m_pos);
+        m_pos = 0;
+        m_buffer.insert(m_buffer.end(), block.begin(), block.end());
+    }
+    return true;
+}
+
+
+//
+void CAsyncFileReader::throwTruncated(const std::string& what) const
+{
+    throw std::runtime_error("DAQ::CAsyncFileReader::read() file ends in the middle of "
+                             + what + ".");
+}
+
+} // end DAQ
@@ -0,0 +1,124 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CASYNCFILEREADER_H
+#define DAQ_CASYNCFILEREADER_H
+
+#include <ByteBuffer.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace DAQ {
+
+namespace V8 {
+    class CRawBuffer;
+}
+
+namespace V12 {
+    class CRawRingItem;
+}
+
+/*!
+ * \brief Reads V12 items or V8 buffers from files with reads kept in flight
+ *
+ * Reading with operator>> blocks on the stream for every item, so parsing and
+ * I/O never overlap. This reader divides the files into large blocks and keeps
+ * several of them being read at once with pread() on worker threads. Items are
+ * framed out of the completed blocks while the following blocks are still
+ * being read.
+ *
+ * The files are read in the order given, each as a complete sequence of items:
+ * an item may span blocks but not files.
+ *
+ * \code
+ * CAsyncFileReader reader({"run-0012-00.evt", "run-0012-01.evt"});
+ * V12::CRawRingItem item;
+ * while (reader.read(item)) {
+ *     ...
+ * }
+ * \endcode
+ */
+class CAsyncFileReader
+{
+    struct Request {
+        std::size_t   s_file;
+        std::uint64_t s_offset;
+        std::size_t   s_length;
+    };
+
+    std::vector<int>                              m_fds;
+    std::vector<Request>                          m_requests;
+    std::size_t                                   m_nextRequest;
+    std::size_t                                   m_nInFlight;
+    std::deque<std::future<Buffer::ByteBuffer> >  m_inFlight;
+
+    Buffer::ByteBuffer  m_buffer;   // completed data not yet framed
+    std::size_t         m_pos;      // start of the next item in m_buffer
+    std::size_t         m_file;     // the file m_buffer belongs to
+
+public:
+    /*!
+     * \param paths      the files to read, in order
+     * \param blockSize  the number of bytes per read
+     * \param nInFlight  the number of reads to keep outstanding
+     *
+     * \throws std::invalid_argument if blockSize or nInFlight is 0
+     * \throws std::runtime_error if a file cannot be opened
+     */
+    explicit CAsyncFileReader(const std::vector<std::string>& paths,
+                              std::size_t blockSize = 4*1024*1024,
+                              std::size_t nInFlight = 4);
+    ~CAsyncFileReader();
+
+    CAsyncFileReader(const CAsyncFileReader&) = delete;
+    CAsyncFileReader& operator=(const CAsyncFileReader&) = delete;
+
+    /*!
+     * \brief Read the next V12 item
+     *
+     * \return false when all files have been read
+     *
+     * \throws std::runtime_error if a read fails, or a file ends in the middle
+     *                            of an item
+     */
+    bool read(V12::CRawRingItem& item);
+
+    /*!
+     * \brief Read the next V8 buffer of V8::gBufferSize bytes
+     *
+     * \return false when all files have been read
+     *
+     * \throws std::runtime_error if a read fails, or a file ends in the middle
+     *                            of a buffer
+     */
+    bool read(V8::CRawBuffer& buffer);
+
+private:
+    static Buffer::ByteBuffer readBlock(int fd, Request request);
+
+    void submit();
+    bool fill(std::size_t nBytes);
+    void throwTruncated(const std::string& what) const;
+};
+
+} // end DAQ
+
+#endif // DAQ_CASYNCFILEREADER_H
@@ -0,0 +1,218 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CChunkSplitter.h"
+
+#include <V12/DataFormat.h>
+#include <V12/CRingItemParser.h>
+
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+#include <string>
+
+namespace DAQ {
+
+static const std::size_t HeaderSize = sizeof(V12::RingItemHeader);
+
+// the number of item starts remembered from the beginning of each walk
+static const std::size_t MaxVisited = 64;
+
+// The result of walking a chunk from header to header
+struct CChunkSplitter::Walk {
+    std::size_t              s_from;
+    std::size_t              s_landing;   // first item start at or past the limit
+    bool                     s_ok;        // false if an implausible header was met
+    std::vector<std::size_t> s_visited;   // the first item starts passed
+
+    bool passedThrough(std::size_t offset) const {
+        return s_ok && ((offset == s_landing)
+                        || std::binary_search(s_visited.begin(), s_visited.end(), offset));
+    }
+};
+
+
+//
+CChunkSplitter::CChunkSplitter(std::size_t nConfirm, std::uint32_t maxItemSize)
+    : m_nConfirm(std::max<std::size_t>(nConfirm, 1)),
+      m_maxItemSize(maxItemSize)
+{}
+
+
+//
+std::vector<CChunkSplitter::Chunk>
+CChunkSplitter::split(const std::uint8_t* beg, const std::uint8_t* end,
+                      std::size_t nChunks) const
+{
+    if (nChunks == 0) {
+        throw std::invalid_argument("DAQ::CChunkSplitter::split() number of chunks must be nonzero.");
+    }
+
+    std::size_t total = end - beg;
+
+    // equal division, each point moved to the next plausible item start
+    std::vector<std::size_t> bounds(nChunks + 1);
+    bounds[0]       = 0;
+    bounds[nChunks] = total;
+    for (std::size_t k=1; k<nChunks; ++k) {
+        std::size_t nominal = (total/nChunks)*k;
+        bounds[k] = findBoundary(beg, end, std::max(nominal, bounds[k-1]));
+    }
+
+    // walk every chunk to see where its last item really ends
+    std::vector<std::future<Walk> > futures;
+    for (std::size_t k=0; k<nChunks; ++k) {
+        futures.push_back(std::async(std::launch::async,
+                                     &CChunkSplitter::walk, this,
+                                     beg, end, bounds[k], bounds[k+1]));
+    }
+    std::vector<Walk> walks;
+    for (auto& future : futures) {
+        walks.push_back(future.get());
+    }
+
+    // Chunk 0 starts at a true item start, so its walk is exact. The end of
+    // each exact walk is the exact start of the next chunk. A walk that began
+    // somewhere else is still good if it passed through that start; otherwise
+    // it is redone.
+    for (std::size_t k=0; k<nChunks; ++k) {
+        if ((walks[k].s_from != bounds[k]) && !walks[k].passedThrough(bounds[k])) {
+            walks[k] = walk(beg, end, bounds[k], std::max(bounds[k], bounds[k+1]));
+        }
+        if (!walks[k].s_ok) {
+            throw std::runtime_error("DAQ::CChunkSplitter::split() implausible item header at offset "
+                                     + std::to_string(walks[k].s_landing) + ".");
+        }
+        bounds[k+1] = std::max(walks[k].s_landing, bounds[k]);
+    }
+
+    std::vector<Chunk> chunks;
+    for (std::size_t k=0; k<nChunks; ++k) {
+        if (bounds[k] != bounds[k+1]) {
+            chunks.push_back({bounds[k], bounds[k+1]});
+        }
+    }
+    return chunks;
+}
+
+
+//
+std::size_t CChunkSplitter::findBoundary(const std::uint8_t* beg, const std::uint8_t* end,
+                                         std::size_t from) const
+{
+    std::size_t total = end - beg;
+    for (std::size_t offset=from; offset < total; ++offset) {
+        if (isChainStart(beg + offset, end)) {
+            return offset;
+        }
+    }
+    return total;
+}
+
+
+/*!
+ * \brief Check the size and type of the header at pos
+ *
+ * \param swap  set to whether the header is in foreign byte order
+ * \param size  set to the item size
+ */
+bool CChunkSplitter::isPlausibleHeader(const std::uint8_t* pos, const std::uint8_t* end,
+                                       bool& swap, std::uint32_t& size) const
+{
+    std::size_t available = end - pos;
+    if (available < HeaderSize) {
+        return false;
+    }
+
+    std::uint32_t type;
+    V12::Parser::parseSizeAndType(pos, pos + 2*sizeof(std::uint32_t), size, type, swap);
+
+    return (size >= HeaderSize) && (size <= m_maxItemSize) && (size <= available)
+            && V12::Parser::isKnownType(type);
+}
+
+
+/*!
+ * \brief Whether m_nConfirm plausible headers are chained from pos
+ *
+ * A shorter chain that ends exactly at the end of the data is accepted too.
+ */
+bool CChunkSplitter::isChainStart(const std::uint8_t* pos, const std::uint8_t* end) const
+{
+    bool firstSwap = false;
+    for (std::size_t i=0; i<m_nConfirm; ++i) {
+        if (pos == end) {
+            return true;
+        }
+
+        bool swap;
+        std::uint32_t size;
+        if (!isPlausibleHeader(pos, end, swap, size)) {
+            return false;
+        }
+        if (i == 0) {
+            firstSwap = swap;
+        } else if (swap != firstSwap) {
+            return false;
+        }
+        pos += size;
+    }
+    return true;
+}
+
+
+/*!
+ * \brief Hop from header to header starting at from until reaching limit
+ *
+ * Only the sizes are checked here; a walk from a true item start must accept
+ * any item type.
+ */
+CChunkSplitter::Walk
+CChunkSplitter::walk(const std::uint8_t* beg, const std::uint8_t* end,
+                     std::size_t from, std::size_t limit) const
+{
+    Walk result;
+    result.s_from = from;
+    result.s_ok   = true;
+
+    std::size_t total = end - beg;
+    std::size_t pos = from;
+    while (pos < limit) {
+        if (result.s_visited.size() < MaxVisited) {
+            result.s_visited.push_back(pos);
+        }
+
+        if (total - pos < HeaderSize) {
+            result.s_ok = false;
+            break;
+        }
+
+        std::uint32_t size, type;
+        bool swap;
+        V12::Parser::parseSizeAndType(beg + pos, beg + pos + 2*sizeof(std::uint32_t),
+                                      size, type, swap);
+        if ((size < HeaderSize) || (size > total - pos)) {
+            result.s_ok = false;
+            break;
+        }
+        pos += size;
+    }
+
+    result.s_landing = pos;
+    return result;
+}
+
+} // end DAQ
@@ -0,0 +1,121 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CCHUNKSPLITTER_H
+#define DAQ_CCHUNKSPLITTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace DAQ {
+
+/*!
+ * \brief Divides V12 data into chunks that begin and end on item boundaries
+ *
+ * V12 data has no sync markers, so a worker handed an arbitrary byte offset
+ * does not know where the next item starts. The splitter first divides the
+ * data into equal byte ranges and moves each split point forward to the next
+ * offset that looks like an item start:
+ *
+ *  - the size is at least a header and at most the maximum item size,
+ *  - the type (without the composite bit) is a known V12 type or a user type,
+ *  - and the same holds for the next few items found by hopping from header
+ *    to header, all in the same byte order, without running past the data.
+ *
+ * An offset can pass those tests and still not be a top level item: children
+ * of composite items are items too. So each chunk is then walked from header
+ * to header, in parallel, up to the start of the next chunk. A walk that lands
+ * past the next split point shows that the split point was inside an item,
+ * and it is moved to where the walk landed. The first chunk starts at offset
+ * 0, so the corrections make every boundary exact.
+ *
+ * Walking reads only the item headers, which is a small fraction of the work
+ * of processing the items.
+ *
+ * \code
+ * std::vector<std::uint8_t> data = ...;   // or a memory mapped file
+ *
+ * CChunkSplitter splitter;
+ * auto chunks = splitter.split(data.data(), data.data() + data.size(), 8);
+ * for (auto& chunk : chunks) {
+ *     // hand data.data() + chunk.s_begin ... data.data() + chunk.s_end to a worker
+ * }
+ * \endcode
+ */
+class CChunkSplitter
+{
+public:
+    /*! \brief A range of byte offsets [s_begin, s_end) */
+    struct Chunk {
+        std::size_t s_begin;
+        std::size_t s_end;
+    };
+
+private:
+    std::size_t   m_nConfirm;
+    std::uint32_t m_maxItemSize;
+
+public:
+    /*!
+     * \param nConfirm     the number of consecutive plausible headers needed to
+     *                     accept a split point (fewer if the data ends first)
+     * \param maxItemSize  the largest item size considered plausible
+     */
+    explicit CChunkSplitter(std::size_t nConfirm = 4,
+                            std::uint32_t maxItemSize = 64*1024*1024);
+
+    /*!
+     * \brief Split the data into at most nChunks chunks
+     *
+     * The chunks are contiguous, cover all of the data and are in order. Empty
+     * chunks are omitted, so fewer than nChunks may be returned.
+     *
+     * \param beg      the first byte of the data, which must be an item start
+     * \param end      one past the last byte, which must end an item
+     * \param nChunks  the desired number of chunks
+     *
+     * \throws std::invalid_argument if nChunks is 0
+     * \throws std::runtime_error if a walk from a known item start meets an
+     *                            implausible header
+     */
+    std::vector<Chunk> split(const std::uint8_t* beg, const std::uint8_t* end,
+                             std::size_t nChunks) const;
+
+    /*!
+     * \brief Find the first plausible item start at or after an offset
+     *
+     * \return the offset, or end - beg if there is none
+     */
+    std::size_t findBoundary(const std::uint8_t* beg, const std::uint8_t* end,
+                             std::size_t from) const;
+
+    std::size_t getConfirmCount() const { return m_nConfirm; }
+    std::uint32_t getMaxItemSize() const { return m_maxItemSize; }
+
+private:
+    struct Walk;
+
+    bool isPlausibleHeader(const std::uint8_t* pos, const std::uint8_t* end,
+                           bool& swap, std::uint32_t& size) const;
+    bool isChainStart(const std::uint8_t* pos, const std::uint8_t* end) const;
+    Walk walk(const std::uint8_t* beg, const std::uint8_t* end,
+              std::size_t from, std::size_t limit) const;
+};
+
+} // end DAQ
+
+#endif // DAQ_CCHUNKSPLITTER_H
@@ -0,0 +1,467 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CCompressedFile.h"
+
+#include <V12/DataFormat.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CRingItemParser.h>
+
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+#include <zlib.h>
+
+namespace DAQ {
+
+static const char          FileMagic[8]   = {'N','S','C','L','Z','V','1','2'};
+static const char          FooterMagic[8] = {'N','S','C','L','Z','I','D','X'};
+static const std::uint32_t FormatVersion  = 1;
+
+static const std::size_t FileHeaderSize  = sizeof(FileMagic) + 2*sizeof(std::uint32_t);
+static const std::size_t BlockHeaderSize = 4*sizeof(std::uint32_t);
+static const std::size_t IndexEntrySize  = 2*sizeof(std::uint64_t) + BlockHeaderSize;
+static const std::size_t FooterSize      = 2*sizeof(std::uint64_t) + sizeof(FooterMagic);
+static const std::size_t ItemHeaderSize  = sizeof(V12::RingItemHeader);
+
+// deflate cannot expand data by more than this factor, so a block that claims
+// more has a corrupt header
+static const std::uint64_t MaxDeflateRatio = 1032;
+
+
+template<class T>
+static std::uint8_t* put(std::uint8_t* pos, T value)
+{
+    std::memcpy(pos, &value, sizeof(value));
+    return pos + sizeof(value);
+}
+
+template<class T>
+static const std::uint8_t* get(const std::uint8_t* pos, T& value)
+{
+    std::memcpy(&value, pos, sizeof(value));
+    return pos + sizeof(value);
+}
+
+static std::uint8_t* putBlockHeader(std::uint8_t* pos, const CompressedBlockInfo& info)
+{
+    pos = put(pos, info.s_compressedSize);
+    pos = put(pos, info.s_uncompressedSize);
+    pos = put(pos, info.s_itemCount);
+    return put(pos, info.s_checksum);
+}
+
+static const std::uint8_t* getBlockHeader(const std::uint8_t* pos, CompressedBlockInfo& info)
+{
+    pos = get(pos, info.s_compressedSize);
+    pos = get(pos, info.s_uncompressedSize);
+    pos = get(pos, info.s_itemCount);
+    return get(pos, info.s_checksum);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CCompressedWriter
+
+//
+CCompressedWriter::CCompressedWriter(std::ostream& stream, std::size_t blockSize, int level)
+    : m_stream(stream),
+      m_blockSize(blockSize),
+      m_level(level),
+      m_pending(),
+      m_nPending(0),
+      m_nItems(0),
+      m_offset(FileHeaderSize),
+      m_index(),
+      m_closed(false)
+{
+    if (blockSize == 0 || blockSize > 0xffffffff) {
+        throw std::invalid_argument("DAQ::CCompressedWriter::CCompressedWriter() block size must be nonzero and fit in 32 bits.");
+    }
+    if (level < -1 || level > 9) {
+        throw std::invalid_argument("DAQ::CCompressedWriter::CCompressedWriter() compression level must be -1 or in the range 0-9.");
+    }
+
+    std::uint8_t header[FileHeaderSize];
+    std::memcpy(header, FileMagic, sizeof(FileMagic));
+    auto pos = put(header + sizeof(FileMagic), FormatVersion);
+    put(pos, std::uint32_t(0));
+    m_stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+}
+
+
+//
+CCompressedWriter::~CCompressedWriter()
+{
+    try {
+        close();
+    } catch (...) {
+        // nothing can be reported from a destructor
+    }
+}
+
+
+//
+void CCompressedWriter::write(const V12::CRawRingItem& item)
+{
+    if (m_closed) {
+        throw std::logic_error("DAQ::CCompressedWriter::write() writer has been closed.");
+    }
+
+    // a block always holds whole items
+    std::size_t size = item.size();
+    if (!m_pending.empty() && (m_pending.size() + size > m_blockSize)) {
+        flushBlock();
+    }
+
+    std::size_t start = m_pending.size();
+    m_pending.resize(start + ItemHeaderSize);
+    V12::serializeHeader(item, m_pending.begin() + start);
+    m_pending.insert(m_pending.end(), item.getBody().begin(), item.getBody().end());
+    ++m_nPending;
+
+    if (m_pending.size() >= m_blockSize) {
+        flushBlock();
+    }
+}
+
+
+//
+void CCompressedWriter::write(const V12::CRingItem& item)
+{
+    auto pRawItem = dynamic_cast<const V12::CRawRingItem*>(&item);
+
+    if (pRawItem) {
+        write(*pRawItem);
+    } else {
+        write(V12::CRawRingItem(item));
+    }
+}
+
+
+//
+void CCompressedWriter::close()
+{
+    if (m_closed) {
+        return;
+    }
+    m_closed = true;
+
+    flushBlock();
+
+    std::uint64_t indexOffset = m_offset + BlockHeaderSize;
+    Buffer::ByteBuffer trailer(BlockHeaderSize + m_index.size()*IndexEntrySize + FooterSize);
+
+    // end marker
+    auto pos = putBlockHeader(trailer.data(), CompressedBlockInfo{0, 0, 0, 0, 0, 0});
+
+    for (auto& info : m_index) {
+        pos = put(pos, info.s_offset);
+        pos = put(pos, info.s_firstItem);
+        pos = putBlockHeader(pos, info);
+    }
+
+    pos = put(pos, indexOffset);
+    pos = put(pos, std::uint64_t(m_index.size()));
+    std::memcpy(pos, FooterMagic, sizeof(FooterMagic));
+
+    m_stream.write(reinterpret_cast<const char*>(trailer.data()), trailer.size());
+    m_stream.flush();
+}
+
+
+/*!
+ * \brief Compress and write the items gathered so far
+ */
+void CCompressedWriter::flushBlock()
+{
+    if (m_pending.empty()) {
+        return;
+    }
+
+    uLongf compressedSize = compressBound(m_pending.size());
+    Buffer::ByteBuffer block(BlockHeaderSize + compressedSize);
+    int status = compress2(block.data() + BlockHeaderSize, &compressedSize,
+                           m_pending.data(), m_pending.size(), m_level);
+    if (status != Z_OK) {
+        throw std::runtime_error("DAQ::CCompressedWriter::flushBlock() compression failed : "
+                                 + std::string(zError(status)));
+    }
+
+    CompressedBlockInfo info;
+    info.s_offset           = m_offset;
+    info.s_firstItem        = m_nItems;
+    info.s_compressedSize   = compressedSize;
+    info.s_uncompressedSize = m_pending.size();
+    info.s_itemCount        = m_nPending;
+    info.s_checksum         = crc32(0, m_pending.data(), m_pending.size());
+    putBlockHeader(block.data(), info);
+
+    m_stream.write(reinterpret_cast<const char*>(block.data()), BlockHeaderSize + compressedSize);
+
+    m_index.push_back(info);
+    m_offset += BlockHeaderSize + compressedSize;
+    m_nItems += m_nPending;
+    m_nPending = 0;
+    m_pending.clear();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CCompressedReader
+
+//
+CCompressedReader::CCompressedReader(std::istream& stream)
+    : m_stream(stream),
+      m_start(0),
+      m_index(),
+      m_hasIndex(false),
+      m_compressed(),
+      m_block(),
+      m_pos(0),
+      m_done(false),
+      m_eof(false)
+{
+    std::streamoff start = m_stream.tellg();
+
+    std::uint8_t header[FileHeaderSize] = {};
+    m_stream.read(reinterpret_cast<char*>(header), sizeof(header));
+    std::uint32_t version;
+    get(header + sizeof(FileMagic), version);
+    if (!m_stream || std::memcmp(header, FileMagic, sizeof(FileMagic)) != 0) {
+        throw std::runtime_error("DAQ::CCompressedReader::CCompressedReader() stream is not a compressed container.");
+    }
+    if (version != FormatVersion) {
+        throw std::runtime_error("DAQ::CCompressedReader::CCompressedReader() unsupported container version "
+                                 + std::to_string(version) + ".");
+    }
+
+    if (start >= 0) {
+        m_start = start;
+        loadIndex();
+    } else {
+        m_stream.clear();
+    }
+}
+
+
+//
+bool CCompressedReader::read(V12::CRawRingItem& item)
+{
+    while (m_pos == m_block.size()) {
+        if (!nextBlock()) {
+            m_eof = true;
+            return false;
+        }
+    }
+
+    std::uint32_t size, type, sourceId;
+    std::uint64_t tstamp;
+    bool swapNeeded;
+    std::size_t available = m_block.size() - m_pos;
+    const std::uint8_t* pItem = m_block.data() + m_pos;
+    if (available < ItemHeaderSize) {
+        throw std::runtime_error("DAQ::CCompressedReader::read() block ends in the middle of an item header.");
+    }
+    V12::Parser::parseHeader(pItem, pItem + ItemHeaderSize, size, type, tstamp, sourceId, swapNeeded);
+    if (size < ItemHeaderSize || size > available) {
+        throw std::runtime_error("DAQ::CCompressedReader::read() item does not fit in its block.");
+    }
+
+    item.setType(type);
+    item.setEventTimestamp(tstamp);
+    item.setSourceId(sourceId);
+    item.setMustSwap(swapNeeded);
+    item.getBody().assign(pItem + ItemHeaderSize, pItem + size);
+
+    m_pos += size;
+    return true;
+}
+
+
+//
+void CCompressedReader::seekBlock(std::size_t index)
+{
+    if (!m_hasIndex) {
+        throw std::runtime_error("DAQ::CCompressedReader::seekBlock() container has no block index.");
+    }
+    if (index > m_index.size()) {
+        throw std::out_of_range("DAQ::CCompressedReader::seekBlock() block index out of range.");
+    }
+
+    m_block.clear();
+    m_pos  = 0;
+    m_done = (index == m_index.size());
+    m_eof  = false;
+    if (!m_done) {
+        m_stream.clear();
+        m_stream.seekg(m_start + m_index[index].s_offset);
+    }
+}
+
+
+//
+void CCompressedReader::readRawBlock(std::size_t index, Buffer::ByteBuffer& compressed)
+{
+    if (!m_hasIndex) {
+        throw std::runtime_error("DAQ::CCompressedReader::readRawBlock() container has no block index.");
+    }
+    if (index >= m_index.size()) {
+        throw std::out_of_range("DAQ::CCompressedReader::readRawBlock() block index out of range.");
+    }
+
+    auto& info = m_index[index];
+    compressed.resize(info.s_compressedSize);
+    m_stream.clear();
+    m_stream.seekg(m_start + info.s_offset + BlockHeaderSize);
+    m_stream.read(reinterpret_cast<char*>(compressed.data()), compressed.size());
+    if (!m_stream) {
+        throw std::runtime_error("DAQ::CCompressedReader::readRawBlock() block is truncated.");
+    }
+}
+
+
+//
+void CCompressedReader::decompressBlock(const CompressedBlockInfo& info,
+                                        const Buffer::ByteBuffer& compressed,
+                                        Buffer::ByteBuffer& items)
+{
+    if (info.s_uncompressedSize > MaxDeflateRatio*compressed.size()) {
+        throw std::runtime_error("DAQ::CCompressedReader::decompressBlock() block is corrupted.");
+    }
+
+    items.resize(info.s_uncompressedSize);
+    uLongf size = items.size();
+    int status = uncompress(items.data(), &size, compressed.data(), compressed.size());
+    if (status != Z_OK || size != info.s_uncompressedSize) {
+        throw std::runtime_error("DAQ::CCompressedReader::decompressBlock() block is corrupted.");
+    }
+    if (crc32(0, items.data(), items.size()) != info.s_checksum) {
+        throw std::runtime_error("DAQ::CCompressedReader::decompressBlock() block checksum mismatch.");
+    }
+}
+
+
+/*!
+ * \brief Read the block index from the end of the container
+ *
+ * A container without a valid footer (for example one whose writer was
+ * never closed) is still readable in order.
+ */
+void CCompressedReader::loadIndex()
+{
+    std::streamoff dataStart = m_stream.tellg();
+
+    std::uint8_t footer[FooterSize] = {};
+    m_stream.seekg(0, std::ios::end);
+    std::streamoff end = m_stream.tellg();
+    if (end >= std::streamoff(m_start + FileHeaderSize + BlockHeaderSize + FooterSize)) {
+        m_stream.seekg(end - std::streamoff(FooterSize));
+        m_stream.read(reinterpret_cast<char*>(footer), sizeof(footer));
+    }
+
+    std::uint64_t indexOffset, nBlocks;
+    auto pos = get(footer, indexOffset);
+    get(pos, nBlocks);
+    std::uint64_t indexEnd = indexOffset + nBlocks*IndexEntrySize;
+
+    if (m_stream && std::memcmp(footer + 2*sizeof(std::uint64_t), FooterMagic, sizeof(FooterMagic)) == 0
+            && (m_start + indexEnd + FooterSize == std::uint64_t(end))) {
+        Buffer::ByteBuffer entries(nBlocks*IndexEntrySize);
+        m_stream.seekg(m_start + indexOffset);
+        m_stream.read(reinterpret_cast<char*>(entries.data()), entries.size());
+
+        const std::uint8_t* pEntry = entries.data();
+        for (std::uint64_t i=0; m_stream && i<nBlocks; ++i) {
+            CompressedBlockInfo info;
+            pEntry = get(pEntry, info.s_offset);
+            pEntry = get(pEntry, info.s_firstItem);
+            pEntry = getBlockHeader(pEntry, info);
+            m_index.push_back(info);
+        }
+        m_hasIndex = bool(m_stream);
+        if (!m_hasIndex) {
+            m_index.clear();
+        }
+    }
+
+    m_stream.clear();
+    m_stream.seekg(dataStart);
+}
+
+
+/*!
+ * \brief Read and decompress the next block into m_block
+ *
+ * \return false at the end marker, or at the end of the stream if a block
+ *         header was not begun
+ */
+bool CCompressedReader::nextBlock()
+{
+    if (m_done) {
+        return false;
+    }
+
+    std::uint8_t header[BlockHeaderSize];
+    m_stream.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (m_stream.gcount() == 0) {
+        m_done = true;      // the writer was not closed
+        return false;
+    }
+    if (!m_stream) {
+        throw std::runtime_error("DAQ::CCompressedReader::read() block header is truncated.");
+    }
+
+    CompressedBlockInfo info;
+    getBlockHeader(header, info);
+    if (info.s_compressedSize == 0) {
+        m_done = true;
+        return false;
+    }
+
+    m_compressed.resize(info.s_compressedSize);
+    m_stream.read(reinterpret_cast<char*>(m_compressed.data()), m_compressed.size());
+    if (!m_stream) {
+        throw std::runtime_error("DAQ::CCompressedReader::read() block is truncated.");
+    }
+
+    decompressBlock(info, m_compressed, m_block);
+    m_pos = 0;
+    return true;
+}
+
+} // end DAQ
+
+
+//
+DAQ::CCompressedWriter& operator<<(DAQ::CCompressedWriter& writer,
+                                   const DAQ::V12::CRingItem& item)
+{
+    writer.write(item);
+    return writer;
+}
+
+
+//
+DAQ::CCompressedReader& operator>>(DAQ::CCompressedReader& reader,
+                                   DAQ::V12::CRawRingItem& item)
+{
+    reader.read(item);
+    return reader;
+}
@@ -0,0 +1,237 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CCOMPRESSEDFILE_H
+#define DAQ_CCOMPRESSEDFILE_H
+
+#include <ByteBuffer.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+/*
+ * A compressed container holds V12 items in independently compressed blocks.
+ * Every block holds whole items. All fields are in the byte order of the
+ * writer.
+ *
+ *   file header   "NSCLZV12", u32 version, u32 reserved
+ *   block         u32 compressed size, u32 uncompressed size,
+ *                 u32 item count, u32 crc32 of the uncompressed data,
+ *                 then the zlib compressed items
+ *   ...
+ *   end marker    a block header of zeroes
+ *   block index   per block: u64 offset, u64 first item, then the four
+ *                 fields of the block header
+ *   footer        u64 offset of the block index, u64 block count, "NSCLZIDX"
+ *
+ * Offsets are relative to the start of the file header. A reader of a stream
+ * that cannot seek reads blocks up to the end marker and ignores the rest.
+ */
+
+namespace DAQ {
+
+namespace V12 {
+    class CRingItem;
+    class CRawRingItem;
+}
+
+/*! \brief Where a block of a compressed container is and what it holds */
+struct CompressedBlockInfo {
+    std::uint64_t s_offset;            // of the block header
+    std::uint64_t s_firstItem;         // index of the first item in the container
+    std::uint32_t s_compressedSize;
+    std::uint32_t s_uncompressedSize;
+    std::uint32_t s_itemCount;
+    std::uint32_t s_checksum;          // crc32 of the uncompressed data
+};
+
+
+/*!
+ * \brief Writes V12 items into a compressed container
+ *
+ * Items are gathered until a block holds at least the block size, and the
+ * block is then compressed and written. An item larger than the block size
+ * gets a block of its own. close() writes the last block and the block index;
+ * the destructor calls it if it has not been called.
+ *
+ * \code
+ * std::ofstream file("run-0012-00.evtz", std::ios::binary);
+ * CCompressedWriter writer(file);
+ * writer << item1 << item2;
+ * writer.close();
+ * \endcode
+ */
+class CCompressedWriter
+{
+    std::ostream&                     m_stream;
+    std::size_t                       m_blockSize;
+    int                               m_level;
+    Buffer::ByteBuffer                m_pending;     // items of the open block
+    std::uint32_t                     m_nPending;
+    std::uint64_t                     m_nItems;      // items in written blocks
+    std::uint64_t                     m_offset;      // of the next block
+    std::vector<CompressedBlockInfo>  m_index;
+    bool                              m_closed;
+
+public:
+    /*!
+     * \param stream     the stream to write to, positioned where the container
+     *                   begins
+     * \param blockSize  the number of uncompressed bytes gathered per block
+     * \param level      the zlib compression level, 0-9 or -1 for the default
+     *
+     * \throws std::invalid_argument if blockSize is 0 or level is out of range
+     */
+    explicit CCompressedWriter(std::ostream& stream,
+                               std::size_t blockSize = 1024*1024,
+                               int level = -1);
+    ~CCompressedWriter();
+
+    CCompressedWriter(const CCompressedWriter&) = delete;
+    CCompressedWriter& operator=(const CCompressedWriter&) = delete;
+
+    /*!
+     * \throws std::logic_error if the writer has been closed
+     */
+    void write(const V12::CRawRingItem& item);
+    void write(const V12::CRingItem& item);
+
+    /*!
+     * \brief Write the open block, the end marker and the block index
+     *
+     * Calling close() more than once has no further effect.
+     */
+    void close();
+
+    const std::vector<CompressedBlockInfo>& getIndex() const { return m_index; }
+
+private:
+    void flushBlock();
+};
+
+
+/*!
+ * \brief Reads V12 items from a compressed container
+ *
+ * Items can be read in order with read(). If the stream can seek, the block
+ * index is loaded when the reader is constructed, and seekBlock() moves to
+ * the start of any block.
+ *
+ * Blocks can also be decompressed independently, for example by a pool of
+ * threads: readRawBlock() fetches the compressed bytes of a block and the
+ * static decompressBlock() turns them into the item sequence of the block.
+ *
+ * \code
+ * std::ifstream file("run-0012-00.evtz", std::ios::binary);
+ * CCompressedReader reader(file);
+ * V12::CRawRingItem item;
+ * while (reader.read(item)) {
+ *     ...
+ * }
+ * \endcode
+ */
+class CCompressedReader
+{
+    std::istream&                     m_stream;
+    std::uint64_t                     m_start;       // stream position of the file header
+    std::vector<CompressedBlockInfo>  m_index;
+    bool                              m_hasIndex;
+    Buffer::ByteBuffer                m_compressed;
+    Buffer::ByteBuffer                m_block;       // items of the current block
+    std::size_t                       m_pos;         // next item in m_block
+    bool                              m_done;        // the end marker was read
+    bool                              m_eof;
+
+public:
+    /*!
+     * \throws std::runtime_error if the stream does not begin with a
+     *                            compressed container header
+     */
+    explicit CCompressedReader(std::istream& stream);
+
+    /*!
+     * \brief Read the next item
+     *
+     * \return false after the last item
+     *
+     * \throws std::runtime_error if a block is truncated or corrupted
+     */
+    bool read(V12::CRawRingItem& item);
+
+    /*! \return whether a read has found no more items, like std::istream::eof() */
+    bool eof() const { return m_eof; }
+
+    /*! \return whether the block index was loaded */
+    bool hasIndex() const { return m_hasIndex; }
+    std::size_t getBlockCount() const { return m_index.size(); }
+    const std::vector<CompressedBlockInfo>& getIndex() const { return m_index; }
+
+    /*!
+     * \brief Continue reading at the first item of a block
+     *
+     * Seeking to the block count positions the reader at the end.
+     *
+     * \throws std::runtime_error if there is no block index
+     * \throws std::out_of_range if index is greater than the block count
+     */
+    void seekBlock(std::size_t index);
+
+    /*!
+     * \brief Read the compressed bytes of a block
+     *
+     * This moves the stream; call seekBlock() before reading items again.
+     *
+     * \throws std::runtime_error if there is no block index
+     * \throws std::out_of_range if there is no such block
+     */
+    void readRawBlock(std::size_t index, Buffer::ByteBuffer& compressed);
+
+    /*!
+     * \brief Decompress a block and verify its checksum
+     *
+     * This does not touch any reader, so it may be called from any thread.
+     *
+     * \throws std::runtime_error if the data does not match info
+     */
+    static void decompressBlock(const CompressedBlockInfo& info,
+                                const Buffer::ByteBuffer& compressed,
+                                Buffer::ByteBuffer& items);
+
+private:
+    void loadIndex();
+    bool nextBlock();
+};
+
+} // end DAQ
+
+
+/*!
+ * \brief Insert V12 items into a compressed container
+ */
+extern DAQ::CCompressedWriter& operator<<(DAQ::CCompressedWriter& writer,
+                                          const DAQ::V12::CRingItem& item);
+
+/*!
+ * \brief Extract a V12 item from a compressed container
+ *
+ * If there are no more items, the item is unchanged and reader.eof() is true.
+ */
+extern DAQ::CCompressedReader& operator>>(DAQ::CCompressedReader& reader,
+                                          DAQ::V12::CRawRingItem& item);
+
+#endif // DAQ_CCOMPRESSEDFILE_H
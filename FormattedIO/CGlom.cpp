@@ -0,0 +1,228 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CGlom.h"
+
+#include <V12/CRawRingItem.h>
+#include <V12/CRingItemParser.h>
+#include <V12/DataFormat.h>
+
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace DAQ {
+
+static const std::size_t HeaderSize = 20;
+
+// write a native header at the start of the buffer
+static void writeHeader(std::uint8_t* pos, std::uint32_t size, std::uint32_t type,
+                        std::uint64_t tstamp, std::uint32_t sourceId)
+{
+    std::memcpy(pos,    &size,     sizeof(size));
+    std::memcpy(pos+4,  &type,     sizeof(type));
+    std::memcpy(pos+8,  &tstamp,   sizeof(tstamp));
+    std::memcpy(pos+16, &sourceId, sizeof(sourceId));
+}
+
+//
+CGlom::CGlom(const V12::CGlomParameters& params, Sink sink, std::uint32_t sourceId)
+    : m_params(params),
+      m_sourceId(sourceId),
+      m_sink(std::move(sink)),
+      m_event(),
+      m_input(),
+      m_firstTimestamp(0),
+      m_lastTimestamp(0),
+      m_sumOfOffsets(0),
+      m_nFragments(0),
+      m_parametersEmitted(false),
+      m_nEvents(0),
+      m_nFragmentsTotal(0)
+{
+    m_event.reserve(8192);
+    m_event.resize(HeaderSize);
+}
+
+//
+CGlom::CGlom(const V12::CGlomParameters& params, std::ostream& output,
+             std::uint32_t sourceId)
+    : CGlom(params,
+            [&output](const std::uint8_t* beg, const std::uint8_t* end) {
+                output.write(reinterpret_cast<const char*>(beg), end-beg);
+            },
+            sourceId)
+{}
+
+//
+void CGlom::addItem(const std::uint8_t* beg, const std::uint8_t* end)
+{
+    if (!m_parametersEmitted) {
+        emitParameters();
+    }
+
+    std::uint32_t size, type, sourceId;
+    std::uint64_t tstamp;
+    bool swap;
+    V12::Parser::parseHeader(beg, end, size, type, tstamp, sourceId, swap);
+
+    if (size != std::size_t(end - beg)) {
+        std::string errmsg("DAQ::CGlom::addItem() item size (");
+        errmsg += std::to_string(size) + ") does not match the data provided (";
+        errmsg += std::to_string(end - beg) + ")";
+        throw std::runtime_error(errmsg);
+    }
+
+    if ((type != V12::PHYSICS_EVENT) || !m_params.isBuilding()
+        || (tstamp == V12::NULL_TIMESTAMP)) {
+        flush();
+        passThrough(beg, end);
+        return;
+    }
+
+    if ((m_nFragments > 0)
+        && (tstamp - m_firstTimestamp > m_params.coincidenceTicks())) {
+        flush();
+    }
+
+    appendFragment(beg, end, tstamp);
+}
+
+//
+void CGlom::addItem(const V12::CRawRingItem& item)
+{
+    // assemble the item contiguously in a reused buffer
+    auto& body = item.getBody();
+    m_input.resize(HeaderSize + body.size());
+    V12::serializeHeader(item, m_input.begin());
+    std::copy(body.begin(), body.end(), m_input.begin() + HeaderSize);
+
+    addItem(m_input.data(), m_input.data() + m_input.size());
+}
+
+//
+std::size_t CGlom::process(std::istream& input)
+{
+    std::size_t nItems = 0;
+    std::uint8_t header[HeaderSize];
+
+    while (input.read(reinterpret_cast<char*>(header), HeaderSize)) {
+        std::uint32_t size, type;
+        bool swap;
+        V12::Parser::parseSizeAndType(header, header+HeaderSize, size, type, swap);
+        if (size < HeaderSize) {
+            throw std::runtime_error("DAQ::CGlom::process() Encountered item with fewer than 20 bytes in size field.");
+        }
+
+        m_input.resize(size);
+        std::memcpy(m_input.data(), header, HeaderSize);
+        input.read(reinterpret_cast<char*>(m_input.data()) + HeaderSize, size - HeaderSize);
+        if (!input) {
+            throw std::runtime_error("DAQ::CGlom::process() stream ended with an incomplete item");
+        }
+
+        addItem(m_input.data(), m_input.data() + size);
+        ++nItems;
+    }
+
+    if (input.gcount() != 0) {
+        throw std::runtime_error("DAQ::CGlom::process() stream ended with an incomplete item");
+    }
+
+    return nItems;
+}
+
+//
+void CGlom::flush()
+{
+    if (!m_parametersEmitted) {
+        emitParameters();
+    }
+
+    if (m_nFragments == 0) {
+        return;
+    }
+
+    writeHeader(m_event.data(), m_event.size(), V12::COMP_PHYSICS_EVENT,
+                computeTimestamp(), m_sourceId);
+    m_sink(m_event.data(), m_event.data() + m_event.size());
+
+    // resize does not release capacity, so the buffer is reused
+    m_event.resize(HeaderSize);
+    m_nFragments   = 0;
+    m_sumOfOffsets = 0;
+    ++m_nEvents;
+}
+
+//
+void CGlom::emitParameters()
+{
+    m_parametersEmitted = true;
+
+    V12::CGlomParameters params(m_params);
+    params.setSourceId(m_sourceId);
+    params.setEventTimestamp(V12::NULL_TIMESTAMP);
+
+    V12::CRawRingItem item(params);
+    auto& body = item.getBody();
+
+    Buffer::ByteBuffer data(HeaderSize);
+    V12::serializeHeader(item, data.begin());
+    data.insert(data.end(), body.begin(), body.end());
+
+    m_sink(data.data(), data.data() + data.size());
+}
+
+//
+void CGlom::appendFragment(const std::uint8_t* beg, const std::uint8_t* end,
+                           std::uint64_t tstamp)
+{
+    if (m_nFragments == 0) {
+        m_firstTimestamp = tstamp;
+    }
+    m_lastTimestamp = tstamp;
+    m_sumOfOffsets += tstamp - m_firstTimestamp;
+
+    m_event.insert(m_event.end(), beg, end);
+
+    ++m_nFragments;
+    ++m_nFragmentsTotal;
+}
+
+//
+void CGlom::passThrough(const std::uint8_t* beg, const std::uint8_t* end)
+{
+    m_sink(beg, end);
+}
+
+//
+std::uint64_t CGlom::computeTimestamp() const
+{
+    switch (m_params.timestampPolicy()) {
+    case V12::CGlomParameters::first:
+        return m_firstTimestamp;
+    case V12::CGlomParameters::last:
+        return m_lastTimestamp;
+    case V12::CGlomParameters::average:
+        // averaging the offsets from the first timestamp avoids overflow
+        return m_firstTimestamp + m_sumOfOffsets/m_nFragments;
+    }
+    return m_firstTimestamp;
+}
+
+} // end DAQ
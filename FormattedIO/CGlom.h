@@ -0,0 +1,146 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CGLOM_H
+#define DAQ_CGLOM_H
+
+#include <V12/CGlomParameters.h>
+#include <ByteBuffer.h>
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+
+namespace DAQ {
+
+namespace V12 {
+    class CRawRingItem;
+}
+
+/*!
+ * \brief Event builder glom stage
+ *
+ * CGlom consumes a time ordered stream of V12 leaf items and groups physics
+ * event fragments whose timestamps lie within a coincidence window of the
+ * first fragment of the event. Each group is emitted as a COMP_PHYSICS_EVENT
+ * composite item whose children are the fragments in their original wire
+ * format. The timestamp of the composite follows the timestamp policy of the
+ * glom parameters (first, last, or average of the fragment timestamps).
+ *
+ * The composite is assembled directly in wire format in a single reusable
+ * buffer, so steady state operation performs no heap allocation per fragment
+ * or per event. The emitted bytes are handed to a sink function and are only
+ * valid for the duration of the call.
+ *
+ * Other items are handled as follows:
+ *
+ * - Non physics items (state changes, scalers, etc.) close the event being
+ *   built and are then passed through unchanged.
+ * - Physics fragments with a NULL_TIMESTAMP cannot be correlated. They close
+ *   the event being built and are passed through unchanged.
+ * - Items that are already composites are passed through unchanged.
+ * - If the glom parameters say that building is disabled, every physics
+ *   fragment is passed through unchanged.
+ *
+ * An EVB_GLOM_INFO item describing the parameters is emitted before anything
+ * else.
+ *
+ * \code
+ * V12::CGlomParameters params(100, true, V12::CGlomParameters::average);
+ * CGlom glom(params, output);  // output is a std::ostream
+ *
+ * glom.process(input);         // input is a time ordered std::istream
+ * glom.flush();
+ * \endcode
+ */
+class CGlom
+{
+public:
+    /*! Receives each complete output item in wire format */
+    typedef std::function<void (const std::uint8_t* beg, const std::uint8_t* end)> Sink;
+
+private:
+    V12::CGlomParameters m_params;
+    std::uint32_t        m_sourceId;
+    Sink                 m_sink;
+
+    Buffer::ByteBuffer   m_event;
+    Buffer::ByteBuffer   m_input;
+    std::uint64_t        m_firstTimestamp;
+    std::uint64_t        m_lastTimestamp;
+    std::uint64_t        m_sumOfOffsets;
+    std::size_t          m_nFragments;
+
+    bool                 m_parametersEmitted;
+    std::size_t          m_nEvents;
+    std::size_t          m_nFragmentsTotal;
+
+public:
+    /*!
+     * \brief Construct with a generic sink
+     *
+     * \param params    the coincidence window, building flag and timestamp policy
+     * \param sink      destination of the output items
+     * \param sourceId  source id assigned to the composites and glom parameters
+     */
+    CGlom(const V12::CGlomParameters& params, Sink sink, std::uint32_t sourceId = 0);
+
+    /*! \brief Construct with a stream as the sink */
+    CGlom(const V12::CGlomParameters& params, std::ostream& output,
+          std::uint32_t sourceId = 0);
+
+    CGlom(const CGlom&) = delete;
+    CGlom& operator=(const CGlom&) = delete;
+
+    /*!
+     * \brief Add an item in wire format
+     *
+     * \param beg  pointer to the first byte of the item
+     * \param end  pointer to one past the last byte of the item
+     *
+     * \throws std::runtime_error if the size in the header does not match the range
+     */
+    void addItem(const std::uint8_t* beg, const std::uint8_t* end);
+
+    /*! \brief Add an item */
+    void addItem(const V12::CRawRingItem& item);
+
+    /*!
+     * \brief Read and process all items from a stream
+     *
+     * \return the number of items read
+     *
+     * \throws std::runtime_error if the stream ends with an incomplete item
+     */
+    std::size_t process(std::istream& input);
+
+    /*! \brief Emit the event being built, if there is one */
+    void flush();
+
+    std::size_t getEventCount() const { return m_nEvents; }
+    std::size_t getFragmentCount() const { return m_nFragmentsTotal; }
+
+private:
+    void emitParameters();
+    void appendFragment(const std::uint8_t* beg, const std::uint8_t* end,
+                        std::uint64_t tstamp);
+    void passThrough(const std::uint8_t* beg, const std::uint8_t* end);
+    std::uint64_t computeTimestamp() const;
+};
+
+} // end DAQ
+
+#endif // DAQ_CGLOM_H
@@ -0,0 +1,95 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CItemSource.h"
+#include "CRingItemQueue.h"
+#include "CShmRing.h"
+#include "RingIOV12.h"
+
+#include <V12/CRawRingItem.h>
+
+#include <chrono>
+#include <istream>
+#include <stdexcept>
+
+namespace DAQ {
+
+//
+CItemSource::Status CQueueItemSource::next(V12::CRawRingItem& item)
+{
+    std::size_t size;
+    if (!m_queue.peek(size)) {
+
+        // the closed flag must be checked before the final peek so that an
+        // item committed just prior to closing is not missed
+        bool closed = m_queue.isClosed();
+        if (!m_queue.peek(size)) {
+            return closed ? End : Pending;
+        }
+    }
+
+    // an item is present, so this does not wait
+    readItem(m_queue, item);
+    return Ready;
+}
+
+
+//
+bool CQueueItemSource::setReadinessSignal(std::shared_ptr<CReadinessSignal> pSignal)
+{
+    m_queue.setReadinessSignal(pSignal);
+    return true;
+}
+
+
+//
+CItemSource::Status CShmRingItemSource::next(V12::CRawRingItem& item)
+{
+    if (readItem(m_source, item, std::chrono::microseconds(0))) {
+        return Ready;
+    }
+    return m_source.eof() ? End : Pending;
+}
+
+
+//
+CItemSource::Status CStreamItemSource::next(V12::CRawRingItem& item)
+{
+    if (m_stream.peek() == std::istream::traits_type::eof()) {
+        return End;
+    }
+
+    m_stream >> item;
+    if (!m_stream) {
+        throw std::runtime_error("DAQ::CStreamItemSource::next() stream ends in the middle of an item.");
+    }
+    return Ready;
+}
+
+
+//
+CItemSource::Status CFilteredItemSource::next(V12::CRawRingItem& item)
+{
+    Status status;
+    while ((status = m_upstream.next(item)) == Ready) {
+        if (m_predicate(item)) {
+            return Ready;
+        }
+    }
+    return status;
+}
+
+} // end DAQ
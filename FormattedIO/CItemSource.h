@@ -0,0 +1,189 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CITEMSOURCE_H
+#define DAQ_CITEMSOURCE_H
+
+#include <functional>
+#include <iosfwd>
+#include <memory>
+
+namespace DAQ {
+
+class CReadinessSignal;
+class CRingItemQueue;
+class CShmRingSource;
+
+namespace V12 {
+    class CRawRingItem;
+}
+
+/*!
+ * \brief A V12 item stream that is pulled from one item at a time
+ *
+ * next() never waits for data. When no complete item is available yet it
+ * returns Pending, and the caller is free to service other sources and come
+ * back later. Pending is where a blocking reader would sleep; here control
+ * returns to the caller instead, so that one thread can drive many sources
+ * (see CSourceMultiplexer).
+ *
+ * A caller that runs out of work can ask a source to notify a
+ * CReadinessSignal when it may have stopped being Pending, and sleep on the
+ * signal instead of polling (see setReadinessSignal()).
+ *
+ * Sources compose: a CFilteredItemSource pulls from another source and passes
+ * on only the items that satisfy its predicate. Nothing is read until the end
+ * of the chain is pulled.
+ *
+ * \code
+ * CQueueItemSource       queued(queue);
+ * CFilteredItemSource    physics(queued, [](const V12::CRawRingItem& item) {
+ *                                            return item.type() == V12::PHYSICS_EVENT;
+ *                                        });
+ * V12::CRawRingItem item;
+ * CItemSource::Status status;
+ * while ((status = physics.next(item)) != CItemSource::End) {
+ *     if (status == CItemSource::Ready) {
+ *         ...
+ *     } else {
+ *         // do other work
+ *     }
+ * }
+ * \endcode
+ */
+class CItemSource
+{
+public:
+    enum Status {
+        Ready,      //!< the item was filled
+        Pending,    //!< no complete item is available yet
+        End         //!< the source will not produce more items
+    };
+
+    virtual ~CItemSource() {}
+
+    /*!
+     * \brief Fill item with the next item if one is available
+     *
+     * The contents of item are unspecified unless Ready is returned.
+     */
+    virtual Status next(V12::CRawRingItem& item) = 0;
+
+    /*!
+     * \brief Ask the source to notify a signal when it may no longer be Pending
+     *
+     * The signal must be notified whenever data arrives or the source ends.
+     * Sources that cannot tell when that happens ignore the signal.
+     *
+     * \param pSignal  the signal, or nullptr to detach the current one
+     *
+     * \return whether the source will notify the signal
+     */
+    virtual bool setReadinessSignal(std::shared_ptr<CReadinessSignal>) { return false; }
+};
+
+
+/*!
+ * \brief Pulls items from a CRingItemQueue
+ *
+ * Pending while the queue is empty, End once it is empty and closed.
+ */
+class CQueueItemSource : public CItemSource
+{
+    CRingItemQueue& m_queue;
+
+public:
+    explicit CQueueItemSource(CRingItemQueue& queue) : m_queue(queue) {}
+
+    Status next(V12::CRawRingItem& item);
+
+    /*! The writer of the queue notifies the signal. */
+    bool setReadinessSignal(std::shared_ptr<CReadinessSignal> pSignal);
+};
+
+
+/*!
+ * \brief Pulls items from the consumer end of a CShmRing
+ *
+ * Pending while no complete item is in the ring, End once the producer has
+ * closed it and it has drained. The producer may be in another process, so
+ * this source cannot notify a CReadinessSignal.
+ */
+class CShmRingItemSource : public CItemSource
+{
+    CShmRingSource& m_source;
+
+public:
+    explicit CShmRingItemSource(CShmRingSource& source) : m_source(source) {}
+
+    Status next(V12::CRawRingItem& item);
+};
+
+
+/*!
+ * \brief Pulls items from a std::istream
+ *
+ * A stream has no way to say that data is not available yet, so this source
+ * is never Pending. It is meant for files.
+ */
+class CStreamItemSource : public CItemSource
+{
+    std::istream& m_stream;
+
+public:
+    explicit CStreamItemSource(std::istream& stream) : m_stream(stream) {}
+
+    /*!
+     * \throws std::runtime_error if the stream ends in the middle of an item
+     */
+    Status next(V12::CRawRingItem& item);
+
+    /*! A stream is never Pending, so there is nothing to notify. */
+    bool setReadinessSignal(std::shared_ptr<CReadinessSignal>) { return true; }
+};
+
+
+/*!
+ * \brief Passes on the items of another source that satisfy a predicate
+ */
+class CFilteredItemSource : public CItemSource
+{
+public:
+    typedef std::function<bool(const V12::CRawRingItem&)> Predicate;
+
+private:
+    CItemSource& m_upstream;
+    Predicate    m_predicate;
+
+public:
+    CFilteredItemSource(CItemSource& upstream, Predicate predicate)
+        : m_upstream(upstream), m_predicate(predicate) {}
+
+    /*!
+     * Items that fail the predicate are consumed from the upstream source.
+     * Pending and End are passed through.
+     */
+    Status next(V12::CRawRingItem& item);
+
+    /*! The signal is passed to the upstream source. */
+    bool setReadinessSignal(std::shared_ptr<CReadinessSignal> pSignal) {
+        return m_upstream.setReadinessSignal(pSignal);
+    }
+};
+
+} // end DAQ
+
+#endif // DAQ_CITEMSOURCE_H
@@ -0,0 +1,229 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CMultiVersionReader.h"
+
+#include <V10/DataFormat.h>
+#include <V11/DataFormat.h>
+#include <V12/DataFormat.h>
+#include <V12/CRingItemParser.h>
+#include <ByteOrder.h>
+
+#include <algorithm>
+#include <istream>
+#include <stdexcept>
+#include <string>
+
+namespace DAQ {
+
+// enough for a V8 buffer header or the format item of any version
+static const std::size_t SniffSize = 32;
+
+// offsets of the byte order signatures in the V8 buffer header
+static const std::size_t V8ShortSignatureOffset = 22;
+static const std::size_t V8LongSignatureOffset  = 24;
+
+// offsets of the major version in the RING_FORMAT items
+static const std::size_t V11MajorOffset = 12;
+static const std::size_t V12MajorOffset = 20;
+
+template<class T>
+static T rawValue(const std::uint8_t* p)
+{
+    T value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static bool isV8Header(const std::uint8_t* beg, const std::uint8_t* end)
+{
+    if (std::size_t(end - beg) < V8LongSignatureOffset + sizeof(std::uint32_t)) {
+        return false;
+    }
+
+    std::uint16_t ssig = rawValue<std::uint16_t>(beg + V8ShortSignatureOffset);
+    std::uint32_t lsig = rawValue<std::uint32_t>(beg + V8LongSignatureOffset);
+
+    bool swap = (ssig == 0x0201);
+    if (!swap && (ssig != 0x0102)) {
+        return false;
+    }
+    if (swap) {
+        BO::swapBytes(lsig);
+    }
+    return (lsig == 0x01020304);
+}
+
+static bool isV10Type(std::uint32_t type)
+{
+    switch (type) {
+        case V10::BEGIN_RUN:
+        case V10::END_RUN:
+        case V10::PAUSE_RUN:
+        case V10::RESUME_RUN:
+        case V10::PACKET_TYPES:
+        case V10::MONITORED_VARIABLES:
+        case V10::INCREMENTAL_SCALERS:
+        case V10::TIMESTAMPED_NONINCR_SCALERS:
+        case V10::PHYSICS_EVENT:
+        case V10::PHYSICS_EVENT_COUNT:
+        case V10::EVB_FRAGMENT:
+        case V10::EVB_UNKNOWN_PAYLOAD:
+            return true;
+        default:
+            return (type >= V10::FIRST_USER_ITEM_CODE) && (type <= 0xffff);
+    }
+}
+
+//
+DataFormatVersion detectFormat(const std::uint8_t* beg, const std::uint8_t* end)
+{
+    std::size_t nBytes = end - beg;
+
+    if (isV8Header(beg, end)) {
+        return V8Format;
+    }
+
+    if (nBytes < 2*sizeof(std::uint32_t)) {
+        return UnknownFormat;
+    }
+
+    // all ring item types fit in the low 16 bits
+    std::uint32_t type = rawValue<std::uint32_t>(beg + sizeof(std::uint32_t));
+    BO::CByteSwapper swapper((type & 0xffff0000) != 0);
+    std::uint32_t size = swapper.copyAs<std::uint32_t>(beg);
+    type = swapper.copyAs<std::uint32_t>(beg + sizeof(std::uint32_t));
+
+    if (size < 2*sizeof(std::uint32_t)) {
+        return UnknownFormat;
+    }
+
+    if (type == V11::RING_FORMAT) {
+        if ((size >= V11MajorOffset + sizeof(std::uint16_t))
+                && (nBytes >= V11MajorOffset + sizeof(std::uint16_t))
+                && (swapper.copyAs<std::uint16_t>(beg + V11MajorOffset) == V11::FORMAT_MAJOR)) {
+            return V11Format;
+        }
+        if ((size >= V12MajorOffset + sizeof(std::uint16_t))
+                && (nBytes >= V12MajorOffset + sizeof(std::uint16_t))
+                && (swapper.copyAs<std::uint16_t>(beg + V12MajorOffset) == V12::FORMAT_MAJOR)) {
+            return V12Format;
+        }
+        return UnknownFormat;
+    }
+
+    if (isV10Type(type)) {
+        return V10Format;
+    }
+
+    return UnknownFormat;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// CMultiVersionReader
+
+//
+CMultiVersionReader::CMultiVersionReader(std::istream& stream, std::size_t chunkSize)
+    : m_stream(stream),
+      m_version(UnknownFormat),
+      m_buffer(),
+      m_pos(0),
+      m_chunkSize(std::max<std::size_t>(chunkSize, 1))
+{
+    fill(SniffSize);
+    if (m_buffer.empty()) {
+        return;
+    }
+
+    m_version = detectFormat(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    if (m_version == UnknownFormat) {
+        throw std::runtime_error("DAQ::CMultiVersionReader::CMultiVersionReader() "
+                                 "unable to determine the data format version.");
+    }
+}
+
+
+//
+CMultiVersionReader::CMultiVersionReader(std::istream& stream, DataFormatVersion version,
+                                         std::size_t chunkSize)
+    : m_stream(stream),
+      m_version(version),
+      m_buffer(),
+      m_pos(0),
+      m_chunkSize(std::max<std::size_t>(chunkSize, 1))
+{
+    if (m_version == UnknownFormat) {
+        throw std::invalid_argument("DAQ::CMultiVersionReader::CMultiVersionReader() "
+                                    "a version must be specified.");
+    }
+}
+
+
+/*!
+ * \brief Ensure that nBytes of unconsumed data are buffered
+ *
+ * \return false if the stream ended before that many bytes were available
+ */
+bool CMultiVersionReader::fill(std::size_t nBytes)
+{
+    while (m_buffer.size() - m_pos < nBytes) {
+        if (!m_stream) {
+            return false;
+        }
+
+        // discard the consumed data before reading more
+        if (m_pos != 0) {
+            m_buffer.erase(m_buffer.begin(), m_buffer.begin() + m_pos);
+            m_pos = 0;
+        }
+
+        std::size_t kept = m_buffer.size();
+        std::size_t nRead = std::max(m_chunkSize, nBytes - kept);
+        m_buffer.resize(kept + nRead);
+        m_stream.read(reinterpret_cast<char*>(m_buffer.data() + kept), nRead);
+        m_buffer.resize(kept + m_stream.gcount());
+    }
+    return true;
+}
+
+
+//
+void CMultiVersionReader::throwMalformed(const std::string& what) const
+{
+    throw std::runtime_error("DAQ::CMultiVersionReader::read() " + what);
+}
+
+
+//
+std::size_t CMultiVersionReader::V10Traits::itemSize(const std::uint8_t* beg)
+{
+    std::uint32_t type = rawValue<std::uint32_t>(beg + sizeof(std::uint32_t));
+    BO::CByteSwapper swapper((type & 0xffff0000) != 0);
+    return swapper.copyAs<std::uint32_t>(beg);
+}
+
+
+//
+std::size_t CMultiVersionReader::V12Traits::itemSize(const std::uint8_t* beg)
+{
+    std::uint32_t size, type;
+    bool swap;
+    V12::Parser::parseSizeAndType(beg, beg + 2*sizeof(std::uint32_t), size, type, swap);
+    return size;
+}
+
+} // end DAQ
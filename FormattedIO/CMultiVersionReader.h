@@ -0,0 +1,281 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CMULTIVERSIONREADER_H
+#define DAQ_CMULTIVERSIONREADER_H
+
+#include <ByteBuffer.h>
+#include <V8/CRawBuffer.h>
+#include <V10/CRingItem.h>
+#include <V11/CRingItem.h>
+#include <V12/CRawRingItem.h>
+
+#include <cstdint>
+#include <cstring>
+#include <iosfwd>
+#include <string>
+
+namespace DAQ {
+
+/*!
+ * \brief The data format versions that can be told apart from their first bytes
+ */
+enum DataFormatVersion {
+    UnknownFormat = 0,
+    V8Format      = 8,
+    V10Format     = 10,
+    V11Format     = 11,
+    V12Format     = 12
+};
+
+/*!
+ * \brief Determine the data format version from the first bytes of a file
+ *
+ * - V8 data begins with a buffer header whose short and long signatures are
+ *   0x0102 and 0x01020304 (in either byte order).
+ * - V11 and V12 data begin with a RING_FORMAT item. The two are told apart by
+ *   the position of the major version, which follows the 4 byte body header
+ *   size in V11 and the 20 byte header in V12.
+ * - V10 has no format item. Data that begins with a V10 item type is
+ *   recognized as V10, since V11 and V12 writers always start with a
+ *   RING_FORMAT item.
+ *
+ * \param beg  the first byte of the data
+ * \param end  one past the last byte available (32 bytes suffice)
+ *
+ * \return the version, or UnknownFormat if none of the above matches
+ */
+DataFormatVersion detectFormat(const std::uint8_t* beg, const std::uint8_t* end);
+
+
+/*!
+ * \brief Reads a file of any data format version
+ *
+ * The reader looks at the first bytes of the stream to determine the version
+ * (see detectFormat()) or is told which version to expect. read() then runs a
+ * decode loop that is compiled separately for each version, so the version is
+ * examined once per call rather than once per item.
+ *
+ * The items are passed to a handler, which must be callable with each of
+ *
+ *   - const V8::CRawBuffer&
+ *   - const V10::CRingItem&
+ *   - const V11::CRingItem&
+ *   - const V12::CRawRingItem&
+ *
+ * and return true to keep reading or false to stop. The objects passed to the
+ * handler are only valid during the call.
+ *
+ * Data are read from the stream in large chunks, so the reader must be the
+ * only consumer of the stream.
+ *
+ * \code
+ * struct Counter {
+ *     std::size_t nEvents = 0;
+ *     bool operator()(const V8::CRawBuffer& buffer)    { ...; return true; }
+ *     bool operator()(const V10::CRingItem& item)      { ...; return true; }
+ *     bool operator()(const V11::CRingItem& item)      { ...; return true; }
+ *     bool operator()(const V12::CRawRingItem& item)   { ...; return true; }
+ * };
+ *
+ * std::ifstream input("run-0012-00.evt", std::ios::binary);
+ * CMultiVersionReader reader(input);
+ * Counter counter;
+ * reader.read(counter);
+ * \endcode
+ */
+class CMultiVersionReader
+{
+private:
+    std::istream&       m_stream;
+    DataFormatVersion   m_version;
+    Buffer::ByteBuffer  m_buffer;
+    std::size_t         m_pos;
+    std::size_t         m_chunkSize;
+
+public:
+    /*!
+     * \brief Construct a reader that detects the version
+     *
+     * The first bytes of the stream are read right away. An empty stream has
+     * the version UnknownFormat and read() returns no items from it.
+     *
+     * \throws std::runtime_error if the stream has data of no recognized version
+     */
+    explicit CMultiVersionReader(std::istream& stream,
+                                 std::size_t chunkSize = 1024*1024);
+
+    /*!
+     * \brief Construct a reader for a known version
+     *
+     * This is needed for V11 data that does not begin with a RING_FORMAT item.
+     *
+     * \throws std::invalid_argument if version is UnknownFormat
+     */
+    CMultiVersionReader(std::istream& stream, DataFormatVersion version,
+                        std::size_t chunkSize = 1024*1024);
+
+    DataFormatVersion getVersion() const { return m_version; }
+
+    /*!
+     * \brief Pass items to the handler until the stream ends or the handler stops
+     *
+     * A later call resumes with the item after the one the handler stopped on.
+     *
+     * \return the number of items passed to the handler
+     *
+     * \throws std::runtime_error if the stream ends in the middle of an item
+     *                            or an item size is smaller than its header
+     */
+    template<class Handler> std::size_t read(Handler& handler);
+
+private:
+    struct V8Traits;
+    struct V10Traits;
+    struct V11Traits;
+    struct V12Traits;
+
+    template<class Traits, class Handler> std::size_t readItems(Handler& handler);
+
+    bool fill(std::size_t nBytes);
+    void throwMalformed(const std::string& what) const;
+};
+
+
+/*
+ * Each version is described by a traits struct:
+ *
+ *  - headerSize()  the number of bytes needed to determine the size of an item
+ *  - itemSize()    the size of the item that begins at the pointer
+ *  - dispatch()    wraps the bytes of an item and passes it to the handler
+ *
+ * readItems() keeps one traits object for the duration of the call, so a
+ * traits struct can hold state that is reused from item to item.
+ */
+
+struct CMultiVersionReader::V8Traits {
+    static std::size_t headerSize() { return V8::gBufferSize; }
+    static std::size_t itemSize(const std::uint8_t*) { return V8::gBufferSize; }
+
+    template<class Handler>
+    bool dispatch(const std::uint8_t* beg, const std::uint8_t* end, Handler& handler) {
+        V8::CRawBuffer buffer;
+        buffer.setBuffer(Buffer::ByteBuffer(beg, end));
+        return handler(static_cast<const V8::CRawBuffer&>(buffer));
+    }
+};
+
+struct CMultiVersionReader::V10Traits {
+    static std::size_t headerSize() { return 2*sizeof(std::uint32_t); }
+    static std::size_t itemSize(const std::uint8_t* beg);
+
+    // V10 items cannot view memory they do not own, so one item is reused
+    // and only reallocated when a larger item comes along
+    V10::CRingItem m_item;
+
+    template<class Handler>
+    bool dispatch(const std::uint8_t* beg, const std::uint8_t* end, Handler& handler) {
+        std::size_t size = end - beg;
+        if (size > m_item.getStorageSize()) {
+            m_item = V10::CRingItem(V10::UNDEFINED, size);
+        }
+        char* pItem = reinterpret_cast<char*>(m_item.getItemPointer());
+        std::memcpy(pItem, beg, size);
+        m_item.setBodyCursor(pItem + size);
+        return handler(static_cast<const V10::CRingItem&>(m_item));
+    }
+};
+
+struct CMultiVersionReader::V11Traits {
+    static std::size_t headerSize() { return 2*sizeof(std::uint32_t); }
+    static std::size_t itemSize(const std::uint8_t* beg) { return V10Traits::itemSize(beg); }
+
+    template<class Handler>
+    bool dispatch(const std::uint8_t* beg, const std::uint8_t*, Handler& handler) {
+        V11::CRingItem item(V11::CRingItem::View(), beg);
+        return handler(static_cast<const V11::CRingItem&>(item));
+    }
+};
+
+struct CMultiVersionReader::V12Traits {
+    static std::size_t headerSize() { return 20; }
+    static std::size_t itemSize(const std::uint8_t* beg);
+
+    template<class Handler>
+    bool dispatch(const std::uint8_t* beg, const std::uint8_t* end, Handler& handler) {
+        V12::CRawRingItem item(beg, end);
+        return handler(static_cast<const V12::CRawRingItem&>(item));
+    }
+};
+
+
+//
+template<class Handler>
+std::size_t CMultiVersionReader::read(Handler& handler)
+{
+    switch (m_version) {
+        case V8Format:
+            return readItems<V8Traits>(handler);
+        case V10Format:
+            return readItems<V10Traits>(handler);
+        case V11Format:
+            return readItems<V11Traits>(handler);
+        case V12Format:
+            return readItems<V12Traits>(handler);
+        default:
+            return 0;
+    }
+}
+
+
+//
+template<class Traits, class Handler>
+std::size_t CMultiVersionReader::readItems(Handler& handler)
+{
+    Traits traits;
+    std::size_t nItems = 0;
+    bool keepReading = true;
+
+    while (keepReading) {
+        if (!fill(Traits::headerSize())) {
+            if (m_pos != m_buffer.size()) {
+                throwMalformed("Stream ends in the middle of an item header.");
+            }
+            break;
+        }
+
+        std::size_t size = Traits::itemSize(m_buffer.data() + m_pos);
+        if (size < Traits::headerSize()) {
+            throwMalformed("Item is smaller than its header.");
+        }
+        if (!fill(size)) {
+            throwMalformed("Stream ends in the middle of an item.");
+        }
+
+        // fill() may have moved the data
+        const std::uint8_t* pItem = m_buffer.data() + m_pos;
+        m_pos += size;
+        ++nItems;
+
+        keepReading = traits.dispatch(pItem, pItem + size, handler);
+    }
+
+    return nItems;
+}
+
+} // end DAQ
+
+#endif // DAQ_CMULTIVERSIONREADER_H
@@ -0,0 +1,62 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CReadinessSignal.h"
+
+namespace DAQ {
+
+//
+CReadinessSignal::CReadinessSignal()
+    : m_count(0),
+      m_nWaiters(0)
+{}
+
+
+//
+void CReadinessSignal::notify()
+{
+    // The count is bumped before looking for waiters, and a waiter registers
+    // before it checks the count, so one of the two always sees the other.
+    m_count.fetch_add(1);
+    if (m_nWaiters.load() != 0) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cond.notify_all();
+    }
+}
+
+
+//
+std::uint64_t CReadinessSignal::getCount() const
+{
+    return m_count.load();
+}
+
+
+//
+bool CReadinessSignal::wait(std::uint64_t lastCount, std::chrono::microseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_nWaiters.fetch_add(1);
+    bool changed = m_cond.wait_for(lock, timeout, [this, lastCount]() {
+        return m_count.load() != lastCount;
+    });
+    m_nWaiters.fetch_sub(1);
+
+    return changed;
+}
+
+} // end DAQ
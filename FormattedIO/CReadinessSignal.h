@@ -0,0 +1,72 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CREADINESSSIGNAL_H
+#define DAQ_CREADINESSSIGNAL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace DAQ {
+
+/*!
+ * \brief Lets a consumer sleep until a producer may have new data
+ *
+ * The signal is a counter that producers bump with notify() whenever data
+ * arrives or a stream ends. A consumer records getCount(), looks for work, and
+ * if it finds none, calls wait() with the recorded count. wait() returns as
+ * soon as the count differs, so a notification that arrives between the
+ * check and the wait is not lost.
+ *
+ * notify() only takes the lock when a consumer is actually waiting, so it is
+ * cheap enough to call for every item on a lock-free path.
+ *
+ * One signal may be shared by many producers (see CSourceMultiplexer).
+ */
+class CReadinessSignal
+{
+private:
+    std::atomic<std::uint64_t> m_count;
+    std::atomic<unsigned>      m_nWaiters;
+    std::mutex                 m_mutex;
+    std::condition_variable    m_cond;
+
+public:
+    CReadinessSignal();
+
+    CReadinessSignal(const CReadinessSignal&) = delete;
+    CReadinessSignal& operator=(const CReadinessSignal&) = delete;
+
+    /*! \brief Wake any waiting consumer (producers) */
+    void notify();
+
+    /*! \return the number of notifications so far */
+    std::uint64_t getCount() const;
+
+    /*!
+     * \brief Wait until the count differs from lastCount or the timeout expires
+     *
+     * \return true if the count changed
+     */
+    bool wait(std::uint64_t lastCount, std::chrono::microseconds timeout);
+};
+
+} // end DAQ
+
+#endif // DAQ_CREADINESSSIGNAL_H
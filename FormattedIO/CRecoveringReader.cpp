@@ -0,0 +1,328 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CRecoveringReader.h"
+
+#include <V12/CRawRingItem.h>
+#include <V12/CRingItemParser.h>
+#include <V12/DataFormat.h>
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <limits>
+
+namespace DAQ {
+
+static const std::size_t HeaderSize = sizeof(V12::RingItemHeader);
+
+// the type is the second word of the header; its upper half is zero in
+// either byte order
+static const std::size_t TypeOffset = sizeof(std::uint32_t);
+
+
+//
+CRecoveringReader::CRecoveringReader(std::istream& stream, std::size_t nConfirm,
+                                     std::uint32_t maxItemSize, std::size_t chunkSize)
+    : m_stream(stream),
+      m_buffer(),
+      m_base(0),
+      m_offset(0),
+      m_keep(0),
+      m_nConfirm(std::max<std::size_t>(nConfirm, 1)),
+      m_maxItemSize(maxItemSize),
+      m_chunkSize(std::max<std::size_t>(chunkSize, 1)),
+      m_skipped()
+{}
+
+
+//
+bool CRecoveringReader::read(V12::CRawRingItem& item)
+{
+    while (true) {
+        m_keep = m_offset;
+        if (atEnd(m_offset)) {
+            return false;
+        }
+
+        std::uint32_t size, nextSize;
+        if (isValidItem(m_offset, size)) {
+            std::uint64_t next = m_offset + size;
+
+            // A corrupted header after a good item looks like a good header
+            // after an item with a corrupted size. The item is kept unless a
+            // chain of items starts inside it.
+            std::uint64_t resume = next;
+            if (!atEnd(next) && !isPlausibleHeader(next, nextSize)) {
+                resume = findChainStart(m_offset + 1, next);
+            }
+
+            if (resume == next) {
+                const std::uint8_t* pItem = at(m_offset, size);
+
+                std::uint32_t type, sourceId;
+                std::uint64_t tstamp;
+                bool swapNeeded;
+                V12::Parser::parseHeader(pItem, pItem + HeaderSize,
+                                         size, type, tstamp, sourceId, swapNeeded);
+                item.setType(type);
+                item.setEventTimestamp(tstamp);
+                item.setSourceId(sourceId);
+                item.setMustSwap(swapNeeded);
+                item.getBody().assign(pItem + HeaderSize, pItem + size);
+
+                m_offset = next;
+                return true;
+            }
+
+            skip(m_offset, resume);
+            m_offset = resume;
+            continue;
+        }
+
+        std::uint64_t resume = findChainStart(m_offset + 1);
+        skip(m_offset, resume);
+        m_offset = resume;
+    }
+}
+
+
+//
+std::uint64_t CRecoveringReader::getSkippedByteCount() const
+{
+    std::uint64_t total = 0;
+    for (auto& range : m_skipped) {
+        total += range.s_length;
+    }
+    return total;
+}
+
+
+/*!
+ * \brief Access nBytes of the stream starting at offset
+ *
+ * Data before m_keep may be discarded to make room.
+ *
+ * \return a pointer to the data, or nullptr if the stream ends first. The
+ *         pointer is invalidated by the next call.
+ */
+const std::uint8_t* CRecoveringReader::at(std::uint64_t offset, std::size_t nBytes)
+{
+    while (offset + nBytes > m_base + m_buffer.size()) {
+        if (!m_stream) {
+            return nullptr;
+        }
+
+        if (m_keep > m_base) {
+            std::size_t nDrop = std::min<std::uint64_t>(m_keep - m_base, m_buffer.size());
+            m_buffer.erase(m_buffer.begin(), m_buffer.begin() + nDrop);
+            m_base += nDrop;
+        }
+
+        std::size_t kept = m_buffer.size();
+        std::size_t nRead = std::max<std::uint64_t>(m_chunkSize,
+                                                    offset + nBytes - (m_base + kept));
+        m_buffer.resize(kept + nRead);
+        m_stream.read(reinterpret_cast<char*>(m_buffer.data() + kept), nRead);
+        m_buffer.resize(kept + m_stream.gcount());
+    }
+    return m_buffer.data() + (offset - m_base);
+}
+
+
+//
+bool CRecoveringReader::atEnd(std::uint64_t offset)
+{
+    return (at(offset, 1) == nullptr);
+}
+
+
+/*!
+ * \brief Check the size and type of the header at offset
+ */
+bool CRecoveringReader::isPlausibleHeader(std::uint64_t offset, std::uint32_t& size)
+{
+    const std::uint8_t* pHeader = at(offset, HeaderSize);
+    if (!pHeader) {
+        return false;
+    }
+
+    std::uint32_t type;
+    bool swapNeeded;
+    V12::Parser::parseSizeAndType(pHeader, pHeader + 2*sizeof(std::uint32_t),
+                                  size, type, swapNeeded);
+
+    return (size >= HeaderSize) && (size <= m_maxItemSize) && V12::Parser::isKnownType(type);
+}
+
+
+/*!
+ * \brief Check the header of the item at offset and the structure of its body
+ */
+bool CRecoveringReader::isValidItem(std::uint64_t offset, std::uint32_t& size)
+{
+    if (!isPlausibleHeader(offset, size)) {
+        return false;
+    }
+
+    const std::uint8_t* pItem = at(offset, size);
+    if (!pItem) {
+        return false;
+    }
+
+    std::uint32_t type;
+    bool swapNeeded;
+    V12::Parser::parseSizeAndType(pItem, pItem + 2*sizeof(std::uint32_t), size, type, swapNeeded);
+
+    if (V12::Parser::isComposite(type)) {
+        return isValidComposite(pItem + HeaderSize, pItem + size, 1);
+    }
+    return true;
+}
+
+
+//
+bool CRecoveringReader::isValidComposite(const std::uint8_t* body, const std::uint8_t* end,
+                                         unsigned depth) const
+{
+    if (depth > MaxCompositeDepth) {
+        return false;
+    }
+
+    while (body != end) {
+        if (std::size_t(end - body) < HeaderSize) {
+            return false;
+        }
+
+        std::uint32_t size, type;
+        bool swapNeeded;
+        V12::Parser::parseSizeAndType(body, body + 2*sizeof(std::uint32_t),
+                                      size, type, swapNeeded);
+        if ((size < HeaderSize) || (size > std::size_t(end - body))
+                || !V12::Parser::isKnownType(type)) {
+            return false;
+        }
+        if (V12::Parser::isComposite(type)
+                && !isValidComposite(body + HeaderSize, body + size, depth + 1)) {
+            return false;
+        }
+        body += size;
+    }
+    return true;
+}
+
+
+/*!
+ * \brief Whether m_nConfirm valid items of one byte order follow each other from offset
+ *
+ * A shorter chain that ends exactly at the end of the stream is accepted too.
+ */
+bool CRecoveringReader::isChainStart(std::uint64_t offset)
+{
+    bool firstSwap = false;
+    for (std::size_t i=0; i<m_nConfirm; ++i) {
+        if (atEnd(offset)) {
+            return (i > 0);
+        }
+
+        std::uint32_t size;
+        if (!isValidItem(offset, size)) {
+            return false;
+        }
+
+        const std::uint8_t* pType = at(offset + TypeOffset, sizeof(std::uint32_t));
+        bool swapNeeded = V12::Parser::mustSwap(pType, pType + sizeof(std::uint32_t));
+        if (i == 0) {
+            firstSwap = swapNeeded;
+        } else if (swapNeeded != firstSwap) {
+            return false;
+        }
+        offset += size;
+    }
+    return true;
+}
+
+
+/*!
+ * \brief Find the first offset in [from, limit) where a chain of valid items starts
+ *
+ * A header needs a zero byte somewhere in bytes 4-7 (the upper half of the
+ * type). memchr() finds the next zero byte, and every offset that would put
+ * it out of that window is skipped without being examined.
+ *
+ * An unbounded search lets the data it has passed be dropped. A bounded
+ * search keeps it, so that the item before the limit can still be returned.
+ *
+ * \return the offset, or the smaller of limit and the end of the stream if
+ *         there is none
+ */
+std::uint64_t CRecoveringReader::findChainStart(std::uint64_t from, std::uint64_t limit)
+{
+    const std::size_t window = 2*sizeof(std::uint32_t);
+    bool bounded = (limit != std::numeric_limits<std::uint64_t>::max());
+
+    std::uint64_t candidate = from;
+    while (candidate < limit) {
+        if (!bounded) {
+            m_keep = candidate;
+        }
+
+        const std::uint8_t* pos = at(candidate, window);
+        if (!pos) {
+            return std::min(limit, m_base + m_buffer.size());
+        }
+
+        const std::uint8_t* end = m_buffer.data() + m_buffer.size();
+        auto pZero = static_cast<const std::uint8_t*>(
+                    std::memchr(pos + TypeOffset, 0, end - (pos + TypeOffset)));
+        if (!pZero) {
+            // only the last few offsets of the buffer remain possible
+            candidate = std::max(candidate, m_base + m_buffer.size() - (window - 1));
+            if (!at(candidate, window + 1)) {
+                return std::min(limit, m_base + m_buffer.size());
+            }
+            continue;
+        }
+
+        std::uint64_t zeroOffset = m_base + (pZero - m_buffer.data());
+        if (zeroOffset > candidate + (window - 1)) {
+            candidate = zeroOffset - (window - 1);
+        }
+
+        if ((candidate < limit) && isChainStart(candidate)) {
+            return candidate;
+        }
+        ++candidate;
+    }
+    return limit;
+}
+
+
+//
+void CRecoveringReader::skip(std::uint64_t from, std::uint64_t to)
+{
+    if (to <= from) {
+        return;
+    }
+
+    if (!m_skipped.empty() && (m_skipped.back().s_offset + m_skipped.back().s_length == from)) {
+        m_skipped.back().s_length += (to - from);
+    } else {
+        m_skipped.push_back({from, to - from});
+    }
+}
+
+} // end DAQ
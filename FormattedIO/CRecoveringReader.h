@@ -0,0 +1,134 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CRECOVERINGREADER_H
+#define DAQ_CRECOVERINGREADER_H
+
+#include <ByteBuffer.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <vector>
+
+namespace DAQ {
+
+namespace V12 {
+    class CRawRingItem;
+}
+
+/*!
+ * \brief Reads V12 items from a stream that may contain corrupted data
+ *
+ * operator>>(std::istream&, V12::CRawRingItem&) trusts the size of every
+ * header, so a single corrupted header makes it read garbage for the rest of
+ * the stream. This reader checks every item before returning it:
+ *
+ *  - the size is at least a header and at most the maximum item size,
+ *  - the type is a known V12 type or a user type (V12::Parser::isKnownType()),
+ *  - the body of a composite is exactly tiled by children that pass the same
+ *    checks, nested no deeper than MaxCompositeDepth,
+ *  - and the header that follows the item is plausible. If it is not, the
+ *    item is still returned if the stream ends right after it or if no chain
+ *    of valid items starts inside it; otherwise its own size is suspect.
+ *
+ * When an item fails, the reader scans forward for the next offset at which
+ * a chain of items passes those checks and resumes there. Offsets are ruled
+ * out quickly with memchr(): every header has two zero bytes in the upper
+ * half of its type, so no offset can be a header until a zero byte is near.
+ * The byte range that was skipped is recorded.
+ *
+ * \code
+ * std::ifstream input("run-0012-00.evt", std::ios::binary);
+ * CRecoveringReader reader(input);
+ * V12::CRawRingItem item;
+ * while (reader.read(item)) {
+ *     ...
+ * }
+ * for (auto& range : reader.getSkippedRanges()) {
+ *     std::cerr << "skipped " << range.s_length << " bytes at " << range.s_offset << "\n";
+ * }
+ * \endcode
+ */
+class CRecoveringReader
+{
+public:
+    /*! \brief Bytes of the stream that were not part of any returned item */
+    struct SkippedRange {
+        std::uint64_t s_offset;
+        std::uint64_t s_length;
+    };
+
+    static const unsigned MaxCompositeDepth = 8;
+
+private:
+    std::istream&              m_stream;
+    Buffer::ByteBuffer         m_buffer;
+    std::uint64_t              m_base;       // stream offset of m_buffer[0]
+    std::uint64_t              m_offset;     // stream offset of the next item
+    std::uint64_t              m_keep;       // buffered data before this may be dropped
+    std::size_t                m_nConfirm;
+    std::uint32_t              m_maxItemSize;
+    std::size_t                m_chunkSize;
+    std::vector<SkippedRange>  m_skipped;
+
+public:
+    /*!
+     * \param stream       the stream to read from
+     * \param nConfirm     the number of consecutive valid items needed to
+     *                     resume after corrupted data (fewer if the stream
+     *                     ends first)
+     * \param maxItemSize  the largest item size considered plausible
+     * \param chunkSize    the number of bytes read from the stream at a time
+     */
+    explicit CRecoveringReader(std::istream& stream,
+                               std::size_t nConfirm = 3,
+                               std::uint32_t maxItemSize = 64*1024*1024,
+                               std::size_t chunkSize = 1024*1024);
+
+    /*!
+     * \brief Read the next valid item
+     *
+     * Corrupted data before it is skipped and recorded.
+     *
+     * \return false if the stream has no more valid items
+     */
+    bool read(V12::CRawRingItem& item);
+
+    /*! \brief The stream offset of the next byte to be examined */
+    std::uint64_t getOffset() const { return m_offset; }
+
+    const std::vector<SkippedRange>& getSkippedRanges() const { return m_skipped; }
+    std::uint64_t getSkippedByteCount() const;
+
+private:
+    const std::uint8_t* at(std::uint64_t offset, std::size_t nBytes);
+    bool atEnd(std::uint64_t offset);
+
+    bool isPlausibleHeader(std::uint64_t offset, std::uint32_t& size);
+    bool isValidItem(std::uint64_t offset, std::uint32_t& size);
+    bool isValidComposite(const std::uint8_t* body, const std::uint8_t* end,
+                          unsigned depth) const;
+    bool isChainStart(std::uint64_t offset);
+    std::uint64_t findChainStart(std::uint64_t from,
+                                 std::uint64_t limit = std::numeric_limits<std::uint64_t>::max());
+    void skip(std::uint64_t from, std::uint64_t to);
+};
+
+} // end DAQ
+
+#endif // DAQ_CRECOVERINGREADER_H
@@ -0,0 +1,202 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CRingItemMerger.h"
+#include "RingIOV12.h"
+
+#include <V12/DataFormat.h>
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace DAQ {
+
+// std heap algorithms build a max-heap, so the comparison is inverted
+static bool laterThan(const std::uint64_t& lhsKey, std::size_t lhsInput,
+                      const std::uint64_t& rhsKey, std::size_t rhsInput)
+{
+    if (lhsKey != rhsKey) {
+        return lhsKey > rhsKey;
+    }
+    return lhsInput > rhsInput;
+}
+
+//
+CRingItemMerger::CRingItemMerger(NullTimestampPolicy policy)
+    : m_policy(policy),
+      m_heads(),
+      m_heap(),
+      m_stalled(),
+      m_releasing(),
+      m_primed(false)
+{}
+
+//
+void CRingItemMerger::addInput(std::istream& stream)
+{
+    std::size_t index = m_heads.size();
+    addInput([&stream, index](V12::CRawRingItem& item) {
+        if (stream.peek() == std::istream::traits_type::eof()) {
+            return false;
+        }
+
+        stream >> item;
+        if (!stream) {
+            std::string errmsg("DAQ::CRingItemMerger input ");
+            errmsg += std::to_string(index) + " ended with an incomplete item";
+            throw std::runtime_error(errmsg);
+        }
+        return true;
+    });
+}
+
+//
+void CRingItemMerger::addInput(Input input)
+{
+    if (m_primed) {
+        throw std::logic_error("DAQ::CRingItemMerger::addInput() inputs cannot be added once merging has begun");
+    }
+
+    Head head;
+    head.s_input         = std::move(input);
+    head.s_lastTimestamp = 0;
+    head.s_valid         = false;
+    m_heads.push_back(std::move(head));
+}
+
+//
+bool CRingItemMerger::next(V12::CRawRingItem& item)
+{
+    if (!m_primed) {
+        prime();
+    }
+
+    std::size_t input;
+    if (!m_releasing.empty()) {
+        input = m_releasing.front();
+        m_releasing.pop_front();
+    } else if (!m_heap.empty()) {
+        auto compare = [](const HeapEntry& lhs, const HeapEntry& rhs) {
+            return laterThan(lhs.s_key, lhs.s_input, rhs.s_key, rhs.s_input);
+        };
+        std::pop_heap(m_heap.begin(), m_heap.end(), compare);
+        input = m_heap.back().s_input;
+        m_heap.pop_back();
+    } else if (!m_stalled.empty()) {
+        releaseBarrier();
+        return next(item);
+    } else {
+        return false;
+    }
+
+    // hand the body to the caller without copying it. The caller's old body
+    // buffer is reused for the next item of this input.
+    Head& head = m_heads[input];
+    item.setType(head.s_item.type());
+    item.setEventTimestamp(head.s_item.getEventTimestamp());
+    item.setSourceId(head.s_item.getSourceId());
+    item.setMustSwap(head.s_item.mustSwap());
+    item.getBody().swap(head.s_item.getBody());
+    head.s_valid = false;
+
+    refill(input);
+
+    return true;
+}
+
+//
+std::size_t CRingItemMerger::merge(std::ostream& output)
+{
+    return merge([&output](const V12::CRawRingItem& item) {
+        output << item;
+    });
+}
+
+//
+std::size_t CRingItemMerger::merge(const Output& output)
+{
+    std::size_t nItems = 0;
+    V12::CRawRingItem item;
+    while (next(item)) {
+        output(item);
+        ++nItems;
+    }
+    return nItems;
+}
+
+//
+void CRingItemMerger::prime()
+{
+    m_primed = true;
+    m_heap.reserve(m_heads.size());
+    for (std::size_t i=0; i<m_heads.size(); ++i) {
+        refill(i);
+    }
+}
+
+//
+void CRingItemMerger::refill(std::size_t input)
+{
+    Head& head = m_heads[input];
+    head.s_valid = head.s_input(head.s_item);
+    if (head.s_valid) {
+        schedule(input);
+    }
+}
+
+//
+void CRingItemMerger::schedule(std::size_t input)
+{
+    Head& head = m_heads[input];
+    std::uint64_t tstamp = head.s_item.getEventTimestamp();
+
+    std::uint64_t key = tstamp;
+    if (tstamp == V12::NULL_TIMESTAMP) {
+        switch (m_policy) {
+        case Immediate:
+            key = 0;
+            break;
+        case InheritPrevious:
+            key = head.s_lastTimestamp;
+            break;
+        case Barrier:
+            m_stalled.push_back(input);
+            return;
+        }
+    } else {
+        head.s_lastTimestamp = tstamp;
+    }
+
+    m_heap.push_back({key, input});
+    std::push_heap(m_heap.begin(), m_heap.end(),
+                   [](const HeapEntry& lhs, const HeapEntry& rhs) {
+        return laterThan(lhs.s_key, lhs.s_input, rhs.s_key, rhs.s_input);
+    });
+}
+
+//
+void CRingItemMerger::releaseBarrier()
+{
+    // every remaining input is stalled at a barrier item... let them all go
+    std::sort(m_stalled.begin(), m_stalled.end());
+    m_releasing.insert(m_releasing.end(), m_stalled.begin(), m_stalled.end());
+    m_stalled.clear();
+}
+
+} // end DAQ
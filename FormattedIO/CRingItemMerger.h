@@ -0,0 +1,165 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CRINGITEMMERGER_H
+#define DAQ_CRINGITEMMERGER_H
+
+#include <V12/CRawRingItem.h>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <vector>
+
+namespace DAQ {
+
+/*!
+ * \brief Timestamp ordered k-way merge of V12 item streams
+ *
+ * The merger keeps the next item (the head) of each input and a min-heap of
+ * their event timestamps. Each call to next() hands out the head with the
+ * smallest timestamp and then refills it from the same input. Item order
+ * within an input is always preserved. When two heads have the same
+ * timestamp, the one from the input added first wins.
+ *
+ * Only the header is interpreted. The body of each item is read once into the
+ * head and handed to the consumer by swapping buffers, so it is never copied
+ * or parsed by the merger.
+ *
+ * Items whose timestamp is V12::NULL_TIMESTAMP (e.g. state changes) are
+ * handled according to the NullTimestampPolicy:
+ *
+ * - Immediate       : the item is emitted as soon as it becomes the head of its
+ *                     input.
+ * - Barrier         : the input stalls at the item until every other input has
+ *                     either stalled at such an item or has been exhausted.
+ *                     All of the stalled items are then emitted in input
+ *                     order before any timestamped items. This keeps, for
+ *                     example, the begin run items of all sources together.
+ * - InheritPrevious : the item is ordered as though it had the timestamp of
+ *                     the preceding item from the same input.
+ *
+ * \code
+ * std::ifstream file0("run-0001-source0.evt", std::ios::binary);
+ * std::ifstream file1("run-0001-source1.evt", std::ios::binary);
+ * std::ofstream merged("run-0001-merged.evt", std::ios::binary);
+ *
+ * CRingItemMerger merger;
+ * merger.addInput(file0);
+ * merger.addInput(file1);
+ * merger.merge(merged);
+ * \endcode
+ */
+class CRingItemMerger
+{
+public:
+    enum NullTimestampPolicy {
+        Immediate,
+        Barrier,
+        InheritPrevious
+    };
+
+    /*!
+     * An input fills the item with the next item of the stream. It returns
+     * false when there are no more items.
+     */
+    typedef std::function<bool (V12::CRawRingItem&)> Input;
+
+    /*! An output receives the merged items in order */
+    typedef std::function<void (const V12::CRawRingItem&)> Output;
+
+private:
+    struct Head {
+        Input             s_input;
+        V12::CRawRingItem s_item;
+        std::uint64_t     s_lastTimestamp;
+        bool              s_valid;
+    };
+
+    struct HeapEntry {
+        std::uint64_t s_key;
+        std::size_t   s_input;
+    };
+
+    NullTimestampPolicy      m_policy;
+    std::vector<Head>        m_heads;
+    std::vector<HeapEntry>   m_heap;
+    std::vector<std::size_t> m_stalled;
+    std::deque<std::size_t>  m_releasing;
+    bool                     m_primed;
+
+public:
+    CRingItemMerger(NullTimestampPolicy policy = Barrier);
+
+    CRingItemMerger(const CRingItemMerger&) = delete;
+    CRingItemMerger& operator=(const CRingItemMerger&) = delete;
+
+    /*!
+     * \brief Add a stream of serialized V12 items as an input
+     *
+     * The stream must outlive the merger.
+     *
+     * \throws std::logic_error if the merge has already begun
+     */
+    void addInput(std::istream& stream);
+
+    /*!
+     * \brief Add a generic input
+     *
+     * \throws std::logic_error if the merge has already begun
+     */
+    void addInput(Input input);
+
+    std::size_t getInputCount() const { return m_heads.size(); }
+
+    void setNullTimestampPolicy(NullTimestampPolicy policy) { m_policy = policy; }
+    NullTimestampPolicy getNullTimestampPolicy() const { return m_policy; }
+
+    /*!
+     * \brief Retrieve the next item in timestamp order
+     *
+     * The previous contents of item are replaced (its body buffer is recycled
+     * by one of the inputs).
+     *
+     * \return false once all inputs are exhausted
+     */
+    bool next(V12::CRawRingItem& item);
+
+    /*!
+     * \brief Merge all inputs into a stream
+     *
+     * \return the number of items written
+     */
+    std::size_t merge(std::ostream& output);
+
+    /*!
+     * \brief Merge all inputs into an output functional
+     *
+     * \return the number of items passed to the output
+     */
+    std::size_t merge(const Output& output);
+
+private:
+    void prime();
+    void refill(std::size_t input);
+    void schedule(std::size_t input);
+    void releaseBarrier();
+};
+
+} // end DAQ
+
+#endif // DAQ_CRINGITEMMERGER_H
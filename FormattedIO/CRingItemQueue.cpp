@@ -0,0 +1,234 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CRingItemQueue.h"
+#include "CReadinessSignal.h"
+
+#include <V12/CRingItemParser.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace DAQ {
+
+// A size field of zero can never start a V12 item regardless of byte order, so
+// it marks the point at which the reader must wrap to the start of the storage.
+static const std::uint32_t WrapMarker = 0;
+static const std::size_t   Alignment  = sizeof(std::uint32_t);
+static const std::size_t   HeaderSize = 20;
+
+//
+CRingItemQueue::CRingItemQueue(std::size_t capacity)
+    : m_storage(storageSize(capacity)),
+      m_writeIndex(0),
+      m_readIndex(0),
+      m_closed(false),
+      m_signalMutex(),
+      m_pSignal(),
+      m_signalGeneration(0),
+      m_pendingSkip(0),
+      m_pWriterSignal(),
+      m_writerGeneration(0),
+      m_peekedSize(0)
+{
+    if (capacity < HeaderSize) {
+        throw std::invalid_argument("DAQ::CRingItemQueue::CRingItemQueue() capacity is smaller than a V12 header");
+    }
+}
+
+//
+std::uint8_t* CRingItemQueue::reserve(std::size_t nBytes)
+{
+    std::size_t nStored = storageSize(nBytes);
+    if (nBytes < HeaderSize || nStored > capacity()) {
+        std::string errmsg("DAQ::CRingItemQueue::reserve() cannot store an item of ");
+        errmsg += std::to_string(nBytes) + " bytes in a queue of capacity ";
+        errmsg += std::to_string(capacity());
+        throw std::invalid_argument(errmsg);
+    }
+
+    std::size_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+    std::size_t readIndex  = m_readIndex.load(std::memory_order_acquire);
+    std::size_t freeBytes  = capacity() - (writeIndex - readIndex);
+
+    std::size_t offset     = writeIndex % capacity();
+    std::size_t contiguous = capacity() - offset;
+
+    if (nStored <= contiguous) {
+        if (nStored > freeBytes) {
+            return nullptr;
+        }
+        m_pendingSkip = 0;
+        return m_storage.data() + offset;
+    }
+
+    // The item does not fit before the end of the storage. If the queue is
+    // empty, the reader is not looking at anything, so both indices can be
+    // moved to the start of the storage. The read index is stored first and
+    // the reader loads the write index first, so the reader never sees the
+    // new write index with the old read index.
+    if (writeIndex == readIndex) {
+        std::size_t start = writeIndex + contiguous;
+        m_readIndex.store(start, std::memory_order_relaxed);
+        m_writeIndex.store(start, std::memory_order_release);
+        m_pendingSkip = 0;
+        return m_storage.data();
+    }
+
+    // Otherwise the item goes at the beginning and the tail end is skipped.
+    // The items in the queue occupy the space just before the tail, so the
+    // item must fit in what is free after the tail.
+    if (contiguous > freeBytes || nStored > freeBytes - contiguous) {
+        return nullptr;
+    }
+
+    std::memcpy(m_storage.data() + offset, &WrapMarker, sizeof(WrapMarker));
+    m_pendingSkip = contiguous;
+
+    return m_storage.data();
+}
+
+//
+void CRingItemQueue::commit(std::size_t nBytes)
+{
+    std::size_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+    writeIndex += m_pendingSkip + storageSize(nBytes);
+    m_pendingSkip = 0;
+
+    m_writeIndex.store(writeIndex, std::memory_order_release);
+
+    notifyWriterSignal();
+}
+
+//
+const std::uint8_t* CRingItemQueue::peek(std::size_t& nBytes)
+{
+    // the write index must be loaded first, see reserve()
+    std::size_t writeIndex = m_writeIndex.load(std::memory_order_acquire);
+    std::size_t readIndex  = m_readIndex.load(std::memory_order_relaxed);
+
+    while (readIndex < writeIndex) {
+        std::size_t offset = readIndex % capacity();
+        const std::uint8_t* pItem = m_storage.data() + offset;
+
+        std::uint32_t sizeField;
+        std::memcpy(&sizeField, pItem, sizeof(sizeField));
+        if (sizeField == WrapMarker) {
+            readIndex += capacity() - offset;
+            m_readIndex.store(readIndex, std::memory_order_release);
+            continue;
+        }
+
+        std::uint32_t size, type;
+        bool swap;
+        V12::Parser::parseSizeAndType(pItem, pItem + HeaderSize, size, type, swap);
+
+        m_peekedSize = size;
+        nBytes       = size;
+        return pItem;
+    }
+
+    nBytes = 0;
+    return nullptr;
+}
+
+//
+void CRingItemQueue::release()
+{
+    if (m_peekedSize == 0) {
+        throw std::logic_error("DAQ::CRingItemQueue::release() called without a preceding successful peek()");
+    }
+
+    std::size_t readIndex = m_readIndex.load(std::memory_order_relaxed);
+    readIndex += storageSize(m_peekedSize);
+    m_peekedSize = 0;
+
+    m_readIndex.store(readIndex, std::memory_order_release);
+}
+
+//
+void CRingItemQueue::close()
+{
+    m_closed.store(true, std::memory_order_release);
+
+    // close() may be called from any thread, so it does not use the writer's copy
+    std::shared_ptr<CReadinessSignal> pSignal;
+    {
+        std::lock_guard<std::mutex> lock(m_signalMutex);
+        pSignal = m_pSignal;
+    }
+    if (pSignal) {
+        pSignal->notify();
+    }
+}
+
+//
+void CRingItemQueue::setReadinessSignal(std::shared_ptr<CReadinessSignal> pSignal)
+{
+    std::lock_guard<std::mutex> lock(m_signalMutex);
+    m_pSignal = std::move(pSignal);
+    m_signalGeneration.fetch_add(1, std::memory_order_release);
+}
+
+/*!
+ * \brief Notify the attached signal from the writer
+ *
+ * The writer keeps its own reference to the signal so that commit() only takes
+ * the lock when a different signal has been attached.
+ */
+void CRingItemQueue::notifyWriterSignal()
+{
+    if (m_signalGeneration.load(std::memory_order_acquire) != m_writerGeneration) {
+        std::lock_guard<std::mutex> lock(m_signalMutex);
+        m_pWriterSignal    = m_pSignal;
+        m_writerGeneration = m_signalGeneration.load(std::memory_order_relaxed);
+    }
+    if (m_pWriterSignal) {
+        m_pWriterSignal->notify();
+    }
+}
+
+//
+bool CRingItemQueue::isClosed() const
+{
+    return m_closed.load(std::memory_order_acquire);
+}
+
+//
+bool CRingItemQueue::empty() const
+{
+    return getUsedBytes() == 0;
+}
+
+//
+std::size_t CRingItemQueue::getUsedBytes() const
+{
+    std::size_t writeIndex = m_writeIndex.load(std::memory_order_acquire);
+    std::size_t readIndex  = m_readIndex.load(std::memory_order_acquire);
+
+    // the read index can pass the loaded write index when the writer moves
+    // both to the start of an empty queue
+    return (readIndex < writeIndex) ? writeIndex - readIndex : 0;
+}
+
+//
+std::size_t CRingItemQueue::storageSize(std::size_t nBytes)
+{
+    return ((nBytes + Alignment - 1)/Alignment)*Alignment;
+}
+
+} // end DAQ
@@ -0,0 +1,188 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CRINGITEMQUEUE_H
+#define DAQ_CRINGITEMQUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace DAQ {
+
+class CReadinessSignal;
+
+/*!
+ * \brief Lock-free single-producer/single-consumer queue of V12 ring items
+ *
+ * The queue is a circular byte buffer that stores V12 items in their wire
+ * format (20-byte header followed by the body) back to back. It is intended to
+ * connect two stages of a pipeline running in separate threads without
+ * copying items into intermediate objects or taking a lock.
+ *
+ * Exactly one thread may act as the writer and exactly one thread may act as
+ * the reader. The writer obtains space for an item with reserve(), fills it,
+ * and then publishes it with commit(). The reader obtains a pointer to the
+ * next item with peek(), and gives the space back with release() once it is
+ * done with the data. An item is always stored contiguously. When an item does
+ * not fit in the space remaining before the end of the storage, the writer
+ * leaves a wrap marker and the item is placed at the beginning. If the queue
+ * is empty at that point, the writer instead moves both indices to the
+ * beginning, so any item that fits in the capacity can always be written.
+ *
+ * The blocking readItem() and writeItem() overloads in RingIOV12.h accept a
+ * CRingItemQueue as a source or sink. A reader that should sleep rather than
+ * poll while the queue is empty can attach a CReadinessSignal, which the
+ * writer notifies on every commit() and on close().
+ *
+ * \code
+ * CRingItemQueue queue(1024*1024);
+ *
+ * // writer thread
+ * uint8_t* pItem = queue.reserve(itemSize);
+ * if (pItem) {
+ *   // ... fill in header and body ...
+ *   queue.commit(itemSize);
+ * }
+ *
+ * // reader thread
+ * std::size_t nBytes;
+ * const uint8_t* pItem = queue.peek(nBytes);
+ * if (pItem) {
+ *   // ... use the nBytes of the item ...
+ *   queue.release();
+ * }
+ * \endcode
+ */
+class CRingItemQueue
+{
+private:
+    static const std::size_t CacheLineSize = 64;
+
+    std::vector<std::uint8_t> m_storage;
+
+    // Both indices increase monotonically. Their value modulo the capacity
+    // locates the position in the storage. They are padded onto separate cache
+    // lines so that the producer and consumer do not contend. Padding is used
+    // instead of alignas because operator new ignores over-alignment in C++11.
+    std::atomic<std::size_t> m_writeIndex;
+    char                     m_writePadding[CacheLineSize - sizeof(std::atomic<std::size_t>)];
+    std::atomic<std::size_t> m_readIndex;
+    char                     m_readPadding[CacheLineSize - sizeof(std::atomic<std::size_t>)];
+    std::atomic<bool>        m_closed;
+
+    // the attached signal, which the writer picks up when the generation changes
+    std::mutex                        m_signalMutex;
+    std::shared_ptr<CReadinessSignal> m_pSignal;
+    std::atomic<unsigned>             m_signalGeneration;
+
+    // writer only state
+    std::size_t                       m_pendingSkip;
+    std::shared_ptr<CReadinessSignal> m_pWriterSignal;
+    unsigned                          m_writerGeneration;
+
+    // reader only state
+    std::size_t m_peekedSize;
+
+public:
+    /*!
+     * \brief Constructor
+     *
+     * \param capacity  number of bytes of storage. This is rounded up to a
+     *                  multiple of 4 bytes.
+     *
+     * \throws std::invalid_argument if capacity is smaller than a V12 header
+     */
+    explicit CRingItemQueue(std::size_t capacity);
+
+    CRingItemQueue(const CRingItemQueue&) = delete;
+    CRingItemQueue& operator=(const CRingItemQueue&) = delete;
+
+    /*!
+     * \brief Obtain contiguous space for an item (writer only)
+     *
+     * The space is not visible to the reader until commit() is called. Calling
+     * reserve() again without a commit() discards the previous reservation.
+     *
+     * \param nBytes  the size of the item, including its header
+     *
+     * \return pointer to the reserved space, or nullptr if the queue does not
+     *         currently have enough free space
+     *
+     * \throws std::invalid_argument if the item can never fit in the queue
+     */
+    std::uint8_t* reserve(std::size_t nBytes);
+
+    /*!
+     * \brief Publish the most recently reserved item (writer only)
+     *
+     * \param nBytes  the size of the item. This must be the same value that
+     *                was passed to reserve().
+     */
+    void commit(std::size_t nBytes);
+
+    /*!
+     * \brief Access the oldest item in the queue (reader only)
+     *
+     * \param nBytes  set to the size of the item in bytes
+     *
+     * \return pointer to the item, or nullptr if the queue is empty
+     */
+    const std::uint8_t* peek(std::size_t& nBytes);
+
+    /*!
+     * \brief Remove the item returned by the last peek() (reader only)
+     */
+    void release();
+
+    /*!
+     * \brief Indicate that the writer will not provide any more items
+     *
+     * Readers blocked in readItem() will return once the queue has drained.
+     */
+    void close();
+    bool isClosed() const;
+
+    /*!
+     * \brief Have the writer notify a signal when an item is committed or the
+     *        queue is closed
+     *
+     * The writer holds a reference to the signal it notifies, so the signal
+     * stays alive until the writer is done with it even if it is detached.
+     *
+     * \param pSignal  the signal, or nullptr to stop notifying
+     */
+    void setReadinessSignal(std::shared_ptr<CReadinessSignal> pSignal);
+
+    bool empty() const;
+    std::size_t capacity() const { return m_storage.size(); }
+
+    /*! \return the number of bytes in use, including padding and wrap markers */
+    std::size_t getUsedBytes() const;
+
+    /*! \return number of bytes an item occupies in the queue */
+    static std::size_t storageSize(std::size_t nBytes);
+
+private:
+    void notifyWriterSignal();
+};
+
+} // end DAQ
+
+#endif // DAQ_CRINGITEMQUEUE_H
@@ -0,0 +1,489 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CScalerExtractor.h"
+
+#include <V12/CRawRingItem.h>
+#include <V12/CRingItemParser.h>
+#include <V12/DataFormat.h>
+
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace DAQ {
+
+static const std::size_t HeaderSize = 20;
+
+// interval offsets, timestamp, divisor, count, incremental flag and width
+static const std::size_t ScalerBodyHeaderWords = 7;
+
+static const char          FileMagic[8] = {'D','A','Q','S','C','A','L','R'};
+static const std::uint32_t FileVersion  = 1;
+
+static inline std::uint32_t swap32(std::uint32_t value)
+{
+    return ((value >> 24) & 0x000000ff) | ((value >>  8) & 0x0000ff00)
+         | ((value <<  8) & 0x00ff0000) | ((value << 24) & 0xff000000);
+}
+
+template<class T>
+static void writeColumn(std::ostream& stream, const std::vector<T>& column)
+{
+    stream.write(reinterpret_cast<const char*>(column.data()), column.size()*sizeof(T));
+}
+
+template<class T>
+static void readColumn(std::istream& stream, std::vector<T>& column, std::size_t nRows)
+{
+    column.resize(nRows);
+    stream.read(reinterpret_cast<char*>(column.data()), nRows*sizeof(T));
+}
+
+template<class T>
+static void writeValue(std::ostream& stream, const T& value)
+{
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<class T>
+static T readValue(std::istream& stream)
+{
+    T value;
+    stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return value;
+}
+
+// the number of bytes after the current position, or the largest value if
+// the stream cannot seek
+static std::uint64_t remainingBytes(std::istream& stream)
+{
+    std::istream::pos_type pos = stream.tellg();
+    if (pos == std::istream::pos_type(-1)) {
+        stream.clear();
+        return std::numeric_limits<std::uint64_t>::max();
+    }
+
+    stream.seekg(0, std::ios::end);
+    std::istream::pos_type end = stream.tellg();
+    stream.seekg(pos);
+    if (end == std::istream::pos_type(-1) || !stream) {
+        stream.clear();
+        stream.seekg(pos);
+        return std::numeric_limits<std::uint64_t>::max();
+    }
+
+    return std::uint64_t(end - pos);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CScalerSeries
+
+//
+CScalerSeries::CScalerSeries(std::uint32_t sourceId, std::size_t nChannels)
+    : m_sourceId(sourceId),
+      m_startOffsets(),
+      m_endOffsets(),
+      m_divisors(),
+      m_timestamps(),
+      m_eventTimestamps(),
+      m_incremental(),
+      m_widths(),
+      m_values(nChannels),
+      m_incrementalRates(nChannels),
+      m_runningRates(nChannels),
+      m_totals(nChannels, 0)
+{}
+
+//
+void CScalerSeries::append(std::uint32_t startOffset, std::uint32_t endOffset,
+                           std::uint32_t divisor, std::uint32_t timestamp,
+                           std::uint64_t eventTimestamp, bool incremental,
+                           std::uint32_t width, const std::uint32_t* values,
+                           std::size_t nChannels)
+{
+    if (getRowCount() == 0 && nChannels != getChannelCount()) {
+        m_values.resize(nChannels);
+        m_incrementalRates.resize(nChannels);
+        m_runningRates.resize(nChannels);
+        m_totals.resize(nChannels, 0);
+    }
+
+    if (nChannels != getChannelCount()) {
+        std::string errmsg("DAQ::CScalerSeries::append() source ");
+        errmsg += std::to_string(m_sourceId) + " changed from ";
+        errmsg += std::to_string(getChannelCount()) + " to ";
+        errmsg += std::to_string(nChannels) + " scaler channels";
+        throw std::runtime_error(errmsg);
+    }
+
+    double seconds = 0;
+    double elapsed = 0;
+    if (divisor != 0) {
+        seconds = double(endOffset - startOffset)/divisor;
+        elapsed = double(endOffset)/divisor;
+    }
+
+    m_startOffsets.push_back(startOffset);
+    m_endOffsets.push_back(endOffset);
+    m_divisors.push_back(divisor);
+    m_timestamps.push_back(timestamp);
+    m_eventTimestamps.push_back(eventTimestamp);
+    m_incremental.push_back(incremental ? 1 : 0);
+    m_widths.push_back(width);
+
+    std::size_t row = getRowCount() - 1;
+    for (std::size_t i=0; i<nChannels; ++i) {
+        m_values[i].push_back(values[i]);
+
+        std::uint64_t counts = countsInInterval(i, row);
+        m_totals[i] += counts;
+
+        m_incrementalRates[i].push_back(seconds > 0 ? counts/seconds : 0);
+        m_runningRates[i].push_back(elapsed > 0 ? m_totals[i]/elapsed : 0);
+    }
+}
+
+//
+std::uint64_t CScalerSeries::countsInInterval(std::size_t channel, std::size_t row) const
+{
+    const std::vector<std::uint32_t>& values = m_values[channel];
+    if (m_incremental[row] || row == 0) {
+        return values[row];
+    }
+
+    // non-incremental scalers count since the start of the run and wrap
+    std::uint32_t width = m_widths[row];
+    std::uint64_t mask  = (width >= 32) ? 0xffffffffull : ((1ull << width) - 1);
+    return (std::uint64_t(values[row]) - values[row-1]) & mask;
+}
+
+//
+const std::vector<std::uint32_t>& CScalerSeries::getValues(std::size_t channel) const
+{
+    return m_values.at(channel);
+}
+
+//
+const std::vector<double>& CScalerSeries::getIncrementalRates(std::size_t channel) const
+{
+    return m_incrementalRates.at(channel);
+}
+
+//
+const std::vector<double>& CScalerSeries::getRunningRates(std::size_t channel) const
+{
+    return m_runningRates.at(channel);
+}
+
+//
+bool CScalerSeries::operator==(const CScalerSeries& rhs) const
+{
+    return (m_sourceId         == rhs.m_sourceId)
+        && (m_startOffsets     == rhs.m_startOffsets)
+        && (m_endOffsets       == rhs.m_endOffsets)
+        && (m_divisors         == rhs.m_divisors)
+        && (m_timestamps       == rhs.m_timestamps)
+        && (m_eventTimestamps  == rhs.m_eventTimestamps)
+        && (m_incremental      == rhs.m_incremental)
+        && (m_widths           == rhs.m_widths)
+        && (m_values           == rhs.m_values)
+        && (m_incrementalRates == rhs.m_incrementalRates)
+        && (m_runningRates     == rhs.m_runningRates);
+}
+
+//
+void CScalerSeries::write(std::ostream& stream) const
+{
+    writeValue(stream, m_sourceId);
+    writeValue(stream, std::uint32_t(getChannelCount()));
+    writeValue(stream, std::uint64_t(getRowCount()));
+
+    writeColumn(stream, m_startOffsets);
+    writeColumn(stream, m_endOffsets);
+    writeColumn(stream, m_divisors);
+    writeColumn(stream, m_timestamps);
+    writeColumn(stream, m_eventTimestamps);
+    writeColumn(stream, m_incremental);
+    writeColumn(stream, m_widths);
+    for (auto& column : m_values)           writeColumn(stream, column);
+    for (auto& column : m_incrementalRates) writeColumn(stream, column);
+    for (auto& column : m_runningRates)     writeColumn(stream, column);
+}
+
+//
+void CScalerSeries::read(std::istream& stream)
+{
+    m_sourceId = readValue<std::uint32_t>(stream);
+    std::size_t nChannels = readValue<std::uint32_t>(stream);
+    std::size_t nRows     = readValue<std::uint64_t>(stream);
+    if (!stream) {
+        throw std::runtime_error("DAQ::CScalerSeries::read() incomplete series header");
+    }
+
+    // The sizes come from the file... check them before allocating anything.
+    // The extractor only records series that have rows, so a channel count
+    // larger than the remaining data is corrupt even when there are no rows.
+    std::uint64_t rowSize = 5*sizeof(std::uint32_t) + sizeof(std::uint64_t) + sizeof(std::uint8_t)
+                          + std::uint64_t(nChannels)*(sizeof(std::uint32_t) + 2*sizeof(double));
+    std::uint64_t available = remainingBytes(stream);
+    if ((nRows > std::numeric_limits<std::uint64_t>::max()/rowSize)
+        || (nRows*rowSize > available)
+        || (nChannels > available)) {
+        std::string errmsg("DAQ::CScalerSeries::read() series of ");
+        errmsg += std::to_string(nRows) + " rows and " + std::to_string(nChannels);
+        errmsg += " channels does not fit in the data that remains";
+        throw std::runtime_error(errmsg);
+    }
+
+    m_values.resize(nChannels);
+    m_incrementalRates.resize(nChannels);
+    m_runningRates.resize(nChannels);
+
+    readColumn(stream, m_startOffsets, nRows);
+    readColumn(stream, m_endOffsets, nRows);
+    readColumn(stream, m_divisors, nRows);
+    readColumn(stream, m_timestamps, nRows);
+    readColumn(stream, m_eventTimestamps, nRows);
+    readColumn(stream, m_incremental, nRows);
+    readColumn(stream, m_widths, nRows);
+    for (auto& column : m_values)           readColumn(stream, column, nRows);
+    for (auto& column : m_incrementalRates) readColumn(stream, column, nRows);
+    for (auto& column : m_runningRates)     readColumn(stream, column, nRows);
+
+    if (!stream) {
+        throw std::runtime_error("DAQ::CScalerSeries::read() incomplete series data");
+    }
+
+    // rebuild the running totals so that more rows can be appended
+    m_totals.assign(nChannels, 0);
+    for (std::size_t i=0; i<nChannels; ++i) {
+        for (std::size_t row=0; row<nRows; ++row) {
+            m_totals[i] += countsInInterval(i, row);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CScalerExtractor
+
+//
+CScalerExtractor::CScalerExtractor()
+    : m_series(),
+      m_scratch(),
+      m_input()
+{}
+
+//
+std::size_t CScalerExtractor::addItem(const std::uint8_t* beg, const std::uint8_t* end)
+{
+    std::uint32_t size, type;
+    bool swap;
+    V12::Parser::parseSizeAndType(beg, end, size, type, swap);
+    if (size != std::size_t(end - beg)) {
+        std::string errmsg("DAQ::CScalerExtractor::addItem() item size (");
+        errmsg += std::to_string(size) + ") does not match the data provided (";
+        errmsg += std::to_string(end - beg) + ")";
+        throw std::runtime_error(errmsg);
+    }
+
+    return extract(beg, end);
+}
+
+//
+std::size_t CScalerExtractor::addItem(const V12::CRawRingItem& item)
+{
+    if (item.type() != V12::PERIODIC_SCALERS
+        && item.type() != V12::COMP_PERIODIC_SCALERS) {
+        return 0;
+    }
+
+    auto& body = item.getBody();
+    m_input.resize(HeaderSize + body.size());
+    V12::serializeHeader(item, m_input.begin());
+    std::copy(body.begin(), body.end(), m_input.begin() + HeaderSize);
+
+    return extract(m_input.data(), m_input.data() + m_input.size());
+}
+
+//
+std::size_t CScalerExtractor::process(std::istream& stream)
+{
+    std::size_t nScalers = 0;
+    std::uint8_t header[HeaderSize];
+
+    while (stream.read(reinterpret_cast<char*>(header), HeaderSize)) {
+        std::uint32_t size, type;
+        bool swap;
+        V12::Parser::parseSizeAndType(header, header+HeaderSize, size, type, swap);
+        if (size < HeaderSize) {
+            throw std::runtime_error("DAQ::CScalerExtractor::process() Encountered item with fewer than 20 bytes in size field.");
+        }
+
+        if (type != V12::PERIODIC_SCALERS && type != V12::COMP_PERIODIC_SCALERS) {
+            // skip the body without decoding it
+            stream.ignore(size - HeaderSize);
+            if (stream.gcount() != std::streamsize(size - HeaderSize)) {
+                throw std::runtime_error("DAQ::CScalerExtractor::process() stream ended with an incomplete item");
+            }
+            continue;
+        }
+
+        m_input.resize(size);
+        std::memcpy(m_input.data(), header, HeaderSize);
+        stream.read(reinterpret_cast<char*>(m_input.data()) + HeaderSize, size - HeaderSize);
+        if (!stream) {
+            throw std::runtime_error("DAQ::CScalerExtractor::process() stream ended with an incomplete item");
+        }
+
+        nScalers += extract(m_input.data(), m_input.data() + size);
+    }
+
+    if (stream.gcount() != 0) {
+        throw std::runtime_error("DAQ::CScalerExtractor::process() stream ended with an incomplete item");
+    }
+
+    return nScalers;
+}
+
+//
+const CScalerSeries& CScalerExtractor::getSeries(std::uint32_t sourceId) const
+{
+    auto it = m_series.find(sourceId);
+    if (it == m_series.end()) {
+        std::string errmsg("DAQ::CScalerExtractor::getSeries() no scalers from source ");
+        errmsg += std::to_string(sourceId);
+        throw std::out_of_range(errmsg);
+    }
+    return it->second;
+}
+
+//
+void CScalerExtractor::write(std::ostream& stream) const
+{
+    stream.write(FileMagic, sizeof(FileMagic));
+    writeValue(stream, std::uint32_t(0x01020304));
+    writeValue(stream, FileVersion);
+    writeValue(stream, std::uint32_t(m_series.size()));
+
+    for (auto& series : m_series) {
+        series.second.write(stream);
+    }
+}
+
+//
+void CScalerExtractor::read(std::istream& stream)
+{
+    char magic[sizeof(FileMagic)];
+    stream.read(magic, sizeof(magic));
+    std::uint32_t bom      = readValue<std::uint32_t>(stream);
+    std::uint32_t version  = readValue<std::uint32_t>(stream);
+    std::uint32_t nSeries  = readValue<std::uint32_t>(stream);
+
+    if (!stream || std::memcmp(magic, FileMagic, sizeof(magic)) != 0) {
+        throw std::runtime_error("DAQ::CScalerExtractor::read() data is not a scaler columnar file");
+    }
+    if (bom != 0x01020304) {
+        throw std::runtime_error("DAQ::CScalerExtractor::read() file is not in native byte order");
+    }
+    if (version != FileVersion) {
+        throw std::runtime_error("DAQ::CScalerExtractor::read() unsupported file version "
+                                 + std::to_string(version));
+    }
+
+    m_series.clear();
+    for (std::uint32_t i=0; i<nSeries; ++i) {
+        CScalerSeries series;
+        series.read(stream);
+        m_series[series.getSourceId()] = std::move(series);
+    }
+}
+
+//
+std::size_t CScalerExtractor::extract(const std::uint8_t* beg, const std::uint8_t* end)
+{
+    std::uint32_t size, type, sourceId;
+    std::uint64_t tstamp;
+    bool swap;
+    V12::Parser::parseHeader(beg, end, size, type, tstamp, sourceId, swap);
+
+    if (type == V12::PERIODIC_SCALERS) {
+        extractScalers(beg + HeaderSize, beg + size, tstamp, sourceId, swap);
+        return 1;
+    }
+
+    if (type != V12::COMP_PERIODIC_SCALERS) {
+        return 0;
+    }
+
+    std::size_t nScalers = 0;
+    const std::uint8_t* pos = beg + HeaderSize;
+    end = beg + size;
+    while (pos < end) {
+        std::uint32_t childSize, childType;
+        bool childSwap;
+        V12::Parser::parseSizeAndType(pos, end, childSize, childType, childSwap);
+        if (childSize < HeaderSize || childSize > std::size_t(end - pos)) {
+            throw std::runtime_error("DAQ::CScalerExtractor composite item has a child with a bad size");
+        }
+        nScalers += extract(pos, pos + childSize);
+        pos += childSize;
+    }
+    return nScalers;
+}
+
+//
+void CScalerExtractor::extractScalers(const std::uint8_t* beg, const std::uint8_t* end,
+                                      std::uint64_t tstamp, std::uint32_t sourceId,
+                                      bool swap)
+{
+    std::size_t nWords = (end - beg)/sizeof(std::uint32_t);
+    if (nWords < ScalerBodyHeaderWords) {
+        throw std::runtime_error("DAQ::CScalerExtractor scaler item body is too small");
+    }
+
+    // one bulk copy of the whole body, then swap in place if needed
+    m_scratch.resize(nWords);
+    std::memcpy(m_scratch.data(), beg, nWords*sizeof(std::uint32_t));
+    if (swap) {
+        for (auto& word : m_scratch) {
+            word = swap32(word);
+        }
+    }
+
+    const std::uint32_t* pBody = m_scratch.data();
+    std::uint32_t nScalers = pBody[4];
+    if (nScalers > nWords - ScalerBodyHeaderWords) {
+        throw std::runtime_error("DAQ::CScalerExtractor scaler count exceeds the size of the item");
+    }
+    if (pBody[5] > 1) {
+        throw std::runtime_error("DAQ::CScalerExtractor bad value for is incremental field");
+    }
+
+    auto it = m_series.find(sourceId);
+    if (it == m_series.end()) {
+        it = m_series.insert(std::make_pair(sourceId, CScalerSeries(sourceId, nScalers))).first;
+    }
+
+    it->second.append(pBody[0], pBody[1], pBody[3], pBody[2], tstamp,
+                      pBody[5] == 1, pBody[6],
+                      pBody + ScalerBodyHeaderWords, nScalers);
+}
+
+} // end DAQ
@@ -0,0 +1,219 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CSCALEREXTRACTOR_H
+#define DAQ_CSCALEREXTRACTOR_H
+
+#include <ByteBuffer.h>
+
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <vector>
+
+namespace DAQ {
+
+namespace V12 {
+    class CRawRingItem;
+}
+
+/*!
+ * \brief Columnar time series of the scaler readings of one data source
+ *
+ * Each scaler item appended to the series adds one row. The row data
+ * (interval offsets, timestamps, etc.) are each stored in their own array, as
+ * are the values of each channel. In addition to the raw values, two rates are
+ * computed for every channel:
+ *
+ * - The incremental rate is the number of counts in the interval divided by
+ *   the length of the interval in seconds.
+ * - The running rate is the total number of counts since the beginning of the
+ *   run divided by the end offset of the interval in seconds.
+ *
+ * For non-incremental scalers the counts in an interval are the difference
+ * with the previous reading, modulo the width of the scaler. Rates of
+ * intervals with zero length are 0.
+ */
+class CScalerSeries
+{
+private:
+    std::uint32_t                        m_sourceId;
+    std::vector<std::uint32_t>           m_startOffsets;
+    std::vector<std::uint32_t>           m_endOffsets;
+    std::vector<std::uint32_t>           m_divisors;
+    std::vector<std::uint32_t>           m_timestamps;
+    std::vector<std::uint64_t>           m_eventTimestamps;
+    std::vector<std::uint8_t>            m_incremental;
+    std::vector<std::uint32_t>           m_widths;
+    std::vector<std::vector<std::uint32_t> > m_values;
+    std::vector<std::vector<double> >    m_incrementalRates;
+    std::vector<std::vector<double> >    m_runningRates;
+
+    // state carried from row to row for the rate computation
+    std::vector<std::uint64_t>           m_totals;
+
+public:
+    explicit CScalerSeries(std::uint32_t sourceId = 0, std::size_t nChannels = 0);
+
+    /*!
+     * \brief Append one scaler reading
+     *
+     * \param startOffset   interval start offset in units of 1/divisor seconds
+     * \param endOffset     interval end offset in units of 1/divisor seconds
+     * \param divisor       the time offset divisor
+     * \param timestamp     unix time of the reading
+     * \param eventTimestamp the event timestamp of the item
+     * \param incremental   whether the scalers were cleared after the last read
+     * \param width         number of significant bits in each scaler
+     * \param values        pointer to the first of the scaler values
+     *
+     * \throws std::runtime_error if the number of channels differs from the
+     *                            number in previous rows
+     */
+    void append(std::uint32_t startOffset, std::uint32_t endOffset,
+                std::uint32_t divisor, std::uint32_t timestamp,
+                std::uint64_t eventTimestamp, bool incremental,
+                std::uint32_t width, const std::uint32_t* values,
+                std::size_t nChannels);
+
+    std::uint32_t getSourceId() const { return m_sourceId; }
+    std::size_t   getRowCount() const { return m_startOffsets.size(); }
+    std::size_t   getChannelCount() const { return m_values.size(); }
+
+    const std::vector<std::uint32_t>& getStartOffsets() const { return m_startOffsets; }
+    const std::vector<std::uint32_t>& getEndOffsets() const { return m_endOffsets; }
+    const std::vector<std::uint32_t>& getDivisors() const { return m_divisors; }
+    const std::vector<std::uint32_t>& getTimestamps() const { return m_timestamps; }
+    const std::vector<std::uint64_t>& getEventTimestamps() const { return m_eventTimestamps; }
+    const std::vector<std::uint8_t>&  getIncrementalFlags() const { return m_incremental; }
+    const std::vector<std::uint32_t>& getWidths() const { return m_widths; }
+
+    const std::vector<std::uint32_t>& getValues(std::size_t channel) const;
+    const std::vector<double>& getIncrementalRates(std::size_t channel) const;
+    const std::vector<double>& getRunningRates(std::size_t channel) const;
+
+    bool operator==(const CScalerSeries& rhs) const;
+    bool operator!=(const CScalerSeries& rhs) const { return !(*this == rhs); }
+
+    /*! \brief Write the columns of the series (see CScalerExtractor::write()) */
+    void write(std::ostream& stream) const;
+
+    /*! \brief Read the columns of a series written by write() */
+    void read(std::istream& stream);
+
+private:
+    std::uint64_t countsInInterval(std::size_t channel, std::size_t row) const;
+};
+
+
+/*!
+ * \brief Extracts the scaler readings of a V12 run into columnar series
+ *
+ * The extractor scans a stream of V12 items and decodes the body of every
+ * PERIODIC_SCALERS item directly from its wire format. The scalers are copied
+ * (and byte swapped if needed) in bulk and appended to the series of the item's
+ * source id. Scaler items found inside composites are extracted as well.
+ * Everything else is skipped without being decoded.
+ *
+ * The series can be written to a compact binary file in which each column is
+ * stored contiguously:
+ *
+ * \verbatim
+ *   char[8]   "DAQSCALR"
+ *   uint32    0x01020304 (byte order mark, the file is in native byte order)
+ *   uint32    format version (1)
+ *   uint32    number of series
+ *   for each series:
+ *     uint32    source id
+ *     uint32    number of channels (C)
+ *     uint64    number of rows (R)
+ *     uint32[R] start offsets, end offsets, divisors, unix timestamps
+ *     uint64[R] event timestamps
+ *     uint8[R]  incremental flags
+ *     uint32[R] scaler widths
+ *     for each channel: uint32[R] values
+ *     for each channel: double[R] incremental rates
+ *     for each channel: double[R] running rates
+ * \endverbatim
+ *
+ * \code
+ * std::ifstream input("run-0012-00.evt", std::ios::binary);
+ * std::ofstream output("run-0012-scalers.bin", std::ios::binary);
+ *
+ * CScalerExtractor extractor;
+ * extractor.process(input);
+ * extractor.write(output);
+ * \endcode
+ */
+class CScalerExtractor
+{
+private:
+    std::map<std::uint32_t, CScalerSeries> m_series;
+    std::vector<std::uint32_t>             m_scratch;
+    Buffer::ByteBuffer                     m_input;
+
+public:
+    CScalerExtractor();
+
+    /*!
+     * \brief Add an item in wire format
+     *
+     * \return the number of scaler items extracted from the item
+     *
+     * \throws std::runtime_error if a scaler item is malformed
+     */
+    std::size_t addItem(const std::uint8_t* beg, const std::uint8_t* end);
+
+    /*! \brief Add an item */
+    std::size_t addItem(const V12::CRawRingItem& item);
+
+    /*!
+     * \brief Process every item of a stream
+     *
+     * \return the number of scaler items extracted
+     *
+     * \throws std::runtime_error if the stream ends with an incomplete item
+     */
+    std::size_t process(std::istream& stream);
+
+    const std::map<std::uint32_t, CScalerSeries>& getSeries() const { return m_series; }
+
+    /*!
+     * \throws std::out_of_range if there are no scalers from the source
+     */
+    const CScalerSeries& getSeries(std::uint32_t sourceId) const;
+
+    void clear() { m_series.clear(); }
+
+    /*! \brief Write all series in the binary columnar format */
+    void write(std::ostream& stream) const;
+
+    /*!
+     * \brief Replace the series with those of a binary columnar file
+     *
+     * \throws std::runtime_error if the data is not a valid columnar file
+     */
+    void read(std::istream& stream);
+
+private:
+    std::size_t extract(const std::uint8_t* beg, const std::uint8_t* end);
+    void extractScalers(const std::uint8_t* beg, const std::uint8_t* end,
+                        std::uint64_t tstamp, std::uint32_t sourceId, bool swap);
+};
+
+} // end DAQ
+
+#endif // DAQ_CSCALEREXTRACTOR_H
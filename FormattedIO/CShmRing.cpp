@@ -0,0 +1,545 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CShmRing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace DAQ {
+
+static const std::uint32_t ShmRingMagic   = 0x52494e47; // "RING"
+static const std::uint32_t ShmRingVersion = 2;
+
+// consumer slot states
+static const std::uint32_t SlotFree     = 0;
+static const std::uint32_t SlotClaiming = 1;
+static const std::uint32_t SlotActive   = 2;
+
+/*
+ * The layout of the segment is :
+ *
+ *   CShmRingHeader | CShmRingConsumerSlot x maxConsumers | data (capacity bytes)
+ *
+ * The indices are absolute byte counts since the creation of the ring. Their
+ * value modulo the capacity locates a byte in the data region.
+ */
+struct CShmRingHeader {
+    std::uint32_t s_magic;
+    std::uint32_t s_version;
+    std::uint64_t s_capacity;
+    std::uint32_t s_maxConsumers;
+
+    alignas(64) std::atomic<std::uint64_t> s_writeIndex;
+    alignas(64) std::atomic<std::uint32_t> s_producerAttached;
+                std::atomic<std::uint32_t> s_producerClosed;
+};
+
+struct CShmRingConsumerSlot {
+    alignas(64) std::atomic<std::uint32_t> s_state;
+                std::atomic<std::int32_t>  s_pid;          // of the consumer process
+                std::atomic<std::uint64_t> s_readIndex;
+};
+
+
+static std::string errnoMessage(const std::string& where, const std::string& name)
+{
+    std::string errmsg("DAQ::CShmRing::");
+    errmsg += where + "() failed for ring '" + name + "' : ";
+    errmsg += std::strerror(errno);
+    return errmsg;
+}
+
+static std::size_t roundUpToPowerOf2(std::size_t value)
+{
+    std::size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+// spin briefly before handing the cpu back to the scheduler
+static void backoff(unsigned& nTries)
+{
+    if (nTries < 100) {
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    ++nTries;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CShmRing
+
+//
+void CShmRing::create(const std::string& name, std::size_t capacity,
+                      unsigned maxConsumers)
+{
+    if (capacity == 0 || maxConsumers == 0) {
+        throw std::invalid_argument("DAQ::CShmRing::create() capacity and consumer count must be nonzero");
+    }
+
+    capacity = roundUpToPowerOf2(capacity);
+    std::size_t size = segmentSize(capacity, maxConsumers);
+
+    int fd = shm_open(segmentName(name).c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+    if (fd < 0) {
+        throw std::runtime_error(errnoMessage("create", name));
+    }
+
+    if (ftruncate(fd, size) < 0) {
+        std::string errmsg = errnoMessage("create", name);
+        close(fd);
+        shm_unlink(segmentName(name).c_str());
+        throw std::runtime_error(errmsg);
+    }
+
+    void* pMapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pMapping == MAP_FAILED) {
+        std::string errmsg = errnoMessage("create", name);
+        shm_unlink(segmentName(name).c_str());
+        throw std::runtime_error(errmsg);
+    }
+
+    auto pHeader = new(pMapping) CShmRingHeader;
+    pHeader->s_version      = ShmRingVersion;
+    pHeader->s_capacity     = capacity;
+    pHeader->s_maxConsumers = maxConsumers;
+    pHeader->s_writeIndex.store(0);
+    pHeader->s_producerAttached.store(0);
+    pHeader->s_producerClosed.store(0);
+
+    auto pSlots = reinterpret_cast<std::uint8_t*>(pMapping) + sizeof(CShmRingHeader);
+    for (unsigned i=0; i<maxConsumers; ++i) {
+        auto pSlot = new(pSlots + i*sizeof(CShmRingConsumerSlot)) CShmRingConsumerSlot;
+        pSlot->s_state.store(SlotFree);
+        pSlot->s_pid.store(0);
+        pSlot->s_readIndex.store(0);
+    }
+
+    // the magic is written last so that a partially initialized segment is
+    // never mistaken for a ring
+    std::atomic_thread_fence(std::memory_order_release);
+    pHeader->s_magic = ShmRingMagic;
+
+    munmap(pMapping, size);
+}
+
+//
+void CShmRing::remove(const std::string& name)
+{
+    if (shm_unlink(segmentName(name).c_str()) < 0) {
+        throw std::runtime_error(errnoMessage("remove", name));
+    }
+}
+
+//
+bool CShmRing::exists(const std::string& name)
+{
+    int fd = shm_open(segmentName(name).c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    close(fd);
+    return true;
+}
+
+//
+CShmRing::CShmRing(const std::string& name)
+    : m_name(name), m_pMapping(nullptr), m_mappingSize(0),
+      m_pHeader(nullptr), m_pData(nullptr)
+{
+    int fd = shm_open(segmentName(name).c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        throw std::runtime_error(errnoMessage("CShmRing", name));
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        std::string errmsg = errnoMessage("CShmRing", name);
+        close(fd);
+        throw std::runtime_error(errmsg);
+    }
+
+    m_mappingSize = info.st_size;
+    m_pMapping = mmap(nullptr, m_mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m_pMapping == MAP_FAILED) {
+        throw std::runtime_error(errnoMessage("CShmRing", name));
+    }
+
+    m_pHeader = reinterpret_cast<CShmRingHeader*>(m_pMapping);
+    if ((m_mappingSize < sizeof(CShmRingHeader))
+        || (m_pHeader->s_magic != ShmRingMagic)
+        || (m_pHeader->s_version != ShmRingVersion)
+        || (m_mappingSize != segmentSize(m_pHeader->s_capacity, m_pHeader->s_maxConsumers))) {
+        munmap(m_pMapping, m_mappingSize);
+        throw std::runtime_error("DAQ::CShmRing::CShmRing() '" + name + "' is not a valid shared memory ring");
+    }
+
+    m_pData = reinterpret_cast<std::uint8_t*>(m_pMapping)
+              + segmentSize(0, m_pHeader->s_maxConsumers);
+}
+
+//
+CShmRing::~CShmRing()
+{
+    munmap(m_pMapping, m_mappingSize);
+}
+
+//
+std::size_t CShmRing::capacity() const
+{
+    return m_pHeader->s_capacity;
+}
+
+//
+unsigned CShmRing::getMaxConsumers() const
+{
+    return m_pHeader->s_maxConsumers;
+}
+
+//
+std::uint64_t CShmRing::getWriteIndex() const
+{
+    return m_pHeader->s_writeIndex.load(std::memory_order_acquire);
+}
+
+//
+void CShmRing::setWriteIndex(std::uint64_t index)
+{
+    m_pHeader->s_writeIndex.store(index, std::memory_order_release);
+}
+
+//
+std::uint64_t CShmRing::getMinimumReadIndex() const
+{
+    std::uint64_t minimum = getWriteIndex();
+    for (unsigned i=0; i<getMaxConsumers(); ++i) {
+        auto pSlot = slot(i);
+        if (pSlot->s_state.load() == SlotActive) {
+            minimum = std::min<std::uint64_t>(minimum, pSlot->s_readIndex.load());
+        }
+    }
+    return minimum;
+}
+
+//
+bool CShmRing::claimProducer()
+{
+    std::uint32_t expected = 0;
+    bool claimed = m_pHeader->s_producerAttached.compare_exchange_strong(expected, 1);
+    if (claimed) {
+        m_pHeader->s_producerClosed.store(0);
+    }
+    return claimed;
+}
+
+//
+void CShmRing::releaseProducer()
+{
+    m_pHeader->s_producerAttached.store(0);
+}
+
+//
+bool CShmRing::isProducerClosed() const
+{
+    return (m_pHeader->s_producerClosed.load() != 0);
+}
+
+//
+void CShmRing::setProducerClosed(bool closed)
+{
+    m_pHeader->s_producerClosed.store(closed ? 1 : 0);
+}
+
+//
+CShmRingConsumerSlot* CShmRing::claimConsumer()
+{
+    for (unsigned i=0; i<getMaxConsumers(); ++i) {
+        auto pSlot = slot(i);
+        std::uint32_t expected = SlotFree;
+        if (pSlot->s_state.compare_exchange_strong(expected, SlotClaiming)) {
+
+            // The producer ignores the slot until it is active. Once it is
+            // active, the cursor is moved to the newest data because the
+            // producer may have advanced while the slot was being claimed.
+            pSlot->s_pid.store(getpid());
+            pSlot->s_readIndex.store(getWriteIndex());
+            pSlot->s_state.store(SlotActive);
+            pSlot->s_readIndex.store(getWriteIndex());
+            return pSlot;
+        }
+    }
+    return nullptr;
+}
+
+//
+void CShmRing::releaseConsumer(CShmRingConsumerSlot* pSlot)
+{
+    pSlot->s_state.store(SlotFree);
+}
+
+//
+unsigned CShmRing::releaseDeadConsumers()
+{
+    unsigned nReleased = 0;
+    for (unsigned i=0; i<getMaxConsumers(); ++i) {
+        auto pSlot = slot(i);
+        if (pSlot->s_state.load() != SlotActive) {
+            continue;
+        }
+
+        pid_t pid = pSlot->s_pid.load();
+        if ((kill(pid, 0) < 0) && (errno == ESRCH)) {
+            std::uint32_t expected = SlotActive;
+            if (pSlot->s_state.compare_exchange_strong(expected, SlotFree)) {
+                ++nReleased;
+            }
+        }
+    }
+    return nReleased;
+}
+
+//
+std::uint64_t CShmRing::getReadIndex(const CShmRingConsumerSlot* pSlot) const
+{
+    return pSlot->s_readIndex.load(std::memory_order_acquire);
+}
+
+//
+void CShmRing::setReadIndex(CShmRingConsumerSlot* pSlot, std::uint64_t index)
+{
+    pSlot->s_readIndex.store(index, std::memory_order_release);
+}
+
+//
+void CShmRing::copyIn(std::uint64_t index, const void* pData, std::size_t nBytes)
+{
+    std::size_t offset = index & (capacity()-1);
+    std::size_t first  = std::min(nBytes, capacity() - offset);
+
+    auto pBytes = reinterpret_cast<const std::uint8_t*>(pData);
+    std::memcpy(m_pData + offset, pBytes, first);
+    std::memcpy(m_pData, pBytes + first, nBytes - first);
+}
+
+//
+void CShmRing::copyOut(std::uint64_t index, void* pData, std::size_t nBytes) const
+{
+    std::size_t offset = index & (capacity()-1);
+    std::size_t first  = std::min(nBytes, capacity() - offset);
+
+    auto pBytes = reinterpret_cast<std::uint8_t*>(pData);
+    std::memcpy(pBytes, m_pData + offset, first);
+    std::memcpy(pBytes + first, m_pData, nBytes - first);
+}
+
+//
+const std::uint8_t* CShmRing::dataAt(std::uint64_t index, std::size_t& nContiguous) const
+{
+    std::size_t offset = index & (capacity()-1);
+    nContiguous = capacity() - offset;
+    return m_pData + offset;
+}
+
+//
+std::string CShmRing::segmentName(const std::string& name)
+{
+    return "/" + name;
+}
+
+//
+std::size_t CShmRing::segmentSize(std::size_t capacity, unsigned maxConsumers)
+{
+    return sizeof(CShmRingHeader) + maxConsumers*sizeof(CShmRingConsumerSlot) + capacity;
+}
+
+//
+CShmRingConsumerSlot* CShmRing::slot(unsigned index) const
+{
+    auto pSlots = reinterpret_cast<std::uint8_t*>(m_pMapping) + sizeof(CShmRingHeader);
+    return reinterpret_cast<CShmRingConsumerSlot*>(pSlots + index*sizeof(CShmRingConsumerSlot));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+// CShmRingSink
+
+//
+CShmRingSink::CShmRingSink(const std::string& name)
+    : m_ring(name)
+{
+    if (! m_ring.claimProducer()) {
+        throw std::runtime_error("DAQ::CShmRingSink::CShmRingSink() ring '" + name + "' already has a producer");
+    }
+}
+
+//
+CShmRingSink::~CShmRingSink()
+{
+    m_ring.setProducerClosed(true);
+    m_ring.releaseProducer();
+}
+
+//
+void CShmRingSink::put(const void* pData, std::size_t nBytes)
+{
+    waitForSpace(nBytes);
+
+    std::uint64_t writeIndex = m_ring.getWriteIndex();
+    m_ring.copyIn(writeIndex, pData, nBytes);
+    m_ring.setWriteIndex(writeIndex + nBytes);
+}
+
+//
+void CShmRingSink::putv(const std::initializer_list<std::pair<const void*, std::size_t> >& parts)
+{
+    std::size_t total = 0;
+    for (auto& part : parts) {
+        total += part.second;
+    }
+
+    waitForSpace(total);
+
+    std::uint64_t writeIndex = m_ring.getWriteIndex();
+    std::uint64_t index = writeIndex;
+    for (auto& part : parts) {
+        m_ring.copyIn(index, part.first, part.second);
+        index += part.second;
+    }
+    m_ring.setWriteIndex(index);
+}
+
+//
+std::size_t CShmRingSink::freeSpace() const
+{
+    std::uint64_t used = m_ring.getWriteIndex() - m_ring.getMinimumReadIndex();
+
+    // a consumer that is in the middle of attaching can briefly report a
+    // stale cursor... treat the ring as full until it settles
+    if (used > m_ring.capacity()) {
+        return 0;
+    }
+    return m_ring.capacity() - used;
+}
+
+//
+void CShmRingSink::waitForSpace(std::size_t nBytes)
+{
+    if (nBytes > m_ring.capacity()) {
+        throw std::invalid_argument("DAQ::CShmRingSink::put() data is larger than the ring capacity");
+    }
+
+    // a consumer process that died without detaching would hold the
+    // producer back forever... look for dead consumers while waiting
+    unsigned nTries = 0;
+    while (freeSpace() < nBytes) {
+        backoff(nTries);
+        if (nTries % 1000 == 0) {
+            m_ring.releaseDeadConsumers();
+        }
+    }
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+// CShmRingSource
+
+//
+CShmRingSource::CShmRingSource(const std::string& name)
+    : m_ring(name), m_pSlot(m_ring.claimConsumer())
+{
+    if (! m_pSlot) {
+        throw std::runtime_error("DAQ::CShmRingSource::CShmRingSource() ring '" + name + "' has no free consumer slots");
+    }
+}
+
+//
+CShmRingSource::~CShmRingSource()
+{
+    m_ring.releaseConsumer(m_pSlot);
+}
+
+//
+std::size_t CShmRingSource::availableData() const
+{
+    return m_ring.getWriteIndex() - m_ring.getReadIndex(m_pSlot);
+}
+
+//
+std::size_t CShmRingSource::peek(void* pBuffer, std::size_t nBytes)
+{
+    nBytes = std::min(nBytes, availableData());
+    m_ring.copyOut(m_ring.getReadIndex(m_pSlot), pBuffer, nBytes);
+    return nBytes;
+}
+
+//
+const std::uint8_t* CShmRingSource::data(std::size_t& nBytes) const
+{
+    std::uint64_t readIndex = m_ring.getReadIndex(m_pSlot);
+    std::size_t available = m_ring.getWriteIndex() - readIndex;
+
+    const std::uint8_t* pData = m_ring.dataAt(readIndex, nBytes);
+    nBytes = std::min(nBytes, available);
+    return pData;
+}
+
+//
+void CShmRingSource::ignore(std::size_t nBytes)
+{
+    nBytes = std::min(nBytes, availableData());
+    m_ring.setReadIndex(m_pSlot, m_ring.getReadIndex(m_pSlot) + nBytes);
+}
+
+//
+std::size_t CShmRingSource::read(void* pBuffer, std::size_t nBytes)
+{
+    unsigned nTries = 0;
+    while (availableData() < nBytes && !m_ring.isProducerClosed()) {
+        backoff(nTries);
+    }
+
+    nBytes = peek(pBuffer, nBytes);
+    ignore(nBytes);
+    return nBytes;
+}
+
+//
+bool CShmRingSource::eof() const
+{
+    // closed must be observed before the final check for data
+    bool closed = m_ring.isProducerClosed();
+    return closed && (availableData() == 0);
+}
+
+} // end DAQ
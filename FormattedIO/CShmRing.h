@@ -0,0 +1,255 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CSHMRING_H
+#define DAQ_CSHMRING_H
+
+#include <cstdint>
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <utility>
+
+namespace DAQ {
+
+struct CShmRingHeader;
+struct CShmRingConsumerSlot;
+
+/*!
+ * \brief A POSIX shared memory ring buffer
+ *
+ * The CShmRing is a byte stream ring buffer that lives in a POSIX shared
+ * memory segment. It has one producer and up to a fixed number of consumers.
+ * Every consumer owns its own cursor, so each one sees every byte that the
+ * producer writes after the consumer attaches. The producer is throttled by
+ * the slowest attached consumer.
+ *
+ * All bookkeeping is done with lock-free atomics that live in the segment, so
+ * producers and consumers may be in different processes.
+ *
+ * This class only manages the segment. Data is moved through it by a
+ * CShmRingSink (the producer) and CShmRingSource (a consumer). Those provide
+ * the same put()/peek()/ignore()/read()/availableData()/eof() operations as
+ * the NSCLDAQ CDataSink and CDataSource, which lets the readItem(),
+ * readItemIf() and writeItem() functions in RingIOV12.h be used in standalone
+ * builds.
+ *
+ * Each consumer slot records the process that claimed it. A producer that is
+ * blocked by a full ring releases the slots of consumer processes that no
+ * longer exist, so a consumer that crashes does not stall the producer.
+ *
+ * \code
+ * CShmRing::create("myring", 1024*1024);
+ *
+ * // producer process
+ * CShmRingSink sink("myring");
+ * writeItem(sink, item);
+ *
+ * // consumer process
+ * CShmRingSource source("myring");
+ * readItem(source, item, std::chrono::seconds(1));
+ * \endcode
+ */
+class CShmRing
+{
+private:
+    std::string           m_name;
+    void*                 m_pMapping;
+    std::size_t           m_mappingSize;
+    CShmRingHeader*       m_pHeader;
+    std::uint8_t*         m_pData;
+
+public:
+    /*!
+     * \brief Create a new shared memory ring
+     *
+     * \param name          the name of the ring (no leading '/')
+     * \param capacity      the number of data bytes (rounded up to a power of 2)
+     * \param maxConsumers  the maximum number of simultaneously attached consumers
+     *
+     * \throws std::runtime_error if the segment could not be created
+     */
+    static void create(const std::string& name, std::size_t capacity,
+                       unsigned maxConsumers = 16);
+
+    /*! \brief Remove the shared memory segment for a ring */
+    static void remove(const std::string& name);
+
+    /*! \return whether a ring by this name exists */
+    static bool exists(const std::string& name);
+
+    /*!
+     * \brief Map an existing ring
+     *
+     * \throws std::runtime_error if the ring does not exist or is not a ring
+     */
+    explicit CShmRing(const std::string& name);
+    ~CShmRing();
+
+    CShmRing(const CShmRing&) = delete;
+    CShmRing& operator=(const CShmRing&) = delete;
+
+    const std::string& getName() const { return m_name; }
+    std::size_t capacity() const;
+    unsigned getMaxConsumers() const;
+
+    std::uint64_t getWriteIndex() const;
+    void          setWriteIndex(std::uint64_t index);
+
+    /*! \return the read index of the slowest attached consumer (write index if none) */
+    std::uint64_t getMinimumReadIndex() const;
+
+    bool claimProducer();
+    void releaseProducer();
+    bool isProducerClosed() const;
+    void setProducerClosed(bool closed);
+
+    CShmRingConsumerSlot* claimConsumer();
+    void releaseConsumer(CShmRingConsumerSlot* pSlot);
+
+    /*!
+     * \brief Free the slots of consumers whose process no longer exists
+     *
+     * \return the number of slots that were freed
+     */
+    unsigned releaseDeadConsumers();
+
+    std::uint64_t getReadIndex(const CShmRingConsumerSlot* pSlot) const;
+    void          setReadIndex(CShmRingConsumerSlot* pSlot, std::uint64_t index);
+
+    /*! \brief Copy bytes into the ring at the given absolute index, wrapping as needed */
+    void copyIn(std::uint64_t index, const void* pData, std::size_t nBytes);
+
+    /*! \brief Copy bytes out of the ring at the given absolute index, wrapping as needed */
+    void copyOut(std::uint64_t index, void* pData, std::size_t nBytes) const;
+
+    /*!
+     * \brief Locate the byte at the given absolute index
+     *
+     * \param nContiguous  set to the number of bytes from there to the end of
+     *                     the data region
+     */
+    const std::uint8_t* dataAt(std::uint64_t index, std::size_t& nContiguous) const;
+
+private:
+    static std::string segmentName(const std::string& name);
+    static std::size_t segmentSize(std::size_t capacity, unsigned maxConsumers);
+    CShmRingConsumerSlot* slot(unsigned index) const;
+};
+
+
+/*!
+ * \brief The producer end of a CShmRing
+ *
+ * Only one sink may be attached to a ring at a time.
+ */
+class CShmRingSink
+{
+private:
+    CShmRing m_ring;
+
+public:
+    /*!
+     * \throws std::runtime_error if the ring does not exist or already has a producer
+     */
+    explicit CShmRingSink(const std::string& name);
+
+    /*! \brief Detaches and marks the ring as closed (consumers then see eof) */
+    ~CShmRingSink();
+
+    /*!
+     * \brief Write data into the ring
+     *
+     * Blocks until the slowest consumer has freed enough space for all
+     * of the data. The data becomes visible to consumers atomically.
+     *
+     * \throws std::invalid_argument if nBytes exceeds the ring capacity
+     */
+    void put(const void* pData, std::size_t nBytes);
+
+    /*!
+     * \brief Gather write of several blocks of data
+     *
+     * All of the blocks become visible to consumers atomically.
+     */
+    void putv(const std::initializer_list<std::pair<const void*, std::size_t> >& parts);
+
+    /*! \return the number of bytes that can currently be written without blocking */
+    std::size_t freeSpace() const;
+
+private:
+    void waitForSpace(std::size_t nBytes);
+};
+
+
+/*!
+ * \brief A consumer of a CShmRing
+ *
+ * A consumer begins reading at the point in the stream at which it attached.
+ */
+class CShmRingSource
+{
+private:
+    CShmRing               m_ring;
+    CShmRingConsumerSlot*  m_pSlot;
+
+public:
+    /*!
+     * \throws std::runtime_error if the ring does not exist or has no free consumer slots
+     */
+    explicit CShmRingSource(const std::string& name);
+    ~CShmRingSource();
+
+    /*! \return number of bytes that can be read without blocking */
+    std::size_t availableData() const;
+
+    /*!
+     * \brief Copy data without consuming it
+     *
+     * \return the number of bytes copied (at most availableData())
+     */
+    std::size_t peek(void* pBuffer, std::size_t nBytes);
+
+    /*!
+     * \brief Access unread data in place without consuming it
+     *
+     * Data that runs past the end of the ring continues at its start, and is
+     * returned by the next call once the first part has been ignored.
+     *
+     * \param nBytes  set to the number of available bytes stored contiguously
+     *                at the returned address
+     */
+    const std::uint8_t* data(std::size_t& nBytes) const;
+
+    /*! \brief Consume up to nBytes without copying them */
+    void ignore(std::size_t nBytes);
+
+    /*!
+     * \brief Consume data
+     *
+     * Blocks until nBytes are available or the producer has closed the ring.
+     *
+     * \return the number of bytes read
+     */
+    std::size_t read(void* pBuffer, std::size_t nBytes);
+
+    /*! \return true if the producer has closed the ring and all data was consumed */
+    bool eof() const;
+};
+
+} // end DAQ
+
+#endif // DAQ_CSHMRING_H
@@ -0,0 +1,117 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "CSourceMultiplexer.h"
+#include "CItemSource.h"
+
+#include <chrono>
+#include <thread>
+
+namespace DAQ {
+
+// The longest run() sleeps on the signal without polling. This only matters
+// if a notification is somehow missed, so it can be long.
+static const std::chrono::microseconds MaxSignalWait(100000);
+
+// spin briefly before handing the cpu back to the scheduler
+static void backoff(unsigned& nTries)
+{
+    if (nTries < 100) {
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    ++nTries;
+}
+
+
+//
+CSourceMultiplexer::CSourceMultiplexer()
+    : m_entries(),
+      m_nActive(0),
+      m_pSignal(std::make_shared<CReadinessSignal>()),
+      m_allNotify(true)
+{}
+
+
+//
+CSourceMultiplexer::~CSourceMultiplexer()
+{
+    for (auto& entry : m_entries) {
+        entry.s_pSource->setReadinessSignal(nullptr);
+    }
+}
+
+
+//
+void CSourceMultiplexer::add(CItemSource& source, Handler handler)
+{
+    if (!source.setReadinessSignal(m_pSignal)) {
+        m_allNotify = false;
+    }
+    m_entries.push_back({&source, handler, true, V12::CRawRingItem()});
+    ++m_nActive;
+}
+
+
+//
+std::size_t CSourceMultiplexer::poll(std::size_t maxItems)
+{
+    std::size_t nHandled = 0;
+
+    for (auto& entry : m_entries) {
+        for (std::size_t i=0; entry.s_active && i<maxItems; ++i) {
+            CItemSource::Status status = entry.s_pSource->next(entry.s_item);
+            if (status == CItemSource::Pending) {
+                break;
+            }
+
+            if (status == CItemSource::Ready) {
+                ++nHandled;
+                if (entry.s_handler(entry.s_item)) {
+                    continue;
+                }
+            }
+
+            entry.s_active = false;
+            --m_nActive;
+        }
+    }
+
+    return nHandled;
+}
+
+
+//
+void CSourceMultiplexer::run()
+{
+    unsigned nIdle = 0;
+
+    while (!done()) {
+        // anything that arrives from here on wakes the wait below
+        std::uint64_t count = m_pSignal->getCount();
+
+        if (poll() != 0) {
+            nIdle = 0;
+        } else if (m_allNotify) {
+            m_pSignal->wait(count, MaxSignalWait);
+        } else {
+            backoff(nIdle);
+        }
+    }
+}
+
+} // end DAQ
@@ -0,0 +1,118 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_CSOURCEMULTIPLEXER_H
+#define DAQ_CSOURCEMULTIPLEXER_H
+
+#include "CReadinessSignal.h"
+
+#include <V12/CRawRingItem.h>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace DAQ {
+
+class CItemSource;
+
+/*!
+ * \brief Drives many CItemSources from one thread
+ *
+ * Each source is paired with a handler. poll() visits every active source and
+ * hands its available items to its handler, moving on as soon as the source
+ * is Pending. No source can hold up the others by waiting for data, so there
+ * is no need for a thread per source. Use one multiplexer per thread to spread
+ * many sources over a few threads.
+ *
+ * When a pass finds nothing to do, run() sleeps on a CReadinessSignal that
+ * every source is asked to notify (see CItemSource::setReadinessSignal()). If
+ * some source cannot notify it, run() backs off instead, spinning briefly and
+ * then sleeping for short periods.
+ *
+ * A source stops being polled when it reaches End or its handler returns
+ * false.
+ *
+ * \code
+ * CSourceMultiplexer mux;
+ * mux.add(ringA, [&](const V12::CRawRingItem& item) { return sinkA.put(item); });
+ * mux.add(ringB, [&](const V12::CRawRingItem& item) { return sinkB.put(item); });
+ * mux.run();
+ * \endcode
+ */
+class CSourceMultiplexer
+{
+public:
+    /*! \brief Handles one item. Returns false to stop polling its source. */
+    typedef std::function<bool(const V12::CRawRingItem&)> Handler;
+
+private:
+    struct Entry {
+        CItemSource*       s_pSource;
+        Handler            s_handler;
+        bool               s_active;
+        V12::CRawRingItem  s_item;     // reused for every item of the source
+    };
+
+    std::vector<Entry> m_entries;
+    std::size_t        m_nActive;
+    std::shared_ptr<CReadinessSignal> m_pSignal;  // shared with the notifying writers
+    bool               m_allNotify;    // every source notifies m_pSignal
+
+public:
+    CSourceMultiplexer();
+
+    /*!
+     * \brief Detaches the readiness signal from the sources
+     *
+     * A writer that is notifying the signal keeps it alive, so producers may
+     * still be running.
+     */
+    ~CSourceMultiplexer();
+
+    CSourceMultiplexer(const CSourceMultiplexer&) = delete;
+    CSourceMultiplexer& operator=(const CSourceMultiplexer&) = delete;
+
+    /*!
+     * \brief Add a source. The source must outlive the multiplexer.
+     */
+    void add(CItemSource& source, Handler handler);
+
+    /*!
+     * \brief Visit every active source once
+     *
+     * \param maxItems  the most items taken from one source per visit, so that
+     *                  a busy source does not starve the others
+     *
+     * \return the number of items handled
+     */
+    std::size_t poll(std::size_t maxItems = 64);
+
+    /*!
+     * \brief Poll until no source is active, waiting for data whenever a pass
+     *        finds nothing to do
+     */
+    void run();
+
+    std::size_t getSourceCount() const { return m_entries.size(); }
+    std::size_t getActiveCount() const { return m_nActive; }
+    bool done() const { return m_nActive == 0; }
+};
+
+} // end DAQ
+
+#endif // DAQ_CSOURCEMULTIPLEXER_H
@@ -22,9 +22,15 @@
 
 #include <V12/DataFormat.h>
 
+#include "CRingItemQueue.h"
+#include "CShmRing.h"
+
 #include <iostream>
 #include <algorithm>
 #include <stdexcept>
+#include <thread>
+#include <chrono>
+#include <array>
 
 std::ostream& operator<<(std::ostream& stream,
                          const DAQ::V12::CRawRingItem& item)
@@ -67,6 +73,192 @@ std::istream& operator>>(std::istream& stream,
 
 
 
+
+namespace DAQ {
+
+void writeItem(CRingItemQueue& queue, const V12::CRawRingItem& item)
+{
+    std::size_t size = item.size();
+
+    std::uint8_t* pItem = queue.reserve(size);
+    while (!pItem) {
+        std::this_thread::yield();
+        pItem = queue.reserve(size);
+    }
+
+    auto& body = item.getBody();
+    pItem = DAQ::V12::serializeHeader(item, pItem);
+    std::copy(body.begin(), body.end(), pItem);
+
+    queue.commit(size);
+}
+
+
+void writeItem(CRingItemQueue& queue, const V12::CRingItem& item)
+{
+    auto pRawItem = dynamic_cast<const DAQ::V12::CRawRingItem*>(&item);
+
+    if (pRawItem) {
+        writeItem(queue, *pRawItem);
+    } else {
+        writeItem(queue, DAQ::V12::CRawRingItem(item));
+    }
+}
+
+
+bool readItem(CRingItemQueue& queue, V12::CRawRingItem& item)
+{
+    std::size_t size;
+    const std::uint8_t* pItem = queue.peek(size);
+    while (!pItem) {
+
+        // the closed flag must be checked before the final peek so that an
+        // item committed just prior to closing is not missed
+        if (queue.isClosed()) {
+            pItem = queue.peek(size);
+            if (!pItem) {
+                return false;
+            }
+            break;
+        }
+
+        std::this_thread::yield();
+        pItem = queue.peek(size);
+    }
+
+    uint32_t itemSize, type, sourceId;
+    uint64_t tstamp;
+    bool swapNeeded;
+    DAQ::V12::Parser::parseHeader(pItem, pItem + size,
+                                  itemSize, type, tstamp, sourceId, swapNeeded);
+
+    item.setType(type);
+    item.setEventTimestamp(tstamp);
+    item.setSourceId(sourceId);
+    item.setMustSwap(swapNeeded);
+
+    item.getBody().assign(pItem + 20, pItem + size);
+
+    queue.release();
+
+    return true;
+}
+
+
+
+void writeItem(CShmRingSink& sink, const V12::CRawRingItem& item)
+{
+    std::array<char,20> header;
+    DAQ::V12::serializeHeader(item, header.begin());
+
+    auto& body = item.getBody();
+
+    // the write is atomic
+    sink.putv({ {header.data(), header.size()},
+                {body.data(), body.size()} });
+}
+
+
+void writeItem(CShmRingSink& sink, const V12::CRingItem& item)
+{
+    auto pRawItem = dynamic_cast<const DAQ::V12::CRawRingItem*>(&item);
+
+    if (pRawItem) {
+        writeItem(sink, *pRawItem);
+    } else {
+        writeItem(sink, DAQ::V12::CRawRingItem(item));
+    }
+}
+
+
+bool readItem(CShmRingSource& source, V12::CRawRingItem& item,
+              const std::chrono::microseconds& timeout)
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    auto waitFor = [&](std::size_t nBytes) {
+        while (source.availableData() < nBytes) {
+            if (std::chrono::steady_clock::now() >= deadline || source.eof()) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(10));
+        }
+        return true;
+    };
+
+    std::array<char,20> header;
+    uint32_t size, type, sourceId;
+    uint64_t tstamp;
+    bool swapNeeded;
+
+    if (!waitFor(header.size())) {
+        return false;
+    }
+
+    // parse the header where it lies in the ring, unless it straddles the end
+    std::size_t nContiguous;
+    const std::uint8_t* pData = source.data(nContiguous);
+    if (nContiguous >= header.size()) {
+        DAQ::V12::Parser::parseHeader(pData, pData + header.size(),
+                                      size, type, tstamp, sourceId, swapNeeded);
+    } else {
+        source.peek(header.data(), header.size());
+        DAQ::V12::Parser::parseHeader(header.begin(), header.end(),
+                                      size, type, tstamp, sourceId, swapNeeded);
+    }
+
+    if (size < header.size()) {
+        throw std::runtime_error("Encountered incomplete V12 RingItem type. Fewer than 20 bytes in size field.");
+    }
+
+    if (!waitFor(size)) {
+        return false;
+    }
+
+    source.ignore(header.size());
+
+    item.setType(type);
+    item.setEventTimestamp(tstamp);
+    item.setSourceId(sourceId);
+    item.setMustSwap(swapNeeded);
+
+    // the body is copied straight out of the ring, in two parts if it wraps
+    auto& body = item.getBody();
+    std::size_t nBody = size - header.size();
+
+    pData = source.data(nContiguous);
+    std::size_t nFirst = std::min(nBody, nContiguous);
+    body.assign(pData, pData + nFirst);
+    source.ignore(nFirst);
+
+    if (nFirst < nBody) {
+        pData = source.data(nContiguous);
+        body.insert(body.end(), pData, pData + (nBody - nFirst));
+        source.ignore(nBody - nFirst);
+    }
+
+    return true;
+}
+
+} // end DAQ
+
+
+DAQ::CRingItemQueue& operator<<(DAQ::CRingItemQueue& queue,
+                                const DAQ::V12::CRawRingItem& item)
+{
+    DAQ::writeItem(queue, item);
+    return queue;
+}
+
+
+DAQ::CRingItemQueue& operator>>(DAQ::CRingItemQueue& queue,
+                                DAQ::V12::CRawRingItem& item)
+{
+    DAQ::readItem(queue, item);
+    return queue;
+}
+
+
+
 #ifdef NSCLDAQ_BUILD
 
 #include <CDataSource.h>
@@ -3,6 +3,7 @@
 
 #include <iosfwd>
 #include <functional>
+#include <chrono>
 
 namespace DAQ {
 namespace V12 {
@@ -34,6 +35,128 @@ extern std::istream& operator>>(std::istream& stream,
                                 DAQ::V12::CRawRingItem& item);
 
 
+namespace DAQ {
+
+class CRingItemQueue;
+
+/*!
+ * \brief Write a V12 item into a CRingItemQueue
+ *
+ * This blocks until the queue has enough free space for the item.
+ *
+ * \param queue  the queue (caller must be the only writer)
+ * \param item   the item to serialize into the queue
+ *
+ * \throws std::invalid_argument if the item is larger than the queue
+ */
+void writeItem(CRingItemQueue& queue, const V12::CRawRingItem& item);
+void writeItem(CRingItemQueue& queue, const V12::CRingItem& item);
+
+/*!
+ * \brief Read a V12 item from a CRingItemQueue
+ *
+ * This blocks until an item is available or the queue has been closed and
+ * there are no more items in it.
+ *
+ * \param queue  the queue (caller must be the only reader)
+ * \param item   the item to fill with data from the queue
+ *
+ * \retval true  - an item was read
+ * \retval false - the queue is closed and empty
+ */
+bool readItem(CRingItemQueue& queue, V12::CRawRingItem& item);
+
+
+class CShmRingSink;
+class CShmRingSource;
+
+/*!
+ * \brief Write a V12 item into a shared memory ring
+ *
+ * The header and body are made visible to consumers atomically. This blocks
+ * until the slowest consumer has made enough room for the item.
+ *
+ * \param sink  the producer end of the ring
+ * \param item  the item to write
+ */
+void writeItem(CShmRingSink& sink, const V12::CRawRingItem& item);
+void writeItem(CShmRingSink& sink, const V12::CRingItem& item);
+
+/*!
+ * \brief Read a V12 item from a shared memory ring
+ *
+ * Like the CDataSource overload, data is only consumed if a complete item is
+ * present. The header is peeked first to learn the size of the item.
+ *
+ * \param source   the consumer end of the ring
+ * \param item     the item to fill with data from the ring
+ * \param timeout  how long to wait for a complete item. A zero timeout polls.
+ *
+ * \retval true  - a complete item was read
+ * \retval false - the timeout expired or the producer closed the ring before
+ *                 a complete item was available
+ *
+ * \throws std::runtime_error if the size in the header is smaller than a header
+ */
+bool readItem(CShmRingSource& source, V12::CRawRingItem& item,
+              const std::chrono::microseconds& timeout = std::chrono::hours(24));
+
+
+/*!
+ * \brief The selective read shared by every kind of source
+ *
+ * pred(source) is called until it returns true or the source reaches its end.
+ * The predicate is expected to skip (ignore()) items it does not want. If it
+ * returns true, the item at the front of the source is read.
+ *
+ * \return whether the predicate was satisfied
+ */
+template<class Source, class UnaryPredicate>
+bool readItemIfImpl(Source& source, V12::CRawRingItem& item, UnaryPredicate& pred)
+{
+    bool stopLooking = false;
+    do {
+      stopLooking = pred(source);
+    }
+    while ( !stopLooking && !source.eof() );
+
+    if (stopLooking) {
+        readItem(source, item);
+    }
+
+    return stopLooking;
+}
+
+/*!
+ * \brief Selectively read an item from a shared memory ring
+ *
+ * This behaves like the CDataSource overload. The predicate has the signature
+ *
+ *     bool Predicate(CShmRingSource& source)
+ *
+ * and can look at the next item with CShmRingSource::peek() or data().
+ */
+template<class UnaryPredicate>
+bool readItemIf(CShmRingSource& source, V12::CRawRingItem& item, UnaryPredicate& pred)
+{
+    return readItemIfImpl(source, item, pred);
+}
+
+} // end DAQ
+
+/*!
+ * \brief Insert V12 CRingItem into a CRingItemQueue
+ */
+extern DAQ::CRingItemQueue& operator<<(DAQ::CRingItemQueue& queue,
+                                       const DAQ::V12::CRawRingItem& item);
+
+/*!
+ * \brief Extract a V12 CRingItem from a CRingItemQueue
+ */
+extern DAQ::CRingItemQueue& operator>>(DAQ::CRingItemQueue& queue,
+                                       DAQ::V12::CRawRingItem& item);
+
+
 
 
 #ifdef NSCLDAQ_BUILD
@@ -112,17 +235,7 @@ template<class UnaryPredicate,
 bool
 readItemIf(CDataSource& source, V12::CRawRingItem& item, UnaryPredicate& pred)
 {
-    bool stopLooking = false;
-    do {
-      stopLooking = pred(source);
-    }
-    while ( !stopLooking && !source.eof() );
-
-    if (stopLooking) {
-        readItem(source, item);
-    }
-
-    return stopLooking;
+    return readItemIfImpl(source, item, pred);
 }
 
 /*!
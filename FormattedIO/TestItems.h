@@ -0,0 +1,70 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_TESTITEMS_H
+#define DAQ_TESTITEMS_H
+
+#include <RingIOV12.h>
+#include <V12/CRingItem.h>
+#include <V12/CRawRingItem.h>
+#include <V12/DataFormat.h>
+#include <ByteBuffer.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+/*
+ * Helpers shared by the unit tests that build streams of items in memory.
+ */
+
+namespace Test {
+
+/*!
+ * \brief Append the serialized form of an item to the data
+ *
+ * \return the offset at which the item begins
+ */
+inline std::size_t appendItem(DAQ::Buffer::ByteBuffer& data, const DAQ::V12::CRingItem& item)
+{
+    DAQ::V12::CRawRingItem raw(item);
+    std::stringstream stream;
+    stream << raw;
+    std::string bytes = stream.str();
+
+    std::size_t start = data.size();
+    data.insert(data.end(), bytes.begin(), bytes.end());
+    return start;
+}
+
+/*!
+ * \brief A physics event from the given source with a body of bodySize bytes
+ *
+ * The body bytes count up from the source id, so items are easy to tell apart.
+ */
+inline DAQ::V12::CRawRingItem makeItem(std::uint32_t id, std::size_t bodySize)
+{
+    DAQ::V12::CRawRingItem item(DAQ::V12::PHYSICS_EVENT, 0x1234, id);
+    for (std::size_t i=0; i<bodySize; ++i) {
+        item.getBody().push_back(std::uint8_t(i+id));
+    }
+    return item;
+}
+
+} // end Test
+
+#endif // DAQ_TESTITEMS_H
@@ -0,0 +1,230 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <Asserts.h>
+
+#include <CAsyncFileReader.h>
+#include <RingIOV12.h>
+
+#include <V8/DataFormat.h>
+#include <V8/CRawBuffer.h>
+#include <V12/DataFormat.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CPhysicsEventItem.h>
+#include <ByteBuffer.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace std;
+using namespace DAQ;
+
+// DAQ::V8::gBufferSize is defined in TestRunner.cpp to be 34.
+
+class CAsyncFileReaderTests : public CppUnit::TestFixture
+{
+public:
+    CPPUNIT_TEST_SUITE(CAsyncFileReaderTests);
+    CPPUNIT_TEST(read_0);
+    CPPUNIT_TEST(read_1);
+    CPPUNIT_TEST(read_2);
+    CPPUNIT_TEST(read_3);
+    CPPUNIT_TEST(read_4);
+    CPPUNIT_TEST(read_5);
+    CPPUNIT_TEST(construct_0);
+    CPPUNIT_TEST(construct_1);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    vector<string> m_paths;
+
+public:
+    void setUp() {
+        m_paths.clear();
+    }
+    void tearDown() {
+        for (auto& path : m_paths) {
+            std::remove(path.c_str());
+        }
+    }
+
+    // write the bytes to a new temporary file and return its name
+    string makeFile(const string& bytes) {
+        char name[] = "/tmp/asyncfilereadertestXXXXXX";
+        int fd = mkstemp(name);
+        CPPUNIT_ASSERT(fd >= 0);
+        close(fd);
+        m_paths.push_back(name);
+
+        ofstream file(name, ios::binary);
+        file.write(bytes.data(), bytes.size());
+        return name;
+    }
+
+    // make a new temporary directory, which opens but cannot be read
+    string makeDirectory() {
+        char name[] = "/tmp/asyncfilereadertestXXXXXX";
+        CPPUNIT_ASSERT(mkdtemp(name) != nullptr);
+
+        // an entry makes sure that the directory has a nonzero size
+        string entry = string(name) + "/entry";
+        ofstream(entry.c_str());
+        m_paths.push_back(entry);
+        m_paths.push_back(name);
+        return name;
+    }
+
+    // V12 items whose timestamps run from first to last - 1
+    string events(uint64_t first, uint64_t last) {
+        stringstream stream;
+        for (uint64_t i=first; i<last; ++i) {
+            Buffer::ByteBuffer body(i % 23, uint8_t(i));
+            stream << V12::CRawRingItem(V12::CPhysicsEventItem(i, 2, body));
+        }
+        return stream.str();
+    }
+
+    vector<uint64_t> readStamps(CAsyncFileReader& reader) {
+        vector<uint64_t> stamps;
+        V12::CRawRingItem item;
+        while (reader.read(item)) {
+            EQMSG("type", V12::PHYSICS_EVENT, item.type());
+            EQMSG("body size", size_t(item.getEventTimestamp() % 23), item.getBody().size());
+            stamps.push_back(item.getEventTimestamp());
+        }
+        return stamps;
+    }
+
+    void checkStamps(const string& msg, uint64_t count, const vector<uint64_t>& stamps) {
+        EQMSG(msg + ": count", size_t(count), stamps.size());
+        for (size_t i=0; i<stamps.size(); ++i) {
+            EQMSG(msg + ": order", uint64_t(i), stamps[i]);
+        }
+    }
+
+    void read_0() {
+        // items span blocks of every size
+        auto path = makeFile(events(0, 50));
+        for (size_t blockSize : {1, 7, 20, 64, 4096}) {
+            for (size_t nInFlight : {1, 3, 8}) {
+                CAsyncFileReader reader({path}, blockSize, nInFlight);
+                checkStamps("block size " + to_string(blockSize), 50, readStamps(reader));
+            }
+        }
+    }
+
+    void read_1() {
+        // files are read in order, and empty files are passed over
+        vector<string> paths = {makeFile(events(0, 10)), makeFile(""),
+                                makeFile(events(10, 25)), makeFile(events(25, 26))};
+        CAsyncFileReader reader(paths, 16, 4);
+        checkStamps("several files", 26, readStamps(reader));
+    }
+
+    void read_2() {
+        // an item may not continue into the next file
+        string data = events(0, 5);
+        vector<string> paths = {makeFile(data.substr(0, data.size() - 6)),
+                                makeFile(data.substr(data.size() - 6))};
+        CAsyncFileReader reader(paths, 8, 2);
+        V12::CRawRingItem item;
+        for (size_t i=0; i<4; ++i) {
+            ASSERTMSG("whole items", reader.read(item));
+        }
+        CPPUNIT_ASSERT_THROW_MESSAGE("split item",
+                                     reader.read(item),
+                                     std::runtime_error);
+    }
+
+    void read_3() {
+        // a truncated last item
+        string data = events(0, 3);
+        CAsyncFileReader reader({makeFile(data.substr(0, data.size() - 1))});
+        V12::CRawRingItem item;
+        ASSERTMSG("first", reader.read(item));
+        ASSERTMSG("second", reader.read(item));
+        CPPUNIT_ASSERT_THROW_MESSAGE("truncated item",
+                                     reader.read(item),
+                                     std::runtime_error);
+    }
+
+    void read_4() {
+        // V8 buffers are fixed size
+        string data;
+        for (size_t i=0; i<5*V8::gBufferSize; ++i) {
+            data.push_back(char(i));
+        }
+        CAsyncFileReader reader({makeFile(data)}, 10, 3);
+        V8::CRawBuffer buffer;
+        for (size_t i=0; i<5; ++i) {
+            ASSERTMSG("buffer read", reader.read(buffer));
+            EQMSG("buffer size", size_t(V8::gBufferSize), buffer.getBuffer().size());
+            EQMSG("first byte", uint8_t(i*V8::gBufferSize), buffer.getBuffer()[0]);
+        }
+        ASSERTMSG("no more", !reader.read(buffer));
+
+        CAsyncFileReader partial({makeFile(data.substr(0, V8::gBufferSize + 3))});
+        ASSERTMSG("whole buffer", partial.read(buffer));
+        CPPUNIT_ASSERT_THROW_MESSAGE("partial buffer",
+                                     partial.read(buffer),
+                                     std::runtime_error);
+    }
+
+    void read_5() {
+        // every block fails to read, and each failure is reported once
+        CAsyncFileReader reader({makeDirectory()}, 8, 4);
+        V12::CRawRingItem item;
+        CPPUNIT_ASSERT_THROW_MESSAGE("failed read",
+                                     reader.read(item),
+                                     std::runtime_error);
+        CPPUNIT_ASSERT_THROW_MESSAGE("next failed read",
+                                     reader.read(item),
+                                     std::runtime_error);
+    }
+
+    void construct_0() {
+        CPPUNIT_ASSERT_THROW_MESSAGE("missing file",
+                                     CAsyncFileReader({"/nonexistent/async/reader/file"}),
+                                     std::runtime_error);
+        CPPUNIT_ASSERT_THROW_MESSAGE("zero block size",
+                                     CAsyncFileReader({}, 0, 1),
+                                     std::invalid_argument);
+        CPPUNIT_ASSERT_THROW_MESSAGE("nothing in flight",
+                                     CAsyncFileReader({}, 1, 0),
+                                     std::invalid_argument);
+    }
+
+    void construct_1() {
+        // no files and the reader is destroyed with reads outstanding
+        CAsyncFileReader empty({});
+        V12::CRawRingItem item;
+        ASSERTMSG("no files", !empty.read(item));
+
+        CAsyncFileReader abandoned({makeFile(events(0, 100))}, 32, 8);
+        ASSERTMSG("one item", abandoned.read(item));
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CAsyncFileReaderTests);
@@ -0,0 +1,200 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <Asserts.h>
+
+#include "TestItems.h"
+
+#include <CChunkSplitter.h>
+
+#include <V12/DataFormat.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CPhysicsEventItem.h>
+#include <V12/CCompositeRingItem.h>
+#include <ByteBuffer.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace DAQ;
+
+class CChunkSplitterTests : public CppUnit::TestFixture
+{
+public:
+    CPPUNIT_TEST_SUITE(CChunkSplitterTests);
+    CPPUNIT_TEST(findBoundary_0);
+    CPPUNIT_TEST(findBoundary_1);
+    CPPUNIT_TEST(split_0);
+    CPPUNIT_TEST(split_1);
+    CPPUNIT_TEST(split_2);
+    CPPUNIT_TEST(split_3);
+    CPPUNIT_TEST(split_4);
+    CPPUNIT_TEST(split_5);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    Buffer::ByteBuffer m_data;
+    set<size_t>        m_starts;   // offsets of the top level items
+
+public:
+    void setUp() {
+        m_data.clear();
+        m_starts.clear();
+    }
+    void tearDown() {}
+
+    void append(const V12::CRingItem& item) {
+        m_starts.insert(Test::appendItem(m_data, item));
+    }
+
+    Buffer::ByteBuffer body(size_t nBytes, uint8_t seed) {
+        Buffer::ByteBuffer result(nBytes);
+        for (size_t i=0; i<nBytes; ++i) {
+            result[i] = uint8_t(seed + 7*i);
+        }
+        return result;
+    }
+
+    void appendEvents(size_t nEvents) {
+        for (size_t i=0; i<nEvents; ++i) {
+            append(V12::CPhysicsEventItem(i, 1, body(i % 37, uint8_t(i))));
+        }
+    }
+
+    void appendComposites(size_t nEvents) {
+        for (size_t i=0; i<nEvents; ++i) {
+            V12::CCompositeRingItem composite(V12::COMP_PHYSICS_EVENT, i, 0);
+            for (uint32_t source=0; source<4; ++source) {
+                composite.appendChild(V12::CRingItemPtr(
+                        new V12::CPhysicsEventItem(i, source, body(3*source + i % 5, uint8_t(i)))));
+            }
+            append(composite);
+        }
+    }
+
+    vector<CChunkSplitter::Chunk> split(size_t nChunks,
+                                        const CChunkSplitter& splitter = CChunkSplitter()) {
+        return splitter.split(m_data.data(), m_data.data() + m_data.size(), nChunks);
+    }
+
+    // the chunks tile the data and every one starts on a top level item
+    void checkChunks(const string& msg, const vector<CChunkSplitter::Chunk>& chunks) {
+        ASSERTMSG(msg + ": some chunks", !chunks.empty());
+        EQMSG(msg + ": first begins at 0", size_t(0), chunks.front().s_begin);
+        EQMSG(msg + ": last ends at the end", m_data.size(), chunks.back().s_end);
+        for (size_t i=0; i<chunks.size(); ++i) {
+            ASSERTMSG(msg + ": not empty", chunks[i].s_begin < chunks[i].s_end);
+            ASSERTMSG(msg + ": begins on an item",
+                      m_starts.count(chunks[i].s_begin) == 1);
+            if (i > 0) {
+                EQMSG(msg + ": contiguous", chunks[i-1].s_end, chunks[i].s_begin);
+            }
+        }
+    }
+
+    void findBoundary_0() {
+        appendEvents(10);
+        CChunkSplitter splitter;
+        auto beg = m_data.data();
+        auto end = m_data.data() + m_data.size();
+
+        EQMSG("item start", size_t(0), splitter.findBoundary(beg, end, 0));
+        size_t second = *std::next(m_starts.begin());
+        EQMSG("from inside the first item", second, splitter.findBoundary(beg, end, 1));
+        EQMSG("nothing past the end", m_data.size(),
+              splitter.findBoundary(beg, end, m_data.size()));
+    }
+
+    void findBoundary_1() {
+        // a short chain that ends exactly at the end of the data is accepted
+        appendEvents(2);
+        size_t last = *m_starts.rbegin();
+        CChunkSplitter splitter(8);
+        EQMSG("last item", last,
+              splitter.findBoundary(m_data.data(), m_data.data() + m_data.size(), last));
+    }
+
+    void split_0() {
+        appendEvents(500);
+        for (size_t n : {1, 2, 3, 7, 16}) {
+            auto chunks = split(n);
+            checkChunks("events in " + to_string(n), chunks);
+            EQMSG("number of chunks", n, chunks.size());
+        }
+    }
+
+    void split_1() {
+        // split points that land on children are moved past their parents
+        appendComposites(200);
+        for (size_t n : {2, 5, 13}) {
+            checkChunks("composites in " + to_string(n), split(n));
+        }
+    }
+
+    void split_2() {
+        // a body holding a whole valid item sequence fools the chain check
+        Buffer::ByteBuffer inner;
+        {
+            CChunkSplitterTests nested;
+            nested.appendEvents(50);
+            inner = nested.m_data;
+        }
+        appendEvents(3);
+        append(V12::CPhysicsEventItem(0, 2, inner));
+        appendEvents(3);
+
+        for (size_t n : {2, 3, 4, 8}) {
+            checkChunks("embedded items in " + to_string(n), split(n));
+        }
+    }
+
+    void split_3() {
+        // more chunks than items
+        appendEvents(3);
+        auto chunks = split(20);
+        checkChunks("few items", chunks);
+        ASSERTMSG("at most one chunk per item", chunks.size() <= 3);
+    }
+
+    void split_4() {
+        CChunkSplitter splitter;
+        EQMSG("empty data", size_t(0),
+              splitter.split(m_data.data(), m_data.data(), 4).size());
+        CPPUNIT_ASSERT_THROW_MESSAGE("zero chunks",
+                                     splitter.split(m_data.data(), m_data.data(), 0),
+                                     std::invalid_argument);
+    }
+
+    void split_5() {
+        // corrupt size in the first item is found by the walk of chunk 0
+        appendEvents(100);
+        uint32_t badSize = 3;
+        std::memcpy(m_data.data(), &badSize, sizeof(badSize));
+        CPPUNIT_ASSERT_THROW_MESSAGE("implausible header",
+                                     split(4),
+                                     std::runtime_error);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CChunkSplitterTests);
@@ -0,0 +1,261 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <Asserts.h>
+
+#include <CCompressedFile.h>
+#include <RingIOV12.h>
+
+#include <V12/DataFormat.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CPhysicsEventItem.h>
+#include <V12/CRingStateChangeItem.h>
+#include <ByteBuffer.h>
+
+#include <cstdint>
+#include <future>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace DAQ;
+
+class CCompressedFileTests : public CppUnit::TestFixture
+{
+public:
+    CPPUNIT_TEST_SUITE(CCompressedFileTests);
+    CPPUNIT_TEST(roundTrip_0);
+    CPPUNIT_TEST(roundTrip_1);
+    CPPUNIT_TEST(index_0);
+    CPPUNIT_TEST(seek_0);
+    CPPUNIT_TEST(parallel_0);
+    CPPUNIT_TEST(unclosed_0);
+    CPPUNIT_TEST(corrupt_0);
+    CPPUNIT_TEST(corrupt_1);
+    CPPUNIT_TEST(corrupt_2);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    V12::CPhysicsEventItem event(uint64_t stamp) {
+        Buffer::ByteBuffer body(8 + stamp % 50);
+        for (size_t i=0; i<body.size(); ++i) {
+            body[i] = uint8_t(i % 4);
+        }
+        return V12::CPhysicsEventItem(stamp, 3, body);
+    }
+
+    // a container of nItems events
+    string container(size_t nItems, size_t blockSize) {
+        stringstream stream;
+        CCompressedWriter writer(stream, blockSize);
+        for (uint64_t i=0; i<nItems; ++i) {
+            writer << event(i);
+        }
+        writer.close();
+        return stream.str();
+    }
+
+    // the raw V12 bytes of the same events
+    string raw(size_t nItems) {
+        stringstream stream;
+        for (uint64_t i=0; i<nItems; ++i) {
+            stream << V12::CRawRingItem(event(i));
+        }
+        return stream.str();
+    }
+
+    void roundTrip_0() {
+        stringstream stream(container(500, 4096));
+        CCompressedReader reader(stream);
+
+        V12::CRawRingItem item;
+        for (uint64_t i=0; i<500; ++i) {
+            ASSERTMSG("read", reader.read(item));
+            V12::CRawRingItem expected(event(i));
+            EQMSG("type", expected.type(), item.type());
+            EQMSG("stamp", i, item.getEventTimestamp());
+            EQMSG("source", uint32_t(3), item.getSourceId());
+            ASSERTMSG("body", expected.getBody() == item.getBody());
+        }
+        ASSERTMSG("no more", !reader.read(item));
+        ASSERTMSG("eof", reader.eof());
+    }
+
+    void roundTrip_1() {
+        // operators, an item larger than a block, an empty container
+        stringstream stream;
+        {
+            CCompressedWriter writer(stream, 64);
+            writer << V12::CRingStateChangeItem(V12::BEGIN_RUN) << event(49) << event(1);
+        }
+        CCompressedReader reader(stream);
+        V12::CRawRingItem item;
+        reader >> item;
+        EQMSG("state change", V12::BEGIN_RUN, item.type());
+        reader >> item;
+        EQMSG("large item", uint64_t(49), item.getEventTimestamp());
+        reader >> item;
+        EQMSG("last item", uint64_t(1), item.getEventTimestamp());
+        ASSERTMSG("not at end yet", !reader.eof());
+        reader >> item;
+        ASSERTMSG("at end", reader.eof());
+        EQMSG("item unchanged", uint64_t(1), item.getEventTimestamp());
+
+        stringstream empty(container(0, 64));
+        CCompressedReader emptyReader(empty);
+        ASSERTMSG("empty index", emptyReader.hasIndex());
+        EQMSG("no blocks", size_t(0), emptyReader.getBlockCount());
+        ASSERTMSG("no items", !emptyReader.read(item));
+    }
+
+    void index_0() {
+        string data = container(1000, 8192);
+        ASSERTMSG("compressed", data.size() < raw(1000).size()/4);
+
+        stringstream stream(data);
+        CCompressedReader reader(stream);
+        ASSERTMSG("index", reader.hasIndex());
+        auto& index = reader.getIndex();
+        ASSERTMSG("several blocks", index.size() > 4);
+
+        uint64_t nextItem = 0;
+        for (auto& info : index) {
+            EQMSG("first item", nextItem, info.s_firstItem);
+            ASSERTMSG("block size", info.s_uncompressedSize <= 8192);
+            nextItem += info.s_itemCount;
+        }
+        EQMSG("all items", uint64_t(1000), nextItem);
+    }
+
+    void seek_0() {
+        stringstream stream(container(300, 1024));
+        CCompressedReader reader(stream);
+        auto index = reader.getIndex();
+        V12::CRawRingItem item;
+
+        for (size_t block : {size_t(3), size_t(0), index.size() - 1}) {
+            reader.seekBlock(block);
+            ASSERTMSG("read", reader.read(item));
+            EQMSG("first item of block", index[block].s_firstItem, item.getEventTimestamp());
+        }
+        while (reader.read(item)) {}
+        EQMSG("last item", uint64_t(299), item.getEventTimestamp());
+
+        reader.seekBlock(index.size());
+        ASSERTMSG("end", !reader.read(item));
+        CPPUNIT_ASSERT_THROW_MESSAGE("past the end",
+                                     reader.seekBlock(index.size() + 1),
+                                     std::out_of_range);
+    }
+
+    void parallel_0() {
+        // blocks decompress independently into whole items
+        stringstream stream(container(400, 2048));
+        CCompressedReader reader(stream);
+        auto& index = reader.getIndex();
+
+        vector<Buffer::ByteBuffer> compressed(index.size());
+        for (size_t i=0; i<index.size(); ++i) {
+            reader.readRawBlock(i, compressed[i]);
+        }
+
+        vector<future<Buffer::ByteBuffer> > futures;
+        for (size_t i=0; i<index.size(); ++i) {
+            futures.push_back(async(launch::async, [&, i]() {
+                Buffer::ByteBuffer items;
+                CCompressedReader::decompressBlock(index[i], compressed[i], items);
+                return items;
+            }));
+        }
+
+        string joined;
+        for (auto& future : futures) {
+            auto items = future.get();
+            joined.append(items.begin(), items.end());
+        }
+        ASSERTMSG("same bytes", raw(400) == joined);
+    }
+
+    void unclosed_0() {
+        // blocks written before a crash can be read without the index
+        stringstream stream;
+        CCompressedWriter writer(stream, 512);
+        for (uint64_t i=0; i<100; ++i) {
+            writer << event(i);
+        }
+        size_t nWritten = 0;
+        for (auto& info : writer.getIndex()) {
+            nWritten += info.s_itemCount;
+        }
+        ASSERTMSG("some blocks written", nWritten > 0);
+
+        stringstream partial(stream.str());
+        CCompressedReader reader(partial);
+        ASSERTMSG("no index", !reader.hasIndex());
+        CPPUNIT_ASSERT_THROW_MESSAGE("cannot seek",
+                                     reader.seekBlock(0),
+                                     std::runtime_error);
+
+        V12::CRawRingItem item;
+        size_t nRead = 0;
+        while (reader.read(item)) {
+            ++nRead;
+        }
+        EQMSG("written items", nWritten, nRead);
+    }
+
+    void corrupt_0() {
+        stringstream notContainer(raw(3));
+        CPPUNIT_ASSERT_THROW_MESSAGE("not a container",
+                                     CCompressedReader reader(notContainer),
+                                     std::runtime_error);
+    }
+
+    void corrupt_1() {
+        string data = container(50, 256);
+        data[16 + 16 + 5] ^= 0x40;     // inside the first block's data
+
+        stringstream stream(data);
+        CCompressedReader reader(stream);
+        V12::CRawRingItem item;
+        CPPUNIT_ASSERT_THROW_MESSAGE("corrupted block",
+                                     reader.read(item),
+                                     std::runtime_error);
+    }
+
+    void corrupt_2() {
+        // an absurd uncompressed size is rejected rather than allocated
+        string data = container(50, 256);
+        uint32_t uncompressedSize = 0xffffffff;
+        data.replace(16 + 4, sizeof(uncompressedSize),
+                     reinterpret_cast<char*>(&uncompressedSize), sizeof(uncompressedSize));
+
+        stringstream stream(data);
+        CCompressedReader reader(stream);
+        V12::CRawRingItem item;
+        CPPUNIT_ASSERT_THROW_MESSAGE("oversized block",
+                                     reader.read(item),
+                                     std::runtime_error);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CCompressedFileTests);
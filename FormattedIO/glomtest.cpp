@@ -0,0 +1,196 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+         NSCL
+         Michigan State University
+         East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <Asserts.h>
+
+#include <CGlom.h>
+#include <RingIOV12.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CCompositeRingItem.h>
+#include <V12/CGlomParameters.h>
+#include <V12/DataFormat.h>
+
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace DAQ;
+
+class CGlomTest : public CppUnit::TestFixture
+{
+private:
+    vector<V12::CRawRingItem> m_output;
+
+public:
+    CPPUNIT_TEST_SUITE( CGlomTest );
+    CPPUNIT_TEST ( params_0 );
+    CPPUNIT_TEST ( build_0 );
+    CPPUNIT_TEST ( build_1 );
+    CPPUNIT_TEST ( policy_0 );
+    CPPUNIT_TEST ( policy_1 );
+    CPPUNIT_TEST ( policy_2 );
+    CPPUNIT_TEST ( passThrough_0 );
+    CPPUNIT_TEST ( passThrough_1 );
+    CPPUNIT_TEST ( passThrough_2 );
+    CPPUNIT_TEST ( stream_0 );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {
+        m_output.clear();
+    }
+    void tearDown() {}
+
+    CGlom::Sink makeSink() {
+        return [this](const uint8_t* beg, const uint8_t* end) {
+            m_output.push_back(V12::CRawRingItem(beg, end));
+        };
+    }
+
+    V12::CRawRingItem makeFragment(uint64_t tstamp, uint32_t sourceId) {
+        V12::CRawRingItem item(V12::PHYSICS_EVENT, tstamp, sourceId);
+        item.getBody().push_back(uint8_t(sourceId));
+        item.getBody().push_back(uint8_t(tstamp));
+        return item;
+    }
+
+    void params_0() {
+        CGlom glom(V12::CGlomParameters(10, true, V12::CGlomParameters::first),
+                   makeSink(), 5);
+        glom.flush();
+
+        EQMSG("parameters are emitted first", size_t(1), m_output.size());
+        V12::CGlomParameters params(m_output[0]);
+        EQMSG("ticks", uint64_t(10), params.coincidenceTicks());
+        EQMSG("building", true, params.isBuilding());
+        EQMSG("policy", V12::CGlomParameters::first, params.timestampPolicy());
+        EQMSG("source id", uint32_t(5), params.getSourceId());
+    }
+
+    void build_0() {
+        CGlom glom(V12::CGlomParameters(10, true, V12::CGlomParameters::first),
+                   makeSink(), 3);
+        glom.addItem(makeFragment(100, 0));
+        glom.addItem(makeFragment(105, 1));
+        glom.addItem(makeFragment(110, 2));   // window is inclusive
+        glom.addItem(makeFragment(111, 0));
+        glom.flush();
+
+        EQMSG("params + 2 events", size_t(3), m_output.size());
+        EQMSG("event count", size_t(2), glom.getEventCount());
+        EQMSG("fragment count", size_t(4), glom.getFragmentCount());
+
+        EQMSG("composite type", V12::COMP_PHYSICS_EVENT, m_output[1].type());
+        EQMSG("source id", uint32_t(3), m_output[1].getSourceId());
+
+        V12::CCompositeRingItem event(m_output[1]);
+        EQMSG("3 fragments", size_t(3), event.count());
+        EQMSG("fragment 0", uint64_t(100), event[0]->getEventTimestamp());
+        EQMSG("fragment 2", uint64_t(110), event[2]->getEventTimestamp());
+        EQMSG("fragment source", uint32_t(1), event[1]->getSourceId());
+
+        V12::CCompositeRingItem event2(m_output[2]);
+        EQMSG("1 fragment", size_t(1), event2.count());
+    }
+
+    void build_1() {
+        // fragments are stored verbatim
+        CGlom glom(V12::CGlomParameters(10, true, V12::CGlomParameters::first),
+                   makeSink());
+        auto fragment = makeFragment(100, 7);
+        glom.addItem(fragment);
+        glom.flush();
+
+        auto& body = m_output.at(1).getBody();
+        V12::CRawRingItem child(body.begin(), body.end());
+        EQMSG("size", fragment.size(), uint32_t(body.size()));
+        EQMSG("child body", fragment.getBody(), child.getBody());
+        EQMSG("child source", uint32_t(7), child.getSourceId());
+    }
+
+    void checkPolicy(V12::CGlomParameters::TimestampPolicy policy, uint64_t expected) {
+        CGlom glom(V12::CGlomParameters(100, true, policy), makeSink());
+        glom.addItem(makeFragment(10, 0));
+        glom.addItem(makeFragment(20, 1));
+        glom.addItem(makeFragment(60, 2));
+        glom.flush();
+
+        EQMSG("timestamp", expected, m_output.at(1).getEventTimestamp());
+    }
+
+    void policy_0() { checkPolicy(V12::CGlomParameters::first, 10); }
+    void policy_1() { checkPolicy(V12::CGlomParameters::last, 60); }
+    void policy_2() { checkPolicy(V12::CGlomParameters::average, 30); }
+
+    void passThrough_0() {
+        CGlom glom(V12::CGlomParameters(10, true, V12::CGlomParameters::first),
+                   makeSink());
+        glom.addItem(makeFragment(100, 0));
+        glom.addItem(V12::CRawRingItem(V12::END_RUN, V12::NULL_TIMESTAMP, 2));
+        glom.addItem(makeFragment(101, 0));
+        glom.flush();
+
+        EQMSG("count", size_t(4), m_output.size());
+        EQMSG("event closed by state change", V12::COMP_PHYSICS_EVENT, m_output[1].type());
+        EQMSG("state change passed through", V12::END_RUN, m_output[2].type());
+        EQMSG("new event", V12::COMP_PHYSICS_EVENT, m_output[3].type());
+    }
+
+    void passThrough_1() {
+        CGlom glom(V12::CGlomParameters(10, false, V12::CGlomParameters::first),
+                   makeSink());
+        glom.addItem(makeFragment(100, 0));
+        glom.addItem(makeFragment(101, 0));
+        glom.flush();
+
+        EQMSG("count", size_t(3), m_output.size());
+        EQMSG("not building", V12::PHYSICS_EVENT, m_output[1].type());
+        EQMSG("not building", V12::PHYSICS_EVENT, m_output[2].type());
+    }
+
+    void passThrough_2() {
+        CGlom glom(V12::CGlomParameters(10, true, V12::CGlomParameters::first),
+                   makeSink());
+        glom.addItem(makeFragment(V12::NULL_TIMESTAMP, 0));
+        glom.flush();
+
+        EQMSG("count", size_t(2), m_output.size());
+        EQMSG("null timestamps are not correlated", V12::PHYSICS_EVENT, m_output[1].type());
+    }
+
+    void stream_0() {
+        stringstream input, output;
+        input << makeFragment(1, 0) << makeFragment(2, 1) << makeFragment(50, 0);
+
+        CGlom glom(V12::CGlomParameters(5, true, V12::CGlomParameters::first), output);
+        EQMSG("items read", size_t(3), glom.process(input));
+        glom.flush();
+
+        V12::CRawRingItem item;
+        output >> item;
+        EQMSG("params", V12::EVB_GLOM_INFO, item.type());
+        output >> item;
+        EQMSG("first event", uint64_t(1), item.getEventTimestamp());
+        output >> item;
+        EQMSG("second event", uint64_t(50), item.getEventTimestamp());
+    }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CGlomTest);
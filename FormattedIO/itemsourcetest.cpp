@@ -0,0 +1,208 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <Asserts.h>
+
+#include <CItemSource.h>
+#include <CRingItemQueue.h>
+#include <CReadinessSignal.h>
+#include <RingIOV12.h>
+
+#include <V12/DataFormat.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CPhysicsEventItem.h>
+#include <V12/CRingStateChangeItem.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+using namespace DAQ;
+
+class CItemSourceTests : public CppUnit::TestFixture
+{
+public:
+    CPPUNIT_TEST_SUITE(CItemSourceTests);
+    CPPUNIT_TEST(queue_0);
+    CPPUNIT_TEST(queue_1);
+    CPPUNIT_TEST(queue_2);
+    CPPUNIT_TEST(queue_3);
+    CPPUNIT_TEST(stream_0);
+    CPPUNIT_TEST(stream_1);
+    CPPUNIT_TEST(filter_0);
+    CPPUNIT_TEST(filter_1);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    V12::CPhysicsEventItem event(uint64_t stamp, uint32_t sourceId = 1) {
+        return V12::CPhysicsEventItem(stamp, sourceId, Buffer::ByteBuffer(stamp % 7, 0x5a));
+    }
+
+    void queue_0() {
+        CRingItemQueue queue(1024);
+        CQueueItemSource source(queue);
+        V12::CRawRingItem item;
+
+        EQMSG("empty queue", CItemSource::Pending, source.next(item));
+
+        writeItem(queue, event(3));
+        writeItem(queue, event(4));
+        EQMSG("first ready", CItemSource::Ready, source.next(item));
+        EQMSG("first stamp", uint64_t(3), item.getEventTimestamp());
+        EQMSG("first body", size_t(3), item.getBody().size());
+        EQMSG("second ready", CItemSource::Ready, source.next(item));
+        EQMSG("second stamp", uint64_t(4), item.getEventTimestamp());
+        EQMSG("drained", CItemSource::Pending, source.next(item));
+    }
+
+    void queue_1() {
+        // items written before closing are still delivered
+        CRingItemQueue queue(1024);
+        CQueueItemSource source(queue);
+        V12::CRawRingItem item;
+
+        writeItem(queue, event(1));
+        queue.close();
+        EQMSG("last item", CItemSource::Ready, source.next(item));
+        EQMSG("closed", CItemSource::End, source.next(item));
+        EQMSG("still closed", CItemSource::End, source.next(item));
+    }
+
+    void queue_2() {
+        // the writer notifies an attached signal, also through a filter
+        CRingItemQueue queue(1024);
+        CQueueItemSource source(queue);
+        CFilteredItemSource filtered(source, [](const V12::CRawRingItem&) { return true; });
+        auto pSignal = std::make_shared<CReadinessSignal>();
+
+        ASSERTMSG("queue sources notify", filtered.setReadinessSignal(pSignal));
+        writeItem(queue, event(1));
+        EQMSG("commit", uint64_t(1), pSignal->getCount());
+        ASSERTMSG("no wait once notified", pSignal->wait(0, std::chrono::microseconds(0)));
+
+        filtered.setReadinessSignal(nullptr);
+        writeItem(queue, event(2));
+        EQMSG("detached", uint64_t(1), pSignal->getCount());
+        ASSERTMSG("times out", !pSignal->wait(1, std::chrono::microseconds(100)));
+
+        source.setReadinessSignal(pSignal);
+        queue.close();
+        EQMSG("close", uint64_t(2), pSignal->getCount());
+    }
+
+    void queue_3() {
+        // a detached signal lives until the writer lets go of it
+        CRingItemQueue queue(1024);
+        CQueueItemSource source(queue);
+        auto pSignal = std::make_shared<CReadinessSignal>();
+        std::weak_ptr<CReadinessSignal> pWeak(pSignal);
+
+        source.setReadinessSignal(pSignal);
+        writeItem(queue, event(1));
+        source.setReadinessSignal(nullptr);
+        pSignal.reset();
+        ASSERTMSG("held by the writer", !pWeak.expired());
+
+        writeItem(queue, event(2));
+        ASSERTMSG("released on the next commit", pWeak.expired());
+    }
+
+    void stream_0() {
+        stringstream stream;
+        for (uint64_t i=0; i<5; ++i) {
+            stream << V12::CRawRingItem(event(i));
+        }
+
+        CStreamItemSource source(stream);
+        V12::CRawRingItem item;
+        for (uint64_t i=0; i<5; ++i) {
+            EQMSG("ready", CItemSource::Ready, source.next(item));
+            EQMSG("stamp", i, item.getEventTimestamp());
+        }
+        EQMSG("end", CItemSource::End, source.next(item));
+    }
+
+    void stream_1() {
+        stringstream whole;
+        whole << V12::CRawRingItem(event(6));
+        string bytes = whole.str();
+        stringstream stream(bytes.substr(0, bytes.size() - 2));
+
+        CStreamItemSource source(stream);
+        V12::CRawRingItem item;
+        CPPUNIT_ASSERT_THROW_MESSAGE("truncated item",
+                                     source.next(item),
+                                     std::runtime_error);
+    }
+
+    void filter_0() {
+        // filters compose and pass Pending and End through
+        CRingItemQueue queue(4096);
+        CQueueItemSource queued(queue);
+        CFilteredItemSource physics(queued, [](const V12::CRawRingItem& item) {
+            return item.type() == V12::PHYSICS_EVENT;
+        });
+        CFilteredItemSource fromTwo(physics, [](const V12::CRawRingItem& item) {
+            return item.getSourceId() == 2;
+        });
+
+        V12::CRawRingItem item;
+        EQMSG("nothing yet", CItemSource::Pending, fromTwo.next(item));
+
+        writeItem(queue, V12::CRingStateChangeItem(V12::BEGIN_RUN));
+        for (uint64_t i=0; i<6; ++i) {
+            writeItem(queue, event(i, i % 3));
+        }
+        queue.close();
+
+        EQMSG("first match", CItemSource::Ready, fromTwo.next(item));
+        EQMSG("first stamp", uint64_t(2), item.getEventTimestamp());
+        EQMSG("second match", CItemSource::Ready, fromTwo.next(item));
+        EQMSG("second stamp", uint64_t(5), item.getEventTimestamp());
+        EQMSG("end", CItemSource::End, fromTwo.next(item));
+        ASSERTMSG("upstream consumed", queue.empty());
+    }
+
+    void filter_1() {
+        // nothing is pulled until the filter is
+        CRingItemQueue queue(1024);
+        CQueueItemSource queued(queue);
+        size_t nCalls = 0;
+        CFilteredItemSource counting(queued, [&nCalls](const V12::CRawRingItem&) {
+            ++nCalls;
+            return true;
+        });
+
+        writeItem(queue, event(1));
+        writeItem(queue, event(2));
+        EQMSG("lazy", size_t(0), nCalls);
+
+        V12::CRawRingItem item;
+        counting.next(item);
+        EQMSG("one pulled", size_t(1), nCalls);
+        ASSERTMSG("one left", !queue.empty());
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CItemSourceTests);
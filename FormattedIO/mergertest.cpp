@@ -0,0 +1,199 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+         NSCL
+         Michigan State University
+         East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <Asserts.h>
+
+#include <CRingItemMerger.h>
+#include <RingIOV12.h>
+#include <V12/CRawRingItem.h>
+#include <V12/DataFormat.h>
+
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace DAQ;
+
+class CRingItemMergerTest : public CppUnit::TestFixture
+{
+public:
+    CPPUNIT_TEST_SUITE( CRingItemMergerTest );
+    CPPUNIT_TEST ( merge_0 );
+    CPPUNIT_TEST ( merge_1 );
+    CPPUNIT_TEST ( merge_2 );
+    CPPUNIT_TEST ( merge_3 );
+    CPPUNIT_TEST ( null_0 );
+    CPPUNIT_TEST ( null_1 );
+    CPPUNIT_TEST ( null_2 );
+    CPPUNIT_TEST ( stream_0 );
+    CPPUNIT_TEST ( stream_1 );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    // encode the source and the position in the source in the body
+    V12::CRawRingItem makeItem(uint32_t sourceId, uint64_t tstamp, uint8_t position) {
+        V12::CRawRingItem item(V12::PHYSICS_EVENT, tstamp, sourceId);
+        item.getBody().push_back(position);
+        return item;
+    }
+
+    CRingItemMerger::Input makeInput(const vector<V12::CRawRingItem>& items) {
+        auto pos = std::make_shared<size_t>(0);
+        return [items, pos](V12::CRawRingItem& item) {
+            if (*pos == items.size()) {
+                return false;
+            }
+            item = items[(*pos)++];
+            return true;
+        };
+    }
+
+    // summarize the merged output as a list of (sourceId, position) pairs
+    vector<pair<uint32_t, int> > drain(CRingItemMerger& merger) {
+        vector<pair<uint32_t, int> > result;
+        merger.merge([&result](const V12::CRawRingItem& item) {
+            result.push_back(make_pair(item.getSourceId(), int(item.getBody().at(0))));
+        });
+        return result;
+    }
+
+    void merge_0() {
+        CRingItemMerger merger;
+        merger.addInput(makeInput({makeItem(0, 1, 0), makeItem(0, 4, 1), makeItem(0, 5, 2)}));
+        merger.addInput(makeInput({makeItem(1, 2, 0), makeItem(1, 3, 1), makeItem(1, 6, 2)}));
+
+        vector<pair<uint32_t, int> > expected = {
+            {0, 0}, {1, 0}, {1, 1}, {0, 1}, {0, 2}, {1, 2}
+        };
+        ASSERTMSG("items are ordered by timestamp", expected == drain(merger));
+    }
+
+    void merge_1() {
+        CRingItemMerger merger;
+        merger.addInput(makeInput({makeItem(0, 5, 0)}));
+        merger.addInput(makeInput({makeItem(1, 5, 0)}));
+        merger.addInput(makeInput({makeItem(2, 5, 0)}));
+
+        vector<pair<uint32_t, int> > expected = { {0, 0}, {1, 0}, {2, 0} };
+        ASSERTMSG("ties are broken by input order", expected == drain(merger));
+    }
+
+    void merge_2() {
+        CRingItemMerger merger;
+        merger.addInput(makeInput({}));
+        merger.addInput(makeInput({makeItem(1, 5, 0)}));
+
+        V12::CRawRingItem item;
+        EQMSG("first", true, merger.next(item));
+        EQMSG("source", uint32_t(1), item.getSourceId());
+        EQMSG("exhausted", false, merger.next(item));
+        EQMSG("stays exhausted", false, merger.next(item));
+    }
+
+    void merge_3() {
+        CRingItemMerger merger;
+        merger.addInput(makeInput({makeItem(0, 1, 0)}));
+
+        V12::CRawRingItem item;
+        merger.next(item);
+        CPPUNIT_ASSERT_THROW_MESSAGE("no inputs after merging has started",
+                                     merger.addInput(makeInput({})),
+                                     std::logic_error);
+    }
+
+    void null_0() {
+        CRingItemMerger merger(CRingItemMerger::Barrier);
+        merger.addInput(makeInput({makeItem(0, V12::NULL_TIMESTAMP, 0),
+                                   makeItem(0, 1, 1),
+                                   makeItem(0, V12::NULL_TIMESTAMP, 2)}));
+        merger.addInput(makeInput({makeItem(1, 2, 0),
+                                   makeItem(1, V12::NULL_TIMESTAMP, 1),
+                                   makeItem(1, 3, 2),
+                                   makeItem(1, V12::NULL_TIMESTAMP, 3)}));
+
+        vector<pair<uint32_t, int> > expected = {
+            {1, 0},           // only timestamped item before the first barrier
+            {0, 0}, {1, 1},   // barrier
+            {0, 1}, {1, 2},
+            {0, 2}, {1, 3}    // barrier
+        };
+        ASSERTMSG("barrier items are emitted together", expected == drain(merger));
+    }
+
+    void null_1() {
+        CRingItemMerger merger(CRingItemMerger::Immediate);
+        merger.addInput(makeInput({makeItem(0, 10, 0), makeItem(0, V12::NULL_TIMESTAMP, 1)}));
+        merger.addInput(makeInput({makeItem(1, 1, 0), makeItem(1, 20, 1)}));
+
+        vector<pair<uint32_t, int> > expected = { {1, 0}, {0, 0}, {0, 1}, {1, 1} };
+        ASSERTMSG("null timestamps are emitted once at the head", expected == drain(merger));
+    }
+
+    void null_2() {
+        CRingItemMerger merger(CRingItemMerger::InheritPrevious);
+        merger.addInput(makeInput({makeItem(0, 10, 0),
+                                   makeItem(0, V12::NULL_TIMESTAMP, 1),
+                                   makeItem(0, 30, 2)}));
+        merger.addInput(makeInput({makeItem(1, 5, 0), makeItem(1, 20, 1)}));
+
+        vector<pair<uint32_t, int> > expected = { {1, 0}, {0, 0}, {0, 1}, {1, 1}, {0, 2} };
+        ASSERTMSG("null timestamps inherit previous", expected == drain(merger));
+    }
+
+    void stream_0() {
+        stringstream in0, in1, out;
+        in0 << makeItem(0, 1, 0) << makeItem(0, 3, 1);
+        in1 << makeItem(1, 2, 0);
+
+        CRingItemMerger merger;
+        merger.addInput(in0);
+        merger.addInput(in1);
+        EQMSG("item count", size_t(3), merger.merge(out));
+
+        V12::CRawRingItem item;
+        out >> item;
+        EQMSG("first", uint64_t(1), item.getEventTimestamp());
+        out >> item;
+        EQMSG("second", uint64_t(2), item.getEventTimestamp());
+        out >> item;
+        EQMSG("third", uint64_t(3), item.getEventTimestamp());
+    }
+
+    void stream_1() {
+        stringstream in0;
+        in0 << makeItem(0, 1, 0);
+        string truncated = in0.str();
+        truncated.resize(truncated.size() - 1);
+        in0.str(truncated);
+
+        CRingItemMerger merger;
+        merger.addInput(in0);
+        V12::CRawRingItem item;
+        CPPUNIT_ASSERT_THROW_MESSAGE("incomplete items are an error",
+                                     merger.next(item),
+                                     std::runtime_error);
+    }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CRingItemMergerTest);
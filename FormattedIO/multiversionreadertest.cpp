@@ -0,0 +1,325 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <Asserts.h>
+
+#include <CMultiVersionReader.h>
+#include <RingIOV10.h>
+#include <RingIOV11.h>
+#include <RingIOV12.h>
+
+#include <V8/DataFormat.h>
+#include <V8/CRawBuffer.h>
+#include <V10/DataFormat.h>
+#include <V10/CRingStateChangeItem.h>
+#include <V10/CRingScalerItem.h>
+#include <V11/DataFormat.h>
+#include <V11/CDataFormatItem.h>
+#include <V11/CRingStateChangeItem.h>
+#include <V11/CPhysicsEventItem.h>
+#include <V12/DataFormat.h>
+#include <V12/CDataFormatItem.h>
+#include <V12/CPhysicsEventItem.h>
+#include <V12/CRawRingItem.h>
+#include <ByteBuffer.h>
+
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace DAQ;
+
+// DAQ::V8::gBufferSize is defined in TestRunner.cpp to be 34.
+
+namespace {
+
+// remembers the version and type of every item it is handed
+struct Recorder {
+    vector<int>      versions;
+    vector<uint32_t> types;
+    vector<size_t>   sizes;
+    size_t           stopAfter;
+
+    Recorder(size_t stop = 0) : stopAfter(stop) {}
+
+    bool record(int version, uint32_t type, size_t size) {
+        versions.push_back(version);
+        types.push_back(type);
+        sizes.push_back(size);
+        return (stopAfter == 0) || (types.size() < stopAfter);
+    }
+
+    bool operator()(const V8::CRawBuffer& buffer) {
+        return record(8, buffer.getHeader().type, buffer.getBuffer().size());
+    }
+    bool operator()(const V10::CRingItem& item) {
+        return record(10, item.type(), item.size());
+    }
+    bool operator()(const V11::CRingItem& item) {
+        return record(11, item.type(), item.size());
+    }
+    bool operator()(const V12::CRawRingItem& item) {
+        return record(12, item.type(), item.size());
+    }
+};
+
+}
+
+class CMultiVersionReaderTests : public CppUnit::TestFixture
+{
+public:
+    CPPUNIT_TEST_SUITE(CMultiVersionReaderTests);
+    CPPUNIT_TEST(detect_0);
+    CPPUNIT_TEST(detect_1);
+    CPPUNIT_TEST(detect_2);
+    CPPUNIT_TEST(detect_3);
+    CPPUNIT_TEST(v8_0);
+    CPPUNIT_TEST(v10_0);
+    CPPUNIT_TEST(v10_1);
+    CPPUNIT_TEST(v11_0);
+    CPPUNIT_TEST(v11_1);
+    CPPUNIT_TEST(v12_0);
+    CPPUNIT_TEST(stop_0);
+    CPPUNIT_TEST(empty_0);
+    CPPUNIT_TEST(unknown_0);
+    CPPUNIT_TEST(truncated_0);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    Buffer::ByteBuffer v8Buffer(uint16_t type) {
+        vector<uint16_t> words = {17, type, 0, 1, 0, 0,
+                                  0, 0, 0, 0,
+                                  5, 0x0102, 0x0304, 0x0102, 0, 0,
+                                  0};
+        Buffer::ByteBuffer bytes;
+        bytes << words;
+        return bytes;
+    }
+
+    Buffer::ByteBuffer bytesOf(const stringstream& stream) {
+        string str = stream.str();
+        return Buffer::ByteBuffer(str.begin(), str.end());
+    }
+
+    DataFormatVersion detect(const Buffer::ByteBuffer& bytes) {
+        return detectFormat(bytes.data(), bytes.data() + bytes.size());
+    }
+
+    void detect_0() {
+        EQMSG("v8 buffer", V8Format, detect(v8Buffer(V8::DATABF)));
+
+        // the other byte order
+        auto bytes = v8Buffer(V8::DATABF);
+        for (auto p = bytes.begin(); p != bytes.end(); p += 2) {
+            std::swap(*p, *(p+1));
+        }
+        std::swap(bytes[24], bytes[26]);
+        std::swap(bytes[25], bytes[27]);
+        EQMSG("swapped v8 buffer", V8Format, detect(bytes));
+    }
+
+    void detect_1() {
+        stringstream stream;
+        stream << V10::CRingStateChangeItem(V10::BEGIN_RUN, 1, 0, 0, "title");
+        EQMSG("v10 state change", V10Format, detect(bytesOf(stream)));
+    }
+
+    void detect_2() {
+        stringstream v11, v12;
+        v11 << V11::CDataFormatItem();
+        v12 << V12::CRawRingItem(V12::CDataFormatItem());
+        EQMSG("v11 format", V11Format, detect(bytesOf(v11)));
+        EQMSG("v12 format", V12Format, detect(bytesOf(v12)));
+    }
+
+    void detect_3() {
+        Buffer::ByteBuffer garbage(32, 0xff);
+        EQMSG("garbage", UnknownFormat, detect(garbage));
+        EQMSG("too short", UnknownFormat, detect(Buffer::ByteBuffer(4, 0)));
+    }
+
+    void v8_0() {
+        stringstream stream;
+        for (auto type : {V8::BEGRUNBF, V8::DATABF, V8::ENDRUNBF}) {
+            auto bytes = v8Buffer(type);
+            stream.write(reinterpret_cast<char*>(bytes.data()), bytes.size());
+        }
+
+        CMultiVersionReader reader(stream, 5);
+        EQMSG("version", V8Format, reader.getVersion());
+
+        Recorder recorder;
+        EQMSG("count", size_t(3), reader.read(recorder));
+        EQMSG("versions", vector<int>({8, 8, 8}), recorder.versions);
+        EQMSG("types",
+              vector<uint32_t>({uint32_t(V8::BEGRUNBF), uint32_t(V8::DATABF),
+                                uint32_t(V8::ENDRUNBF)}),
+              recorder.types);
+        EQMSG("sizes", vector<size_t>(3, V8::gBufferSize), recorder.sizes);
+    }
+
+    void v10_0() {
+        V10::CRingStateChangeItem begin(V10::BEGIN_RUN, 1, 0, 0, "title");
+        V10::CRingScalerItem scaler(0, 1, 2, {1, 2, 3});
+        V10::CRingStateChangeItem end(V10::END_RUN, 1, 2, 3, "title");
+
+        stringstream stream;
+        stream << begin << scaler << end;
+
+        // a small chunk size makes items straddle reads
+        CMultiVersionReader reader(stream, 7);
+        EQMSG("version", V10Format, reader.getVersion());
+
+        Recorder recorder;
+        EQMSG("count", size_t(3), reader.read(recorder));
+        EQMSG("versions", vector<int>({10, 10, 10}), recorder.versions);
+        EQMSG("types",
+              vector<uint32_t>({V10::BEGIN_RUN, V10::INCREMENTAL_SCALERS, V10::END_RUN}),
+              recorder.types);
+        EQMSG("sizes", vector<size_t>({begin.size(), scaler.size(), end.size()}),
+              recorder.sizes);
+    }
+
+    void v10_1() {
+        // the item passed to the handler is reused, and must grow for an item
+        // larger than its storage
+        V10::CRingItem small(V10::PHYSICS_EVENT, 16);
+        small.fillBody(vector<uint32_t>({1, 2}));
+        V10::CRingItem large(V10::PHYSICS_EVENT, 40000);
+        large.fillBody(vector<uint32_t>(9000, 3));
+
+        stringstream stream;
+        stream << small << large << small;
+
+        CMultiVersionReader reader(stream, V10Format);
+        Recorder recorder;
+        EQMSG("count", size_t(3), reader.read(recorder));
+        EQMSG("sizes", vector<size_t>({small.size(), large.size(), small.size()}),
+              recorder.sizes);
+    }
+
+    void v11_0() {
+        V11::CDataFormatItem format;
+        V11::CRingStateChangeItem begin(V11::BEGIN_RUN, 1, 0, 0, "title");
+        V11::CPhysicsEventItem event(123, 4, 0);
+
+        stringstream stream;
+        stream << format << begin << event;
+
+        CMultiVersionReader reader(stream);
+        EQMSG("version", V11Format, reader.getVersion());
+
+        Recorder recorder;
+        EQMSG("count", size_t(3), reader.read(recorder));
+        EQMSG("versions", vector<int>({11, 11, 11}), recorder.versions);
+        EQMSG("types",
+              vector<uint32_t>({V11::RING_FORMAT, V11::BEGIN_RUN, V11::PHYSICS_EVENT}),
+              recorder.types);
+        EQMSG("sizes", vector<size_t>({format.size(), begin.size(), event.size()}),
+              recorder.sizes);
+    }
+
+    void v11_1() {
+        // without a format item V11 must be named explicitly
+        stringstream stream;
+        stream << V11::CRingStateChangeItem(V11::BEGIN_RUN, 1, 0, 0, "title");
+
+        CMultiVersionReader reader(stream, V11Format);
+        Recorder recorder;
+        EQMSG("count", size_t(1), reader.read(recorder));
+        EQMSG("version", 11, recorder.versions.at(0));
+
+        CPPUNIT_ASSERT_THROW_MESSAGE("unknown version is not a choice",
+                                     CMultiVersionReader(stream, UnknownFormat),
+                                     std::invalid_argument);
+    }
+
+    void v12_0() {
+        V12::CRawRingItem format(V12::CDataFormatItem(0, 1, V12::FORMAT_MAJOR, V12::FORMAT_MINOR));
+        V12::CRawRingItem event(V12::CPhysicsEventItem(1234, 5, {1, 2, 3, 4}));
+
+        stringstream stream;
+        stream << format << event << event;
+
+        CMultiVersionReader reader(stream, 11);
+        EQMSG("version", V12Format, reader.getVersion());
+
+        Recorder recorder;
+        EQMSG("count", size_t(3), reader.read(recorder));
+        EQMSG("versions", vector<int>({12, 12, 12}), recorder.versions);
+        EQMSG("types",
+              vector<uint32_t>({V12::RING_FORMAT, V12::PHYSICS_EVENT, V12::PHYSICS_EVENT}),
+              recorder.types);
+        EQMSG("sizes", vector<size_t>({format.size(), event.size(), event.size()}),
+              recorder.sizes);
+    }
+
+    void stop_0() {
+        stringstream stream;
+        stream << V11::CDataFormatItem();
+        for (uint32_t run=0; run<4; ++run) {
+            stream << V11::CRingStateChangeItem(V11::BEGIN_RUN, run, 0, 0, "title");
+        }
+
+        CMultiVersionReader reader(stream);
+        Recorder first(2);
+        EQMSG("stopped after two", size_t(2), reader.read(first));
+
+        Recorder rest;
+        EQMSG("the rest", size_t(3), reader.read(rest));
+        EQMSG("resumed on a state change", V11::BEGIN_RUN, rest.types.at(0));
+    }
+
+    void empty_0() {
+        stringstream stream;
+        CMultiVersionReader reader(stream);
+        EQMSG("version", UnknownFormat, reader.getVersion());
+
+        Recorder recorder;
+        EQMSG("no items", size_t(0), reader.read(recorder));
+    }
+
+    void unknown_0() {
+        stringstream stream(string(64, '\xff'));
+        CPPUNIT_ASSERT_THROW_MESSAGE("unrecognized data",
+                                     CMultiVersionReader reader(stream),
+                                     std::runtime_error);
+    }
+
+    void truncated_0() {
+        stringstream full;
+        full << V11::CDataFormatItem()
+             << V11::CRingStateChangeItem(V11::BEGIN_RUN, 1, 0, 0, "title");
+        string data = full.str();
+
+        stringstream stream(data.substr(0, data.size() - 10));
+        CMultiVersionReader reader(stream);
+        Recorder recorder;
+        CPPUNIT_ASSERT_THROW_MESSAGE("partial item",
+                                     reader.read(recorder),
+                                     std::runtime_error);
+        EQMSG("items before the partial one were handled", size_t(1), recorder.types.size());
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CMultiVersionReaderTests);
@@ -0,0 +1,248 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <Asserts.h>
+#include <DebugUtils.h>
+#include "TestItems.h"
+
+#include <CRecoveringReader.h>
+#include <RingIOV12.h>
+
+#include <V12/DataFormat.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CPhysicsEventItem.h>
+#include <V12/CCompositeRingItem.h>
+#include <ByteBuffer.h>
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace DAQ;
+
+class CRecoveringReaderTests : public CppUnit::TestFixture
+{
+public:
+    CPPUNIT_TEST_SUITE(CRecoveringReaderTests);
+    CPPUNIT_TEST(read_0);
+    CPPUNIT_TEST(read_1);
+    CPPUNIT_TEST(read_2);
+    CPPUNIT_TEST(read_3);
+    CPPUNIT_TEST(read_4);
+    CPPUNIT_TEST(read_5);
+    CPPUNIT_TEST(read_6);
+    CPPUNIT_TEST(read_7);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    Buffer::ByteBuffer m_data;
+    vector<size_t>     m_starts;   // offsets of the items
+
+public:
+    void setUp() {
+        m_data.clear();
+        m_starts.clear();
+    }
+    void tearDown() {}
+
+    void append(const V12::CRingItem& item) {
+        m_starts.push_back(Test::appendItem(m_data, item));
+    }
+
+    void appendEvents(size_t nEvents, uint64_t firstStamp = 0) {
+        for (size_t i=0; i<nEvents; ++i) {
+            Buffer::ByteBuffer body(4 + i % 29);
+            for (size_t j=0; j<body.size(); ++j) {
+                body[j] = uint8_t(0x11*i + 3*j + 1);
+            }
+            append(V12::CPhysicsEventItem(firstStamp + i, 1, body));
+        }
+    }
+
+    void appendComposite(uint64_t stamp) {
+        V12::CCompositeRingItem composite(V12::COMP_PHYSICS_EVENT, stamp, 0);
+        for (uint32_t source=0; source<3; ++source) {
+            composite.appendChild(V12::CRingItemPtr(
+                    new V12::CPhysicsEventItem(stamp, source, Buffer::ByteBuffer(4 + source, 0xab))));
+        }
+        append(composite);
+    }
+
+    void setWord(size_t offset, uint32_t value) {
+        std::memcpy(m_data.data() + offset, &value, sizeof(value));
+    }
+
+    // read every item, returning the timestamps
+    vector<uint64_t> readAll(CRecoveringReader& reader) {
+        vector<uint64_t> stamps;
+        V12::CRawRingItem item;
+        while (reader.read(item)) {
+            stamps.push_back(item.getEventTimestamp());
+        }
+        return stamps;
+    }
+
+    vector<uint64_t> range(uint64_t first, uint64_t last) {
+        vector<uint64_t> result;
+        for (uint64_t i=first; i<last; ++i) {
+            result.push_back(i);
+        }
+        return result;
+    }
+
+    string stream() {
+        return string(m_data.begin(), m_data.end());
+    }
+
+    void read_0() {
+        // clean data is read exactly, across small chunks
+        appendEvents(40);
+        istringstream input(stream());
+        CRecoveringReader reader(input, 3, 64*1024*1024, 16);
+
+        EQMSG("all items", range(0, 40), readAll(reader));
+        EQMSG("nothing skipped", size_t(0), reader.getSkippedRanges().size());
+        EQMSG("offset at the end", uint64_t(m_data.size()), reader.getOffset());
+    }
+
+    void read_1() {
+        // a corrupted size loses only that item
+        appendEvents(20);
+        setWord(m_starts[7], 7);
+        istringstream input(stream());
+        CRecoveringReader reader(input);
+
+        vector<uint64_t> expected = range(0, 7);
+        auto rest = range(8, 20);
+        expected.insert(expected.end(), rest.begin(), rest.end());
+        EQMSG("items around the corruption", expected, readAll(reader));
+
+        auto& skipped = reader.getSkippedRanges();
+        EQMSG("one range", size_t(1), skipped.size());
+        EQMSG("range offset", uint64_t(m_starts[7]), skipped[0].s_offset);
+        EQMSG("range length", uint64_t(m_starts[8] - m_starts[7]), skipped[0].s_length);
+        EQMSG("byte count", skipped[0].s_length, reader.getSkippedByteCount());
+    }
+
+    void read_2() {
+        // garbage between items is skipped
+        appendEvents(5);
+        size_t garbageStart = m_data.size();
+        for (size_t i=0; i<1000; ++i) {
+            m_data.push_back(uint8_t(i*37 + 5) | 1);
+        }
+        m_data.push_back(0);
+        m_data.push_back(0);
+        size_t garbageEnd = m_data.size();
+        appendEvents(5, 5);
+
+        istringstream input(stream());
+        CRecoveringReader reader(input, 3, 64*1024*1024, 64);
+
+        EQMSG("items on both sides", range(0, 10), readAll(reader));
+        auto& skipped = reader.getSkippedRanges();
+        EQMSG("one range", size_t(1), skipped.size());
+        EQMSG("range offset", uint64_t(garbageStart), skipped[0].s_offset);
+        EQMSG("range length", uint64_t(garbageEnd - garbageStart), skipped[0].s_length);
+    }
+
+    void read_3() {
+        // a composite whose children do not tile its body is rejected, and
+        // its intact children are recovered as items of their own
+        appendEvents(3);
+        appendComposite(3);
+        appendComposite(4);
+        appendEvents(3, 5);
+
+        // the first child of the first composite claims 4 more bytes
+        size_t child = m_starts[3] + sizeof(V12::RingItemHeader);
+        uint32_t childSize;
+        std::memcpy(&childSize, m_data.data() + child, sizeof(childSize));
+        setWord(child, childSize + 4);
+
+        istringstream input(stream());
+        CRecoveringReader reader(input);
+
+        vector<uint64_t> expected = {0, 1, 2, 3, 3, 4, 5, 6, 7};
+        EQMSG("bad composite dropped", expected, readAll(reader));
+        EQMSG("skipped up to the second child", uint64_t(child + childSize - m_starts[3]),
+              reader.getSkippedByteCount());
+    }
+
+    void read_4() {
+        // intact composites are returned
+        appendComposite(0);
+        appendComposite(1);
+        appendEvents(2, 2);
+        istringstream input(stream());
+        CRecoveringReader reader(input);
+
+        EQMSG("all items", range(0, 4), readAll(reader));
+        EQMSG("nothing skipped", uint64_t(0), reader.getSkippedByteCount());
+    }
+
+    void read_5() {
+        // a truncated last item is recorded as skipped
+        appendEvents(6);
+        m_data.resize(m_data.size() - 3);
+        istringstream input(stream());
+        CRecoveringReader reader(input);
+
+        EQMSG("complete items", range(0, 5), readAll(reader));
+        auto& skipped = reader.getSkippedRanges();
+        EQMSG("one range", size_t(1), skipped.size());
+        EQMSG("range offset", uint64_t(m_starts[5]), skipped[0].s_offset);
+        EQMSG("range length", uint64_t(m_data.size() - m_starts[5]), skipped[0].s_length);
+    }
+
+    void read_6() {
+        // a huge size is not trusted
+        appendEvents(10);
+        setWord(m_starts[2], 0xfffffff0);
+        istringstream input(stream());
+        CRecoveringReader reader(input);
+
+        vector<uint64_t> expected = {0, 1};
+        auto rest = range(3, 10);
+        expected.insert(expected.end(), rest.begin(), rest.end());
+        EQMSG("huge item skipped", expected, readAll(reader));
+    }
+
+    void read_7() {
+        // a corrupted header after a good item does not lose the good item,
+        // and empty input gives nothing
+        appendEvents(10);
+        setWord(m_starts[4] + sizeof(uint32_t), 0x12345678);
+        istringstream input(stream());
+        CRecoveringReader reader(input);
+
+        vector<uint64_t> expected = range(0, 4);
+        auto rest = range(5, 10);
+        expected.insert(expected.end(), rest.begin(), rest.end());
+        EQMSG("bad type skipped", expected, readAll(reader));
+
+        istringstream empty;
+        CRecoveringReader emptyReader(empty);
+        V12::CRawRingItem item;
+        ASSERTMSG("empty input", !emptyReader.read(item));
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CRecoveringReaderTests);
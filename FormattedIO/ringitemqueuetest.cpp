@@ -0,0 +1,191 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+         NSCL
+         Michigan State University
+         East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <Asserts.h>
+#include "TestItems.h"
+
+#include <CRingItemQueue.h>
+#include <RingIOV12.h>
+#include <V12/CRawRingItem.h>
+#include <V12/DataFormat.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace DAQ;
+
+class CRingItemQueueTest : public CppUnit::TestFixture
+{
+public:
+    CPPUNIT_TEST_SUITE( CRingItemQueueTest );
+    CPPUNIT_TEST ( reserve_0 );
+    CPPUNIT_TEST ( reserve_1 );
+    CPPUNIT_TEST ( reserve_2 );
+    CPPUNIT_TEST ( peek_0 );
+    CPPUNIT_TEST ( wrap_0 );
+    CPPUNIT_TEST ( wrap_1 );
+    CPPUNIT_TEST ( wrap_2 );
+    CPPUNIT_TEST ( readWrite_0 );
+    CPPUNIT_TEST ( readWrite_1 );
+    CPPUNIT_TEST ( threaded_0 );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    void reserve_0() {
+        CRingItemQueue queue(64);
+        ASSERTMSG("reserve space in empty queue", queue.reserve(30) != nullptr);
+        queue.commit(30);
+        EQMSG("item is padded to 4 bytes", size_t(32), queue.getUsedBytes());
+        ASSERTMSG("second item fits", queue.reserve(32) != nullptr);
+        queue.commit(32);
+        ASSERTMSG("full queue refuses", queue.reserve(20) == nullptr);
+    }
+
+    void reserve_1() {
+        CRingItemQueue queue(64);
+        CPPUNIT_ASSERT_THROW_MESSAGE("items larger than the queue are an error",
+                                     queue.reserve(68), std::invalid_argument);
+    }
+
+    void reserve_2() {
+        CPPUNIT_ASSERT_THROW_MESSAGE("capacity must hold a header",
+                                     CRingItemQueue queue(16), std::invalid_argument);
+    }
+
+    void peek_0() {
+        CRingItemQueue queue(64);
+        size_t nBytes;
+        ASSERTMSG("empty queue peek", queue.peek(nBytes) == nullptr);
+        EQMSG("empty queue size", size_t(0), nBytes);
+        ASSERTMSG("empty", queue.empty());
+    }
+
+    void wrap_0() {
+        CRingItemQueue queue(64);
+
+        writeItem(queue, Test::makeItem(1, 4));   // 24 bytes
+        writeItem(queue, Test::makeItem(2, 4));   // 24 bytes
+
+        V12::CRawRingItem item;
+        readItem(queue, item);
+
+        // 16 bytes remain at the end, so this must go to the front
+        writeItem(queue, Test::makeItem(3, 4));
+
+        readItem(queue, item);
+        EQMSG("second item", uint32_t(2), item.getSourceId());
+        readItem(queue, item);
+        EQMSG("wrapped item", uint32_t(3), item.getSourceId());
+        EQMSG("wrapped item body", Test::makeItem(3, 4).getBody(), item.getBody());
+        ASSERTMSG("empty after wrap", queue.empty());
+    }
+
+    void wrap_1() {
+        // an empty queue takes any item that fits in the capacity, wherever
+        // the last item ended
+        CRingItemQueue queue(100);
+        V12::CRawRingItem item;
+        writeItem(queue, Test::makeItem(1, 40));      // 60 bytes
+        readItem(queue, item);
+
+        uint8_t* pItem = queue.reserve(80);
+        ASSERTMSG("large item after the write offset moved", pItem != nullptr);
+        V12::serializeHeader(Test::makeItem(2, 60), pItem);
+        queue.commit(80);
+        EQMSG("used", size_t(80), queue.getUsedBytes());
+
+        size_t nBytes;
+        const uint8_t* pPeeked = queue.peek(nBytes);
+        ASSERTMSG("item is at the start", pPeeked == pItem);
+        EQMSG("size", size_t(80), nBytes);
+        queue.release();
+        ASSERTMSG("empty", queue.empty());
+    }
+
+    void wrap_2() {
+        // fill and drain past the wrap point many times with items larger
+        // than half the capacity
+        CRingItemQueue queue(100);
+        V12::CRawRingItem item;
+        for (uint32_t i=0; i<50; ++i) {
+            size_t bodySize = 32 + (i*7) % 49;      // 52 to 100 bytes in total
+            writeItem(queue, Test::makeItem(i, bodySize));
+            readItem(queue, item);
+            EQMSG("source id", i, item.getSourceId());
+            EQMSG("body", Test::makeItem(i, bodySize).getBody(), item.getBody());
+            ASSERTMSG("empty", queue.empty());
+        }
+    }
+
+    void readWrite_0() {
+        CRingItemQueue queue(1024);
+        auto expected = Test::makeItem(7, 13);
+        queue << expected;
+
+        V12::CRawRingItem item;
+        queue >> item;
+        EQMSG("type", expected.type(), item.type());
+        EQMSG("timestamp", expected.getEventTimestamp(), item.getEventTimestamp());
+        EQMSG("source id", expected.getSourceId(), item.getSourceId());
+        EQMSG("body", expected.getBody(), item.getBody());
+        EQMSG("native byte order", false, item.mustSwap());
+    }
+
+    void readWrite_1() {
+        CRingItemQueue queue(1024);
+        writeItem(queue, Test::makeItem(1, 1));
+        queue.close();
+
+        V12::CRawRingItem item;
+        EQMSG("items are drained after close", true, readItem(queue, item));
+        EQMSG("closed and empty", false, readItem(queue, item));
+    }
+
+    void threaded_0() {
+        CRingItemQueue queue(256);
+        const uint32_t nItems = 10000;
+
+        std::thread producer([&queue, nItems, this]() {
+            for (uint32_t i=0; i<nItems; ++i) {
+                writeItem(queue, Test::makeItem(i, i%50));
+            }
+            queue.close();
+        });
+
+        bool inOrder = true;
+        uint32_t count = 0;
+        V12::CRawRingItem item;
+        while (readItem(queue, item)) {
+            inOrder = inOrder && (item.getSourceId() == count)
+                              && (item.getBody() == Test::makeItem(count, count%50).getBody());
+            ++count;
+        }
+        producer.join();
+
+        EQMSG("all items received", nItems, count);
+        ASSERTMSG("items received in order and intact", inOrder);
+    }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CRingItemQueueTest);
@@ -0,0 +1,225 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+         NSCL
+         Michigan State University
+         East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <Asserts.h>
+
+#include <CScalerExtractor.h>
+#include <RingIOV12.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CRingScalerItem.h>
+#include <V12/DataFormat.h>
+#include <ByteBuffer.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace DAQ;
+
+class CScalerExtractorTest : public CppUnit::TestFixture
+{
+public:
+    CPPUNIT_TEST_SUITE( CScalerExtractorTest );
+    CPPUNIT_TEST ( extract_0 );
+    CPPUNIT_TEST ( extract_1 );
+    CPPUNIT_TEST ( extract_2 );
+    CPPUNIT_TEST ( swap_0 );
+    CPPUNIT_TEST ( composite_0 );
+    CPPUNIT_TEST ( stream_0 );
+    CPPUNIT_TEST ( file_0 );
+    CPPUNIT_TEST ( file_1 );
+    CPPUNIT_TEST ( file_2 );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    V12::CRawRingItem makeScaler(uint32_t sourceId, uint32_t start, uint32_t stop,
+                                 vector<uint32_t> values, bool incremental = true,
+                                 uint32_t width = 32, uint32_t divisor = 1) {
+        V12::CRingScalerItem item(start*100, sourceId, start, stop, 1000+stop,
+                                  values, divisor, incremental, width);
+        return V12::CRawRingItem(item);
+    }
+
+    Buffer::ByteBuffer serialize(const V12::CRawRingItem& item) {
+        Buffer::ByteBuffer data(20);
+        V12::serializeHeader(item, data.begin());
+        data.insert(data.end(), item.getBody().begin(), item.getBody().end());
+        return data;
+    }
+
+    void extract_0() {
+        CScalerExtractor extractor;
+        EQMSG("scaler", size_t(1), extractor.addItem(makeScaler(1, 0, 2, {10, 20})));
+        EQMSG("scaler", size_t(1), extractor.addItem(makeScaler(1, 2, 6, {40, 0})));
+
+        auto& series = extractor.getSeries(1);
+        EQMSG("rows", size_t(2), series.getRowCount());
+        EQMSG("channels", size_t(2), series.getChannelCount());
+        ASSERTMSG("start", vector<uint32_t>({0, 2}) == series.getStartOffsets());
+        ASSERTMSG("end", vector<uint32_t>({2, 6}) == series.getEndOffsets());
+        ASSERTMSG("unix time", vector<uint32_t>({1002, 1006}) == series.getTimestamps());
+        ASSERTMSG("event tstamp", vector<uint64_t>({0, 200}) == series.getEventTimestamps());
+        ASSERTMSG("channel 0", vector<uint32_t>({10, 40}) == series.getValues(0));
+
+        ASSERTMSG("incremental rate", vector<double>({5, 10}) == series.getIncrementalRates(0));
+        ASSERTMSG("running rate", vector<double>({5, 50.0/6}) == series.getRunningRates(0));
+        ASSERTMSG("idle channel", vector<double>({10, 0}) == series.getIncrementalRates(1));
+    }
+
+    void extract_1() {
+        // non-incremental 24-bit scalers wrap
+        CScalerExtractor extractor;
+        extractor.addItem(makeScaler(2, 0, 10, {0xfffff0}, false, 24, 2));
+        extractor.addItem(makeScaler(2, 10, 20, {0x10}, false, 24, 2));
+
+        auto& series = extractor.getSeries(2);
+        ASSERTMSG("divisors", vector<uint32_t>({2, 2}) == series.getDivisors());
+        EQMSG("first interval", double(0xfffff0)/5, series.getIncrementalRates(0).at(0));
+        EQMSG("wrapped interval", double(0x20)/5, series.getIncrementalRates(0).at(1));
+        EQMSG("running", double(0x1000010)/10, series.getRunningRates(0).at(1));
+    }
+
+    void extract_2() {
+        CScalerExtractor extractor;
+        extractor.addItem(makeScaler(3, 0, 1, {1, 2}));
+        CPPUNIT_ASSERT_THROW_MESSAGE("channel count cannot change",
+                                     extractor.addItem(makeScaler(3, 1, 2, {1})),
+                                     std::runtime_error);
+        CPPUNIT_ASSERT_THROW_MESSAGE("unknown source",
+                                     extractor.getSeries(4),
+                                     std::out_of_range);
+    }
+
+    void swap_0() {
+        auto data = serialize(makeScaler(5, 1, 3, {7, 8, 9}));
+
+        // reverse the byte order of every field
+        Buffer::ByteBuffer swapped(data.size());
+        for (size_t i=0; i<data.size(); i += 4) {
+            size_t width = (i == 8) ? 8 : 4;
+            std::reverse_copy(data.begin()+i, data.begin()+i+width, swapped.begin()+i);
+            i += width - 4;
+        }
+
+        CScalerExtractor extractor;
+        extractor.addItem(swapped.data(), swapped.data() + swapped.size());
+
+        auto& series = extractor.getSeries(5);
+        ASSERTMSG("values", vector<uint32_t>({8}) == series.getValues(1));
+        ASSERTMSG("end", vector<uint32_t>({3}) == series.getEndOffsets());
+        ASSERTMSG("event tstamp", vector<uint64_t>({100}) == series.getEventTimestamps());
+    }
+
+    void composite_0() {
+        Buffer::ByteBuffer body = serialize(makeScaler(1, 0, 1, {1}));
+        Buffer::ByteBuffer child = serialize(makeScaler(2, 0, 1, {2}));
+        body.insert(body.end(), child.begin(), child.end());
+
+        V12::CRawRingItem composite(V12::COMP_PERIODIC_SCALERS, 0, 9, body);
+
+        CScalerExtractor extractor;
+        EQMSG("children", size_t(2), extractor.addItem(composite));
+        EQMSG("series", size_t(2), extractor.getSeries().size());
+        EQMSG("source 2", uint32_t(2), extractor.getSeries(2).getValues(0).at(0));
+    }
+
+    void stream_0() {
+        stringstream stream;
+        stream << makeScaler(1, 0, 1, {1});
+        stream << V12::CRawRingItem(V12::PHYSICS_EVENT, 12, 1, {1, 2, 3, 4});
+        stream << makeScaler(1, 1, 2, {2});
+
+        CScalerExtractor extractor;
+        EQMSG("scalers", size_t(2), extractor.process(stream));
+        EQMSG("rows", size_t(2), extractor.getSeries(1).getRowCount());
+    }
+
+    void file_0() {
+        CScalerExtractor extractor;
+        extractor.addItem(makeScaler(1, 0, 2, {10, 20}));
+        extractor.addItem(makeScaler(1, 2, 6, {40, 0}));
+        extractor.addItem(makeScaler(7, 0, 10, {5}, false, 24));
+
+        stringstream file;
+        extractor.write(file);
+
+        CScalerExtractor copy;
+        copy.read(file);
+        EQMSG("series", size_t(2), copy.getSeries().size());
+        ASSERTMSG("source 1", extractor.getSeries(1) == copy.getSeries(1));
+        ASSERTMSG("source 7", extractor.getSeries(7) == copy.getSeries(7));
+
+        // rows appended after reading continue the running rates
+        extractor.addItem(makeScaler(7, 10, 20, {15}, false, 24));
+        copy.addItem(makeScaler(7, 10, 20, {15}, false, 24));
+        ASSERTMSG("appended", extractor.getSeries(7) == copy.getSeries(7));
+    }
+
+    void file_1() {
+        stringstream file("not a scaler file at all");
+        CScalerExtractor extractor;
+        CPPUNIT_ASSERT_THROW_MESSAGE("bad magic",
+                                     extractor.read(file),
+                                     std::runtime_error);
+    }
+
+    void file_2() {
+        CScalerExtractor extractor;
+        extractor.addItem(makeScaler(1, 0, 2, {10, 20}));
+        extractor.addItem(makeScaler(1, 2, 6, {40, 0}));
+        stringstream file;
+        extractor.write(file);
+        string data = file.str();
+
+        // the series header follows the 20 byte file header
+        const size_t channelsOffset = 24, rowsOffset = 28;
+        vector<pair<string, string> > corrupt;
+
+        corrupt.push_back(make_pair("truncated", data.substr(0, data.size() - 1)));
+
+        string data2 = data;
+        uint64_t nRows = uint64_t(1) << 62;
+        data2.replace(rowsOffset, sizeof(nRows), reinterpret_cast<char*>(&nRows), sizeof(nRows));
+        corrupt.push_back(make_pair("overflowing row count", data2));
+
+        nRows = 1000;
+        data2.replace(rowsOffset, sizeof(nRows), reinterpret_cast<char*>(&nRows), sizeof(nRows));
+        corrupt.push_back(make_pair("row count past the end", data2));
+
+        data2 = data;
+        uint32_t nChannels = 0xffffffff;
+        data2.replace(channelsOffset, sizeof(nChannels), reinterpret_cast<char*>(&nChannels), sizeof(nChannels));
+        corrupt.push_back(make_pair("huge channel count", data2));
+
+        for (auto& bad : corrupt) {
+            stringstream badFile(bad.second);
+            CScalerExtractor copy;
+            CPPUNIT_ASSERT_THROW_MESSAGE(bad.first, copy.read(badFile), std::runtime_error);
+        }
+    }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CScalerExtractorTest);
@@ -0,0 +1,309 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+         NSCL
+         Michigan State University
+         East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <Asserts.h>
+#include "TestItems.h"
+
+#include <CShmRing.h>
+#include <RingIOV12.h>
+#include <V12/CRawRingItem.h>
+#include <V12/DataFormat.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace DAQ;
+
+extern std::string uniqueName(std::string baseName);
+
+class CShmRingTest : public CppUnit::TestFixture
+{
+private:
+    std::string m_name;
+
+public:
+    CPPUNIT_TEST_SUITE( CShmRingTest );
+    CPPUNIT_TEST ( create_0 );
+    CPPUNIT_TEST ( create_1 );
+    CPPUNIT_TEST ( attach_0 );
+    CPPUNIT_TEST ( attach_1 );
+    CPPUNIT_TEST ( attach_2 );
+    CPPUNIT_TEST ( put_0 );
+    CPPUNIT_TEST ( cursors_0 );
+    CPPUNIT_TEST ( wrap_0 );
+    CPPUNIT_TEST ( eof_0 );
+    CPPUNIT_TEST ( item_0 );
+    CPPUNIT_TEST ( item_1 );
+    CPPUNIT_TEST ( item_2 );
+    CPPUNIT_TEST ( select_0 );
+    CPPUNIT_TEST ( process_0 );
+    CPPUNIT_TEST ( deadConsumer_0 );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {
+        m_name = uniqueName("shmringtest");
+        CShmRing::create(m_name, 100, 4);
+    }
+
+    void tearDown() {
+        if (CShmRing::exists(m_name)) {
+            CShmRing::remove(m_name);
+        }
+    }
+
+    void create_0() {
+        ASSERTMSG("ring exists after create", CShmRing::exists(m_name));
+        CShmRing ring(m_name);
+        EQMSG("capacity rounded to power of 2", size_t(128), ring.capacity());
+        EQMSG("max consumers", 4u, ring.getMaxConsumers());
+    }
+
+    void create_1() {
+        CPPUNIT_ASSERT_THROW_MESSAGE("creating an existing ring fails",
+                                     CShmRing::create(m_name, 100),
+                                     std::runtime_error);
+    }
+
+    void attach_0() {
+        CPPUNIT_ASSERT_THROW_MESSAGE("attaching to a nonexistent ring fails",
+                                     CShmRingSource source(m_name + "_nope"),
+                                     std::runtime_error);
+    }
+
+    void attach_1() {
+        CShmRingSink sink(m_name);
+        CPPUNIT_ASSERT_THROW_MESSAGE("only one producer",
+                                     CShmRingSink sink2(m_name),
+                                     std::runtime_error);
+    }
+
+    void attach_2() {
+        vector<unique_ptr<CShmRingSource> > sources;
+        for (int i=0; i<4; ++i) {
+            sources.emplace_back(new CShmRingSource(m_name));
+        }
+        CPPUNIT_ASSERT_THROW_MESSAGE("consumer slots are limited",
+                                     CShmRingSource source(m_name),
+                                     std::runtime_error);
+        sources.pop_back();
+        CShmRingSource source(m_name); // slot was released
+    }
+
+    void put_0() {
+        CShmRingSink sink(m_name);
+        CShmRingSource source(m_name);
+
+        vector<uint8_t> data = {0, 1, 2, 3, 4, 5};
+        sink.put(data.data(), data.size());
+        EQMSG("available", size_t(6), source.availableData());
+
+        vector<uint8_t> result(3);
+        EQMSG("peek count", size_t(3), source.peek(result.data(), result.size()));
+        EQMSG("peek data", vector<uint8_t>({0, 1, 2}), result);
+        EQMSG("peek does not consume", size_t(6), source.availableData());
+
+        source.ignore(2);
+        EQMSG("read count", size_t(3), source.read(result.data(), result.size()));
+        EQMSG("read data", vector<uint8_t>({2, 3, 4}), result);
+        EQMSG("remaining", size_t(1), source.availableData());
+        EQMSG("free space limited by consumer", size_t(127), sink.freeSpace());
+    }
+
+    void cursors_0() {
+        CShmRingSink sink(m_name);
+        CShmRingSource early(m_name);
+
+        vector<uint8_t> data = {0, 1, 2, 3};
+        sink.put(data.data(), data.size());
+
+        CShmRingSource late(m_name);
+        EQMSG("late consumer starts at newest data", size_t(0), late.availableData());
+
+        sink.put(data.data(), data.size());
+        EQMSG("early consumer sees everything", size_t(8), early.availableData());
+        EQMSG("late consumer sees new data", size_t(4), late.availableData());
+
+        late.ignore(4);
+        EQMSG("free space limited by slowest consumer", size_t(120), sink.freeSpace());
+    }
+
+    void wrap_0() {
+        CShmRingSink sink(m_name);
+        CShmRingSource source(m_name);
+
+        bool ok = true;
+        vector<uint8_t> data(50), result(50);
+        for (int i=0; i<20; ++i) {
+            for (size_t j=0; j<data.size(); ++j) data[j] = uint8_t(i+j);
+            sink.put(data.data(), data.size());
+            source.read(result.data(), result.size());
+            ok = ok && (data == result);
+        }
+        ASSERTMSG("data survives wrapping", ok);
+    }
+
+    void eof_0() {
+        unique_ptr<CShmRingSink> pSink(new CShmRingSink(m_name));
+        CShmRingSource source(m_name);
+
+        uint32_t value = 42;
+        pSink->put(&value, sizeof(value));
+        pSink.reset();
+
+        EQMSG("data remains after producer detaches", false, source.eof());
+        source.ignore(sizeof(value));
+        EQMSG("eof once drained", true, source.eof());
+
+        EQMSG("read does not block after eof", size_t(0), source.read(&value, sizeof(value)));
+    }
+
+    void item_0() {
+        CShmRingSink sink(m_name);
+        CShmRingSource source(m_name);
+
+        auto expected = Test::makeItem(3, 17);
+        writeItem(sink, expected);
+
+        V12::CRawRingItem item;
+        EQMSG("item read", true, readItem(source, item, std::chrono::microseconds(0)));
+        EQMSG("type", expected.type(), item.type());
+        EQMSG("timestamp", expected.getEventTimestamp(), item.getEventTimestamp());
+        EQMSG("source id", expected.getSourceId(), item.getSourceId());
+        EQMSG("body", expected.getBody(), item.getBody());
+    }
+
+    void item_1() {
+        CShmRingSink sink(m_name);
+        CShmRingSource source(m_name);
+
+        // only part of the header is present
+        uint32_t size = 24;
+        sink.put(&size, sizeof(size));
+
+        V12::CRawRingItem item;
+        EQMSG("incomplete items are not read", false,
+              readItem(source, item, std::chrono::microseconds(1000)));
+        EQMSG("incomplete items are not consumed", sizeof(size), source.availableData());
+    }
+
+    void item_2() {
+        // items that wrap around the end of the ring are read intact
+        CShmRingSink sink(m_name);
+        CShmRingSource source(m_name);
+
+        V12::CRawRingItem item;
+        for (uint32_t i=0; i<40; ++i) {
+            auto expected = Test::makeItem(i, 9 + i%30);
+            writeItem(sink, expected);
+            EQMSG("item read", true, readItem(source, item, std::chrono::microseconds(0)));
+            EQMSG("source id", i, item.getSourceId());
+            EQMSG("body", expected.getBody(), item.getBody());
+        }
+    }
+
+    void select_0() {
+        CShmRingSink sink(m_name);
+        CShmRingSource source(m_name);
+
+        writeItem(sink, V12::CRawRingItem(V12::BEGIN_RUN, 0, 1));
+        writeItem(sink, Test::makeItem(2, 8));
+        writeItem(sink, V12::CRawRingItem(V12::END_RUN, 0, 3));
+
+        // skip everything but physics events
+        auto pred = [](CShmRingSource& source) {
+            uint32_t header[2];
+            if (source.peek(header, sizeof(header)) < sizeof(header)) {
+                return false;
+            }
+            if (header[1] == V12::PHYSICS_EVENT) {
+                return true;
+            }
+            source.ignore(header[0]);
+            return false;
+        };
+
+        V12::CRawRingItem item;
+        EQMSG("found", true, readItemIf(source, item, pred));
+        EQMSG("physics event", uint32_t(2), item.getSourceId());
+        EQMSG("end run remains", size_t(20), source.availableData());
+    }
+
+    void process_0() {
+        const uint32_t nItems = 1000;
+        CShmRingSource source(m_name);
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            try {
+                CShmRingSink sink(m_name);
+                for (uint32_t i=0; i<nItems; ++i) {
+                    writeItem(sink, Test::makeItem(i, i%40));
+                }
+            } catch (...) {
+                _exit(1);
+            }
+            _exit(0);
+        }
+
+        bool inOrder = true;
+        uint32_t count = 0;
+        V12::CRawRingItem item;
+        while (readItem(source, item, std::chrono::seconds(10))) {
+            inOrder = inOrder && (item.getSourceId() == count)
+                              && (item.getBody() == Test::makeItem(count, count%40).getBody());
+            ++count;
+        }
+
+        int status;
+        waitpid(pid, &status, 0);
+
+        EQMSG("producer process succeeded", 0, WEXITSTATUS(status));
+        EQMSG("all items received", nItems, count);
+        ASSERTMSG("items received in order and intact", inOrder);
+    }
+
+    void deadConsumer_0() {
+        // a consumer process that exits without detaching
+        pid_t pid = fork();
+        if (pid == 0) {
+            new CShmRingSource(m_name);
+            _exit(0);
+        }
+        int status;
+        waitpid(pid, &status, 0);
+
+        // the producer writes far more than the ring holds
+        CShmRingSink sink(m_name);
+        for (uint32_t i=0; i<20; ++i) {
+            writeItem(sink, Test::makeItem(i, 40));
+        }
+        EQMSG("slot of dead consumer was released", 0u, CShmRing(m_name).releaseDeadConsumers());
+    }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CShmRingTest);
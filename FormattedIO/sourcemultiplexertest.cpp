@@ -0,0 +1,191 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <Asserts.h>
+
+#include <CSourceMultiplexer.h>
+#include <CItemSource.h>
+#include <CRingItemQueue.h>
+#include <RingIOV12.h>
+
+#include <V12/CRawRingItem.h>
+#include <V12/CPhysicsEventItem.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace DAQ;
+
+class CSourceMultiplexerTests : public CppUnit::TestFixture
+{
+public:
+    CPPUNIT_TEST_SUITE(CSourceMultiplexerTests);
+    CPPUNIT_TEST(poll_0);
+    CPPUNIT_TEST(poll_1);
+    CPPUNIT_TEST(poll_2);
+    CPPUNIT_TEST(run_0);
+    CPPUNIT_TEST(run_1);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    V12::CPhysicsEventItem event(uint64_t stamp, uint32_t sourceId) {
+        return V12::CPhysicsEventItem(stamp, sourceId, Buffer::ByteBuffer(4, 0));
+    }
+
+    void poll_0() {
+        // a pending source does not hold up the others
+        CRingItemQueue idle(1024), busy(1024);
+        CQueueItemSource idleSource(idle), busySource(busy);
+        vector<uint64_t> stamps;
+
+        CSourceMultiplexer mux;
+        mux.add(idleSource, [&](const V12::CRawRingItem&) { return true; });
+        mux.add(busySource, [&](const V12::CRawRingItem& item) {
+            stamps.push_back(item.getEventTimestamp());
+            return true;
+        });
+
+        for (uint64_t i=0; i<3; ++i) {
+            writeItem(busy, event(i, 1));
+        }
+        EQMSG("handled", size_t(3), mux.poll());
+        EQMSG("in order", (vector<uint64_t>{0, 1, 2}), stamps);
+        EQMSG("both active", size_t(2), mux.getActiveCount());
+        EQMSG("nothing left", size_t(0), mux.poll());
+    }
+
+    void poll_1() {
+        // a source is dropped at End or when its handler says to stop
+        CRingItemQueue ended(1024), stopped(1024);
+        CQueueItemSource endedSource(ended), stoppedSource(stopped);
+        size_t nStopped = 0;
+
+        CSourceMultiplexer mux;
+        mux.add(endedSource, [](const V12::CRawRingItem&) { return true; });
+        mux.add(stoppedSource, [&](const V12::CRawRingItem&) { return ++nStopped < 2; });
+
+        ended.close();
+        for (uint64_t i=0; i<5; ++i) {
+            writeItem(stopped, event(i, 2));
+        }
+
+        mux.poll();
+        EQMSG("stopped after two", size_t(2), nStopped);
+        ASSERTMSG("done", mux.done());
+        EQMSG("sources", size_t(2), mux.getSourceCount());
+        EQMSG("no more handled", size_t(0), mux.poll());
+    }
+
+    void poll_2() {
+        // a busy source gives way after maxItems
+        CRingItemQueue first(4096), second(4096);
+        CQueueItemSource firstSource(first), secondSource(second);
+        vector<uint32_t> order;
+
+        CSourceMultiplexer mux;
+        auto record = [&](const V12::CRawRingItem& item) {
+            order.push_back(item.getSourceId());
+            return true;
+        };
+        mux.add(firstSource, record);
+        mux.add(secondSource, record);
+
+        for (uint64_t i=0; i<10; ++i) {
+            writeItem(first, event(i, 1));
+            writeItem(second, event(i, 2));
+        }
+        EQMSG("handled", size_t(6), mux.poll(3));
+        EQMSG("turns", (vector<uint32_t>{1, 1, 1, 2, 2, 2}), order);
+    }
+
+    void run_0() {
+        // several producer threads feed one consumer thread
+        const size_t nSources = 4;
+        const uint64_t nItems = 2000;
+
+        vector<unique_ptr<CRingItemQueue> > queues;
+        vector<unique_ptr<CQueueItemSource> > sources;
+        vector<uint64_t> nextStamp(nSources, 0);
+        bool inOrder = true;
+
+        CSourceMultiplexer mux;
+        for (size_t i=0; i<nSources; ++i) {
+            queues.emplace_back(new CRingItemQueue(512));
+            sources.emplace_back(new CQueueItemSource(*queues.back()));
+            mux.add(*sources.back(), [&, i](const V12::CRawRingItem& item) {
+                inOrder = inOrder && (item.getEventTimestamp() == nextStamp[i]);
+                ++nextStamp[i];
+                return true;
+            });
+        }
+
+        vector<thread> producers;
+        for (size_t i=0; i<nSources; ++i) {
+            producers.emplace_back([&, i]() {
+                for (uint64_t stamp=0; stamp<nItems; ++stamp) {
+                    writeItem(*queues[i], event(stamp, i));
+                }
+                queues[i]->close();
+            });
+        }
+
+        mux.run();
+        for (auto& producer : producers) {
+            producer.join();
+        }
+
+        ASSERTMSG("in order", inOrder);
+        EQMSG("all items", vector<uint64_t>(nSources, nItems), nextStamp);
+    }
+
+    void run_1() {
+        // run() sleeps between the items of a slow producer and wakes for each
+        CRingItemQueue queue(512);
+        CQueueItemSource source(queue);
+        vector<uint64_t> stamps;
+
+        CSourceMultiplexer mux;
+        mux.add(source, [&](const V12::CRawRingItem& item) {
+            stamps.push_back(item.getEventTimestamp());
+            return true;
+        });
+
+        thread producer([&]() {
+            for (uint64_t stamp=0; stamp<10; ++stamp) {
+                this_thread::sleep_for(chrono::milliseconds(2));
+                writeItem(queue, event(stamp, 1));
+            }
+            this_thread::sleep_for(chrono::milliseconds(2));
+            queue.close();
+        });
+
+        mux.run();
+        producer.join();
+
+        EQMSG("all items", (vector<uint64_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), stamps);
+        ASSERTMSG("done", mux.done());
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CSourceMultiplexerTests);
@@ -17,6 +17,7 @@
 #include "V10/CRingItem.h"
 #include "V10/DataFormat.h"
 #include <string.h>
+#include <time.h>
 #include <iostream>
 #include <string>
 #include <sstream>
@@ -433,7 +434,12 @@ std::string
 CRingItem::timeString(time_t theTime) 
 {
 
-  std::string result(ctime(&theTime));
+  // ctime_r rather than ctime so that items can be formatted in parallel
+  char buffer[32];
+  if (ctime_r(&theTime, buffer) == nullptr) {
+    return std::to_string(theTime);
+  }
+  std::string result(buffer);
   
   // For whatever reason, ctime appends a '\n' on the end.
   // We need to remove that.
@@ -0,0 +1,174 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Ron Fox
+	     NSCL
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+#include "V11/CFragmentIterator.h"
+#include "V11/CRingItem.h"
+#include "V11/DataFormat.h"
+#include <ByteOrder.h>
+
+#include <stdexcept>
+#include <typeinfo>
+
+namespace DAQ {
+  namespace V11 {
+
+/*-------------------------------------------------------------------------------------
+ *   CFragmentIterator
+ */
+
+/**
+ * constructor
+ *
+ *  Create the end iterator.
+ */
+CFragmentIterator::CFragmentIterator() :
+  m_pNext(nullptr), m_pEnd(nullptr), m_swap(false), m_atEnd(true), m_current()
+{}
+
+/**
+ * constructor
+ *
+ *  Create an iterator referring to the first fragment.
+ *
+ * @param pBegin - header of the first fragment.
+ * @param pEnd   - end of the fragments.
+ * @param swap   - true if the fragment headers must be byte swapped.
+ *
+ * @throws std::runtime_error if the first fragment is truncated.
+ */
+CFragmentIterator::CFragmentIterator(const void* pBegin, const void* pEnd, bool swap) :
+  m_pNext(static_cast<const uint8_t*>(pBegin)),
+  m_pEnd(static_cast<const uint8_t*>(pEnd)),
+  m_swap(swap), m_atEnd(false), m_current()
+{
+  advance();
+}
+
+/**
+ * advance
+ *
+ *  Decode the next fragment header or become the end iterator if there are
+ *  no more fragments.
+ *
+ * @throws std::runtime_error if the fragment extends past the end.
+ */
+void
+CFragmentIterator::advance()
+{
+  if (m_pNext == m_pEnd) {
+    m_atEnd = true;
+    return;
+  }
+
+  size_t remaining = m_pEnd - m_pNext;
+  if (remaining < sizeof(EventBuilderFragmentHeader)) {
+    throw std::runtime_error("CFragmentIterator - truncated fragment header");
+  }
+
+  BO::CByteSwapper swapper(m_swap);
+  uint64_t timestamp;
+  uint32_t sourceId, payloadSize, barrier;
+  const uint8_t* pField = m_pNext;
+  pField = swapper.interpretAs(pField, timestamp);
+  pField = swapper.interpretAs(pField, sourceId);
+  pField = swapper.interpretAs(pField, payloadSize);
+  swapper.interpretAs(pField, barrier);
+
+  remaining -= sizeof(EventBuilderFragmentHeader);
+  if (payloadSize > remaining) {
+    throw std::runtime_error("CFragmentIterator - fragment payload extends past the end of the event");
+  }
+
+  m_current.s_timestamp   = timestamp;
+  m_current.s_sourceId    = sourceId;
+  m_current.s_barrier     = barrier;
+  m_current.s_payloadSize = payloadSize;
+  m_current.s_pPayload    = m_pNext + sizeof(EventBuilderFragmentHeader);
+
+  m_pNext = m_current.s_pPayload + payloadSize;
+}
+
+/*-------------------------------------------------------------------------------------
+ *   CFragmentRange
+ */
+
+/**
+ * constructor
+ *
+ *  Refer to the fragments of a built event body.
+ *
+ * @param pBody  - the body of the event, starting with its byte count.
+ * @param nBytes - bytes available at pBody.
+ * @param swap   - true if the body was written in the other byte order.
+ *
+ * @throws std::runtime_error if the byte count does not fit in nBytes.
+ */
+CFragmentRange::CFragmentRange(const void* pBody, size_t nBytes, bool swap) :
+  m_pBegin(nullptr), m_pEnd(nullptr), m_swap(swap)
+{
+  init(pBody, nBytes);
+}
+
+/**
+ * constructor
+ *
+ *  Refer to the fragments of a built physics event.
+ *
+ * @param item - the event. It must outlive the range.
+ *
+ * @throws std::bad_cast if the item is not a PHYSICS_EVENT.
+ * @throws std::runtime_error if the byte count does not fit in the body.
+ */
+CFragmentRange::CFragmentRange(const CRingItem& item) :
+  m_pBegin(nullptr), m_pEnd(nullptr), m_swap(item.mustSwap())
+{
+  if (item.type() != PHYSICS_EVENT) {
+    throw std::bad_cast();
+  }
+  init(item.getBodyPointer(), item.getBodySize());
+}
+
+/**
+ * size
+ *
+ * @return size_t - the number of fragments. This walks the fragments.
+ */
+size_t
+CFragmentRange::size() const
+{
+  return std::distance(begin(), end());
+}
+
+void
+CFragmentRange::init(const void* pBody, size_t nBytes)
+{
+  uint32_t byteCount;
+  if (nBytes < sizeof(byteCount)) {
+    throw std::runtime_error("CFragmentRange - body is too small for the byte count");
+  }
+
+  BO::CByteSwapper swapper(m_swap);
+  byteCount = swapper.copyAs<uint32_t>(static_cast<const uint8_t*>(pBody));
+  if (byteCount < sizeof(byteCount) || byteCount > nBytes) {
+    throw std::runtime_error("CFragmentRange - byte count is inconsistent with the body size");
+  }
+
+  m_pBegin = static_cast<const uint8_t*>(pBody) + sizeof(byteCount);
+  m_pEnd   = static_cast<const uint8_t*>(pBody) + byteCount;
+}
+
+  } // end V11
+} // end DAQ
@@ -0,0 +1,120 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Ron Fox
+	     NSCL
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_V11_CFRAGMENTITERATOR_H
+#define DAQ_V11_CFRAGMENTITERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+namespace DAQ {
+  namespace V11 {
+
+class CRingItem;
+
+/**
+ * A fragment of a built physics event. The payload is not copied; it
+ * points into the memory of the event and is normally a complete ring item
+ * in the byte order of the event.
+ */
+struct FragmentRef {
+  uint64_t       s_timestamp;
+  uint32_t       s_sourceId;
+  uint32_t       s_barrier;
+  uint32_t       s_payloadSize;
+  const uint8_t* s_pPayload;
+};
+
+/**
+ * Forward iterator over the fragments of a built physics event.
+ *
+ * The fragment headers are decoded in place, swapping bytes if the event
+ * was written with the other byte order. Nothing is allocated.  A fragment
+ * whose header or payload would extend past the end of the event raises
+ * std::runtime_error rather than producing a payload outside the event.
+ */
+class CFragmentIterator
+{
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type        = FragmentRef;
+  using difference_type   = std::ptrdiff_t;
+  using pointer           = const FragmentRef*;
+  using reference         = const FragmentRef&;
+
+private:
+  const uint8_t* m_pNext;     // header of the fragment after the current one
+  const uint8_t* m_pEnd;
+  bool           m_swap;
+  bool           m_atEnd;
+  FragmentRef    m_current;
+
+public:
+  CFragmentIterator();
+  CFragmentIterator(const void* pBegin, const void* pEnd, bool swap);
+
+  const FragmentRef& operator*() const  { return m_current; }
+  const FragmentRef* operator->() const { return &m_current; }
+
+  CFragmentIterator& operator++() { advance(); return *this; }
+  CFragmentIterator operator++(int) { CFragmentIterator old(*this); advance(); return old; }
+
+  bool operator==(const CFragmentIterator& rhs) const {
+    return (m_atEnd == rhs.m_atEnd) && (m_atEnd || m_pNext == rhs.m_pNext);
+  }
+  bool operator!=(const CFragmentIterator& rhs) const { return !(*this == rhs); }
+
+private:
+  void advance();
+};
+
+/**
+ * The fragments of a built physics event:
+ *
+ * \code
+ * for (const FragmentRef& frag : CFragmentRange(event)) {
+ *     process(frag.s_sourceId, frag.s_pPayload, frag.s_payloadSize);
+ * }
+ * \endcode
+ *
+ * The range references the memory of the event, which must outlive it.
+ */
+class CFragmentRange
+{
+private:
+  const uint8_t* m_pBegin;
+  const uint8_t* m_pEnd;
+  bool           m_swap;
+
+public:
+  CFragmentRange(const void* pBody, size_t nBytes, bool swap);
+  explicit CFragmentRange(const CRingItem& item);
+
+  CFragmentIterator begin() const { return CFragmentIterator(m_pBegin, m_pEnd, m_swap); }
+  CFragmentIterator end() const   { return CFragmentIterator(); }
+
+  bool mustSwap() const { return m_swap; }
+  size_t size() const;
+
+private:
+  void init(const void* pBody, size_t nBytes);
+};
+
+  } // end V11
+} // end DAQ
+
+#endif
@@ -18,6 +18,7 @@
 #include "V11/DataFormat.h"
 
 #include <string.h>
+#include <time.h>
 #include <iostream>
 #include <string>
 #include <sstream>
@@ -49,7 +50,8 @@ namespace DAQ {
 CRingItem::CRingItem(uint16_t type, size_t maxBody) :
   m_pItem(reinterpret_cast<RingItem*>(&m_staticBuffer)),
   m_storageSize(maxBody),
-  m_swapNeeded(false)
+  m_swapNeeded(false),
+  m_isView(false)
 {
 
   // If necessary, dynamically allocate (big max item).
@@ -78,7 +80,8 @@ CRingItem::CRingItem(uint16_t type, uint64_t timestamp, uint32_t sourceId,
                      uint32_t barrierType, size_t maxBody) :
   m_pItem(reinterpret_cast<RingItem*>(&m_staticBuffer)),
   m_storageSize(maxBody),
-  m_swapNeeded(false)
+  m_swapNeeded(false),
+  m_isView(false)
 {
   // If necessary, dynamically allocate (big max item).
 
@@ -103,7 +106,8 @@ CRingItem::CRingItem(uint16_t type, uint64_t timestamp, uint32_t sourceId,
 
   \param rhs  - The source of the copy.
 */
-CRingItem::CRingItem(const CRingItem& rhs)
+CRingItem::CRingItem(const CRingItem& rhs) :
+  m_isView(false)
 {
   // If the storage size is big enough, we need to dynamically allocate
   // our storage
@@ -112,6 +116,25 @@ CRingItem::CRingItem(const CRingItem& rhs)
 
   copyIn(rhs);
 }
+/*!
+  Construct a view of an existing item. No data is copied, the view just
+  refers to the caller's memory, which must outlive it. Copying a view
+  copies the item, so a derived item constructed from a view is filled
+  with a single memcpy.
+
+  The byte order of the item is taken from its type, whose upper 16 bits
+  are zero in the native order.
+
+  \param pItem - pointer to the item in wire format
+*/
+CRingItem::CRingItem(View, const void* pItem) :
+  m_pItem(reinterpret_cast<RingItem*>(const_cast<void*>(pItem))),
+  m_swapNeeded((m_pItem->s_header.s_type & 0xffff0000) != 0),
+  m_isView(true)
+{
+  m_storageSize = size();
+  m_pCursor = reinterpret_cast<uint8_t*>(m_pItem) + m_storageSize;
+}
 /*!
     Destroy the item. If the storage size was big, we need to delete the 
     storage as it was dynamically allocated.
@@ -539,7 +562,7 @@ CRingItem::copyIn(const CRingItem& rhs)
 void 
 CRingItem::deleteIfNecessary()
 {
-  if (m_pItem != (pRingItem)m_staticBuffer) {
+  if (!m_isView && (m_pItem != (pRingItem)m_staticBuffer)) {
     delete [](reinterpret_cast<uint8_t*>(m_pItem));
   }
 }
@@ -614,7 +637,12 @@ std::string
 CRingItem::timeString(time_t theTime) 
 {
 
-  std::string result(ctime(&theTime));
+  // ctime_r rather than ctime so that items can be formatted in parallel
+  char buffer[32];
+  if (ctime_r(&theTime, buffer) == nullptr) {
+    return std::to_string(theTime);
+  }
+  std::string result(buffer);
   
   // For whatever reason, ctime appends a '\n' on the end.
   // We need to remove that.
@@ -58,6 +58,7 @@ private:
   uint8_t*      m_pCursor;
   uint32_t      m_storageSize;
   bool          m_swapNeeded;
+  bool          m_isView;       // m_pItem refers to memory we do not own
   uint8_t       m_staticBuffer[CRingItemStaticBufferSize + 100];
 
   // Constructors and canonicals.
@@ -67,6 +68,13 @@ public:
   CRingItem(uint16_t type, uint64_t timestamp, uint32_t sourceId,
             uint32_t barrierType = 0, size_t maxBody = CRingItemStaticBufferSize - 10);
   CRingItem(const CRingItem& rhs);
+
+  // A non-owning view of an item in wire format. CRingItemFactory uses it
+  // to copy construct the derived item types straight from the raw data and
+  // readers use it to pass items on without copying them.
+  struct View {};
+  CRingItem(View, const void* pItem);
+
   virtual ~CRingItem();
   
   CRingItem& operator=(const CRingItem& rhs);
@@ -125,7 +133,6 @@ private:
   void copyIn(const CRingItem& rhs);
   void throwIfNoBodyHeader(std::string msg) const;
   void getTimestampExtractor();
-
   
 };
 
@@ -30,15 +30,17 @@
 #include "V11/CAbnormalEndItem.h"
 #include "V11/DataFormat.h"
 
-#include <vector>
 #include <string>
 #include <string.h>
-#include <set>
 
 namespace DAQ {
   namespace V11 {
 
-static std::set<uint32_t> knownItemTypes;
+CUnknownItemType::CUnknownItemType(uint32_t type) :
+  std::runtime_error("CRingItemFactory::createRingItem - unknown ring item type "
+                     + std::to_string(type)),
+  m_type(type)
+{}
 
 /**
  * Create a ring item of the correct underlying type as indicated by the
@@ -140,27 +142,25 @@ CRingItemFactory::createRingItem(const CRingItem& item)
  *
  * @param pItem - Pointer to the pRingItem.
  *
+ * The data are copied once, straight into the new item.
+ *
  * @return CRingItem* - dynamically allocated with the underlying type matching that
  *                      of s_header.s_type.
- * @throw std::string if the type does not match a known ring item type.
+ * @throw CUnknownItemType if the type does not match a known ring item type.
  */
 CRingItem*
 CRingItemFactory::createRingItem(const void* pItem)
 {
   if (!isKnownItemType(pItem)) {
-    throw std::string("CRingItemFactory::createRingItem - unknown ring item type");
+    throw CUnknownItemType(itemType(reinterpret_cast<const RingItem*>(pItem)));
   }
-  /* Make a 'vanilla' CRing item that we can pass into the other creator */
 
-  const RingItem* pRitem = reinterpret_cast<const RingItem*>(pItem);
-  CRingItem baseItem(pRitem->s_header.s_type, pRitem->s_header.s_size);
-  uint8_t*  pBody  = reinterpret_cast<uint8_t*>(baseItem.getItemPointer());
-  memcpy(pBody, pRitem, pRitem->s_header.s_size);
-  pBody += pRitem->s_header.s_size;
-  baseItem.setBodyCursor(pBody);
-  baseItem.updateSize();
+  /* Wrap the data in a 'vanilla' CRing item that we can pass into the other
+     creator. The view does not copy, the derived item copies from it. */
+
+  CRingItem view(CRingItem::View(), pItem);
 
-  return createRingItem(baseItem);
+  return createRingItem(view);
 }
 /**
  * Determines if a  pointer points to something that might be a valid ring item.
@@ -180,29 +180,31 @@ CRingItemFactory::isKnownItemType(const void* pItem)
     return false;
   }
 
-  // if necessary stock the set of known item types:
+  // a switch rather than a lazily filled set keeps this reentrant
 
-  if(knownItemTypes.empty()) {
-    knownItemTypes.insert(BEGIN_RUN);
-    knownItemTypes.insert(END_RUN);
-    knownItemTypes.insert(PAUSE_RUN);
-    knownItemTypes.insert(RESUME_RUN);
-    knownItemTypes.insert(RING_FORMAT);
+  switch (itemType(p)) {
+  case BEGIN_RUN:
+  case END_RUN:
+  case PAUSE_RUN:
+  case RESUME_RUN:
+  case RING_FORMAT:
 
-    knownItemTypes.insert(PACKET_TYPES);
-    knownItemTypes.insert(MONITORED_VARIABLES);
+  case PACKET_TYPES:
+  case MONITORED_VARIABLES:
 
-    knownItemTypes.insert(PERIODIC_SCALERS);
-    knownItemTypes.insert(PHYSICS_EVENT);
-    knownItemTypes.insert(PHYSICS_EVENT_COUNT);
-    knownItemTypes.insert(EVB_FRAGMENT);
-    knownItemTypes.insert(EVB_UNKNOWN_PAYLOAD);
-    knownItemTypes.insert(EVB_GLOM_INFO);
-    
-    knownItemTypes.insert(ABNORMAL_ENDRUN);
-  }
+  case PERIODIC_SCALERS:
+  case PHYSICS_EVENT:
+  case PHYSICS_EVENT_COUNT:
+  case EVB_FRAGMENT:
+  case EVB_UNKNOWN_PAYLOAD:
+  case EVB_GLOM_INFO:
 
-  return knownItemTypes.count(itemType(p)) > 0;
+  case ABNORMAL_ENDRUN:
+    return true;
+
+  default:
+    return false;
+  }
 
 }
 
@@ -19,6 +19,8 @@
 #define DAQ_V11_CRINGITEMFACTORY_H
 
 #include <memory>
+#include <stdexcept>
+#include <cstdint>
 
 namespace DAQ {
   namespace V11 {
@@ -29,6 +31,21 @@ class CRingItem;
     using CRingItemFactoryUPtr = std::unique_ptr<CRingItemFactory>;
     using CRingItemFactoryPtr  = std::shared_ptr<CRingItemFactory>;
 
+/**
+ * Thrown by the factory when asked to create an item whose type it does not
+ * recognize.
+ */
+class CUnknownItemType : public std::runtime_error
+{
+private:
+  uint32_t m_type;
+
+public:
+  explicit CUnknownItemType(uint32_t type);
+
+  uint32_t getType() const { return m_type; }
+};
+
 /**
  * This class is a factory for the correct type of ring item.
  * It is used to effectively up-cast CRingItem base class objects
@@ -363,6 +363,19 @@ typedef PSTRUCT _EventBuilderFragment {
   uint8_t       s_body[];	/* Really s_payload bytes of data.. */
 } EventBuilderFragment, *pEventBuilderFragment;
 
+/**
+ * The body of a physics event built by the event builder is a uint32_t
+ * byte count (which includes itself) followed by fragments. Each fragment
+ * is this header followed by s_payloadSize bytes of payload, normally a
+ * complete ring item:
+ */
+typedef PSTRUCT _EventBuilderFragmentHeader {
+  uint64_t      s_timestamp;
+  uint32_t      s_sourceId;
+  uint32_t      s_payloadSize;
+  uint32_t      s_barrier;
+} EventBuilderFragmentHeader, *pEventBuilderFragmentHeader;
+
 /**
  * The ring item format never has an event header.  Just major and minor
  * version numbers:
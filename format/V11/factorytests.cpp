@@ -48,6 +48,8 @@ class RingFactoryTests : public CppUnit::TestFixture
     CPPUNIT_TEST(evbFragment);    // Always have timestamps.
     CPPUNIT_TEST(evbUnkPayload);  // Always have timestamps.
     CPPUNIT_TEST(glom);           // Never has a timetamp.
+    CPPUNIT_TEST(bigPhysics);
+    CPPUNIT_TEST(unknownType);
     CPPUNIT_TEST_SUITE_END();
     
     
@@ -78,6 +80,9 @@ protected:
     void evbUnkPayload();
     
     void glom();
+    
+    void bigPhysics();
+    void unknownType();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(RingFactoryTests);
@@ -514,3 +519,47 @@ RingFactoryTests::glom()
     EQ(CGlomParameters::first, item.timestampPolicy());
 
 }
+/**
+ * bigPhysics
+ *
+ * Physics event that does not fit in the static buffer of a ring item.
+ */
+void
+RingFactoryTests::bigPhysics()
+{
+    std::vector<uint16_t> payload(3*CRingItemStaticBufferSize);
+    for (size_t i = 0; i < payload.size(); i++) {
+        payload[i] = i;
+    }
+
+    pPhysicsEventItem pEvent = formatEventItem(payload.size(), payload.data());
+    CRingItem*        pBase  = CRingItemFactory::createRingItem(pEvent);
+
+    EQ(itemSize(reinterpret_cast<pRingItem>(pEvent)), pBase->size());
+    // the body starts with the 32-bit size of the event in words
+    const uint8_t* pBody = reinterpret_cast<const uint8_t*>(pBase->getBodyPointer());
+    EQ(0, memcmp(payload.data(), pBody + sizeof(uint32_t),
+                 payload.size()*sizeof(uint16_t)));
+
+    delete pBase;
+    free(pEvent);
+}
+/**
+ * unknownType
+ *
+ * Items of unknown type are reported with a typed exception.
+ */
+void
+RingFactoryTests::unknownType()
+{
+    RingItemHeader header = {sizeof(header), 0x1234};
+
+    ASSERT(!CRingItemFactory::isKnownItemType(&header));
+    try {
+        CRingItemFactory::createRingItem(&header);
+        CPPUNIT_FAIL("unknown item type did not throw");
+    }
+    catch (CUnknownItemType& e) {
+        EQ(uint32_t(0x1234), e.getType());
+    }
+}
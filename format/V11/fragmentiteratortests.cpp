@@ -0,0 +1,219 @@
+// Tests for iterating over the fragments of a built physics event.
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include "Asserts.h"
+
+#include <V11/DataFormat.h>
+#include <V11/CFragmentIterator.h>
+#include <V11/CPhysicsEventItem.h>
+#include <V11/CRingItemFactory.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string.h>
+#include <typeinfo>
+#include <vector>
+
+using namespace DAQ::V11;
+
+namespace {
+
+// Append a value in native or swapped byte order
+template<class T>
+void append(std::vector<uint8_t>& bytes, T value, bool swap)
+{
+  uint8_t* p = reinterpret_cast<uint8_t*>(&value);
+  if (swap) {
+    std::reverse(p, p + sizeof(value));
+  }
+  bytes.insert(bytes.end(), p, p + sizeof(value));
+}
+
+void appendFragment(std::vector<uint8_t>& bytes, uint64_t timestamp, uint32_t sourceId,
+                    uint32_t barrier, const std::vector<uint8_t>& payload, bool swap)
+{
+  append(bytes, timestamp, swap);
+  append(bytes, sourceId, swap);
+  append(bytes, uint32_t(payload.size()), swap);
+  append(bytes, barrier, swap);
+  bytes.insert(bytes.end(), payload.begin(), payload.end());
+}
+
+// Body of a built event with the byte count in front
+std::vector<uint8_t> builtBody(const std::vector<uint8_t>& fragments, bool swap)
+{
+  std::vector<uint8_t> body;
+  append(body, uint32_t(fragments.size() + sizeof(uint32_t)), swap);
+  body.insert(body.end(), fragments.begin(), fragments.end());
+  return body;
+}
+
+std::vector<uint8_t> itemBytes(const CRingItem& item)
+{
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(item.getItemPointer());
+  return std::vector<uint8_t>(p, p + item.size());
+}
+
+}
+
+class fragmentiteratortests : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(fragmentiteratortests);
+  CPPUNIT_TEST( iterate );
+  CPPUNIT_TEST( payload );
+  CPPUNIT_TEST( swapped );
+  CPPUNIT_TEST( empty );
+  CPPUNIT_TEST( truncatedPayload );
+  CPPUNIT_TEST( truncatedHeader );
+  CPPUNIT_TEST( badByteCount );
+  CPPUNIT_TEST( badcast );
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+public:
+  void setUp() {
+  }
+  void tearDown() {
+  }
+protected:
+  void iterate();
+  void payload();
+  void swapped();
+  void empty();
+  void truncatedPayload();
+  void truncatedHeader();
+  void badByteCount();
+  void badcast();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(fragmentiteratortests);
+
+void fragmentiteratortests::iterate()
+{
+  std::vector<uint8_t> fragments;
+  appendFragment(fragments, 0x123456789aLL, 2, 0, {1, 2, 3}, false);
+  appendFragment(fragments, 0x123456789bLL, 5, 1, {4, 5}, false);
+  std::vector<uint8_t> body = builtBody(fragments, false);
+
+  CFragmentRange range(body.data(), body.size(), false);
+  EQMSG("count", size_t(2), range.size());
+
+  CFragmentIterator it = range.begin();
+  EQMSG("first timestamp", uint64_t(0x123456789aLL), it->s_timestamp);
+  EQMSG("first source", uint32_t(2), it->s_sourceId);
+  EQMSG("first barrier", uint32_t(0), it->s_barrier);
+  EQMSG("first size", uint32_t(3), it->s_payloadSize);
+  EQMSG("first payload is not copied", (const uint8_t*)(body.data() + 4 + 20), it->s_pPayload);
+
+  ++it;
+  EQMSG("second timestamp", uint64_t(0x123456789bLL), it->s_timestamp);
+  EQMSG("second source", uint32_t(5), it->s_sourceId);
+  EQMSG("second barrier", uint32_t(1), it->s_barrier);
+  EQMSG("second size", uint32_t(2), it->s_payloadSize);
+  EQMSG("second payload", uint8_t(5), it->s_pPayload[1]);
+
+  ++it;
+  ASSERTMSG("end", it == range.end());
+}
+
+void fragmentiteratortests::payload()
+{
+  CPhysicsEventItem first(100, 1, 0);
+  uint16_t* p = reinterpret_cast<uint16_t*>(first.getBodyCursor());
+  for (uint16_t i = 0; i < 5; i++) {
+    *p++ = i;
+  }
+  first.setBodyCursor(p);
+  first.updateSize();
+  CPhysicsEventItem second(101, 2, 0);
+
+  std::vector<uint8_t> fragments;
+  appendFragment(fragments, 100, 1, 0, itemBytes(first), false);
+  appendFragment(fragments, 101, 2, 0, itemBytes(second), false);
+
+  CPhysicsEventItem built(100, 10, 0);
+  std::vector<uint8_t> body = builtBody(fragments, false);
+  uint8_t* pCursor = reinterpret_cast<uint8_t*>(built.getBodyCursor());
+  memcpy(pCursor, body.data(), body.size());
+  built.setBodyCursor(pCursor + body.size());
+  built.updateSize();
+
+  std::vector<CRingItem*> items;
+  for (const FragmentRef& frag : CFragmentRange(built)) {
+    items.push_back(CRingItemFactory::createRingItem(frag.s_pPayload));
+  }
+  EQMSG("count", size_t(2), items.size());
+  std::unique_ptr<CRingItem> pFirst(items[0]);
+  std::unique_ptr<CRingItem> pSecond(items[1]);
+  EQMSG("first type", PHYSICS_EVENT, pFirst->type());
+  ASSERTMSG("first", itemBytes(first) == itemBytes(*pFirst));
+  ASSERTMSG("second", itemBytes(second) == itemBytes(*pSecond));
+}
+
+void fragmentiteratortests::swapped()
+{
+  std::vector<uint8_t> fragments;
+  appendFragment(fragments, 0x0102030405060708LL, 0x0a0b, 3, {1, 2, 3, 4}, true);
+  std::vector<uint8_t> body = builtBody(fragments, true);
+
+  CFragmentRange range(body.data(), body.size(), true);
+  ASSERTMSG("swapping", range.mustSwap());
+
+  CFragmentIterator it = range.begin();
+  EQMSG("timestamp", uint64_t(0x0102030405060708LL), it->s_timestamp);
+  EQMSG("source", uint32_t(0x0a0b), it->s_sourceId);
+  EQMSG("barrier", uint32_t(3), it->s_barrier);
+  EQMSG("size", uint32_t(4), it->s_payloadSize);
+  it++;
+  ASSERTMSG("end", it == range.end());
+}
+
+void fragmentiteratortests::empty()
+{
+  std::vector<uint8_t> body = builtBody({}, false);
+  body.push_back(0xff);   // outside the byte count
+
+  CFragmentRange range(body.data(), body.size(), false);
+  ASSERTMSG("no fragments", range.begin() == range.end());
+}
+
+void fragmentiteratortests::truncatedPayload()
+{
+  std::vector<uint8_t> fragments;
+  appendFragment(fragments, 1, 2, 0, {1, 2, 3, 4}, false);
+  fragments.pop_back();
+  std::vector<uint8_t> body = builtBody(fragments, false);
+
+  CFragmentRange range(body.data(), body.size(), false);
+  CPPUNIT_ASSERT_THROW(range.begin(), std::runtime_error);
+}
+
+void fragmentiteratortests::truncatedHeader()
+{
+  std::vector<uint8_t> fragments;
+  appendFragment(fragments, 1, 2, 0, {1}, false);
+  appendFragment(fragments, 1, 2, 0, {}, false);
+  fragments.resize(fragments.size() - 1);
+  std::vector<uint8_t> body = builtBody(fragments, false);
+
+  CFragmentRange range(body.data(), body.size(), false);
+  CFragmentIterator it = range.begin();
+  EQMSG("first is intact", uint32_t(1), it->s_payloadSize);
+  CPPUNIT_ASSERT_THROW(++it, std::runtime_error);
+}
+
+void fragmentiteratortests::badByteCount()
+{
+  std::vector<uint8_t> body = builtBody({1, 2, 3}, false);
+  CPPUNIT_ASSERT_THROW(CFragmentRange(body.data(), body.size() - 1, false),
+                       std::runtime_error);
+  CPPUNIT_ASSERT_THROW(CFragmentRange(body.data(), 2, false), std::runtime_error);
+}
+
+void fragmentiteratortests::badcast()
+{
+  CRingItem item(PHYSICS_EVENT_COUNT, 8192);
+  CPPUNIT_ASSERT_THROW(CFragmentRange range(item), std::bad_cast);
+}
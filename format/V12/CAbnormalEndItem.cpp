@@ -21,6 +21,7 @@
 
 #include "V12/CAbnormalEndItem.h"
 #include "V12/CRawRingItem.h"
+#include "V12/CRingItemEncoder.h"
 #include "V12/DataFormat.h"
 
 #include <make_unique.h>
@@ -44,6 +45,16 @@ namespace DAQ {
  * \throws std::runtime_error if the raw ring item has a type other than ABNORMAL_ENDRUN
  */
   CAbnormalEndItem::CAbnormalEndItem(const CRawRingItem& rhs)
+  {
+      fromRawRingItem(rhs);
+  }
+
+  /*!
+   * \brief Refill the item from a raw ring item
+   *
+   * \throws std::bad_cast if rhs is not an abnormal end item
+   */
+  void CAbnormalEndItem::fromRawRingItem(const CRawRingItem& rhs)
   {
       if(rhs.type() != ABNORMAL_ENDRUN) {
           throw std::bad_cast();
@@ -173,6 +184,11 @@ namespace DAQ {
       item.setMustSwap(mustSwap());
   }
 
+  uint8_t* CAbnormalEndItem::encode(uint8_t* out) const
+  {
+      return Encoder::encodeHeader(out, size(), type(), m_evtTimestamp, m_sourceId);
+  }
+
 
   /* Formatting interface */
 
@@ -72,6 +72,8 @@ public:
     bool mustSwap() const;
 
     void toRawRingItem(CRawRingItem& rawItem) const;
+    uint8_t* encode(uint8_t* out) const;
+    void fromRawRingItem(const CRawRingItem& rhs);
 
     virtual std::string typeName() const;
     virtual std::string toString() const;
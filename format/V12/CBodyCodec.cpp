@@ -0,0 +1,375 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "V12/CBodyCodec.h"
+#include "V12/CRawRingItem.h"
+#include "V12/CPhysicsEventItem.h"
+#include "V12/DataFormat.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace DAQ {
+namespace V12 {
+
+static const std::size_t HeaderSize = 4*sizeof(std::uint8_t) + 2*sizeof(std::uint32_t);
+
+// the largest body that fits in a V12 item after its 20-byte header
+static const std::uint64_t MaxBodySize = std::numeric_limits<std::uint32_t>::max() - 20;
+
+namespace {
+
+// the fields of the encoded header
+struct Header {
+    std::uint8_t  s_method;
+    std::uint8_t  s_wordSize;
+    std::uint8_t  s_bitWidth;
+    std::uint8_t  s_nTrailing;
+    std::uint32_t s_nWords;
+    std::uint32_t s_reference;
+};
+
+unsigned bitsNeeded(std::uint64_t value)
+{
+    unsigned nBits = 0;
+    while (value) {
+        ++nBits;
+        value >>= 1;
+    }
+    return nBits;
+}
+
+std::uint64_t zigzag(std::int64_t value)
+{
+    return (std::uint64_t(value) << 1) ^ std::uint64_t(value >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t value)
+{
+    return std::int64_t(value >> 1) ^ -std::int64_t(value & 1);
+}
+
+std::uint64_t packedBytes(std::uint64_t nValues, unsigned bitWidth)
+{
+    return (nValues*bitWidth + 7)/8;
+}
+
+template<class Word>
+Word loadWord(const std::uint8_t* pos)
+{
+    Word word;
+    std::memcpy(&word, pos, sizeof(word));
+    return word;
+}
+
+template<class Word>
+void storeWord(std::uint8_t* pos, Word word)
+{
+    std::memcpy(pos, &word, sizeof(word));
+}
+
+// Little endian 64-bit load. Compilers turn this into a single load on
+// little endian machines.
+inline std::uint64_t load64(const std::uint8_t* pos)
+{
+    return   std::uint64_t(pos[0])        | (std::uint64_t(pos[1]) << 8)
+          | (std::uint64_t(pos[2]) << 16) | (std::uint64_t(pos[3]) << 24)
+          | (std::uint64_t(pos[4]) << 32) | (std::uint64_t(pos[5]) << 40)
+          | (std::uint64_t(pos[6]) << 48) | (std::uint64_t(pos[7]) << 56);
+}
+
+// the same, for the last few bytes of the packed data
+std::uint64_t loadTail(const std::uint8_t* pos, const std::uint8_t* end)
+{
+    std::uint64_t value = 0;
+    for (unsigned i=0; pos + i < end; ++i) {
+        value |= std::uint64_t(pos[i]) << (8*i);
+    }
+    return value;
+}
+
+// Appends bitWidth-bit values to zeroed memory, least significant bit first
+class BitPacker {
+    std::uint8_t* m_pOut;
+    std::uint64_t m_bit;
+    unsigned      m_bitWidth;
+
+public:
+    BitPacker(std::uint8_t* pOut, unsigned bitWidth)
+        : m_pOut(pOut), m_bit(0), m_bitWidth(bitWidth) {}
+
+    void put(std::uint64_t value) {
+        std::uint8_t* pos = m_pOut + (m_bit >> 3);
+        std::uint64_t shifted = value << (m_bit & 7);
+        for (; shifted; shifted >>= 8) {
+            *pos++ |= std::uint8_t(shifted);
+        }
+        m_bit += m_bitWidth;
+    }
+};
+
+// Hands each of nValues bitWidth-bit values in [beg, end) to sink. The
+// bitWidth is at most 33, so a value and its bit offset fit in one 64-bit load.
+template<class Sink>
+void unpackBits(const std::uint8_t* beg, const std::uint8_t* end,
+                std::uint64_t nValues, unsigned bitWidth, Sink sink)
+{
+    std::uint64_t mask = (std::uint64_t(1) << bitWidth) - 1;
+    std::uint64_t bit  = 0;
+    for (std::uint64_t i=0; i<nValues; ++i, bit += bitWidth) {
+        const std::uint8_t* pos = beg + (bit >> 3);
+        std::uint64_t window = (end - pos >= 8) ? load64(pos) : loadTail(pos, end);
+        sink((window >> (bit & 7)) & mask);
+    }
+}
+
+// Find the best packing of the body as Words, updating best if it is smaller
+template<class Word>
+void evaluate(const Buffer::ByteBuffer& body, Header& best, std::size_t& bestSize)
+{
+    std::size_t nWords = body.size()/sizeof(Word);
+    if (nWords == 0) {
+        return;
+    }
+    std::size_t nTrailing = body.size() % sizeof(Word);
+
+    const std::uint8_t* pWords = body.data();
+    Word first    = loadWord<Word>(pWords);
+    Word smallest = first;
+    Word largest  = first;
+    Word previous = first;
+    std::uint64_t largestDelta = 0;
+    for (std::size_t i=1; i<nWords; ++i) {
+        Word word = loadWord<Word>(pWords + i*sizeof(Word));
+        smallest = std::min(smallest, word);
+        largest  = std::max(largest, word);
+        largestDelta = std::max(largestDelta,
+                                zigzag(std::int64_t(word) - std::int64_t(previous)));
+        previous = word;
+    }
+
+    unsigned forWidth = bitsNeeded(largest - smallest);
+    std::size_t forSize = HeaderSize + packedBytes(nWords, forWidth) + nTrailing;
+    if (forSize < bestSize) {
+        best = {CBodyCodec::FrameOfReference, sizeof(Word), std::uint8_t(forWidth),
+                std::uint8_t(nTrailing), std::uint32_t(nWords), smallest};
+        bestSize = forSize;
+    }
+
+    unsigned deltaWidth = bitsNeeded(largestDelta);
+    std::size_t deltaSize = HeaderSize + packedBytes(nWords - 1, deltaWidth) + nTrailing;
+    if (deltaSize < bestSize) {
+        best = {CBodyCodec::Delta, sizeof(Word), std::uint8_t(deltaWidth),
+                std::uint8_t(nTrailing), std::uint32_t(nWords), first};
+        bestSize = deltaSize;
+    }
+}
+
+template<class Word>
+void packWords(const Buffer::ByteBuffer& body, const Header& header, std::uint8_t* pOut)
+{
+    BitPacker packer(pOut, header.s_bitWidth);
+    const std::uint8_t* pWords = body.data();
+
+    if (header.s_method == CBodyCodec::FrameOfReference) {
+        for (std::size_t i=0; i<header.s_nWords; ++i) {
+            packer.put(loadWord<Word>(pWords + i*sizeof(Word)) - Word(header.s_reference));
+        }
+    } else {
+        Word previous = Word(header.s_reference);
+        for (std::size_t i=1; i<header.s_nWords; ++i) {
+            Word word = loadWord<Word>(pWords + i*sizeof(Word));
+            packer.put(zigzag(std::int64_t(word) - std::int64_t(previous)));
+            previous = word;
+        }
+    }
+}
+
+template<class Word>
+void unpackWords(const Header& header, const std::uint8_t* beg, const std::uint8_t* end,
+                 std::uint8_t* pOut)
+{
+    if (header.s_method == CBodyCodec::FrameOfReference) {
+        Word reference = Word(header.s_reference);
+        unpackBits(beg, end, header.s_nWords, header.s_bitWidth, [&](std::uint64_t value) {
+            storeWord<Word>(pOut, Word(reference + value));
+            pOut += sizeof(Word);
+        });
+    } else {
+        Word previous = Word(header.s_reference);
+        storeWord<Word>(pOut, previous);
+        pOut += sizeof(Word);
+        unpackBits(beg, end, header.s_nWords - 1, header.s_bitWidth, [&](std::uint64_t value) {
+            previous = Word(std::int64_t(previous) + unzigzag(value));
+            storeWord<Word>(pOut, previous);
+            pOut += sizeof(Word);
+        });
+    }
+}
+
+Header parseHeader(const Buffer::ByteBuffer& encoded)
+{
+    if (encoded.size() < HeaderSize) {
+        throw std::runtime_error("DAQ::V12::CBodyCodec::decode() encoded data is shorter than its header.");
+    }
+
+    Header header;
+    const std::uint8_t* pos = encoded.data();
+    header.s_method    = pos[0] & ~CBodyCodec::ForeignOrderFlag;
+    header.s_wordSize  = pos[1];
+    header.s_bitWidth  = pos[2];
+    header.s_nTrailing = pos[3];
+    header.s_nWords    = loadWord<std::uint32_t>(pos + 4);
+    header.s_reference = loadWord<std::uint32_t>(pos + 8);
+    return header;
+}
+
+} // end anonymous namespace
+
+
+//
+void CBodyCodec::encode(const Buffer::ByteBuffer& body, Buffer::ByteBuffer& encoded,
+                        bool foreignOrder)
+{
+    Header best = {Stored, 0, 0, 0, 0, 0};
+    std::size_t bestSize = HeaderSize + body.size();
+    if (body.size() <= std::numeric_limits<std::uint32_t>::max()) {
+        evaluate<std::uint16_t>(body, best, bestSize);
+        evaluate<std::uint32_t>(body, best, bestSize);
+    }
+
+    encoded.assign(bestSize, 0);
+    std::uint8_t* pos = encoded.data();
+    pos[0] = best.s_method;
+    if (foreignOrder) {
+        pos[0] |= ForeignOrderFlag;
+    }
+    pos[1] = best.s_wordSize;
+    pos[2] = best.s_bitWidth;
+    pos[3] = best.s_nTrailing;
+    storeWord(pos + 4, best.s_nWords);
+    storeWord(pos + 8, best.s_reference);
+    pos += HeaderSize;
+
+    if (best.s_method == Stored) {
+        std::copy(body.begin(), body.end(), pos);
+        return;
+    }
+
+    if (best.s_wordSize == sizeof(std::uint16_t)) {
+        packWords<std::uint16_t>(body, best, pos);
+    } else {
+        packWords<std::uint32_t>(body, best, pos);
+    }
+
+    std::copy(body.end() - best.s_nTrailing, body.end(), encoded.end() - best.s_nTrailing);
+}
+
+
+//
+void CBodyCodec::decode(const Buffer::ByteBuffer& encoded, Buffer::ByteBuffer& body)
+{
+    Header header = parseHeader(encoded);
+
+    if (header.s_method == Stored) {
+        body.assign(encoded.begin() + HeaderSize, encoded.end());
+        return;
+    }
+
+    bool valid = ((header.s_method == FrameOfReference) || (header.s_method == Delta))
+            && ((header.s_wordSize == sizeof(std::uint16_t)) || (header.s_wordSize == sizeof(std::uint32_t)))
+            && (header.s_nTrailing < header.s_wordSize)
+            && (header.s_bitWidth <= 8*header.s_wordSize + 1)
+            && (header.s_nWords > 0);
+
+    // A bit width of 0 packs any number of words into no bytes, so the header
+    // alone must not be trusted with the size of the body.
+    std::uint64_t bodySize = std::uint64_t(header.s_nWords)*header.s_wordSize + header.s_nTrailing;
+    if (valid && (bodySize > MaxBodySize)) {
+        throw std::runtime_error("DAQ::V12::CBodyCodec::decode() decoded body would not fit in a V12 item.");
+    }
+
+    std::uint64_t nValues = header.s_nWords - ((header.s_method == Delta) ? 1 : 0);
+    std::uint64_t nPacked = packedBytes(nValues, header.s_bitWidth);
+    if (!valid || (encoded.size() != HeaderSize + nPacked + header.s_nTrailing)) {
+        throw std::runtime_error("DAQ::V12::CBodyCodec::decode() encoded data is malformed.");
+    }
+
+    body.resize(bodySize);
+    const std::uint8_t* pPacked = encoded.data() + HeaderSize;
+
+    if (header.s_wordSize == sizeof(std::uint16_t)) {
+        unpackWords<std::uint16_t>(header, pPacked, pPacked + nPacked, body.data());
+    } else {
+        unpackWords<std::uint32_t>(header, pPacked, pPacked + nPacked, body.data());
+    }
+
+    std::copy(encoded.end() - header.s_nTrailing, encoded.end(),
+              body.end() - header.s_nTrailing);
+}
+
+
+//
+CBodyCodec::Method CBodyCodec::getMethod(const Buffer::ByteBuffer& encoded)
+{
+    return Method(parseHeader(encoded).s_method);
+}
+
+
+//
+bool CBodyCodec::isForeignOrder(const Buffer::ByteBuffer& encoded)
+{
+    parseHeader(encoded);
+    return (encoded[0] & ForeignOrderFlag) != 0;
+}
+
+
+//
+CRawRingItem CBodyCodec::pack(const CRawRingItem& event)
+{
+    if (event.type() != PHYSICS_EVENT) {
+        throw std::invalid_argument("DAQ::V12::CBodyCodec::pack() item is not a physics event.");
+    }
+
+    // the packed item itself is native, only its contents may be foreign
+    CRawRingItem packed(PACKED_PHYSICS_EVENT, event.getEventTimestamp(), event.getSourceId());
+    encode(event.getBody(), packed.getBody(), event.mustSwap());
+
+    return packed;
+}
+
+
+//
+CPhysicsEventItem CBodyCodec::unpack(const CRawRingItem& packed)
+{
+    if (packed.type() != PACKED_PHYSICS_EVENT) {
+        throw std::invalid_argument("DAQ::V12::CBodyCodec::unpack() item is not a packed physics event.");
+    }
+    if (packed.mustSwap()) {
+        throw std::runtime_error("DAQ::V12::CBodyCodec::unpack() item was packed on a machine of the other byte order.");
+    }
+
+    CPhysicsEventItem event(packed.getEventTimestamp(), packed.getSourceId());
+    decode(packed.getBody(), event.getBody());
+    event.setMustSwap(isForeignOrder(packed.getBody()));
+
+    return event;
+}
+
+} // end V12
+} // end DAQ
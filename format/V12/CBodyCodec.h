@@ -0,0 +1,129 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+
+#ifndef DAQ_V12_CBODYCODEC_H
+#define DAQ_V12_CBODYCODEC_H
+
+#include <ByteBuffer.h>
+
+#include <cstdint>
+
+namespace DAQ {
+namespace V12 {
+
+class CRawRingItem;
+class CPhysicsEventItem;
+
+/**
+ * \brief Lossless packing of physics event bodies
+ *
+ * Event bodies are mostly 16 or 32-bit digitizer words that span a small
+ * range. The body is read as a sequence of words and one of these methods is
+ * applied:
+ *
+ *  - FrameOfReference: each word is stored as its difference from the
+ *    smallest word, in just enough bits for the largest difference.
+ *  - Delta: each word is stored as its zigzag encoded difference from the
+ *    previous word, in just enough bits for the largest difference.
+ *  - Stored: the body is copied as is.
+ *
+ * encode() tries both word sizes with both packing methods and keeps the
+ * smallest result, falling back to Stored, so each item gets the method that
+ * suits it. The encoded data begins with a 12 byte header:
+ *
+ *   u8 method and flags, u8 word size, u8 bit width, u8 trailing byte count,
+ *   u32 word count, u32 reference (the smallest or the first word)
+ *
+ * followed by the packed bits (least significant first) and the bytes left
+ * over after the last whole word. Fields are in the byte order of the
+ * encoding machine. The high bit of the first byte (ForeignOrderFlag) records
+ * that the body was in the other byte order. decode() restores the bytes of
+ * the body either way.
+ *
+ * pack() and unpack() wrap this as the PACKED_PHYSICS_EVENT item type. The
+ * codec works on any byte buffer, so V8 physics event bodies can be packed
+ * with encode() and decode() too.
+ */
+class CBodyCodec
+{
+public:
+    enum Method {
+        Stored           = 0,
+        FrameOfReference = 1,
+        Delta            = 2
+    };
+
+    /*! \brief Set in the method byte when the body is in the other byte order */
+    static const std::uint8_t ForeignOrderFlag = 0x80;
+
+    /*!
+     * \brief Encode a body with the method that packs it smallest
+     *
+     * \param foreignOrder  whether the body is in the byte order of the other
+     *                      kind of machine. This is only recorded.
+     */
+    static void encode(const Buffer::ByteBuffer& body, Buffer::ByteBuffer& encoded,
+                       bool foreignOrder = false);
+
+    /*!
+     * \brief Restore a body from the output of encode()
+     *
+     * \throws std::runtime_error if the encoded data is malformed
+     */
+    static void decode(const Buffer::ByteBuffer& encoded, Buffer::ByteBuffer& body);
+
+    /*!
+     * \return the method used to encode the data
+     *
+     * \throws std::runtime_error if the data is too short to have a header
+     */
+    static Method getMethod(const Buffer::ByteBuffer& encoded);
+
+    /*!
+     * \return whether the encoded body is in the other byte order
+     *
+     * \throws std::runtime_error if the data is too short to have a header
+     */
+    static bool isForeignOrder(const Buffer::ByteBuffer& encoded);
+
+    /*!
+     * \brief Pack a physics event into a PACKED_PHYSICS_EVENT item
+     *
+     * The timestamp and source id are kept. The packed item is always in the
+     * native byte order. If the event must be swapped, that is recorded in the
+     * codec header and restored by unpack().
+     *
+     * \throws std::invalid_argument if the item is not a PHYSICS_EVENT
+     */
+    static CRawRingItem pack(const CRawRingItem& event);
+
+    /*!
+     * \brief Restore the physics event from a PACKED_PHYSICS_EVENT item
+     *
+     * The event must be swapped if the packed event had to be.
+     *
+     * \throws std::invalid_argument if the item is not a PACKED_PHYSICS_EVENT
+     * \throws std::runtime_error if the item was packed on a machine of the
+     *                            other byte order or is malformed
+     */
+    static CPhysicsEventItem unpack(const CRawRingItem& packed);
+};
+
+} // end V12
+} // end DAQ
+
+#endif // DAQ_V12_CBODYCODEC_H
@@ -0,0 +1,46 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "V12/CCodecRingItemFactory.h"
+#include "V12/CBodyCodec.h"
+#include "V12/CRingItemFactory.h"
+#include "V12/CRawRingItem.h"
+#include "V12/CPhysicsEventItem.h"
+#include "V12/DataFormat.h"
+
+#include <utility>
+
+namespace DAQ {
+namespace V12 {
+
+CRingItemUPtr CCodecRingItemFactory::createRingItem(const CRawRingItem& item)
+{
+    if (item.type() == PACKED_PHYSICS_EVENT) {
+        return CRingItemUPtr(new CPhysicsEventItem(CBodyCodec::unpack(item)));
+    }
+    return CRingItemFactory::createRingItem(item);
+}
+
+CRingItemUPtr CCodecRingItemFactory::createRingItem(CRawRingItem&& item)
+{
+    if (item.type() == PACKED_PHYSICS_EVENT) {
+        return CRingItemUPtr(new CPhysicsEventItem(CBodyCodec::unpack(item)));
+    }
+    return CRingItemFactory::createRingItem(std::move(item));
+}
+
+} // end V12
+} // end DAQ
@@ -0,0 +1,49 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+
+#ifndef DAQ_V12_CCODECRINGITEMFACTORY_H
+#define DAQ_V12_CCODECRINGITEMFACTORY_H
+
+#include <V12/CRingItem.h>
+
+namespace DAQ {
+namespace V12 {
+
+class CRawRingItem;
+
+/**
+ * \brief A ring item factory that also understands packed physics events
+ *
+ * PACKED_PHYSICS_EVENT items are unpacked with CBodyCodec into the
+ * CPhysicsEventItem they were made from. Every other item is created by
+ * CRingItemFactory, which itself leaves packed items as CRawRingItems, so
+ * code that does not use this factory passes packed items through untouched.
+ */
+class CCodecRingItemFactory
+{
+public:
+    /*!
+     * \throws std::runtime_error if a packed item cannot be unpacked
+     */
+    static CRingItemUPtr createRingItem(const CRawRingItem& item);
+    static CRingItemUPtr createRingItem(CRawRingItem&& item);
+};
+
+} // end V12
+} // end DAQ
+
+#endif // DAQ_V12_CCODECRINGITEMFACTORY_H
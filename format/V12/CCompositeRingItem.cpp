@@ -16,6 +16,7 @@
 #include <V12/CCompositeRingItem.h>
 #include <V12/DataFormat.h>
 #include <V12/CRingItemParser.h>
+#include <V12/CRingItemEncoder.h>
 #include <ByteBuffer.h>
 #include <ByteOrder.h>
 #include <RangeDeserializer.h>
@@ -74,6 +75,23 @@ CCompositeRingItem::CCompositeRingItem(uint32_t type,
  */
 CCompositeRingItem::CCompositeRingItem(const CRawRingItem& rawItem)
 {
+    fromRawRingItem(rawItem);
+}
+
+/*!
+ * \brief Replace the contents with those of a raw ring item
+ *
+ * The children are parsed as in the constructor, so they are newly allocated.
+ *
+ * \param rawItem the raw ring item to parse
+ *
+ * \throws std::runtime_error if the buffer contains incomplete ring items
+ * \throws std::runtime_error if the type of the children (lowest 15 bits) do not match the type of the parent.
+ */
+void CCompositeRingItem::fromRawRingItem(const CRawRingItem& rawItem)
+{
+    m_children.clear();
+
     m_type = rawItem.type();
     m_evtTimestamp = rawItem.getEventTimestamp();
     m_sourceId = rawItem.getSourceId();
@@ -233,18 +251,22 @@ void CCompositeRingItem::toRawRingItem(CRawRingItem& rawBuffer) const {
     rawBuffer.setMustSwap(mustSwap());
 
     auto& body = rawBuffer.getBody();
-    body.clear();
+    body.resize(size()-20); // the minus 20 is to exclude for the header
 
-    body.reserve(size()-20); // the minus 20 is to exclude for the header
+    // the children write themselves straight into the body
+    uint8_t* out = body.data();
+    for (auto& pChild : m_children) {
+        out = pChild->encode(out);
+    }
+}
 
-    for (auto pChild : m_children) {
-        CRawRingItem chunk(*pChild);
-        body << chunk.size();
-        body << chunk.type();
-        body << chunk.getEventTimestamp();
-        body << chunk.getSourceId();
-        body.insert(body.end(), chunk.getBody().begin(), chunk.getBody().end());
+uint8_t* CCompositeRingItem::encode(uint8_t* out) const
+{
+    out = Encoder::encodeHeader(out, size(), type() | 0x8000, m_evtTimestamp, m_sourceId);
+    for (auto& pChild : m_children) {
+        out = pChild->encode(out);
     }
+    return out;
 }
 
 std::string CCompositeRingItem::typeName() const {
@@ -176,6 +176,8 @@ public:
     bool mustSwap() const;
 
     void toRawRingItem(CRawRingItem& rawBuffer) const;
+    uint8_t* encode(uint8_t* out) const;
+    void fromRawRingItem(const CRawRingItem& rhs);
 
     std::string typeName() const;
     std::string toString() const;
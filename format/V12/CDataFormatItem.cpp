@@ -16,8 +16,10 @@
 #include "V12/CDataFormatItem.h"
 #include "V12/DataFormat.h"
 #include "V12/CRawRingItem.h"
+#include "V12/CRingItemEncoder.h"
 #include "ContainerDeserializer.h"
 #include "ByteBuffer.h"
+#include "ByteWriter.h"
 #include <make_unique.h>
 
 #include <sstream>
@@ -65,6 +67,16 @@ CDataFormatItem::CDataFormatItem(uint64_t tstamp, uint32_t sourceId, uint16_t ma
  * \throws std::runtime_error if insufficient data is provided in the body of raw ring item
  */
 CDataFormatItem::CDataFormatItem(const CRawRingItem& rawItem)
+{
+    fromRawRingItem(rawItem);
+}
+
+/**
+ * Refill the item from a raw ring item
+ *
+ * @param rawItem - a raw RING_FORMAT item
+ */
+void CDataFormatItem::fromRawRingItem(const CRawRingItem& rawItem)
 {
     m_evtTimestamp = rawItem.getEventTimestamp();
     m_sourceId = rawItem.getSourceId();
@@ -184,20 +196,32 @@ bool CDataFormatItem::mustSwap() const {
 /*!
  * \brief Serialize data into a raw ring item
  * \param item  the raw ring item to fill with the data
+ *
+ * The body of item is cleared prior to adding new data.
  */
 void CDataFormatItem::toRawRingItem(CRawRingItem& item) const
 {
-    item.getBody().clear();
-
     item.setType(type());
     item.setEventTimestamp(getEventTimestamp());
     item.setSourceId(getSourceId());
     item.setMustSwap(mustSwap());
 
-    item.getBody() << m_major << m_minor;
+    // the writer appends, so stale data must go first
+    auto& body = item.getBody();
+    body.clear();
+
+    Buffer::ByteWriter writer(body, size() - 20);
+    writer << m_major << m_minor;
 
 }
 
+uint8_t* CDataFormatItem::encode(uint8_t* out) const
+{
+    out = Encoder::encodeHeader(out, size(), type(), m_evtTimestamp, m_sourceId);
+    out = Encoder::put(out, m_major);
+    return Encoder::put(out, m_minor);
+}
+
 
 /**
  * major
@@ -79,6 +79,8 @@ public:
     bool mustSwap() const;
 
     void toRawRingItem(CRawRingItem& item) const;
+    uint8_t* encode(uint8_t* out) const;
+    void fromRawRingItem(const CRawRingItem& rhs);
     
     uint16_t getMajor() const;
     void setMajor(uint16_t major);
@@ -16,7 +16,9 @@
 #include "V12/CGlomParameters.h"
 #include "V12/DataFormat.h"
 #include "V12/CRawRingItem.h"
+#include "V12/CRingItemEncoder.h"
 #include "ContainerDeserializer.h"
+#include "ByteWriter.h"
 
 #include <make_unique.h>
 
@@ -102,6 +104,18 @@ CGlomParameters::~CGlomParameters()
  * \throws std::invalid_argument if policy is not one of the enumerated values provided
  */
 CGlomParameters::CGlomParameters(const CRawRingItem& rhs)
+{
+    fromRawRingItem(rhs);
+}
+
+/**
+ * Refill the item from a raw ring item
+ *
+ * @param rhs - a raw EVB_GLOM_INFO item
+ *
+ * @throw std::bad_cast if rhs is not a glom parameters item
+ */
+void CGlomParameters::fromRawRingItem(const CRawRingItem& rhs)
 {
     if (rhs.type() != EVB_GLOM_INFO) throw std::bad_cast();
 
@@ -256,12 +270,21 @@ void CGlomParameters::toRawRingItem(CRawRingItem& raw) const
     auto& body = raw.getBody();
     body.clear();
 
-    body << m_coincTicks;
-    body << (m_isBuilding ? uint16_t(1) : uint16_t(0));
-    body << uint16_t(m_policy);
+    Buffer::ByteWriter writer(body, size() - 20);
+    writer << m_coincTicks;
+    writer << (m_isBuilding ? uint16_t(1) : uint16_t(0));
+    writer << uint16_t(m_policy);
 
 }
 
+uint8_t* CGlomParameters::encode(uint8_t* out) const
+{
+    out = Encoder::encodeHeader(out, size(), EVB_GLOM_INFO, m_evtTimestamp, m_sourceId);
+    out = Encoder::put(out, m_coincTicks);
+    out = Encoder::put(out, m_isBuilding ? uint16_t(1) : uint16_t(0));
+    return Encoder::put(out, uint16_t(m_policy));
+}
+
 
 
 /**
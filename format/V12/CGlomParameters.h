@@ -85,6 +85,8 @@ public:
     bool isComposite() const;
 
     void toRawRingItem(CRawRingItem& raw) const;
+    uint8_t* encode(uint8_t* out) const;
+    void fromRawRingItem(const CRawRingItem& rhs);
 
 
    uint64_t coincidenceTicks() const;
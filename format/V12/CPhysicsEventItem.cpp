@@ -22,6 +22,15 @@
 namespace DAQ {
   namespace V12 {
 
+  // Validate the type before the body of rhs is taken over
+  static CRawRingItem&& requirePhysicsEvent(CRawRingItem&& rhs)
+  {
+      if (rhs.type() != PHYSICS_EVENT) {
+          throw std::bad_cast();
+      }
+      return std::move(rhs);
+  }
+
   /*!
    * \brief Construct an empty physics event
    */
@@ -55,8 +64,36 @@ namespace DAQ {
       }
   }
 
+  /*!
+   * \brief Construct from an expiring raw ring item
+   *
+   * \param rhs the raw ring item, whose body is taken over without a copy
+   *
+   * \throws std::bad_cast if rhs is not a physics event. rhs is left
+   *         untouched in that case.
+   */
+  CPhysicsEventItem::CPhysicsEventItem(CRawRingItem&& rhs)
+      : CRawRingItem(requirePhysicsEvent(std::move(rhs)))
+  {
+  }
+
   CPhysicsEventItem::~CPhysicsEventItem() {}
 
+  /*!
+   * \brief Refill the item from a raw ring item
+   *
+   * The body is copied into the existing body, reusing its capacity.
+   *
+   * \throws std::bad_cast if rhs is not a physics event
+   */
+  void CPhysicsEventItem::fromRawRingItem(const CRawRingItem& rhs)
+  {
+      if (rhs.type() != PHYSICS_EVENT) {
+          throw std::bad_cast();
+      }
+      CRawRingItem::operator=(rhs);
+  }
+
   /*!
    * \brief Equality comparison operator
    *
@@ -66,10 +66,15 @@ public:
   CPhysicsEventItem(uint64_t timestamp, uint32_t source, const Buffer::ByteBuffer& body = Buffer::ByteBuffer() );
 
   CPhysicsEventItem(const CRawRingItem& rhs);
+  CPhysicsEventItem(CRawRingItem&& rhs);
   CPhysicsEventItem(const CPhysicsEventItem& rhs) = default;
+  CPhysicsEventItem(CPhysicsEventItem&& rhs) = default;
   virtual ~CPhysicsEventItem();
 
+  void fromRawRingItem(const CRawRingItem& rhs);
+
   CPhysicsEventItem& operator=(const CPhysicsEventItem& rhs) = default;
+  CPhysicsEventItem& operator=(CPhysicsEventItem&& rhs) = default;
   virtual bool operator==(const CRingItem& rhs) const;
   virtual bool operator!=(const CRingItem& rhs) const;
 
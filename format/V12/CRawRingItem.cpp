@@ -16,11 +16,11 @@
 
 #include "CRawRingItem.h"
 #include "DataFormat.h"
+#include "TextFormat.h"
+#include "CRingItemEncoder.h"
 #include "ContainerDeserializer.h"
 #include "ByteOrder.h"
 #include <make_unique.h>
-#include <sstream>
-#include <iomanip>
 
 namespace DAQ {
   namespace V12 {
@@ -38,6 +38,12 @@ namespace DAQ {
     CRawRingItem::CRawRingItem(uint32_t type, uint64_t timestamp, uint32_t sourceId, const Buffer::ByteBuffer& body)
         : m_type(type), m_timestamp(timestamp), m_sourceId(sourceId), m_body(body), m_mustSwap(false) {}
 
+    /*!
+     * \brief Construct from header fields, taking over the storage of the body
+     */
+    CRawRingItem::CRawRingItem(uint32_t type, uint64_t timestamp, uint32_t sourceId, Buffer::ByteBuffer&& body)
+        : m_type(type), m_timestamp(timestamp), m_sourceId(sourceId), m_body(std::move(body)), m_mustSwap(false) {}
+
     /*!
      * \brief Default constructor
      *
@@ -202,49 +208,28 @@ namespace DAQ {
      * byte without any padding.
      */
     std::string CRawRingItem::toString() const {
+      std::string out;
+      appendString(out);
+      return out;
+    }
 
-      std::ostringstream out;
-      uint32_t  bytes = getBodySize();
-
-      Buffer::ContainerDeserializer<Buffer::ByteBuffer> bodyStream(getBody());
-
+    /*!
+     * \brief Append the textual representation to a string
+     *
+     * \param out  the string to append to
+     *
+     * See toString() for the format.
+     */
+    void CRawRingItem::appendString(std::string& out) const {
 
-      out << headerToString(*this);
+      appendHeaderString(out, *this);
 
       if (mustSwap()) {
-          out << "** Data is NOT in native byte order **" << std::endl;
+          out += "** Data is NOT in native byte order **\n";
       }
 
-      out << std::hex << setfill('0');
-
-      uint8_t byte0, byte1;
-      int i = 0;
-      while (1) {
-        bodyStream >> byte0;
-        if (bodyStream.eof()) break;
-        bodyStream >> byte1;
-        if (bodyStream.eof()) {
-            // odd number of bytes.
-            // this only happens at the end, so we don't need
-            // to worry about line endings
-            out << std::setw(2) << int(byte0) << " ";
-        } else {
-            if ( (i%8) == 0 && i!=0) {
-                out << std::endl;
-            }
-
-            uint16_t value = byte1;
-            value = (value<<8) | byte0;
-            out << std::setw(4) << value << " ";
-
-            i++;
-        }
-      }
-      out << std::endl;
-
-      return out.str();
-
-    };
+      TextFormat::appendHexWords(out, m_body.data(), m_body.data() + m_body.size());
+    }
 
 
     uint32_t CRawRingItem::getBodySize() const {
@@ -267,6 +252,11 @@ namespace DAQ {
         m_body = body;
     }
 
+    void CRawRingItem::setBody(Buffer::ByteBuffer&& body)
+    {
+        m_body = std::move(body);
+    }
+
     /*!
      * \brief Copy contents of this into another raw ring item
      *
@@ -276,6 +266,11 @@ namespace DAQ {
       item = *this;
     }
 
+    uint8_t* CRawRingItem::encode(uint8_t* out) const {
+      return Encoder::encodeItem(out, m_type, m_timestamp, m_sourceId,
+                                 m_body.data(), m_body.data() + m_body.size());
+    }
+
     /*!
      * \retval false body data is in native byte order
      * \retval true otherwise
@@ -87,15 +87,18 @@ private:
 public:
   explicit CRawRingItem();
   explicit CRawRingItem(uint32_t type, uint64_t timestamp, uint32_t sourceId, const Buffer::ByteBuffer& body=Buffer::ByteBuffer());
+  explicit CRawRingItem(uint32_t type, uint64_t timestamp, uint32_t sourceId, Buffer::ByteBuffer&& body);
   explicit CRawRingItem(const Buffer::ByteBuffer& rawData);
 
   template<class ByteIterator> CRawRingItem(ByteIterator beg, ByteIterator end);
 
   CRawRingItem(const CRawRingItem& rhs) = default;
+  CRawRingItem(CRawRingItem&& rhs) = default;
   CRawRingItem(const CRingItem& rhs);
   virtual ~CRawRingItem();
 
   CRawRingItem& operator=(const CRawRingItem& rhs) = default;
+  CRawRingItem& operator=(CRawRingItem&& rhs) = default;
   virtual bool operator==(const CRingItem& rhs) const;
   virtual bool operator!=(const CRingItem& rhs) const;
 
@@ -117,6 +120,7 @@ public:
 
   virtual std::string typeName() const;	// Textual type of item.
   virtual std::string toString() const; // Provide string dump of the item.
+  virtual void appendString(std::string& out) const;
 
   virtual CRingItemUPtr clone() const;
 
@@ -126,10 +130,13 @@ public:
   Buffer::ByteBuffer& getBody();
   const Buffer::ByteBuffer& getBody() const;
   void setBody(const Buffer::ByteBuffer& body);
+  void setBody(Buffer::ByteBuffer&& body);
 
   void toRawRingItem(CRawRingItem& item) const;
+  uint8_t* encode(uint8_t* out) const;
 
-  template<class T> std::unique_ptr<T> as() const;
+  template<class T> std::unique_ptr<T> as() const &;
+  template<class T> std::unique_ptr<T> as() &&;
 
 };
 
@@ -193,9 +200,25 @@ template<class ByteIterator> CRawRingItem::CRawRingItem(ByteIterator beg, ByteIt
  * All CRingItem-derived types must able to construct from a CRawRingItem.
  */
 template<class T>
-std::unique_ptr<T> DAQ::V12::CRawRingItem::as() const
+std::unique_ptr<T> DAQ::V12::CRawRingItem::as() const &
 {
   return std::unique_ptr<T>(new T(*this));
 }
 
+/*! \brief Convert an expiring raw item to a CRingItem
+ *
+ * Types that can construct from a CRawRingItem&& (e.g. CPhysicsEventItem)
+ * take over the body rather than copying it. This item is left in a valid
+ * but unspecified state.
+ *
+ * \code
+ * auto pEvent = std::move(rawItem).as<CPhysicsEventItem>();
+ * \endcode
+ */
+template<class T>
+std::unique_ptr<T> DAQ::V12::CRawRingItem::as() &&
+{
+  return std::unique_ptr<T>(new T(std::move(*this)));
+}
+
 #endif
@@ -0,0 +1,252 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+        Jeromy Tompkins
+         NSCL
+         Michigan State University
+         East Lansing, MI 48824-1321
+*/
+
+#include <V12/CRecyclingRingItemFactory.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CPhysicsEventItem.h>
+#include <V12/CRingPhysicsEventCountItem.h>
+#include <V12/CRingScalerItem.h>
+#include <V12/CRingStateChangeItem.h>
+#include <V12/CRingTextItem.h>
+#include <V12/CGlomParameters.h>
+#include <V12/CAbnormalEndItem.h>
+#include <V12/CCompositeRingItem.h>
+#include <V12/CDataFormatItem.h>
+#include <V12/DataFormat.h>
+
+namespace DAQ {
+namespace V12 {
+
+namespace {
+
+// index of the free list for each item class
+enum Slot {
+    StateChangeSlot,
+    TextSlot,
+    ScalerSlot,
+    PhysicsEventSlot,
+    PhysicsEventCountSlot,
+    DataFormatSlot,
+    GlomParametersSlot,
+    AbnormalEndSlot,
+    CompositeSlot,
+    RawSlot
+};
+
+// refill a recycled item from the raw data
+template<class T>
+void refill(T& item, const CRawRingItem& raw)
+{
+    item.fromRawRingItem(raw);
+}
+
+void refill(CRawRingItem& item, const CRawRingItem& raw)
+{
+    item = raw;
+}
+
+} // end anonymous namespace
+
+
+CRecyclingRingItemFactory::Pools::Pools(std::size_t maxPooled)
+    : s_free(), s_maxPooled(maxPooled)
+{}
+
+CRecyclingRingItemFactory::Pools::~Pools()
+{
+    for (auto& freeList : s_free) {
+        for (auto pItem : freeList) {
+            delete pItem;
+        }
+    }
+}
+
+
+CRecyclingRingItemFactory::Recycler::Recycler()
+    : m_pPools(), m_slot(0)
+{}
+
+CRecyclingRingItemFactory::Recycler::Recycler(std::shared_ptr<Pools> pPools,
+                                              unsigned slot)
+    : m_pPools(std::move(pPools)), m_slot(slot)
+{}
+
+/*!
+ * \brief Put the item back on its free list
+ *
+ * The item is deleted if the free list is full or if the deleter is not
+ * attached to a factory.
+ */
+void CRecyclingRingItemFactory::Recycler::operator()(CRingItem* pItem) const
+{
+    if (!pItem) return;
+
+    if (m_pPools) {
+        auto& freeList = m_pPools->s_free[m_slot];
+        if (freeList.size() < m_pPools->s_maxPooled) {
+            freeList.push_back(pItem);
+            return;
+        }
+    }
+
+    delete pItem;
+}
+
+
+/*!
+ * \param maxPooled  maximum number of items kept on each free list
+ */
+CRecyclingRingItemFactory::CRecyclingRingItemFactory(std::size_t maxPooled)
+    : m_pPools(std::make_shared<Pools>(maxPooled))
+{}
+
+
+/*!
+ * \brief Pop an item off a free list and refill it, or allocate a new one
+ */
+template<class T>
+CRecyclingRingItemFactory::ItemPtr
+CRecyclingRingItemFactory::makeItem(unsigned slot, const CRawRingItem& raw)
+{
+    auto& freeList = m_pPools->s_free[slot];
+    if (freeList.empty()) {
+        freeList.reserve(m_pPools->s_maxPooled);
+        return ItemPtr(new T(raw), Recycler(m_pPools, slot));
+    }
+
+    T* pItem = static_cast<T*>(freeList.back());
+    freeList.pop_back();
+    try {
+        refill(*pItem, raw);
+    } catch (...) {
+        freeList.push_back(pItem);
+        throw;
+    }
+
+    return ItemPtr(pItem, Recycler(m_pPools, slot));
+}
+
+/**
+ * Create a ring item of the correct underlying type for item.type()
+ *
+ * \param item - the raw ring item to decode
+ *
+ * The mapping from type to class is the same as for
+ * CRingItemFactory::createRingItem(). If an item of the selected class is on
+ * the free list, it is refilled from item instead of allocating a new object.
+ *
+ * \return the item, which is returned to the factory when the pointer is reset
+ *
+ * \throws whatever the constructor or fromRawRingItem() of the class throws. A
+ *         recycled item that fails to refill is kept on the free list.
+ */
+CRecyclingRingItemFactory::ItemPtr
+CRecyclingRingItemFactory::createRingItem(const CRawRingItem& item)
+{
+    switch (item.type()) {
+    case BEGIN_RUN:
+    case END_RUN:
+    case PAUSE_RUN:
+    case RESUME_RUN:
+        return makeItem<CRingStateChangeItem>(StateChangeSlot, item);
+
+    case PACKET_TYPES:
+    case MONITORED_VARIABLES:
+        return makeItem<CRingTextItem>(TextSlot, item);
+
+    case PERIODIC_SCALERS:
+        return makeItem<CRingScalerItem>(ScalerSlot, item);
+
+    case PHYSICS_EVENT:
+        return makeItem<CPhysicsEventItem>(PhysicsEventSlot, item);
+
+    case PHYSICS_EVENT_COUNT:
+        return makeItem<CRingPhysicsEventCountItem>(PhysicsEventCountSlot, item);
+
+    case RING_FORMAT:
+        return makeItem<CDataFormatItem>(DataFormatSlot, item);
+
+    case EVB_GLOM_INFO:
+        return makeItem<CGlomParameters>(GlomParametersSlot, item);
+
+    case ABNORMAL_ENDRUN:
+        return makeItem<CAbnormalEndItem>(AbnormalEndSlot, item);
+
+    case COMP_BEGIN_RUN:
+    case COMP_END_RUN:
+    case COMP_PAUSE_RUN:
+    case COMP_RESUME_RUN:
+    case COMP_PACKET_TYPES:
+    case COMP_MONITORED_VARIABLES:
+    case COMP_PERIODIC_SCALERS:
+    case COMP_PHYSICS_EVENT:
+    case COMP_PHYSICS_EVENT_COUNT:
+    case COMP_ABNORMAL_ENDRUN:
+    case COMP_RING_FORMAT:
+    case COMP_EVB_GLOM_INFO:
+        return makeItem<CCompositeRingItem>(CompositeSlot, item);
+
+    default:
+        return makeItem<CRawRingItem>(RawSlot, item);
+    }
+}
+
+
+/*!
+ * \brief Set the maximum number of items kept on each free list
+ *
+ * Free lists that are longer than the new limit are trimmed.
+ */
+void CRecyclingRingItemFactory::setMaxPooled(std::size_t maxPooled)
+{
+    m_pPools->s_maxPooled = maxPooled;
+    for (auto& freeList : m_pPools->s_free) {
+        while (freeList.size() > maxPooled) {
+            delete freeList.back();
+            freeList.pop_back();
+        }
+    }
+}
+
+std::size_t CRecyclingRingItemFactory::getMaxPooled() const
+{
+    return m_pPools->s_maxPooled;
+}
+
+/*! \return the number of items on all free lists */
+std::size_t CRecyclingRingItemFactory::getPooledCount() const
+{
+    std::size_t count = 0;
+    for (auto& freeList : m_pPools->s_free) {
+        count += freeList.size();
+    }
+    return count;
+}
+
+/*! \brief Delete all items on the free lists */
+void CRecyclingRingItemFactory::clear()
+{
+    for (auto& freeList : m_pPools->s_free) {
+        for (auto pItem : freeList) {
+            delete pItem;
+        }
+        freeList.clear();
+    }
+}
+
+
+} // end V12
+} // end DAQ
@@ -0,0 +1,117 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+        Jeromy Tompkins
+         NSCL
+         Michigan State University
+         East Lansing, MI 48824-1321
+*/
+
+
+#ifndef DAQ_V12_CRECYCLINGRINGITEMFACTORY_H
+#define DAQ_V12_CRECYCLINGRINGITEMFACTORY_H
+
+#include <V12/CRingItem.h>
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace DAQ {
+namespace V12 {
+
+class CRawRingItem;
+
+/**
+ * \brief A ring item factory that reuses the items it has produced
+ *
+ * CRingItemFactory::createRingItem() allocates a new object, and with it a new
+ * body, for every item that is decoded. This factory instead keeps a free list
+ * per item class. When an item it produced is released, the item goes back on
+ * its free list rather than being deleted. The next time an item of the same
+ * class is requested, the recycled object is refilled in place with
+ * fromRawRingItem(), so its body, scaler vector, strings, etc. keep the
+ * capacity they already had. Once the free lists are warm, decoding a stream
+ * does not allocate any memory, except for the children of composite items.
+ *
+ * \code
+ * CRecyclingRingItemFactory factory;
+ * CRawRingItem raw;
+ * while (stream >> raw) {
+ *     CRecyclingRingItemFactory::ItemPtr pItem = factory.createRingItem(raw);
+ *     process(*pItem);
+ * }   // pItem goes back to the factory here
+ * \endcode
+ *
+ * Items are handed out through a unique_ptr with a Recycler deleter. The deleter
+ * shares ownership of the free lists, so an item may safely outlive the factory
+ * that created it; it is then simply deleted. An ItemPtr must not be converted to
+ * a CRingItemPtr with a plain deleter.
+ *
+ * The factory is not thread-safe. Items must be released on the thread that
+ * uses the factory.
+ */
+class CRecyclingRingItemFactory
+{
+private:
+    // the free lists, shared with the deleters of the outstanding items
+    struct Pools {
+        std::array<std::vector<CRingItem*>, 10> s_free;
+        std::size_t                             s_maxPooled;
+
+        explicit Pools(std::size_t maxPooled);
+        ~Pools();
+    };
+
+public:
+    /*!
+     * \brief Deleter that returns an item to the free list it came from
+     *
+     * A default constructed Recycler deletes the item.
+     */
+    class Recycler {
+    private:
+        std::shared_ptr<Pools> m_pPools;
+        unsigned               m_slot;
+
+    public:
+        Recycler();
+        Recycler(std::shared_ptr<Pools> pPools, unsigned slot);
+
+        void operator()(CRingItem* pItem) const;
+    };
+
+    using ItemPtr = std::unique_ptr<CRingItem, Recycler>;
+
+private:
+    std::shared_ptr<Pools> m_pPools;
+
+public:
+    explicit CRecyclingRingItemFactory(std::size_t maxPooled = 64);
+
+    CRecyclingRingItemFactory(const CRecyclingRingItemFactory&) = delete;
+    CRecyclingRingItemFactory& operator=(const CRecyclingRingItemFactory&) = delete;
+
+    ItemPtr createRingItem(const CRawRingItem& item);
+
+    void        setMaxPooled(std::size_t maxPooled);
+    std::size_t getMaxPooled() const;
+    std::size_t getPooledCount() const;
+    void        clear();
+
+private:
+    template<class T> ItemPtr makeItem(unsigned slot, const CRawRingItem& raw);
+};
+
+} // end V12
+} // end DAQ
+
+#endif // DAQ_V12_CRECYCLINGRINGITEMFACTORY_H
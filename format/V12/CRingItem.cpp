@@ -15,30 +15,51 @@
 */
 
 #include <V12/CRingItem.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CRingItemEncoder.h>
 #include <V12/DataFormat.h>
-#include <iostream>
-#include <sstream>
+#include <V12/TextFormat.h>
 
 
 namespace DAQ {
 namespace V12 {
 
 std::string headerToString(const DAQ::V12::CRingItem &item) {
-    std::ostringstream result;
-    result << "Size (bytes) : " << item.size() << std::endl;
-    result << "Type         : " << item.typeName() << std::endl;
+    std::string result;
+    appendHeaderString(result, item);
+    return result;
+}
+
+void appendHeaderString(std::string& out, const DAQ::V12::CRingItem& item) {
+    out += "Size (bytes) : ";
+    TextFormat::appendDecimal(out, item.size());
+    out += "\nType         : ";
+    out += item.typeName();
+    out += "\nTimestamp    : ";
     uint64_t tstamp = item.getEventTimestamp();
     if (tstamp != NULL_TIMESTAMP) {
-        result << "Timestamp    : " << tstamp << std::endl;
+        TextFormat::appendDecimal(out, tstamp);
     } else {
-        result << "Timestamp    : NULL_TIMESTAMP" << std::endl;
+        out += "NULL_TIMESTAMP";
     }
-    result << "Source Id    : " << item.getSourceId()  << std::endl;
+    out += "\nSource Id    : ";
+    TextFormat::appendDecimal(out, item.getSourceId());
+    out += '\n';
+}
 
-    return result.str();
-    }
+void CRingItem::appendString(std::string& out) const {
+    out += toString();
+}
 
+uint8_t* CRingItem::encode(uint8_t* out) const {
+    CRawRingItem raw;
+    toRawRingItem(raw);
 
+    auto& body = raw.getBody();
+    return Encoder::encodeItem(out, raw.type(), raw.getEventTimestamp(),
+                               raw.getSourceId(), body.data(),
+                               body.data() + body.size());
+}
 
 
 } // end V12 namespace
@@ -53,6 +53,8 @@ namespace DAQ {
     class CRingItem {
       public:
 
+        virtual ~CRingItem() {}
+
         /*!
          * \return the full type of the item (including the composite bit)
          */
@@ -100,6 +102,30 @@ namespace DAQ {
          */
         virtual std::string toString() const = 0;
 
+        /*!
+         * \brief Append the string representation to an existing string
+         *
+         * The output is identical to toString(). Dumping many items into the
+         * same, reused string avoids allocating a new string per item. The
+         * default implementation just appends the result of toString().
+         *
+         * \param out  the string to append to
+         */
+        virtual void appendString(std::string& out) const;
+
+        /*!
+         * \brief Write the item in its wire format (native byte order)
+         *
+         * Exactly size() bytes are written, header included. The default
+         * implementation goes through toRawRingItem(). Derived types write
+         * their fields directly. See also the Encoder namespace.
+         *
+         * \param out  memory of at least size() bytes
+         *
+         * \return pointer to the byte following the item
+         */
+        virtual uint8_t* encode(uint8_t* out) const;
+
         /*!
          * \brief Serialize the ring item to a raw ring item
          *
@@ -144,6 +170,14 @@ namespace DAQ {
      */
     std::string headerToString(const CRingItem& item);
 
+    /*!
+     * \brief Append the representation of the header to a string
+     *
+     * \param out   the string to append to
+     * \param item  the item whose header will be represented
+     */
+    void appendHeaderString(std::string& out, const CRingItem& item);
+
 
     /*!
      * \brief Serialize the ring item header into some memory
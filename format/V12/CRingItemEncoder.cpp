@@ -0,0 +1,84 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+        Jeromy Tompkins
+         NSCL
+         Michigan State University
+         East Lansing, MI 48824-1321
+*/
+
+#include <V12/CRingItemEncoder.h>
+#include <V12/CRingItem.h>
+#include <V12/DataFormat.h>
+
+#include <cstddef>
+#include <stdexcept>
+
+namespace DAQ {
+namespace V12 {
+namespace Encoder {
+
+std::uint8_t* encode(const CRingItem& item, std::uint8_t* beg, std::uint8_t* end)
+{
+    if (end - beg < std::ptrdiff_t(item.size())) {
+        throw std::runtime_error("DAQ::V12::Encoder::encode() insufficient space for item");
+    }
+
+    return item.encode(beg);
+}
+
+
+void encode(const CRingItem& item, Buffer::ByteBuffer& arena)
+{
+    std::size_t offset = arena.size();
+    arena.resize(offset + item.size());
+    item.encode(arena.data() + offset);
+}
+
+
+std::uint8_t* encodeScalerItem(std::uint8_t* out, std::uint64_t tstamp,
+                               std::uint32_t sourceId, std::uint32_t startOffset,
+                               std::uint32_t endOffset, std::uint32_t timestamp,
+                               std::uint32_t divisor, bool incremental,
+                               std::uint32_t width, const std::uint32_t* scalers,
+                               std::size_t nScalers)
+{
+    out = encodeHeader(out, scalerItemSize(nScalers), PERIODIC_SCALERS, tstamp, sourceId);
+    out = put(out, startOffset);
+    out = put(out, endOffset);
+    out = put(out, timestamp);
+    out = put(out, divisor);
+    out = put(out, std::uint32_t(nScalers));
+    out = put(out, incremental ? std::uint32_t(1) : std::uint32_t(0));
+    out = put(out, width);
+
+    std::size_t nBytes = nScalers*sizeof(std::uint32_t);
+    if (nBytes) {
+        std::memcpy(out, scalers, nBytes);
+    }
+    return out + nBytes;
+}
+
+
+std::uint8_t* encodeItem(std::uint8_t* out, std::uint32_t type, std::uint64_t tstamp,
+                         std::uint32_t sourceId, const std::uint8_t* bodyBeg,
+                         const std::uint8_t* bodyEnd)
+{
+    std::size_t nBytes = bodyEnd - bodyBeg;
+    out = encodeHeader(out, 20 + nBytes, type, tstamp, sourceId);
+    if (nBytes) {
+        std::memcpy(out, bodyBeg, nBytes);
+    }
+    return out + nBytes;
+}
+
+} // end Encoder
+} // end V12
+} // end DAQ
@@ -0,0 +1,159 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+        Jeromy Tompkins
+         NSCL
+         Michigan State University
+         East Lansing, MI 48824-1321
+*/
+
+
+#ifndef DAQ_V12_CRINGITEMENCODER_H
+#define DAQ_V12_CRINGITEMENCODER_H
+
+#include <ByteBuffer.h>
+#include <ByteOrder.h>
+#include <cstdint>
+#include <cstring>
+
+namespace DAQ {
+namespace V12 {
+
+class CRingItem;
+
+/*!
+ * The Encoder namespace contains the functions that write ring items straight
+ * into their wire format (native byte order). As opposed to toRawRingItem()
+ * followed by serializeHeader(), the header and body are written in a single
+ * pass into memory that is sized exactly once from CRingItem::size().
+ *
+ * \code
+ * Buffer::ByteBuffer arena;
+ * for (auto& item : items) {
+ *     Encoder::encode(*item, arena);   // appends the wire format of item
+ * }
+ * sink.write(arena.data(), arena.size());
+ * \endcode
+ *
+ * The field level encoders (e.g. encodeScalerItem()) emit items without ever
+ * constructing an object.
+ */
+namespace Encoder {
+
+/*!
+ * \brief Copy a value into memory in native byte order
+ *
+ * \return pointer to the byte following the value
+ */
+template<class T>
+inline std::uint8_t* put(std::uint8_t* out, T value)
+{
+    std::memcpy(out, &value, sizeof(value));
+    return out + sizeof(value);
+}
+
+/*!
+ * \brief Write a 20-byte ring item header
+ *
+ * \return pointer to the first byte of the body
+ */
+inline std::uint8_t* encodeHeader(std::uint8_t* out, std::uint32_t size,
+                                  std::uint32_t type, std::uint64_t tstamp,
+                                  std::uint32_t sourceId)
+{
+    out = put(out, size);
+    out = put(out, type);
+    out = put(out, tstamp);
+    return put(out, sourceId);
+}
+
+/*!
+ * \brief Copy a value into memory, in the foreign byte order if swap is set
+ *
+ * \return pointer to the byte following the value
+ */
+template<class T>
+inline std::uint8_t* put(std::uint8_t* out, T value, bool swap)
+{
+    if (swap) {
+        BO::swapBytes(value);
+    }
+    return put(out, value);
+}
+
+/*!
+ * \brief Write a 20-byte ring item header, in the foreign byte order if swap is set
+ *
+ * \return pointer to the first byte of the body
+ */
+inline std::uint8_t* encodeHeader(std::uint8_t* out, std::uint32_t size,
+                                  std::uint32_t type, std::uint64_t tstamp,
+                                  std::uint32_t sourceId, bool swap)
+{
+    out = put(out, size, swap);
+    out = put(out, type, swap);
+    out = put(out, tstamp, swap);
+    return put(out, sourceId, swap);
+}
+
+
+/*!
+ * \brief Encode an item into the range [beg, end)
+ *
+ * \return pointer to the byte following the item
+ *
+ * \throws std::runtime_error if the range is smaller than item.size()
+ */
+std::uint8_t* encode(const CRingItem& item, std::uint8_t* beg, std::uint8_t* end);
+
+/*!
+ * \brief Append the encoded item to the end of an arena
+ *
+ * The arena grows by exactly item.size() bytes.
+ */
+void encode(const CRingItem& item, Buffer::ByteBuffer& arena);
+
+
+/*! \return the number of bytes in a scaler item with nScalers scalers */
+inline std::uint32_t scalerItemSize(std::size_t nScalers)
+{
+    return 20 + 7*sizeof(std::uint32_t) + nScalers*sizeof(std::uint32_t);
+}
+
+/*!
+ * \brief Write a complete PERIODIC_SCALERS item
+ *
+ * The memory at out must be at least scalerItemSize(nScalers) bytes.
+ *
+ * \return pointer to the byte following the item
+ */
+std::uint8_t* encodeScalerItem(std::uint8_t* out, std::uint64_t tstamp,
+                               std::uint32_t sourceId, std::uint32_t startOffset,
+                               std::uint32_t endOffset, std::uint32_t timestamp,
+                               std::uint32_t divisor, bool incremental,
+                               std::uint32_t width, const std::uint32_t* scalers,
+                               std::size_t nScalers);
+
+/*!
+ * \brief Write a complete item with an opaque body, e.g. a PHYSICS_EVENT
+ *
+ * The memory at out must be at least 20 + (bodyEnd - bodyBeg) bytes.
+ *
+ * \return pointer to the byte following the item
+ */
+std::uint8_t* encodeItem(std::uint8_t* out, std::uint32_t type, std::uint64_t tstamp,
+                         std::uint32_t sourceId, const std::uint8_t* bodyBeg,
+                         const std::uint8_t* bodyEnd);
+
+} // end Encoder
+} // end V12
+} // end DAQ
+
+#endif // DAQ_V12_CRINGITEMENCODER_H
@@ -39,6 +39,71 @@ namespace DAQ {
 
 static std::set<uint32_t> knownItemTypes;
 
+// Shared implementation of the createRingItem() overloads. The raw item is
+// forwarded to CRawRingItem::as<T>() so that rvalues are moved from.
+template<class RawItem>
+static CRingItemUPtr createFromRaw(RawItem&& item)
+{
+
+    switch (item.type()) {
+    // State change:
+
+    case BEGIN_RUN:
+    case END_RUN:
+    case PAUSE_RUN:
+    case RESUME_RUN:
+    {
+        return std::forward<RawItem>(item).template as<CRingStateChangeItem>();
+    }
+
+        // String list.
+
+    case PACKET_TYPES:
+    case MONITORED_VARIABLES:
+        return std::forward<RawItem>(item).template as<CRingTextItem>();
+        // Scalers:
+
+    case PERIODIC_SCALERS:
+        return std::forward<RawItem>(item).template as<CRingScalerItem>();
+
+        // Physics trigger:
+
+    case PHYSICS_EVENT:
+        return std::forward<RawItem>(item).template as<CPhysicsEventItem>();
+        // trigger count.
+
+    case PHYSICS_EVENT_COUNT:
+        return std::forward<RawItem>(item).template as<CRingPhysicsEventCountItem>();
+
+    case RING_FORMAT:
+        return std::forward<RawItem>(item).template as<CDataFormatItem>();
+
+    case EVB_GLOM_INFO:
+        return std::forward<RawItem>(item).template as<CGlomParameters>();
+
+    case ABNORMAL_ENDRUN:
+        return std::forward<RawItem>(item).template as<CAbnormalEndItem>();
+
+    case COMP_BEGIN_RUN:
+    case COMP_END_RUN:
+    case COMP_PAUSE_RUN:
+    case COMP_RESUME_RUN:
+    case COMP_PACKET_TYPES:
+    case COMP_MONITORED_VARIABLES:
+    case COMP_PERIODIC_SCALERS:
+    case COMP_PHYSICS_EVENT:
+    case COMP_PHYSICS_EVENT_COUNT:
+    case COMP_ABNORMAL_ENDRUN:
+    case COMP_RING_FORMAT:
+    case COMP_EVB_GLOM_INFO:
+        return std::forward<RawItem>(item).template as<CCompositeRingItem>();
+
+    default:
+        return std::forward<RawItem>(item).template as<CRawRingItem>();
+    }
+}
+
+
 /**
  * Create a ring item of the correct underlying type as indicated by the
  * value returned by CRawRingItem::type().
@@ -108,63 +173,24 @@ static std::set<uint32_t> knownItemTypes;
 std::unique_ptr<CRingItem>
 CRingItemFactory::createRingItem(const CRawRingItem& item)
 {
+    return createFromRaw(item);
+}
 
-    switch (item.type()) {
-    // State change:
-
-    case BEGIN_RUN:
-    case END_RUN:
-    case PAUSE_RUN:
-    case RESUME_RUN:
-    {
-        return item.as<CRingStateChangeItem>();
-    }
-
-        // String list.
-
-    case PACKET_TYPES:
-    case MONITORED_VARIABLES:
-        return item.as<CRingTextItem>();
-        // Scalers:
-
-    case PERIODIC_SCALERS:
-        return item.as<CRingScalerItem>();
-
-        // Physics trigger:
-
-    case PHYSICS_EVENT:
-        return item.as<CPhysicsEventItem>();
-        // trigger count.
-
-    case PHYSICS_EVENT_COUNT:
-        return item.as<CRingPhysicsEventCountItem>();
-
-    case RING_FORMAT:
-        return item.as<CDataFormatItem>();
-
-    case EVB_GLOM_INFO:
-        return item.as<CGlomParameters>();
-
-    case ABNORMAL_ENDRUN:
-        return item.as<CAbnormalEndItem>();
-
-    case COMP_BEGIN_RUN:
-    case COMP_END_RUN:
-    case COMP_PAUSE_RUN:
-    case COMP_RESUME_RUN:
-    case COMP_PACKET_TYPES:
-    case COMP_MONITORED_VARIABLES:
-    case COMP_PERIODIC_SCALERS:
-    case COMP_PHYSICS_EVENT:
-    case COMP_PHYSICS_EVENT_COUNT:
-    case COMP_ABNORMAL_ENDRUN:
-    case COMP_RING_FORMAT:
-    case COMP_EVB_GLOM_INFO:
-        return item.as<CCompositeRingItem>();
-
-    default:
-        return item.as<CRawRingItem>();
-    }
+/**
+ * Create a ring item from an expiring raw ring item
+ *
+ * @param item - the raw ring item, which is left in a valid but unspecified state
+ *
+ * The mapping is the same as for createRingItem(const CRawRingItem&). Types
+ * that store the raw body (CPhysicsEventItem and CRawRingItem) take it over
+ * instead of copying it.
+ *
+ * @return CRingItemUPtr (i.e. std::unique_ptr<CRingItem>)
+ */
+std::unique_ptr<CRingItem>
+CRingItemFactory::createRingItem(CRawRingItem&& item)
+{
+    return createFromRaw(std::move(item));
 }
 
 /**
@@ -38,6 +38,7 @@ class CRingItemFactory
 {
 public:
   static CRingItemUPtr createRingItem(const CRawRingItem& item);
+  static CRingItemUPtr createRingItem(CRawRingItem&& item);
 
   template<class ByteIterator>
   static CRingItemUPtr createRingItem(ByteIterator beg, ByteIterator end);
@@ -51,8 +52,8 @@ public:
  * \param end   points to the address immediately after valid contiguous byte data
  *
  *
- * At present, this is a bit wasteful of CPU cycles because it performs an extra copy.
- * It would be much more efficient if we constructed directly from the range.
+ * The bytes are copied once into a temporary CRawRingItem, whose body is then
+ * handed to the resulting item when it stores the body as is (e.g. physics events).
  *
  * In any case, it is expected that the range of bytes [beg, end), represent
  * a complete ring item. It is not an error for the range to be larger than the
@@ -85,7 +86,7 @@ CRingItemUPtr CRingItemFactory::createRingItem(ByteIterator beg,
                                                ByteIterator end)
 {
     CRawRingItem rawItem(beg,end);
-    return createRingItem(rawItem);
+    return createRingItem(std::move(rawItem));
 }
 
 
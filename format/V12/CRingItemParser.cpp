@@ -27,6 +27,32 @@ bool isComposite(uint32_t type) {
 }
 
 
+bool isKnownType(uint32_t type) {
+    if (type > 0xffff) {
+        return false;
+    }
+
+    switch (type & 0x7fff) {
+        case BEGIN_RUN:
+        case END_RUN:
+        case PAUSE_RUN:
+        case RESUME_RUN:
+        case ABNORMAL_ENDRUN:
+        case PACKET_TYPES:
+        case MONITORED_VARIABLES:
+        case RING_FORMAT:
+        case PERIODIC_SCALERS:
+        case PHYSICS_EVENT:
+        case PHYSICS_EVENT_COUNT:
+        case PACKED_PHYSICS_EVENT:
+        case EVB_GLOM_INFO:
+            return true;
+        default:
+            return ((type & 0x7fff) >= FIRST_USER_ITEM_CODE);
+    }
+}
+
+
 bool isTypeConsistent(CRingItem& item, uint32_t type)
 {
     if (item.isComposite()) {
@@ -42,6 +42,20 @@ namespace Parser {
 bool isComposite(uint32_t type);
 
 
+/*!
+ * \brief Checks whether a type value is one that V12 defines
+ *
+ * The composite bit is ignored. Any type at or above FIRST_USER_ITEM_CODE is
+ * a user type and is accepted.
+ *
+ * \param type  a type value (must be native byte order)
+ *
+ * \retval true  - the type is a known or user type
+ * \retval false - otherwise, including types wider than 16 bits
+ */
+bool isKnownType(uint32_t type);
+
+
 
 /*! \brief Parses raw type and checks whether it indicates need to swap
  *
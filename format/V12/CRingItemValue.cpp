@@ -0,0 +1,246 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+        Jeromy Tompkins
+         NSCL
+         Michigan State University
+         East Lansing, MI 48824-1321
+*/
+
+#include <V12/CRingItemValue.h>
+#include <V12/DataFormat.h>
+
+namespace DAQ {
+namespace V12 {
+
+namespace {
+
+// Construct a copy of the visited item in raw storage
+struct CopyInto {
+    void* m_pStorage;
+
+    template<class T> void operator()(const T& item) const {
+        new (m_pStorage) T(item);
+    }
+};
+
+// Move construct the visited item into raw storage
+struct MoveInto {
+    void* m_pStorage;
+
+    template<class T> void operator()(T& item) const {
+        new (m_pStorage) T(std::move(item));
+    }
+};
+
+struct Destroy {
+    template<class T> void operator()(T& item) const {
+        item.~T();
+    }
+};
+
+struct Upcast {
+    CRingItem& operator()(CRingItem& item) const { return item; }
+};
+
+struct ConstUpcast {
+    const CRingItem& operator()(const CRingItem& item) const { return item; }
+};
+
+// Compare with the item of the same class in another value
+struct EqualTo {
+    const CRingItemValue& m_rhs;
+
+    template<class T> bool operator()(const T& item) const {
+        return item == m_rhs.get<T>();
+    }
+};
+
+// Build the value for the class selected by the type of the raw item
+template<class RawItem>
+CRingItemValue createFromRaw(RawItem&& item)
+{
+    switch (item.type()) {
+    case BEGIN_RUN:
+    case END_RUN:
+    case PAUSE_RUN:
+    case RESUME_RUN:
+        return CRingStateChangeItem(std::forward<RawItem>(item));
+
+    case PACKET_TYPES:
+    case MONITORED_VARIABLES:
+        return CRingTextItem(std::forward<RawItem>(item));
+
+    case PERIODIC_SCALERS:
+        return CRingScalerItem(std::forward<RawItem>(item));
+
+    case PHYSICS_EVENT:
+        return CPhysicsEventItem(std::forward<RawItem>(item));
+
+    case PHYSICS_EVENT_COUNT:
+        return CRingPhysicsEventCountItem(std::forward<RawItem>(item));
+
+    case RING_FORMAT:
+        return CDataFormatItem(std::forward<RawItem>(item));
+
+    case EVB_GLOM_INFO:
+        return CGlomParameters(std::forward<RawItem>(item));
+
+    case ABNORMAL_ENDRUN:
+        return CAbnormalEndItem(std::forward<RawItem>(item));
+
+    case COMP_BEGIN_RUN:
+    case COMP_END_RUN:
+    case COMP_PAUSE_RUN:
+    case COMP_RESUME_RUN:
+    case COMP_PACKET_TYPES:
+    case COMP_MONITORED_VARIABLES:
+    case COMP_PERIODIC_SCALERS:
+    case COMP_PHYSICS_EVENT:
+    case COMP_PHYSICS_EVENT_COUNT:
+    case COMP_ABNORMAL_ENDRUN:
+    case COMP_RING_FORMAT:
+    case COMP_EVB_GLOM_INFO:
+        return CCompositeRingItem(std::forward<RawItem>(item));
+
+    default:
+        return CRawRingItem(std::forward<RawItem>(item));
+    }
+}
+
+} // end anonymous namespace
+
+
+/*!
+ * \brief Construct with an empty CRawRingItem of type UNDEFINED
+ */
+CRingItemValue::CRingItemValue()
+    : m_kind(Raw)
+{
+    new (&m_storage) CRawRingItem();
+}
+
+CRingItemValue::CRingItemValue(const CRingItemValue& rhs)
+    : m_kind(rhs.m_kind)
+{
+    rhs.visit(CopyInto{&m_storage});
+}
+
+/*!
+ * \brief Move constructor
+ *
+ * The item of rhs is moved from but rhs keeps holding an item of the same class.
+ * The item classes all have non-throwing moves, so a vector of values moves
+ * rather than copies its elements when it grows.
+ */
+CRingItemValue::CRingItemValue(CRingItemValue&& rhs) noexcept
+    : m_kind(rhs.m_kind)
+{
+    rhs.visit(MoveInto{&m_storage});
+}
+
+CRingItemValue::~CRingItemValue()
+{
+    destroy();
+}
+
+/*!
+ * \brief Assignment operator
+ *
+ * If the construction of the copy throws, this holds an empty CRawRingItem.
+ */
+CRingItemValue& CRingItemValue::operator=(const CRingItemValue& rhs)
+{
+    if (this != &rhs) {
+        destroy();
+        try {
+            rhs.visit(CopyInto{&m_storage});
+            m_kind = rhs.m_kind;
+        } catch (...) {
+            new (&m_storage) CRawRingItem();
+            m_kind = Raw;
+            throw;
+        }
+    }
+    return *this;
+}
+
+CRingItemValue& CRingItemValue::operator=(CRingItemValue&& rhs)
+{
+    if (this != &rhs) {
+        destroy();
+        try {
+            rhs.visit(MoveInto{&m_storage});
+            m_kind = rhs.m_kind;
+        } catch (...) {
+            new (&m_storage) CRawRingItem();
+            m_kind = Raw;
+            throw;
+        }
+    }
+    return *this;
+}
+
+/*!
+ * \retval true if both hold the same class and the items compare equal
+ */
+bool CRingItemValue::operator==(const CRingItemValue& rhs) const
+{
+    if (m_kind != rhs.m_kind) return false;
+
+    return visit(EqualTo{rhs});
+}
+
+bool CRingItemValue::operator!=(const CRingItemValue& rhs) const
+{
+    return !(*this == rhs);
+}
+
+/*!
+ * \brief Decode a raw ring item
+ *
+ * The class is selected by item.type() in the same way as
+ * CRingItemFactory::createRingItem().
+ */
+CRingItemValue CRingItemValue::fromRawRingItem(const CRawRingItem& item)
+{
+    return createFromRaw(item);
+}
+
+/*!
+ * \brief Decode an expiring raw ring item
+ *
+ * The body of physics events and unknown items is taken over without a copy.
+ */
+CRingItemValue CRingItemValue::fromRawRingItem(CRawRingItem&& item)
+{
+    return createFromRaw(std::move(item));
+}
+
+/*!
+ * \return the stored item through the CRingItem interface
+ */
+const CRingItem& CRingItemValue::getItem() const
+{
+    return visit(ConstUpcast());
+}
+
+CRingItem& CRingItemValue::getItem()
+{
+    return visit(Upcast());
+}
+
+void CRingItemValue::destroy()
+{
+    visit(Destroy());
+}
+
+} // end V12
+} // end DAQ
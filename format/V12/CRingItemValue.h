@@ -0,0 +1,286 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+        Jeromy Tompkins
+         NSCL
+         Michigan State University
+         East Lansing, MI 48824-1321
+*/
+
+
+#ifndef DAQ_V12_CRINGITEMVALUE_H
+#define DAQ_V12_CRINGITEMVALUE_H
+
+#include <V12/CRawRingItem.h>
+#include <V12/CPhysicsEventItem.h>
+#include <V12/CRingStateChangeItem.h>
+#include <V12/CRingTextItem.h>
+#include <V12/CRingScalerItem.h>
+#include <V12/CRingPhysicsEventCountItem.h>
+#include <V12/CDataFormatItem.h>
+#include <V12/CGlomParameters.h>
+#include <V12/CAbnormalEndItem.h>
+#include <V12/CCompositeRingItem.h>
+
+#include <new>
+#include <typeinfo>
+#include <type_traits>
+#include <utility>
+
+namespace DAQ {
+namespace V12 {
+
+/*!
+ * \brief A ring item of any V12 class, held by value
+ *
+ * A CRingItemValue stores exactly one of the V12 item classes inline, in a
+ * tagged union. Unlike a CRingItemPtr, it does not need a heap allocation of
+ * its own, so a std::vector<CRingItemValue> keeps the items contiguous.
+ *
+ * The stored item is processed with visit(), which calls the visitor with a
+ * reference to the concrete class. A visitor typically provides one
+ * operator() per class of interest and a catch-all for the rest:
+ *
+ * \code
+ * struct ScalerSum {
+ *     uint64_t operator()(const CRingScalerItem& item) const { ... }
+ *     uint64_t operator()(const CRingItem&) const { return 0; }
+ * };
+ *
+ * std::vector<CRingItemValue> items;
+ * ...
+ * for (auto& item : items) {
+ *     total += item.visit(ScalerSum());
+ * }
+ * \endcode
+ *
+ * The header accessors (type(), size(), getEventTimestamp(), getSourceId())
+ * call the implementation of the stored class directly rather than through the
+ * CRingItem vtable. Composite items are stored by value, but their children
+ * remain CRingItemPtr.
+ */
+class CRingItemValue
+{
+public:
+    //! The class of the stored item
+    enum Kind {
+        StateChange,
+        Text,
+        Scaler,
+        PhysicsEvent,
+        PhysicsEventCount,
+        DataFormat,
+        GlomParameters,
+        AbnormalEnd,
+        Composite,
+        Raw
+    };
+
+    //! Maps an item class to its Kind. Undefined for other types.
+    template<class T> struct KindOf;
+
+private:
+    union Storage {
+        CRingStateChangeItem       s_stateChange;
+        CRingTextItem              s_text;
+        CRingScalerItem            s_scaler;
+        CPhysicsEventItem          s_physicsEvent;
+        CRingPhysicsEventCountItem s_physicsEventCount;
+        CDataFormatItem            s_dataFormat;
+        CGlomParameters            s_glomParameters;
+        CAbnormalEndItem           s_abnormalEnd;
+        CCompositeRingItem         s_composite;
+        CRawRingItem               s_raw;
+
+        Storage() {}
+        ~Storage() {}
+    };
+
+    Kind    m_kind;
+    Storage m_storage;
+
+public:
+    CRingItemValue();
+
+    /*!
+     * \brief Store a copy of, or move, a V12 item
+     *
+     * Only participates for the classes listed in Kind.
+     */
+    template<class T,
+             class Item = typename std::decay<T>::type,
+             class = decltype(KindOf<Item>::value)>
+    CRingItemValue(T&& item)
+        : m_kind(KindOf<Item>::value)
+    {
+        new (&m_storage) Item(std::forward<T>(item));
+    }
+
+    CRingItemValue(const CRingItemValue& rhs);
+    CRingItemValue(CRingItemValue&& rhs) noexcept;
+    ~CRingItemValue();
+
+    CRingItemValue& operator=(const CRingItemValue& rhs);
+    CRingItemValue& operator=(CRingItemValue&& rhs);
+
+    bool operator==(const CRingItemValue& rhs) const;
+    bool operator!=(const CRingItemValue& rhs) const;
+
+    static CRingItemValue fromRawRingItem(const CRawRingItem& item);
+    static CRingItemValue fromRawRingItem(CRawRingItem&& item);
+
+    Kind kind() const { return m_kind; }
+
+    template<class T> bool is() const { return m_kind == KindOf<T>::value; }
+
+    template<class T> T&       get();
+    template<class T> const T& get() const;
+
+    template<class Visitor>
+    auto visit(Visitor&& visitor) -> decltype(visitor(std::declval<CRawRingItem&>()));
+
+    template<class Visitor>
+    auto visit(Visitor&& visitor) const -> decltype(visitor(std::declval<const CRawRingItem&>()));
+
+    const CRingItem& getItem() const;
+    CRingItem&       getItem();
+
+    uint32_t type() const;
+    uint32_t size() const;
+    uint64_t getEventTimestamp() const;
+    uint32_t getSourceId() const;
+
+private:
+    template<class T> T&       unchecked()       { return *static_cast<T*>(static_cast<void*>(&m_storage)); }
+    template<class T> const T& unchecked() const { return *static_cast<const T*>(static_cast<const void*>(&m_storage)); }
+
+    void destroy();
+};
+
+
+template<> struct CRingItemValue::KindOf<CRingStateChangeItem>       { static const Kind value = StateChange; };
+template<> struct CRingItemValue::KindOf<CRingTextItem>              { static const Kind value = Text; };
+template<> struct CRingItemValue::KindOf<CRingScalerItem>            { static const Kind value = Scaler; };
+template<> struct CRingItemValue::KindOf<CPhysicsEventItem>          { static const Kind value = PhysicsEvent; };
+template<> struct CRingItemValue::KindOf<CRingPhysicsEventCountItem> { static const Kind value = PhysicsEventCount; };
+template<> struct CRingItemValue::KindOf<CDataFormatItem>            { static const Kind value = DataFormat; };
+template<> struct CRingItemValue::KindOf<CGlomParameters>            { static const Kind value = GlomParameters; };
+template<> struct CRingItemValue::KindOf<CAbnormalEndItem>           { static const Kind value = AbnormalEnd; };
+template<> struct CRingItemValue::KindOf<CCompositeRingItem>         { static const Kind value = Composite; };
+template<> struct CRingItemValue::KindOf<CRawRingItem>               { static const Kind value = Raw; };
+
+
+/*!
+ * \brief Access the stored item as its concrete class
+ *
+ * \throws std::bad_cast if the stored item is not a T
+ */
+template<class T>
+T& CRingItemValue::get()
+{
+    if (!is<T>()) throw std::bad_cast();
+    return unchecked<T>();
+}
+
+template<class T>
+const T& CRingItemValue::get() const
+{
+    if (!is<T>()) throw std::bad_cast();
+    return unchecked<T>();
+}
+
+/*!
+ * \brief Call visitor with the stored item as its concrete class
+ *
+ * The visitor must be callable with every item class and return the same
+ * type for each of them.
+ *
+ * \return the value returned by the visitor
+ */
+template<class Visitor>
+auto CRingItemValue::visit(Visitor&& visitor) -> decltype(visitor(std::declval<CRawRingItem&>()))
+{
+    switch (m_kind) {
+    case StateChange:       return visitor(unchecked<CRingStateChangeItem>());
+    case Text:              return visitor(unchecked<CRingTextItem>());
+    case Scaler:            return visitor(unchecked<CRingScalerItem>());
+    case PhysicsEvent:      return visitor(unchecked<CPhysicsEventItem>());
+    case PhysicsEventCount: return visitor(unchecked<CRingPhysicsEventCountItem>());
+    case DataFormat:        return visitor(unchecked<CDataFormatItem>());
+    case GlomParameters:    return visitor(unchecked<CGlomParameters>());
+    case AbnormalEnd:       return visitor(unchecked<CAbnormalEndItem>());
+    case Composite:         return visitor(unchecked<CCompositeRingItem>());
+    case Raw:
+    default:                return visitor(unchecked<CRawRingItem>());
+    }
+}
+
+template<class Visitor>
+auto CRingItemValue::visit(Visitor&& visitor) const -> decltype(visitor(std::declval<const CRawRingItem&>()))
+{
+    switch (m_kind) {
+    case StateChange:       return visitor(unchecked<CRingStateChangeItem>());
+    case Text:              return visitor(unchecked<CRingTextItem>());
+    case Scaler:            return visitor(unchecked<CRingScalerItem>());
+    case PhysicsEvent:      return visitor(unchecked<CPhysicsEventItem>());
+    case PhysicsEventCount: return visitor(unchecked<CRingPhysicsEventCountItem>());
+    case DataFormat:        return visitor(unchecked<CDataFormatItem>());
+    case GlomParameters:    return visitor(unchecked<CGlomParameters>());
+    case AbnormalEnd:       return visitor(unchecked<CAbnormalEndItem>());
+    case Composite:         return visitor(unchecked<CCompositeRingItem>());
+    case Raw:
+    default:                return visitor(unchecked<CRawRingItem>());
+    }
+}
+
+
+namespace Detail {
+
+// Visitors that call the implementation of the concrete class without
+// going through the vtable
+struct TypeOf {
+    template<class T> uint32_t operator()(const T& item) const { return item.T::type(); }
+};
+struct SizeOf {
+    template<class T> uint32_t operator()(const T& item) const { return item.T::size(); }
+};
+struct TimestampOf {
+    template<class T> uint64_t operator()(const T& item) const { return item.T::getEventTimestamp(); }
+};
+struct SourceIdOf {
+    template<class T> uint32_t operator()(const T& item) const { return item.T::getSourceId(); }
+};
+
+} // end Detail
+
+inline uint32_t CRingItemValue::type() const
+{
+    return visit(Detail::TypeOf());
+}
+
+inline uint32_t CRingItemValue::size() const
+{
+    return visit(Detail::SizeOf());
+}
+
+inline uint64_t CRingItemValue::getEventTimestamp() const
+{
+    return visit(Detail::TimestampOf());
+}
+
+inline uint32_t CRingItemValue::getSourceId() const
+{
+    return visit(Detail::SourceIdOf());
+}
+
+} // end V12
+} // end DAQ
+
+#endif // DAQ_V12_CRINGITEMVALUE_H
@@ -16,7 +16,10 @@
 
 #include "V12/CRingPhysicsEventCountItem.h"
 #include <V12/CRawRingItem.h>
+#include <V12/CRingItemEncoder.h>
+#include <V12/TextFormat.h>
 #include <ContainerDeserializer.h>
+#include <ByteWriter.h>
 #include <make_unique.h>
 #include <sstream>
 #include <stdexcept>
@@ -103,6 +106,18 @@ CRingPhysicsEventCountItem::CRingPhysicsEventCountItem(
   \throw std::bad_cast if rhs is not a PHYSICS_EVENT_COUNT item.
 */
 CRingPhysicsEventCountItem::CRingPhysicsEventCountItem(const CRawRingItem& rhs)
+{
+  fromRawRingItem(rhs);
+}
+
+/*!
+  Refill the item from a raw ring item.
+
+  \param rhs - a raw PHYSICS_EVENT_COUNT item
+
+  \throws std::bad_cast if rhs is not a physics event count item
+*/
+void CRingPhysicsEventCountItem::fromRawRingItem(const CRawRingItem& rhs)
 {
   if (rhs.type() != PHYSICS_EVENT_COUNT) {
     throw bad_cast();
@@ -255,10 +270,20 @@ void CRingPhysicsEventCountItem::toRawRingItem(CRawRingItem& item) const
     auto& body = item.getBody();
     body.clear();
 
-    body << m_timeOffset;
-    body << uint32_t(m_timestamp);
-    body << m_offsetDivisor;
-    body << m_eventCount;
+    Buffer::ByteWriter writer(body, size() - 20);
+    writer << m_timeOffset;
+    writer << uint32_t(m_timestamp);
+    writer << m_offsetDivisor;
+    writer << m_eventCount;
+}
+
+uint8_t* CRingPhysicsEventCountItem::encode(uint8_t* out) const
+{
+    out = Encoder::encodeHeader(out, size(), type(), m_evtTimestamp, m_sourceId);
+    out = Encoder::put(out, m_timeOffset);
+    out = Encoder::put(out, uint32_t(m_timestamp));
+    out = Encoder::put(out, m_offsetDivisor);
+    return Encoder::put(out, m_eventCount);
 }
 
 /*!
@@ -376,9 +401,8 @@ CRingPhysicsEventCountItem::toString() const
   out.precision(1);
   out.setf(ios::fixed);
 
-  time_t time = getTimestamp();
-  string   timeString   = std::ctime(&time);
-  timeString = string(timeString.begin(), timeString.end()-1);
+  string   timeString;
+  TextFormat::appendTime(timeString, getTimestamp());
   uint32_t offset = getTimeOffset();
   uint64_t events = getEventCount();
   double elapsedTime = computeElapsedTime();
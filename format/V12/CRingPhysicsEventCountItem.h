@@ -93,6 +93,8 @@ public:
   bool isComposite() const;
 
   void toRawRingItem(CRawRingItem& item) const;
+  uint8_t* encode(uint8_t* out) const;
+  void fromRawRingItem(const CRawRingItem& rhs);
 
 
   uint32_t getTimeOffset() const;
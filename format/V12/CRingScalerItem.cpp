@@ -17,7 +17,10 @@
 #include "V12/CRingScalerItem.h"
 #include <V12/DataFormat.h>
 #include <V12/CRawRingItem.h>
+#include <V12/CRingItemEncoder.h>
+#include <V12/TextFormat.h>
 #include <ContainerDeserializer.h>
+#include <ByteWriter.h>
 
 #include <make_unique.h>
 
@@ -119,6 +122,19 @@ CRingScalerItem::CRingScalerItem(
  * \throws std::runtime_error if isIncremental field is neither 0 or 1
  */
 CRingScalerItem::CRingScalerItem(const CRawRingItem& rhs)
+{
+  fromRawRingItem(rhs);
+}
+
+/*!
+  Refill the item from a raw ring item. The capacity of the scaler vector is
+  reused.
+
+  \param rhs - a raw PERIODIC_SCALERS item
+
+  \throws std::bad_cast if rhs is not a scaler item
+*/
+void CRingScalerItem::fromRawRingItem(const CRawRingItem& rhs)
 {
   if (rhs.type() != PERIODIC_SCALERS) {
     throw std::bad_cast();
@@ -144,12 +160,10 @@ CRingScalerItem::CRingScalerItem(const CRawRingItem& rhs)
   }
   rhsBody >> m_scalerWidth;
 
-  m_scalers.reserve(scalerCount);
-  for (int i=0; i<scalerCount; ++i) {
-    rhsBody >> temp;
-    m_scalers.push_back(temp);
+  m_scalers.resize(scalerCount);
+  for (auto& scaler : m_scalers) {
+    rhsBody >> scaler;
   }
-  
 }
 
 /*!
@@ -270,18 +284,25 @@ void CRingScalerItem::toRawRingItem(DAQ::V12::CRawRingItem& item) const
   item.setMustSwap(mustSwap());
 
   auto& body = item.getBody();
-     
   body.clear();
-  body << m_intervalStartOffset;
-  body << m_intervalEndOffset;
-  body << m_timestamp;
-  body << m_intervalDivisor;
-  body << uint32_t(m_scalers.size());
-  body << (m_isIncremental ? uint32_t(1) : uint32_t(0));
-  body << m_scalerWidth;
-  for (auto& scaler : m_scalers) {
-    body << scaler;
-  }
+
+  Buffer::ByteWriter writer(body, bodySize());
+  writer << m_intervalStartOffset;
+  writer << m_intervalEndOffset;
+  writer << m_timestamp;
+  writer << m_intervalDivisor;
+  writer << uint32_t(m_scalers.size());
+  writer << (m_isIncremental ? uint32_t(1) : uint32_t(0));
+  writer << m_scalerWidth;
+  writer << m_scalers;
+}
+
+uint8_t* CRingScalerItem::encode(uint8_t* out) const
+{
+  return Encoder::encodeScalerItem(out, m_evtTimestamp, m_sourceId,
+                                   m_intervalStartOffset, m_intervalEndOffset,
+                                   m_timestamp, m_intervalDivisor, m_isIncremental,
+                                   m_scalerWidth, m_scalers.data(), m_scalers.size());
 }
 
 
@@ -516,14 +537,14 @@ CRingScalerItem::toString() const
 
   float end   = computeEndTime();
   float start = computeStartTime();
-  time_t rawTime(getTimestamp());
-  string   time  = std::ctime(&rawTime);
-  vector<uint32_t> scalers = getScalers();
+  string time;
+  TextFormat::appendTime(time, getTimestamp());
+  const vector<uint32_t>& scalers = m_scalers;
 
   float   duration = end - start;
 
   out << headerToString(*this);
-  out << "Unix Tstamp  : " << time;
+  out << "Unix Tstamp  : " << time << std::endl;
   out << "Start Offset : " << start << " seconds" << std::endl;
   out << "End Offset   : " << end << " seconds" << std::endl;
   out << "Incremental? : " << (isIncremental() ? "Yes" : "No") << std::endl;
@@ -82,10 +82,12 @@ public:
 
   CRingScalerItem(const CRawRingItem& rhs);
   CRingScalerItem(const CRingScalerItem& rhs) = default;
+  CRingScalerItem(CRingScalerItem&& rhs) = default;
   
   virtual ~CRingScalerItem();
 
   CRingScalerItem& operator=(const CRingScalerItem& rhs) = default;
+  CRingScalerItem& operator=(CRingScalerItem&& rhs) = default;
   virtual bool operator==(const CRingItem& rhs) const;
   virtual bool operator!=(const CRingItem& rhs) const;
 
@@ -100,6 +102,8 @@ public:
   bool      isComposite() const;
   bool      mustSwap() const;
   void      toRawRingItem(CRawRingItem& item) const;
+  uint8_t*  encode(uint8_t* out) const;
+  void      fromRawRingItem(const CRawRingItem& rhs);
 
   void     setStartTime(uint32_t startTime);
   uint32_t getStartTime() const;
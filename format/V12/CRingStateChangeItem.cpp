@@ -17,10 +17,15 @@
 
 #include "V12/CRingStateChangeItem.h"
 #include <V12/CRawRingItem.h>
+#include <V12/CRingItemEncoder.h>
+#include <V12/TextFormat.h>
 #include <ContainerDeserializer.h>
+#include <ByteWriter.h>
 #include <make_unique.h>
 #include <sstream>
 #include <ctime>
+#include <cstring>
+#include <algorithm>
 
 using namespace std;
 
@@ -116,7 +121,18 @@ CRingStateChangeItem::CRingStateChangeItem(
 */
 CRingStateChangeItem::CRingStateChangeItem(const CRawRingItem& rhs)
 {
+  fromRawRingItem(rhs);
+}
+
+/*!
+  Refill the item from a raw ring item. The capacity of the title is reused.
 
+  \param rhs - a raw state change item
+
+  \throws std::bad_cast if rhs is not a state change item
+*/
+void CRingStateChangeItem::fromRawRingItem(const CRawRingItem& rhs)
+{
   if (rhs.type() != V12::BEGIN_RUN &&
           rhs.type() != V12::END_RUN &&
           rhs.type() != V12::PAUSE_RUN &&
@@ -137,10 +153,8 @@ CRingStateChangeItem::CRingStateChangeItem(const CRawRingItem& rhs)
   rhsBody >> m_offsetDivisor;
   rhsBody >> titleLength;
 
-  char * pTitle = new char[titleLength];
-  rhsBody.extract(pTitle, pTitle + titleLength);
-  m_title = std::string(pTitle, pTitle+titleLength);
-  delete [] pTitle;
+  m_title.resize(titleLength);
+  rhsBody.extract(&m_title[0], &m_title[0] + titleLength);
 }
 
 /*! Destruction */
@@ -256,15 +270,27 @@ void CRingStateChangeItem::toRawRingItem(CRawRingItem& item) const
     Buffer::ByteBuffer& body = item.getBody();
     body.clear();
 
-    body << m_runNumber;
-    body << m_timeOffset;
-    body << uint32_t(m_timestamp);
-    body << m_offsetDivisor;
-    body << uint32_t(m_title.size());
-    body.insert(body.end(), m_title.begin(), m_title.end());
+    Buffer::ByteWriter writer(body, size() - 20);
+    writer << m_runNumber;
+    writer << m_timeOffset;
+    writer << uint32_t(m_timestamp);
+    writer << m_offsetDivisor;
+    writer << uint32_t(m_title.size());
+    writer << m_title;
 
 }
 
+uint8_t* CRingStateChangeItem::encode(uint8_t* out) const
+{
+    out = Encoder::encodeHeader(out, size(), type(), m_evtTimestamp, m_sourceId);
+    out = Encoder::put(out, m_runNumber);
+    out = Encoder::put(out, m_timeOffset);
+    out = Encoder::put(out, uint32_t(m_timestamp));
+    out = Encoder::put(out, m_offsetDivisor);
+    out = Encoder::put(out, uint32_t(m_title.size()));
+    return std::copy(m_title.begin(), m_title.end(), out);
+}
+
 
 
 /*!
@@ -406,24 +432,30 @@ CRingStateChangeItem::typeName() const
 std::string
 CRingStateChangeItem::toString() const
 {
-  std::ostringstream out;		//  Build up via outputting to this psuedo stream.
-  out.precision(1);
-  out.setf(std::ios::fixed);
-
-  uint32_t run       = getRunNumber();
-  uint32_t elapsed   = getElapsedTime();
-  string   title     = getTitle();
-  time_t   wall_time = getTimestamp();
-  string   timestamp = std::ctime(&wall_time);
-  timestamp = std::string(timestamp.begin(), timestamp.end()-1);
-
-  out << headerToString(*this);
-  out << "Run Number   : " << run << endl;
-  out << "Unix Tstamp  : " << timestamp << endl;
-  out << "Elapsed Time : " << computeElapsedTime() << " seconds" << std::endl;
-  out << "Title        : " << title << std::endl;
-
-  return out.str();
+  std::string out;
+  appendString(out);
+  return out;
+}
+/**
+ * appendString
+ *
+ * Appends the same text that toString returns to an existing string.
+ *
+ * @param out - the string to append to.
+ */
+void
+CRingStateChangeItem::appendString(std::string& out) const
+{
+  appendHeaderString(out, *this);
+  out += "Run Number   : ";
+  TextFormat::appendDecimal(out, m_runNumber);
+  out += "\nUnix Tstamp  : ";
+  TextFormat::appendTime(out, getTimestamp());
+  out += "\nElapsed Time : ";
+  TextFormat::appendFixed(out, computeElapsedTime(), 1);
+  out += " seconds\nTitle        : ";
+  out += m_title;
+  out += '\n';
 }
 
 
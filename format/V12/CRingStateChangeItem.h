@@ -78,9 +78,11 @@ public:
 
   CRingStateChangeItem(const CRawRingItem& item);
   CRingStateChangeItem(const CRingStateChangeItem& rhs) = default;
+  CRingStateChangeItem(CRingStateChangeItem&& rhs) = default;
   virtual ~CRingStateChangeItem();
 
   CRingStateChangeItem& operator=(const CRingStateChangeItem& rhs) = default;
+  CRingStateChangeItem& operator=(CRingStateChangeItem&& rhs) = default;
 
   virtual uint32_t type() const;
   virtual void setType(uint32_t type);
@@ -98,6 +100,8 @@ public:
   virtual bool mustSwap() const;
 
   virtual void toRawRingItem(CRawRingItem& item) const;
+  virtual uint8_t* encode(uint8_t* out) const;
+  void fromRawRingItem(const CRawRingItem& rhs);
 
   virtual bool operator==(const CRingItem& rhs) const;
   virtual bool operator!=(const CRingItem& rhs) const;
@@ -122,6 +126,7 @@ public:
 
   virtual std::string typeName() const;
   virtual std::string toString() const;
+  virtual void appendString(std::string& out) const;
 
   virtual CRingItemUPtr clone() const;
 
@@ -17,7 +17,10 @@
 
 #include "V12/CRingTextItem.h"
 #include <V12/CRawRingItem.h>
+#include <V12/CRingItemEncoder.h>
+#include <V12/TextFormat.h>
 #include <ContainerDeserializer.h>
+#include <ByteWriter.h>
 #include <make_unique.h>
 #include <sstream>
 #include <ctime>
@@ -106,12 +109,26 @@ CRingTextItem::CRingTextItem(
    
    \throw bad_cast - if rhs is not a text ring item.
 
-   It will parse the body until all of the strings have been found or
-   until the body is fully parsed.
+   It will parse the body until the number of strings recorded in the body
+   have been found or until the body is fully parsed.
 */
 CRingTextItem::CRingTextItem(const CRawRingItem& rhs)
 {
-  if (!validType(rhs)) throw bad_cast();
+  fromRawRingItem(rhs);
+}
+
+/*!
+  Refill the item from a raw ring item. The strings already held are
+  overwritten so that their capacity is reused.
+
+  \param rhs - a raw PACKET_TYPES or MONITORED_VARIABLES item
+
+  \throws std::bad_cast if rhs is not a text item
+  \throws std::runtime_error if the body is too short for a text item
+*/
+void CRingTextItem::fromRawRingItem(const CRawRingItem& rhs)
+{
+  CStringTable table = getStringTable(rhs);
 
   m_type = rhs.type();
   m_sourceId     = rhs.getSourceId();
@@ -126,19 +143,16 @@ CRingTextItem::CRingTextItem(const CRawRingItem& rhs)
   rhsBody >> stringCount;
   rhsBody >> m_offsetDivisor;
 
-  m_strings.reserve(stringCount);
-
-  auto iter = rhsBody.pos();
-  auto next = iter;
-  while (iter != body.end()) {
-    next = std::find(iter, body.end(), '\0');
-
-    if (next != body.end()) {
-        m_strings.emplace_back(iter, next);
-        next++;
-        iter = next;
+  size_t nStrings = 0;
+  for (auto& str : table) {
+    if (nStrings < m_strings.size()) {
+        m_strings[nStrings].assign(str.begin(), str.end());
+    } else {
+        m_strings.emplace_back(str.begin(), str.end());
     }
+    ++nStrings;
   }
+  m_strings.resize(nStrings);
 }
 
 /*! Destructor */
@@ -162,6 +176,7 @@ CRingTextItem::operator==(const CRingItem& rhs) const
     if (m_sourceId != rhs.getSourceId()) return false;
 
     const auto pItem = dynamic_cast<const CRingTextItem*>(&rhs);
+    if (!pItem) return false;
     if (m_type != pItem->type()) return false;
     if (m_timeOffset != pItem->getTimeOffset()) return false;
     if (m_offsetDivisor != pItem->getTimeDivisor()) return false;
@@ -287,25 +302,40 @@ void CRingTextItem::toRawRingItem(CRawRingItem& buffer) const
     // clear the body
     auto& body = buffer.getBody();
     body.clear();
-    body.reserve(size());
 
-    body << m_timeOffset;
-    body << uint32_t(m_timestamp);
-    body << uint32_t(m_strings.size());
-    body << m_offsetDivisor;
+    Buffer::ByteWriter writer(body, size() - 20);
+    writer << m_timeOffset;
+    writer << uint32_t(m_timestamp);
+    writer << uint32_t(m_strings.size());
+    writer << m_offsetDivisor;
 
     for (auto& s : m_strings) {
-        body.insert(body.end(), s.begin(), s.end());
-        body.push_back(0); // null terminate
+        writer << s;
+        writer << char(0); // null terminate
     }
 }
 
+uint8_t* CRingTextItem::encode(uint8_t* out) const
+{
+    out = Encoder::encodeHeader(out, size(), m_type, m_evtTimestamp, m_sourceId);
+    out = Encoder::put(out, m_timeOffset);
+    out = Encoder::put(out, uint32_t(m_timestamp));
+    out = Encoder::put(out, uint32_t(m_strings.size()));
+    out = Encoder::put(out, m_offsetDivisor);
+
+    for (auto& s : m_strings) {
+        out = std::copy(s.begin(), s.end(), out);
+        *out++ = 0; // null terminate
+    }
+    return out;
+}
+
 
 /*!
     \return vector<string>
     \retval The strings that were put in the item unpacked into elements of the vector.
 */
-vector<string>
+const vector<string>&
 CRingTextItem::getStrings() const
 {
    return m_strings;
@@ -321,6 +351,38 @@ uint32_t
 CRingTextItem::getStringCount() const {
     return m_strings.size();
 }
+
+/*!
+   View the strings of a raw text item without decoding it
+
+   \param item - a raw PACKET_TYPES or MONITORED_VARIABLES item
+
+   \return a table that references the body of item. At most the string count
+           recorded in the body is produced and the table never extends past
+           the end of the body.
+
+   \throws std::bad_cast if item is not a text item
+   \throws std::runtime_error if the body is too short for a text item
+*/
+CStringTable
+CRingTextItem::getStringTable(const CRawRingItem& item)
+{
+    if (item.type() != PACKET_TYPES && item.type() != MONITORED_VARIABLES) {
+        throw std::bad_cast();
+    }
+
+    auto& body = item.getBody();
+    const size_t fixedSize = 4*sizeof(uint32_t);
+    if (body.size() < fixedSize) {
+        throw std::runtime_error("V12::CRingTextItem body is too short for a text item");
+    }
+
+    Buffer::ContainerDeserializer<Buffer::ByteBuffer> stream(body, item.mustSwap());
+    uint32_t skip, stringCount;
+    stream >> skip >> skip >> stringCount;
+
+    return CStringTable(body.data() + fixedSize, body.data() + body.size(), stringCount);
+}
 /*!
    Modify the buffered value of the run time offset.  This may be done if you use the
    simplified constuctor and only later figure out what the run time offset actually is.
@@ -424,24 +486,34 @@ CRingTextItem::typeName() const
 std::string
 CRingTextItem::toString() const
 {
-  std::ostringstream out;
-  out.precision(1);
-  out.setf(std::ios::fixed);
-
-  uint32_t elapsed  = getTimeOffset();
-  time_t time = getTimestamp();
-  string   timeString = std::ctime(&time);
-  vector<string> strings = getStrings();
-
-  out << headerToString(*this);
-  out << "Elapsed Time : " << computeElapsedTime() << " seconds" << std::endl;
-  out << "Unix Tstamp  : " << timeString;
-  out << "# of Strings : " << m_strings.size() << std::endl;
-  for (int i = 0; i < strings.size(); i++) {
-    out << i << ": \"" << strings[i] << "\"" << endl;
+  std::string out;
+  appendString(out);
+  return out;
+}
+/**
+ * appendString
+ *
+ * Appends the same text that toString returns to an existing string.
+ *
+ * @param out - the string to append to.
+ */
+void
+CRingTextItem::appendString(std::string& out) const
+{
+  appendHeaderString(out, *this);
+  out += "Elapsed Time : ";
+  TextFormat::appendFixed(out, computeElapsedTime(), 1);
+  out += " seconds\nUnix Tstamp  : ";
+  TextFormat::appendTime(out, getTimestamp());
+  out += "\n# of Strings : ";
+  TextFormat::appendDecimal(out, m_strings.size());
+  out += '\n';
+  for (size_t i = 0; i < m_strings.size(); i++) {
+    TextFormat::appendDecimal(out, i);
+    out += ": \"";
+    out += m_strings[i];
+    out += "\"\n";
   }
-
-  return out.str();
 }
 
 
@@ -19,6 +19,7 @@
 
 #include "V12/CRingItem.h"
 #include "V12/DataFormat.h"
+#include "V12/CStringTable.h"
 
 #include <ctime>
 #include <string>
@@ -64,7 +65,9 @@ public:
   );
   CRingTextItem(const CRawRingItem& rhs);
   CRingTextItem(const CRingTextItem& rhs) = default;
+  CRingTextItem(CRingTextItem&& rhs) = default;
   CRingTextItem& operator=(const CRingTextItem& rhs) = default;
+  CRingTextItem& operator=(CRingTextItem&& rhs) = default;
 
   virtual ~CRingTextItem();
 
@@ -88,12 +91,16 @@ public:
   bool isComposite() const;
   bool mustSwap() const;
   void toRawRingItem(CRawRingItem& buffer) const;
+  uint8_t* encode(uint8_t* out) const;
+  void fromRawRingItem(const CRawRingItem& rhs);
 
 
-  std::vector<std::string>  getStrings() const;
+  const std::vector<std::string>& getStrings() const;
   std::vector<std::string>& getStrings();
   uint32_t getStringCount() const;
 
+  static CStringTable getStringTable(const CRawRingItem& item);
+
   void     setTimeOffset(uint32_t offset);
   uint32_t getTimeOffset() const;
   float    computeElapsedTime() const;
@@ -106,6 +113,7 @@ public:
 
   virtual std::string typeName() const;
   virtual std::string toString() const;
+  virtual void appendString(std::string& out) const;
 
   virtual CRingItemUPtr clone() const;
 
@@ -0,0 +1,187 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#ifndef DAQ_V12_CSTRINGTABLE_H
+#define DAQ_V12_CSTRINGTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <ostream>
+#include <string>
+
+namespace DAQ {
+namespace V12 {
+
+/*!
+ * \brief A non-owning reference to a sequence of characters
+ *
+ * The characters are not necessarily null terminated. The referenced memory
+ * must outlive the StringRef.
+ */
+class StringRef
+{
+private:
+    const char*  m_data;
+    std::size_t  m_size;
+
+public:
+    StringRef() : m_data(""), m_size(0) {}
+    StringRef(const char* data, std::size_t size) : m_data(data), m_size(size) {}
+    StringRef(const std::string& str) : m_data(str.data()), m_size(str.size()) {}
+
+    const char* data() const  { return m_data; }
+    std::size_t size() const  { return m_size; }
+    bool        empty() const { return m_size == 0; }
+
+    const char* begin() const { return m_data; }
+    const char* end() const   { return m_data + m_size; }
+
+    std::string str() const { return std::string(m_data, m_size); }
+};
+
+inline bool operator==(const StringRef& lhs, const StringRef& rhs)
+{
+    return lhs.size() == rhs.size()
+            && std::memcmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+inline bool operator!=(const StringRef& lhs, const StringRef& rhs)
+{
+    return !(lhs == rhs);
+}
+
+inline std::ostream& operator<<(std::ostream& stream, const StringRef& str)
+{
+    return stream.write(str.data(), str.size());
+}
+
+
+/*!
+ * \brief A view of a table of null terminated strings, e.g. a text item body
+ *
+ * The table is decoded lazily while iterating and without any allocation.
+ * Decoding is bounded both by the expected number of strings and by the end
+ * of the range:
+ *
+ *  - no more than count strings are produced, even if the range holds more.
+ *  - iteration stops at the end of the range, even if fewer than count
+ *    strings were found.
+ *  - a last string that is not null terminated extends to the end of
+ *    the range.
+ *
+ * \code
+ * CStringTable table = CRingTextItem::getStringTable(rawItem);
+ * for (StringRef str : table) {
+ *     std::cout << str << std::endl;
+ * }
+ * \endcode
+ *
+ * The table references the memory of the range, which must outlive it.
+ */
+class CStringTable
+{
+public:
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = StringRef;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const StringRef*;
+        using reference         = const StringRef&;
+
+    private:
+        const char*   m_next;       // first character after the current string
+        const char*   m_end;
+        std::uint32_t m_remaining;  // strings left to decode after the current one
+        bool          m_atEnd;
+        StringRef     m_current;
+
+    public:
+        const_iterator()
+            : m_next(nullptr), m_end(nullptr), m_remaining(0), m_atEnd(true), m_current() {}
+
+        const_iterator(const char* beg, const char* end, std::uint32_t count)
+            : m_next(beg), m_end(end), m_remaining(count), m_atEnd(false), m_current()
+        {
+            advance();
+        }
+
+        const StringRef& operator*() const  { return m_current; }
+        const StringRef* operator->() const { return &m_current; }
+
+        const_iterator& operator++() { advance(); return *this; }
+        const_iterator operator++(int) { const_iterator old(*this); advance(); return old; }
+
+        bool operator==(const const_iterator& rhs) const {
+            return (m_atEnd == rhs.m_atEnd) && (m_atEnd || m_next == rhs.m_next);
+        }
+        bool operator!=(const const_iterator& rhs) const { return !(*this == rhs); }
+
+    private:
+        void advance() {
+            if (m_remaining == 0 || m_next == m_end) {
+                m_atEnd = true;
+                return;
+            }
+
+            auto pNull = static_cast<const char*>(std::memchr(m_next, '\0', m_end - m_next));
+            if (pNull) {
+                m_current = StringRef(m_next, pNull - m_next);
+                m_next    = pNull + 1;
+            } else {
+                m_current = StringRef(m_next, m_end - m_next);
+                m_next    = m_end;
+            }
+            --m_remaining;
+        }
+    };
+
+    using iterator = const_iterator;
+
+private:
+    const char*   m_beg;
+    const char*   m_end;
+    std::uint32_t m_count;
+
+public:
+    CStringTable() : m_beg(nullptr), m_end(nullptr), m_count(0) {}
+
+    /*!
+     * \param beg    first byte of the table
+     * \param end    end of the memory the table may occupy
+     * \param count  expected number of strings
+     */
+    CStringTable(const void* beg, const void* end, std::uint32_t count)
+        : m_beg(static_cast<const char*>(beg)), m_end(static_cast<const char*>(end)),
+          m_count(count) {}
+
+    const_iterator begin() const { return const_iterator(m_beg, m_end, m_count); }
+    const_iterator end() const   { return const_iterator(); }
+
+    /*! \return the expected number of strings */
+    std::uint32_t getExpectedCount() const { return m_count; }
+
+    /*! \return the number of strings actually present. This walks the table. */
+    std::size_t size() const { return std::distance(begin(), end()); }
+};
+
+} // end V12
+} // end DAQ
+
+#endif // DAQ_V12_CSTRINGTABLE_H
@@ -134,6 +134,12 @@ static const uint32_t COMP_PHYSICS_EVENT        = 0x801e;
 static const uint32_t PHYSICS_EVENT_COUNT       = 0x001f;
 static const uint32_t COMP_PHYSICS_EVENT_COUNT  = 0x801f;
 
+/* A physics event whose body is packed by CBodyCodec. Readers without the codec
+   pass it through as a CRawRingItem. It is outside the user range so that no
+   converted user item can take its type. */
+
+static const uint32_t PACKED_PHYSICS_EVENT      = 0x0020;
+
 
 /* Event builder related items: */
 
@@ -0,0 +1,165 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include "V12/TextFormat.h"
+
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <time.h>
+
+namespace DAQ {
+namespace V12 {
+namespace TextFormat {
+
+static const char sDecimalPairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+static const char sHexDigits[] = "0123456789abcdef";
+
+//
+void appendDecimal(std::string& out, std::uint64_t value)
+{
+    char digits[20];
+    char* pos = digits + sizeof(digits);
+
+    while (value >= 100) {
+        unsigned pair = (value % 100) * 2;
+        value /= 100;
+        *--pos = sDecimalPairs[pair+1];
+        *--pos = sDecimalPairs[pair];
+    }
+    if (value >= 10) {
+        unsigned pair = value * 2;
+        *--pos = sDecimalPairs[pair+1];
+        *--pos = sDecimalPairs[pair];
+    } else {
+        *--pos = char('0' + value);
+    }
+
+    out.append(pos, digits + sizeof(digits));
+}
+
+//
+void appendHex(std::string& out, std::uint64_t value, unsigned width)
+{
+    char digits[16];
+    char* pos = digits + sizeof(digits);
+
+    do {
+        *--pos = sHexDigits[value & 0xf];
+        value >>= 4;
+    } while (value != 0);
+
+    unsigned nDigits = digits + sizeof(digits) - pos;
+    if (width > nDigits) {
+        out.append(width - nDigits, '0');
+    }
+    out.append(pos, nDigits);
+}
+
+//
+void appendFixed(std::string& out, double value, int precision)
+{
+    char buffer[64];
+    int n = std::snprintf(buffer, sizeof(buffer), "%.*f", precision, value);
+    if (n < 0) {
+        return;
+    }
+
+    std::size_t start = out.size();
+    if (std::size_t(n) < sizeof(buffer)) {
+        out.append(buffer, n);
+    } else {
+        // huge values... format directly into the output
+        out.resize(start + n + 1);
+        std::snprintf(&out[start], n + 1, "%.*f", precision, value);
+        out.resize(start + n);
+    }
+
+    // snprintf honors LC_NUMERIC, the classic locale always uses '.'. Only the
+    // decimal point of the locale is replaced; inf and nan do not have one.
+    const char* point = std::localeconv()->decimal_point;
+    std::size_t pointSize = std::strlen(point);
+    if (std::isfinite(value) && (pointSize != 1 || point[0] != '.')) {
+        std::size_t pos = out.find(point, start, pointSize);
+        if (pos != std::string::npos) {
+            out.replace(pos, pointSize, 1, '.');
+        }
+    }
+}
+
+//
+void appendHexWords(std::string& out, const std::uint8_t* beg, const std::uint8_t* end)
+{
+    // 5 characters per word plus a newline for every 8 words
+    std::size_t nBytes = end - beg;
+    out.reserve(out.size() + (nBytes/2)*5 + nBytes/16 + 4);
+
+    int i = 0;
+    while (end - beg >= 2) {
+        if ((i%8) == 0 && i != 0) {
+            out += '\n';
+        }
+
+        std::uint8_t byte0 = *beg++;
+        std::uint8_t byte1 = *beg++;
+        char word[5] = { sHexDigits[byte1 >> 4], sHexDigits[byte1 & 0xf],
+                         sHexDigits[byte0 >> 4], sHexDigits[byte0 & 0xf],
+                         ' ' };
+        out.append(word, sizeof(word));
+        ++i;
+    }
+
+    if (beg != end) {
+        // odd number of bytes. This only happens at the end, so
+        // there is no line ending to worry about
+        char byte[3] = { sHexDigits[*beg >> 4], sHexDigits[*beg & 0xf], ' ' };
+        out.append(byte, sizeof(byte));
+    }
+
+    out += '\n';
+}
+
+//
+void appendTime(std::string& out, std::time_t time)
+{
+    char buffer[32];    // ctime_r needs 26 characters
+    if (ctime_r(&time, buffer) == nullptr) {
+        appendDecimal(out, std::uint64_t(time));
+        return;
+    }
+
+    std::size_t length = std::strlen(buffer);
+    if (length > 0 && buffer[length-1] == '\n') {
+        --length;
+    }
+    out.append(buffer, length);
+}
+
+} // end TextFormat namespace
+} // end V12 namespace
+} // end DAQ namespace
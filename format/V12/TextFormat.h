@@ -0,0 +1,82 @@
+#ifndef DAQ_V12_TEXTFORMAT_H
+#define DAQ_V12_TEXTFORMAT_H
+
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+namespace DAQ {
+namespace V12 {
+
+/*!
+ * \brief Low level helpers for building textual dumps of ring items
+ *
+ * These append to a caller supplied string rather than returning a new one.
+ * A dumper that clears and reuses the same string for every item therefore
+ * reaches a steady state in which no allocation is performed. The integer
+ * conversions are table driven and independent of the locale. The output is
+ * identical to what an std::ostringstream imbued with the classic locale
+ * produces for the same values.
+ */
+namespace TextFormat {
+
+/*! \brief Append an unsigned integer in decimal */
+void appendDecimal(std::string& out, std::uint64_t value);
+
+/*!
+ * \brief Append an unsigned integer in lower case hexadecimal
+ *
+ * \param out    the string to append to
+ * \param value  the value to format
+ * \param width  minimum number of digits, the value is zero padded to this
+ */
+void appendHex(std::string& out, std::uint64_t value, unsigned width = 0);
+
+/*!
+ * \brief Append a floating point value in fixed notation
+ *
+ * This is equivalent to streaming with std::fixed and
+ * std::setprecision(precision). The decimal point is always a '.'.
+ */
+void appendFixed(std::string& out, double value, int precision);
+
+/*!
+ * \brief Append a block of bytes as 16-bit hexadecimal words
+ *
+ * Words are assembled little endian from pairs of bytes and printed
+ * with 4 digits, 8 words per line. A trailing odd byte is printed with 2 digits.
+ * The output is terminated by a newline.
+ */
+void appendHexWords(std::string& out, const std::uint8_t* beg, const std::uint8_t* end);
+
+/*!
+ * \brief Append a wall clock time in the format of std::ctime()
+ *
+ * Unlike std::ctime(), this is reentrant, so items can be formatted in
+ * several threads at once. The trailing newline of std::ctime() is not
+ * appended. A time that ctime cannot represent is printed as the number of
+ * seconds.
+ */
+void appendTime(std::string& out, std::time_t time);
+
+} // end TextFormat namespace
+} // end V12 namespace
+} // end DAQ namespace
+
+#endif
@@ -0,0 +1,304 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+             NSCL
+             Michigan State University
+             East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "Asserts.h"
+
+#include <V12/CBodyCodec.h>
+#include <V12/CCodecRingItemFactory.h>
+#include <V12/CRingItemFactory.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CPhysicsEventItem.h>
+#include <V12/CRingStateChangeItem.h>
+#include <V12/DataFormat.h>
+#include <ByteBuffer.h>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+
+using namespace std;
+using namespace DAQ;
+using namespace DAQ::V12;
+
+class BodyCodecTests : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(BodyCodecTests);
+  CPPUNIT_TEST(frameOfReference_0);
+  CPPUNIT_TEST(delta_0);
+  CPPUNIT_TEST(stored_0);
+  CPPUNIT_TEST(sizes_0);
+  CPPUNIT_TEST(extremes_0);
+  CPPUNIT_TEST(malformed_0);
+  CPPUNIT_TEST(malformed_1);
+  CPPUNIT_TEST(pack_0);
+  CPPUNIT_TEST(pack_1);
+  CPPUNIT_TEST(pack_2);
+  CPPUNIT_TEST(factory_0);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {}
+  void tearDown() {}
+
+  template<class Word>
+  Buffer::ByteBuffer toBody(const vector<Word>& words) {
+    Buffer::ByteBuffer body(words.size()*sizeof(Word));
+    if (!words.empty()) {
+      memcpy(body.data(), words.data(), body.size());
+    }
+    return body;
+  }
+
+  Buffer::ByteBuffer roundTrip(const Buffer::ByteBuffer& body, CBodyCodec::Method& method) {
+    Buffer::ByteBuffer encoded, decoded;
+    CBodyCodec::encode(body, encoded);
+    method = CBodyCodec::getMethod(encoded);
+    CBodyCodec::decode(encoded, decoded);
+    ASSERTMSG("never larger than stored", encoded.size() <= body.size() + 12);
+    return decoded;
+  }
+
+  void frameOfReference_0() {
+    // 12-bit adc values on a pedestal
+    mt19937 engine(1);
+    uniform_int_distribution<int> adc(0, 4095);
+    vector<uint16_t> words;
+    for (int i=0; i<1000; ++i) {
+      words.push_back(uint16_t(0x8000 + adc(engine)));
+    }
+    Buffer::ByteBuffer body = toBody(words), encoded;
+    CBodyCodec::encode(body, encoded);
+    EQMSG("method", CBodyCodec::FrameOfReference, CBodyCodec::getMethod(encoded));
+    EQMSG("size", size_t(12 + 1000*12/8), encoded.size());
+
+    Buffer::ByteBuffer decoded;
+    CBodyCodec::decode(encoded, decoded);
+    ASSERTMSG("round trip", body == decoded);
+  }
+
+  void delta_0() {
+    // slowly increasing 32-bit counters
+    vector<uint32_t> words;
+    uint32_t value = 0xfffff000;
+    for (int i=0; i<500; ++i) {
+      words.push_back(value);
+      value += 3 + i % 5;     // wraps around
+    }
+    CBodyCodec::Method method;
+    Buffer::ByteBuffer body = toBody(words);
+    ASSERTMSG("round trip", body == roundTrip(body, method));
+    EQMSG("method", CBodyCodec::Delta, method);
+  }
+
+  void stored_0() {
+    mt19937 engine(2);
+    Buffer::ByteBuffer body(777);
+    for (auto& byte : body) {
+      byte = uint8_t(engine());
+    }
+    CBodyCodec::Method method;
+    ASSERTMSG("round trip", body == roundTrip(body, method));
+    EQMSG("method", CBodyCodec::Stored, method);
+  }
+
+  void sizes_0() {
+    // every size, including bodies with bytes after the last whole word
+    for (size_t size=0; size<40; ++size) {
+      Buffer::ByteBuffer body(size);
+      for (size_t i=0; i<size; ++i) {
+        body[i] = uint8_t(i % 3);
+      }
+      CBodyCodec::Method method;
+      EQMSG("round trip", body, roundTrip(body, method));
+    }
+
+    // a constant body packs into no bits at all
+    Buffer::ByteBuffer body = toBody(vector<uint32_t>(100, 0xdeadbeef)), encoded;
+    CBodyCodec::encode(body, encoded);
+    EQMSG("constant", size_t(12), encoded.size());
+    Buffer::ByteBuffer decoded;
+    CBodyCodec::decode(encoded, decoded);
+    ASSERTMSG("constant round trip", body == decoded);
+  }
+
+  void extremes_0() {
+    // differences that need every bit of the word, plus the zigzag bit
+    vector<uint16_t> shorts;
+    vector<uint32_t> longs;
+    for (int i=0; i<64; ++i) {
+      shorts.push_back((i % 2) ? 0xffff : 0);
+      longs.push_back((i % 3) ? 0xffffffff : 0);
+    }
+    CBodyCodec::Method method;
+    ASSERTMSG("16 bits", toBody(shorts) == roundTrip(toBody(shorts), method));
+    ASSERTMSG("32 bits", toBody(longs) == roundTrip(toBody(longs), method));
+  }
+
+  void malformed_0() {
+    Buffer::ByteBuffer body = toBody(vector<uint16_t>({1, 2, 3, 4, 5, 6, 7, 8}));
+    Buffer::ByteBuffer encoded, decoded;
+    CBodyCodec::encode(body, encoded);
+
+    Buffer::ByteBuffer shortHeader({1, 2, 3});
+    CPPUNIT_ASSERT_THROW_MESSAGE("short header",
+                                 CBodyCodec::decode(shortHeader, decoded),
+                                 std::runtime_error);
+
+    Buffer::ByteBuffer truncated(encoded.begin(), encoded.end() - 1);
+    CPPUNIT_ASSERT_THROW_MESSAGE("truncated",
+                                 CBodyCodec::decode(truncated, decoded),
+                                 std::runtime_error);
+
+    Buffer::ByteBuffer badMethod = encoded;
+    badMethod[0] = 9;
+    CPPUNIT_ASSERT_THROW_MESSAGE("method",
+                                 CBodyCodec::decode(badMethod, decoded),
+                                 std::runtime_error);
+
+    Buffer::ByteBuffer badWordSize = encoded;
+    badWordSize[1] = 3;
+    CPPUNIT_ASSERT_THROW_MESSAGE("word size",
+                                 CBodyCodec::decode(badWordSize, decoded),
+                                 std::runtime_error);
+
+    Buffer::ByteBuffer badWidth = encoded;
+    badWidth[2] = 40;
+    CPPUNIT_ASSERT_THROW_MESSAGE("bit width",
+                                 CBodyCodec::decode(badWidth, decoded),
+                                 std::runtime_error);
+  }
+
+  // a frame of reference header for nWords words of wordSize bytes
+  Buffer::ByteBuffer makeHeader(uint8_t wordSize, uint8_t bitWidth, uint32_t nWords) {
+    Buffer::ByteBuffer encoded(12, 0);
+    encoded[0] = CBodyCodec::FrameOfReference;
+    encoded[1] = wordSize;
+    encoded[2] = bitWidth;
+    memcpy(encoded.data() + 4, &nWords, sizeof(nWords));
+    return encoded;
+  }
+
+  void malformed_1() {
+    Buffer::ByteBuffer decoded;
+
+    // a bit width of 0 packs any number of words into nothing
+    Buffer::ByteBuffer constant = makeHeader(4, 0, 1000);
+    CBodyCodec::decode(constant, decoded);
+    EQMSG("constant body", size_t(4000), decoded.size());
+
+    CPPUNIT_ASSERT_THROW_MESSAGE("body too large for an item",
+                                 CBodyCodec::decode(makeHeader(4, 0, 0xffffffff), decoded),
+                                 std::runtime_error);
+    CPPUNIT_ASSERT_THROW_MESSAGE("just too large",
+                                 CBodyCodec::decode(makeHeader(2, 0, 0x7ffffff6), decoded),
+                                 std::runtime_error);
+
+    Buffer::ByteBuffer extra = constant;
+    extra.push_back(0);
+    CPPUNIT_ASSERT_THROW_MESSAGE("packed data for a width of 0",
+                                 CBodyCodec::decode(extra, decoded),
+                                 std::runtime_error);
+
+    Buffer::ByteBuffer shortPacking = makeHeader(2, 3, 8);
+    shortPacking.resize(12 + 2);
+    CPPUNIT_ASSERT_THROW_MESSAGE("packed size does not match the width",
+                                 CBodyCodec::decode(shortPacking, decoded),
+                                 std::runtime_error);
+  }
+
+  void pack_0() {
+    vector<uint16_t> words;
+    for (int i=0; i<200; ++i) {
+      words.push_back(uint16_t(100 + i % 17));
+    }
+    CPhysicsEventItem event(0x123456789aULL, 7, toBody(words));
+
+    CRawRingItem packed = CBodyCodec::pack(CRawRingItem(event));
+    EQMSG("type", PACKED_PHYSICS_EVENT, packed.type());
+    EQMSG("stamp", uint64_t(0x123456789aULL), packed.getEventTimestamp());
+    EQMSG("source", uint32_t(7), packed.getSourceId());
+    ASSERTMSG("smaller", packed.size() < CRawRingItem(event).size());
+
+    CPhysicsEventItem unpacked = CBodyCodec::unpack(packed);
+    EQMSG("unpacked type", PHYSICS_EVENT, unpacked.type());
+    EQMSG("unpacked stamp", uint64_t(0x123456789aULL), unpacked.getEventTimestamp());
+    EQMSG("unpacked source", uint32_t(7), unpacked.getSourceId());
+    ASSERTMSG("unpacked body", event.getBody() == unpacked.getBody());
+  }
+
+  void pack_1() {
+    CPPUNIT_ASSERT_THROW_MESSAGE("not a physics event",
+                                 CBodyCodec::pack(CRawRingItem(CRingStateChangeItem(BEGIN_RUN))),
+                                 std::invalid_argument);
+    CPPUNIT_ASSERT_THROW_MESSAGE("not packed",
+                                 CBodyCodec::unpack(CRawRingItem(CPhysicsEventItem(1, 2))),
+                                 std::invalid_argument);
+
+    CRawRingItem packed = CBodyCodec::pack(CRawRingItem(CPhysicsEventItem(1, 2)));
+    packed.setMustSwap(true);
+    CPPUNIT_ASSERT_THROW_MESSAGE("other byte order",
+                                 CBodyCodec::unpack(packed),
+                                 std::runtime_error);
+  }
+
+  void pack_2() {
+    // an event in the other byte order round trips, and the packed item is native
+    vector<uint32_t> words;
+    for (uint32_t i=0; i<100; ++i) {
+      words.push_back(0x01000000*(i % 5) + 3);   // small values, byte swapped
+    }
+    CRawRingItem event(CPhysicsEventItem(99, 4, toBody(words)));
+    event.setMustSwap(true);
+
+    CRawRingItem packed = CBodyCodec::pack(event);
+    ASSERTMSG("packed is native", !packed.mustSwap());
+    ASSERTMSG("foreign body recorded", CBodyCodec::isForeignOrder(packed.getBody()));
+
+    CPhysicsEventItem unpacked = CBodyCodec::unpack(packed);
+    ASSERTMSG("unpacked must swap", unpacked.mustSwap());
+    EQMSG("unpacked stamp", uint64_t(99), unpacked.getEventTimestamp());
+    ASSERTMSG("unpacked body", event.getBody() == unpacked.getBody());
+
+    CRawRingItem nativePacked = CBodyCodec::pack(CRawRingItem(CPhysicsEventItem(1, 2, toBody(words))));
+    ASSERTMSG("native body", !CBodyCodec::isForeignOrder(nativePacked.getBody()));
+    ASSERTMSG("native unpacked", !CBodyCodec::unpack(nativePacked).mustSwap());
+  }
+
+  void factory_0() {
+    CPhysicsEventItem event(42, 1, toBody(vector<uint32_t>({10, 11, 12, 14, 13})));
+    CRawRingItem packed = CBodyCodec::pack(CRawRingItem(event));
+
+    // readers without the codec pass the item through
+    CRingItemUPtr pRaw = CRingItemFactory::createRingItem(packed);
+    EQMSG("legacy type", PACKED_PHYSICS_EVENT, pRaw->type());
+    ASSERTMSG("legacy not decoded", dynamic_cast<CPhysicsEventItem*>(pRaw.get()) == nullptr);
+
+    CRingItemUPtr pItem = CCodecRingItemFactory::createRingItem(packed);
+    auto pEvent = dynamic_cast<CPhysicsEventItem*>(pItem.get());
+    ASSERTMSG("decoded", pEvent != nullptr);
+    EQMSG("stamp", uint64_t(42), pEvent->getEventTimestamp());
+    ASSERTMSG("body", event.getBody() == pEvent->getBody());
+
+    pItem = CCodecRingItemFactory::createRingItem(CRawRingItem(CRingStateChangeItem(END_RUN)));
+    ASSERTMSG("other items", dynamic_cast<CRingStateChangeItem*>(pItem.get()) != nullptr);
+
+    pItem = CCodecRingItemFactory::createRingItem(std::move(packed));
+    ASSERTMSG("decoded from rvalue", dynamic_cast<CPhysicsEventItem*>(pItem.get()) != nullptr);
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BodyCodecTests);
@@ -0,0 +1,179 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+         NSCL
+         Michigan State University
+         East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "Asserts.h"
+
+#include <V12/CRingItemEncoder.h>
+#include <V12/DataFormat.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CPhysicsEventItem.h>
+#include <V12/CRingScalerItem.h>
+#include <V12/CRingTextItem.h>
+#include <V12/CRingStateChangeItem.h>
+#include <V12/CRingPhysicsEventCountItem.h>
+#include <V12/CDataFormatItem.h>
+#include <V12/CAbnormalEndItem.h>
+#include <V12/CGlomParameters.h>
+#include <V12/CCompositeRingItem.h>
+#include <ByteBuffer.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace DAQ;
+using namespace DAQ::V12;
+
+class EncoderTests : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(EncoderTests);
+  CPPUNIT_TEST(leaf_0);
+  CPPUNIT_TEST(composite_0);
+  CPPUNIT_TEST(composite_1);
+  CPPUNIT_TEST(refill_0);
+  CPPUNIT_TEST(span_0);
+  CPPUNIT_TEST(arena_0);
+  CPPUNIT_TEST(scaler_0);
+  CPPUNIT_TEST(item_0);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {}
+  void tearDown() {}
+
+  // the wire format produced by the toRawRingItem() path
+  Buffer::ByteBuffer reference(const CRingItem& item) {
+      CRawRingItem raw(item);
+      Buffer::ByteBuffer result(20);
+      serializeHeader(raw, result.begin());
+      result.insert(result.end(), raw.getBody().begin(), raw.getBody().end());
+      return result;
+  }
+
+  Buffer::ByteBuffer encoded(const CRingItem& item) {
+      Buffer::ByteBuffer result(item.size());
+      uint8_t* end = item.encode(result.data());
+      EQMSG(item.typeName() + " writes size() bytes",
+            ptrdiff_t(item.size()), end - result.data());
+      return result;
+  }
+
+  vector<CRingItemPtr> leafItems() {
+      return {
+          CRingItemPtr(new CPhysicsEventItem(12, 3, {0, 1, 2, 3, 4})),
+          CRingItemPtr(new CRingScalerItem(45, 2, 10, 20, 1234, {1, 2, 3}, 2, false, 24)),
+          CRingItemPtr(new CRingTextItem(MONITORED_VARIABLES, 4, 5, {"a", "", "bcd"}, 6, 7, 8)),
+          CRingItemPtr(new CRingStateChangeItem(8, 9, BEGIN_RUN, 10, 11, 12, "a title", 13)),
+          CRingItemPtr(new CRingPhysicsEventCountItem(14, 15, 16, 17, 18, 19)),
+          CRingItemPtr(new CDataFormatItem(20, 21, 12, 0)),
+          CRingItemPtr(new CAbnormalEndItem),
+          CRingItemPtr(new CGlomParameters(22, 23, 24, true, CGlomParameters::average))
+      };
+  }
+
+  void leaf_0() {
+      for (auto& pItem : leafItems()) {
+          ASSERTMSG(pItem->typeName(), reference(*pItem) == encoded(*pItem));
+      }
+  }
+
+  void composite_0() {
+      CCompositeRingItem item(COMP_PHYSICS_EVENT, 1, 2);
+      item.appendChild(CRingItemPtr(new CPhysicsEventItem(3, 4, {5, 6})));
+      item.appendChild(CRingItemPtr(new CPhysicsEventItem(12, 13, {14, 15, 16})));
+
+      auto child = std::make_shared<CCompositeRingItem>(COMP_PHYSICS_EVENT, 7, 8);
+      child->appendChild(CRingItemPtr(new CPhysicsEventItem(9, 10, {11})));
+      item.appendChild(child);
+
+      auto bytes = encoded(item);
+      ASSERTMSG("composite", reference(item) == bytes);
+
+      CRawRingItem raw(bytes);
+      ASSERTMSG("round trip", item == CCompositeRingItem(raw));
+  }
+
+  void composite_1() {
+      CCompositeRingItem item(COMP_PHYSICS_EVENT, 1, 2);
+      item.appendChild(CRingItemPtr(new CPhysicsEventItem(3, 4, {5, 6})));
+
+      CRawRingItem raw;
+      item.toRawRingItem(raw);
+      item.toRawRingItem(raw);
+      EQMSG("refilling a raw item replaces the body", item.size(), raw.size());
+  }
+
+  void refill_0() {
+      // serializing twice into a raw item that holds a stale body
+      for (auto& pItem : leafItems()) {
+          CRawRingItem raw(PHYSICS_EVENT, 1, 2, Buffer::ByteBuffer(100, 0xff));
+          pItem->toRawRingItem(raw);
+          pItem->toRawRingItem(raw);
+          ASSERTMSG(pItem->typeName(), CRawRingItem(*pItem) == raw);
+      }
+  }
+
+  void span_0() {
+      CRingScalerItem item(45, 2, 10, 20, 1234, {1, 2, 3});
+      Buffer::ByteBuffer buffer(item.size() - 1);
+      CPPUNIT_ASSERT_THROW_MESSAGE("range too small",
+                                   Encoder::encode(item, buffer.data(), buffer.data() + buffer.size()),
+                                   std::runtime_error);
+
+      buffer.resize(item.size() + 4);
+      auto end = Encoder::encode(item, buffer.data(), buffer.data() + buffer.size());
+      EQMSG("end", buffer.data() + item.size(), end);
+  }
+
+  void arena_0() {
+      CPhysicsEventItem event(1, 2, {3, 4, 5});
+      CRingStateChangeItem begin(8, 9, BEGIN_RUN, 10, 11, 12, "a title", 13);
+
+      Buffer::ByteBuffer arena;
+      Encoder::encode(begin, arena);
+      Encoder::encode(event, arena);
+
+      Buffer::ByteBuffer expected = reference(begin);
+      auto second = reference(event);
+      expected.insert(expected.end(), second.begin(), second.end());
+      ASSERTMSG("items are appended", expected == arena);
+  }
+
+  void scaler_0() {
+      vector<uint32_t> scalers = {7, 8, 9, 10};
+      CRingScalerItem item(45, 2, 10, 20, 1234, scalers, 3, true, 32);
+
+      Buffer::ByteBuffer buffer(Encoder::scalerItemSize(scalers.size()));
+      EQMSG("size", item.size(), uint32_t(buffer.size()));
+
+      Encoder::encodeScalerItem(buffer.data(), 45, 2, 10, 20, 1234, 3, true, 32,
+                                scalers.data(), scalers.size());
+      ASSERTMSG("scaler", reference(item) == buffer);
+  }
+
+  void item_0() {
+      Buffer::ByteBuffer body = {1, 2, 3, 4, 5};
+      Buffer::ByteBuffer buffer(25);
+      auto end = Encoder::encodeItem(buffer.data(), PHYSICS_EVENT, 6, 7,
+                                     body.data(), body.data() + body.size());
+      EQMSG("end", buffer.data() + buffer.size(), end);
+      ASSERTMSG("re-tagged body",
+                reference(CPhysicsEventItem(6, 7, body)) == buffer);
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(EncoderTests);
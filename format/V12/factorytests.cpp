@@ -39,6 +39,7 @@ class RingFactoryTests : public CppUnit::TestFixture
     CPPUNIT_TEST(textTs_0);
     CPPUNIT_TEST(scalerTs_0);
     CPPUNIT_TEST(physicsTs_0);
+    CPPUNIT_TEST(physicsMove_0);
 //    CPPUNIT_TEST(triggersTs_0);
     CPPUNIT_TEST(glom_0);           // Never has a timetamp.
     CPPUNIT_TEST_SUITE_END();
@@ -58,6 +59,7 @@ protected:
     void scalerTs_0();
     
     void physicsTs_0();
+    void physicsMove_0();
     
 //    void triggersTs_0();
 
@@ -131,6 +133,20 @@ RingFactoryTests::physicsTs_0()
                                     dynamic_cast<V12::CPhysicsEventItem&>(*pBaseItem));
 }
 
+// An expiring raw physics event hands its body to the new item
+void
+RingFactoryTests::physicsMove_0()
+{
+    CRawRingItem rawItem(CPhysicsEventItem(123, 345, {1,2,3,4,5}));
+    const uint8_t* pBody = rawItem.getBody().data();
+
+    std::unique_ptr<CRingItem> pBaseItem  = CRingItemFactory::createRingItem(std::move(rawItem));
+
+    auto& item = dynamic_cast<V12::CPhysicsEventItem&>(*pBaseItem);
+    EQMSG("body is not copied", pBody, (const uint8_t*)item.getBody().data());
+    ASSERTMSG("content", CPhysicsEventItem(123, 345, {1,2,3,4,5}) == item);
+}
+
 /**
  * glom
  *
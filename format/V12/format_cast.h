@@ -14,7 +14,29 @@ T format_cast(const CRingItem& item) {
     return T(rawItem);
 }
 
-template<> CRawRingItem format_cast(const CRingItem& item) {
+template<> inline CRawRingItem format_cast(const CRingItem& item) {
+    CRawRingItem rawItem;
+    item.toRawRingItem(rawItem);
+    return rawItem;
+}
+
+/*!
+ * \brief Convert an expiring item
+ *
+ * The raw body is moved into the result when T can construct from a
+ * CRawRingItem&&, e.g. format_cast<CPhysicsEventItem>(std::move(rawItem)).
+ */
+template<class T>
+T format_cast(CRingItem&& item) {
+    auto& rawItem = dynamic_cast<CRawRingItem&>(item);
+    return T(std::move(rawItem));
+}
+
+template<> inline CRawRingItem format_cast(CRingItem&& item) {
+    if (auto pRawItem = dynamic_cast<CRawRingItem*>(&item)) {
+        return CRawRingItem(std::move(*pRawItem));
+    }
+
     CRawRingItem rawItem;
     item.toRawRingItem(rawItem);
     return rawItem;
@@ -11,6 +11,7 @@
 #include "V12/format_cast.h"
 #include "V12/CRawRingItem.h"
 #include "V12/CDataFormatItem.h"
+#include "V12/CPhysicsEventItem.h"
 #include "ByteBuffer.h"
 #include "ContainerDeserializer.h"
 
@@ -27,6 +28,8 @@ class format_castTests : public CppUnit::TestFixture
     CPPUNIT_TEST_SUITE(format_castTests);
     CPPUNIT_TEST(toRawRingItem_0);
     CPPUNIT_TEST(fromRawRingItem_0);
+    CPPUNIT_TEST(fromRawRingItem_1);
+    CPPUNIT_TEST(toRawRingItem_1);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -73,6 +76,29 @@ protected:
       EQMSG("minor", uint16_t(0), item.getMinor());
   }
 
+  void fromRawRingItem_1()
+  {
+      V12::CRawRingItem rawItem(PHYSICS_EVENT, 1, 2, {3, 4, 5});
+      auto pBody = rawItem.getBody().data();
+
+      auto item = V12::format_cast<V12::CPhysicsEventItem>(std::move(rawItem));
+
+      EQMSG("body is moved", pBody, item.getBody().data());
+      EQMSG("body size", size_t(3), item.getBody().size());
+  }
+
+  void toRawRingItem_1()
+  {
+      V12::CPhysicsEventItem item(1, 2, {3, 4, 5});
+      auto pBody = item.getBody().data();
+
+      auto rawItem = V12::format_cast<V12::CRawRingItem>(std::move(item));
+
+      EQMSG("body is moved", pBody, rawItem.getBody().data());
+      EQMSG("type", PHYSICS_EVENT, rawItem.type());
+      EQMSG("tstamp", uint64_t(1), rawItem.getEventTimestamp());
+  }
+
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(format_castTests);
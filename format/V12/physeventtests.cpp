@@ -19,6 +19,9 @@ class physeventtests : public CppUnit::TestFixture {
   CPPUNIT_TEST( ringitemassign_0 );
   CPPUNIT_TEST( badcast );
   CPPUNIT_TEST( setType_0);
+  CPPUNIT_TEST( move_0 );
+  CPPUNIT_TEST( move_1 );
+  CPPUNIT_TEST( move_2 );
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -33,6 +36,9 @@ protected:
   void comparison_1();
   void ringitemassign_0();
   void setType_0();
+  void move_0();
+  void move_1();
+  void move_2();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(physeventtests);
@@ -101,3 +107,35 @@ void physeventtests::setType_0() {
                                  item.setType(V12::UNDEFINED),
                                  std::invalid_argument);
 }
+
+// constructing from an expiring raw item takes over the body
+void physeventtests::move_0()
+{
+  V12::CRawRingItem item(V12::PHYSICS_EVENT, 1, 2, {0, 1, 2, 3});
+  const uint8_t* pBody = item.getBody().data();
+
+  V12::CPhysicsEventItem phys_item(std::move(item));
+  EQMSG("body is not copied", pBody, (const uint8_t*)phys_item.getBody().data());
+  EQMSG("body size", size_t(4), phys_item.getBody().size());
+  EQMSG("tstamp", uint64_t(1), phys_item.getEventTimestamp());
+  EQMSG("source id", uint32_t(2), phys_item.getSourceId());
+}
+
+// as<T>() on an rvalue takes over the body
+void physeventtests::move_1()
+{
+  V12::CRawRingItem item(V12::PHYSICS_EVENT, 1, 2, {0, 1, 2, 3});
+  const uint8_t* pBody = item.getBody().data();
+
+  auto pItem = std::move(item).as<V12::CPhysicsEventItem>();
+  EQMSG("body is not copied", pBody, (const uint8_t*)pItem->getBody().data());
+}
+
+// a failed conversion leaves the source intact
+void physeventtests::move_2()
+{
+  V12::CRawRingItem item(V12::PHYSICS_EVENT_COUNT, 1, 2, {0, 1, 2, 3});
+
+  CPPUNIT_ASSERT_THROW( V12::CPhysicsEventItem(std::move(item)), std::bad_cast );
+  EQMSG("body is kept", size_t(4), item.getBody().size());
+}
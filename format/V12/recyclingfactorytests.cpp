@@ -0,0 +1,170 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+         NSCL
+         Michigan State University
+         East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "Asserts.h"
+
+#include <V12/CRecyclingRingItemFactory.h>
+#include <V12/CRingItemFactory.h>
+#include <V12/DataFormat.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CPhysicsEventItem.h>
+#include <V12/CRingScalerItem.h>
+#include <V12/CRingTextItem.h>
+#include <V12/CRingStateChangeItem.h>
+#include <V12/CCompositeRingItem.h>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace DAQ;
+using namespace DAQ::V12;
+
+class RecyclingFactoryTests : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RecyclingFactoryTests);
+  CPPUNIT_TEST(reuse_0);
+  CPPUNIT_TEST(reuse_1);
+  CPPUNIT_TEST(slots_0);
+  CPPUNIT_TEST(content_0);
+  CPPUNIT_TEST(maxPooled_0);
+  CPPUNIT_TEST(outlive_0);
+  CPPUNIT_TEST(exception_0);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {}
+  void tearDown() {}
+
+  void reuse_0() {
+      CRecyclingRingItemFactory factory;
+      CRawRingItem first(CPhysicsEventItem(1, 2, {0, 1, 2, 3, 4, 5, 6, 7}));
+      CRawRingItem second(CPhysicsEventItem(3, 4, {8, 9}));
+
+      auto pItem = factory.createRingItem(first);
+      CRingItem* pAddress = pItem.get();
+      const uint8_t* pBody = dynamic_cast<CRawRingItem&>(*pItem).getBody().data();
+      pItem.reset();
+      EQMSG("released item is pooled", size_t(1), factory.getPooledCount());
+
+      pItem = factory.createRingItem(second);
+      EQMSG("same object", pAddress, pItem.get());
+      EQMSG("same body storage", pBody,
+            (const uint8_t*)dynamic_cast<CRawRingItem&>(*pItem).getBody().data());
+      EQMSG("pool is empty while item is in use", size_t(0), factory.getPooledCount());
+      ASSERTMSG("refilled", CPhysicsEventItem(3, 4, {8, 9}) == *pItem);
+  }
+
+  void reuse_1() {
+      CRecyclingRingItemFactory factory;
+      CRawRingItem first(CRingScalerItem(1, 2, 3, 4, 5, {6, 7, 8}));
+      CRawRingItem second(CRingScalerItem(9, 10, 11, 12, 13, {14}, 2, false, 24));
+
+      auto pItem = factory.createRingItem(first);
+      CRingItem* pAddress = pItem.get();
+      pItem.reset();
+
+      pItem = factory.createRingItem(second);
+      EQMSG("same object", pAddress, pItem.get());
+      ASSERTMSG("refilled",
+                CRingScalerItem(9, 10, 11, 12, 13, {14}, 2, false, 24) == *pItem);
+  }
+
+  void slots_0() {
+      CRecyclingRingItemFactory factory;
+      CRawRingItem event(CPhysicsEventItem(1, 2, {3}));
+      CRawRingItem text(CRingTextItem(MONITORED_VARIABLES, {"a", "b"}));
+
+      auto pEvent = factory.createRingItem(event);
+      CRingItem* pAddress = pEvent.get();
+      pEvent.reset();
+
+      auto pText = factory.createRingItem(text);
+      ASSERTMSG("text does not reuse the event", pAddress != pText.get());
+      EQMSG("type", MONITORED_VARIABLES, pText->type());
+      ASSERTMSG("class", dynamic_cast<CRingTextItem*>(pText.get()) != nullptr);
+  }
+
+  void content_0() {
+      CCompositeRingItem composite(COMP_PHYSICS_EVENT, 1, 2);
+      composite.appendChild(CRingItemPtr(new CPhysicsEventItem(3, 4, {5, 6})));
+
+      vector<CRawRingItem> raws = {
+          CRawRingItem(CRingStateChangeItem(8, 9, BEGIN_RUN, 10, 11, 12, "a title", 13)),
+          CRawRingItem(CRingTextItem(PACKET_TYPES, {"abc", "de"})),
+          CRawRingItem(CRingScalerItem(1, 2, 3, 4, 5, {6, 7, 8})),
+          CRawRingItem(CPhysicsEventItem(1, 2, {3, 4})),
+          CRawRingItem(composite),
+          CRawRingItem(UNDEFINED, 1, 2, {3, 4, 5})
+      };
+
+      CRecyclingRingItemFactory factory;
+      for (int pass=0; pass<2; ++pass) {
+          for (auto& raw : raws) {
+              auto pItem = factory.createRingItem(raw);
+              auto pExpected = CRingItemFactory::createRingItem(raw);
+              EQMSG("type name", pExpected->typeName(), pItem->typeName());
+              ASSERTMSG(pExpected->typeName(), *pExpected == *pItem);
+          }
+      }
+      EQMSG("one item per class", raws.size(), factory.getPooledCount());
+  }
+
+  void maxPooled_0() {
+      CRecyclingRingItemFactory factory(1);
+      CRawRingItem event(CPhysicsEventItem(1, 2, {3}));
+
+      auto pFirst = factory.createRingItem(event);
+      auto pSecond = factory.createRingItem(event);
+      pFirst.reset();
+      pSecond.reset();
+      EQMSG("limited", size_t(1), factory.getPooledCount());
+
+      factory.setMaxPooled(0);
+      EQMSG("trimmed", size_t(0), factory.getPooledCount());
+  }
+
+  void outlive_0() {
+      CRecyclingRingItemFactory::ItemPtr pItem;
+      {
+          CRecyclingRingItemFactory factory;
+          pItem = factory.createRingItem(CRawRingItem(CPhysicsEventItem(1, 2, {3})));
+      }
+      EQMSG("item is usable", PHYSICS_EVENT, pItem->type());
+      pItem.reset();
+  }
+
+  void exception_0() {
+      CRecyclingRingItemFactory factory;
+      CRawRingItem good(CRingScalerItem(1, 2, 3, 4, 5, {6, 7, 8}));
+      CRawRingItem bad(good);
+      uint32_t incremental = 2;
+      memcpy(bad.getBody().data() + 5*sizeof(uint32_t), &incremental, sizeof(incremental));
+
+      factory.createRingItem(good).reset();
+      CPPUNIT_ASSERT_THROW_MESSAGE("bad incremental flag",
+                                   factory.createRingItem(bad),
+                                   std::runtime_error);
+      EQMSG("item stays pooled", size_t(1), factory.getPooledCount());
+
+      ASSERTMSG("recovers",
+                CRingScalerItem(1, 2, 3, 4, 5, {6, 7, 8}) == *factory.createRingItem(good));
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RecyclingFactoryTests);
@@ -0,0 +1,199 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+         NSCL
+         Michigan State University
+         East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "Asserts.h"
+
+#include <V12/CRingItemValue.h>
+#include <V12/CRingItemFactory.h>
+#include <V12/DataFormat.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+using namespace std;
+using namespace DAQ;
+using namespace DAQ::V12;
+
+namespace {
+
+// counts scalers and reports everything else as not a scaler
+struct ScalerCount {
+    size_t operator()(const CRingScalerItem& item) const { return item.getScalerCount(); }
+    size_t operator()(const CRingItem&) const { return 0; }
+};
+
+struct TypeNameOf {
+    template<class T> string operator()(const T& item) const { return item.typeName(); }
+};
+
+struct SetSourceId {
+    template<class T> void operator()(T& item) const { item.setSourceId(99); }
+};
+
+}
+
+class RingItemValueTests : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RingItemValueTests);
+  CPPUNIT_TEST(default_0);
+  CPPUNIT_TEST(construct_0);
+  CPPUNIT_TEST(header_0);
+  CPPUNIT_TEST(visit_0);
+  CPPUNIT_TEST(visit_1);
+  CPPUNIT_TEST(get_0);
+  CPPUNIT_TEST(copy_0);
+  CPPUNIT_TEST(assign_0);
+  CPPUNIT_TEST(fromRaw_0);
+  CPPUNIT_TEST(fromRaw_1);
+  CPPUNIT_TEST(vector_0);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {}
+  void tearDown() {}
+
+  void default_0() {
+      CRingItemValue value;
+      EQMSG("kind", CRingItemValue::Raw, value.kind());
+      EQMSG("type", UNDEFINED, value.type());
+      EQMSG("size", uint32_t(20), value.size());
+  }
+
+  void construct_0() {
+      CRingItemValue value(CRingScalerItem(1, 2, 3, 4, 5, {6, 7}));
+      EQMSG("kind", CRingItemValue::Scaler, value.kind());
+      ASSERTMSG("is scaler", value.is<CRingScalerItem>());
+      ASSERTMSG("is not text", !value.is<CRingTextItem>());
+  }
+
+  void header_0() {
+      CRingScalerItem scaler(1, 2, 3, 4, 5, {6, 7});
+      CRingItemValue value(scaler);
+      EQMSG("type", scaler.type(), value.type());
+      EQMSG("size", scaler.size(), value.size());
+      EQMSG("tstamp", scaler.getEventTimestamp(), value.getEventTimestamp());
+      EQMSG("source id", scaler.getSourceId(), value.getSourceId());
+
+      CPhysicsEventItem event(10, 11, {1, 2, 3});
+      CRingItemValue eventValue(event);
+      EQMSG("event type", PHYSICS_EVENT, eventValue.type());
+      EQMSG("event size", event.size(), eventValue.size());
+      EQMSG("event tstamp", uint64_t(10), eventValue.getEventTimestamp());
+      EQMSG("event source id", uint32_t(11), eventValue.getSourceId());
+  }
+
+  void visit_0() {
+      CRingItemValue scaler(CRingScalerItem(1, 2, 3, 4, 5, {6, 7, 8}));
+      CRingItemValue text(CRingTextItem(PACKET_TYPES, {"a"}));
+
+      EQMSG("scaler overload", size_t(3), scaler.visit(ScalerCount()));
+      EQMSG("catch-all overload", size_t(0), text.visit(ScalerCount()));
+      EQMSG("typeName", text.getItem().typeName(), text.visit(TypeNameOf()));
+  }
+
+  void visit_1() {
+      CRingItemValue value{CRingStateChangeItem(BEGIN_RUN)};
+      value.visit(SetSourceId());
+      EQMSG("modified in place", uint32_t(99), value.getSourceId());
+  }
+
+  void get_0() {
+      CRingItemValue value(CRingTextItem(PACKET_TYPES, {"a", "b"}));
+      EQMSG("get", size_t(2), value.get<CRingTextItem>().getStrings().size());
+      CPPUNIT_ASSERT_THROW_MESSAGE("wrong class", value.get<CRingScalerItem>(),
+                                   std::bad_cast);
+  }
+
+  void copy_0() {
+      CRingItemValue value(CRingTextItem(PACKET_TYPES, {"a", "b"}));
+      CRingItemValue copy(value);
+      ASSERTMSG("copy", value == copy);
+
+      copy.get<CRingTextItem>().setSourceId(3);
+      ASSERTMSG("copy is independent", value != copy);
+
+      CRingItemValue moved(std::move(copy));
+      EQMSG("moved", uint32_t(3), moved.getSourceId());
+  }
+
+  void assign_0() {
+      CRingItemValue value(CRingTextItem(PACKET_TYPES, {"a", "b"}));
+      CRingItemValue other(CPhysicsEventItem(1, 2, {3}));
+
+      value = other;
+      EQMSG("class changes", CRingItemValue::PhysicsEvent, value.kind());
+      ASSERTMSG("content", value == other);
+
+      value = CRingItemValue(CRingScalerItem(2));
+      EQMSG("move assigned", CRingItemValue::Scaler, value.kind());
+  }
+
+  void fromRaw_0() {
+      CCompositeRingItem composite(COMP_PHYSICS_EVENT, 1, 2);
+      composite.appendChild(CRingItemPtr(new CPhysicsEventItem(3, 4, {5, 6})));
+
+      vector<CRawRingItem> raws = {
+          CRawRingItem(CRingStateChangeItem(8, 9, BEGIN_RUN, 10, 11, 12, "a title", 13)),
+          CRawRingItem(CRingTextItem(PACKET_TYPES, {"abc", "de"})),
+          CRawRingItem(CRingScalerItem(1, 2, 3, 4, 5, {6, 7, 8})),
+          CRawRingItem(CPhysicsEventItem(1, 2, {3, 4})),
+          CRawRingItem(CRingPhysicsEventCountItem(14, 15, 16, 17, 18, 19)),
+          CRawRingItem(CDataFormatItem(20, 21, 12, 0)),
+          CRawRingItem(CGlomParameters(22, 23, 24, true, CGlomParameters::average)),
+          CRawRingItem(CAbnormalEndItem()),
+          CRawRingItem(composite),
+          CRawRingItem(UNDEFINED, 1, 2, {3, 4, 5})
+      };
+
+      for (auto& raw : raws) {
+          auto value = CRingItemValue::fromRawRingItem(raw);
+          auto pExpected = CRingItemFactory::createRingItem(raw);
+          EQMSG("type name", pExpected->typeName(), value.getItem().typeName());
+          ASSERTMSG(pExpected->typeName(), *pExpected == value.getItem());
+      }
+  }
+
+  void fromRaw_1() {
+      CRawRingItem raw(PHYSICS_EVENT, 1, 2, {3, 4, 5});
+      const uint8_t* pBody = raw.getBody().data();
+
+      auto value = CRingItemValue::fromRawRingItem(std::move(raw));
+      EQMSG("body is not copied", pBody,
+            (const uint8_t*)value.get<CPhysicsEventItem>().getBody().data());
+  }
+
+  void vector_0() {
+      vector<CRingItemValue> items;
+      for (uint32_t i=0; i<10; ++i) {
+          items.push_back(CRingScalerItem(i, 0, 0, 0, 0, {i, i+1}));
+          items.push_back(CPhysicsEventItem(i, 0, {uint8_t(i)}));
+      }
+
+      size_t nScalers = 0;
+      uint64_t tstampSum = 0;
+      for (auto& item : items) {
+          nScalers  += item.visit(ScalerCount());
+          tstampSum += item.getEventTimestamp();
+      }
+      EQMSG("scalers", size_t(20), nScalers);
+      EQMSG("timestamps", uint64_t(90), tstampSum);
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RingItemValueTests);
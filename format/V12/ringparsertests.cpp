@@ -34,6 +34,7 @@ class CRingItemParserTests : public CppUnit::TestFixture
     CPPUNIT_TEST(parseSwapped_0);
     CPPUNIT_TEST(parseSizeAndType_0);
     CPPUNIT_TEST(parseHeader_0);
+    CPPUNIT_TEST(isKnownType_0);
     CPPUNIT_TEST_SUITE_END();
 private:
 
@@ -213,6 +214,17 @@ protected:
       EQMSG("swap", false, swapNeeded);
   }
 
+  void isKnownType_0() {
+      EQMSG("physics event", true, Parser::isKnownType(PHYSICS_EVENT));
+      EQMSG("composite", true, Parser::isKnownType(COMP_PERIODIC_SCALERS));
+      EQMSG("packed physics event", true, Parser::isKnownType(PACKED_PHYSICS_EVENT));
+      EQMSG("user type", true, Parser::isKnownType(FIRST_USER_ITEM_CODE + 3));
+      EQMSG("composite user type", true, Parser::isKnownType(COMP_FIRST_USER_ITEM_CODE));
+      EQMSG("undefined", false, Parser::isKnownType(UNDEFINED));
+      EQMSG("unassigned", false, Parser::isKnownType(0x0100));
+      EQMSG("wider than 16 bits", false, Parser::isKnownType(0x10000 | PHYSICS_EVENT));
+  }
+
 };
 
 
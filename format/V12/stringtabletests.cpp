@@ -0,0 +1,93 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+         NSCL
+         Michigan State University
+         East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "Asserts.h"
+
+#include <V12/CStringTable.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace DAQ::V12;
+
+class StringTableTests : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(StringTableTests);
+  CPPUNIT_TEST(empty_0);
+  CPPUNIT_TEST(empty_1);
+  CPPUNIT_TEST(iterate_0);
+  CPPUNIT_TEST(unterminated_0);
+  CPPUNIT_TEST(ref_0);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {}
+  void tearDown() {}
+
+  vector<string> decode(const string& bytes, uint32_t count) {
+      vector<string> result;
+      CStringTable table(bytes.data(), bytes.data() + bytes.size(), count);
+      for (auto& str : table) {
+          result.push_back(str.str());
+      }
+      return result;
+  }
+
+  void empty_0() {
+      EQMSG("empty range", size_t(0), decode("", 5).size());
+      EQMSG("default", size_t(0), CStringTable().size());
+  }
+
+  void empty_1() {
+      EQMSG("zero count", size_t(0), decode(string("a\0b\0", 4), 0).size());
+  }
+
+  void iterate_0() {
+      string bytes("a\0\0bc\0", 6);
+      CStringTable table(bytes.data(), bytes.data() + bytes.size(), 3);
+
+      auto it = table.begin();
+      auto first = it++;
+      EQMSG("post increment returns the old value", string("a"), first->str());
+      EQMSG("empty string", string(""), it->str());
+      ++it;
+      EQMSG("last", string("bc"), (*it).str());
+      ++it;
+      ASSERTMSG("end", it == table.end());
+      EQMSG("all", vector<string>({"a", "", "bc"}), decode(bytes, 3));
+  }
+
+  void unterminated_0() {
+      EQMSG("bounded by the range", vector<string>({"a", "bc"}),
+            decode(string("a\0bc", 4), 10));
+  }
+
+  void ref_0() {
+      string value("hello");
+      StringRef ref(value);
+      ASSERTMSG("equal", ref == StringRef("hello", 5));
+      ASSERTMSG("different size", ref != StringRef("hell", 4));
+      ASSERTMSG("different content", ref != StringRef("jello", 5));
+
+      ostringstream stream;
+      stream << StringRef("abc", 2);
+      EQMSG("stream", string("ab"), stream.str());
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(StringTableTests);
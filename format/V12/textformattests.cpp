@@ -0,0 +1,179 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2017.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+     Author:
+             Jeromy Tompkins
+         NSCL
+         Michigan State University
+         East Lansing, MI 48824-1321
+*/
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "Asserts.h"
+
+#include <V12/TextFormat.h>
+#include <V12/DataFormat.h>
+#include <V12/CRawRingItem.h>
+#include <V12/CRingTextItem.h>
+#include <V12/CRingStateChangeItem.h>
+
+#include <clocale>
+#include <cstdint>
+#include <ctime>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+
+using namespace std;
+using namespace DAQ;
+using namespace DAQ::V12;
+
+class TextFormatTests : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TextFormatTests);
+  CPPUNIT_TEST(decimal_0);
+  CPPUNIT_TEST(hex_0);
+  CPPUNIT_TEST(fixed_0);
+  CPPUNIT_TEST(fixed_1);
+  CPPUNIT_TEST(hexWords_0);
+  CPPUNIT_TEST(append_0);
+  CPPUNIT_TEST(append_1);
+  CPPUNIT_TEST(append_2);
+  CPPUNIT_TEST(time_0);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {}
+  void tearDown() {}
+
+  void decimal_0() {
+      uint64_t values[] = {0, 9, 10, 99, 100, 12345, 4294967295ull,
+                           std::numeric_limits<uint64_t>::max()};
+      for (auto value : values) {
+          ostringstream expected;
+          expected << value;
+
+          string result("x");
+          TextFormat::appendDecimal(result, value);
+          EQMSG("decimal", "x" + expected.str(), result);
+      }
+  }
+
+  void hex_0() {
+      string result;
+      TextFormat::appendHex(result, 0x1a, 4);
+      EQMSG("padded", string("001a"), result);
+
+      result.clear();
+      TextFormat::appendHex(result, 0x12345, 4);
+      EQMSG("wider than width", string("12345"), result);
+
+      result.clear();
+      TextFormat::appendHex(result, 0);
+      EQMSG("zero", string("0"), result);
+
+      result.clear();
+      TextFormat::appendHex(result, std::numeric_limits<uint64_t>::max());
+      EQMSG("max", string("ffffffffffffffff"), result);
+  }
+
+  void fixed_0() {
+      double values[] = {0, 0.05, 0.25, 1.0/3, 12.75, -2.5, 1e20,
+                         std::numeric_limits<double>::infinity(),
+                         -std::numeric_limits<double>::infinity(),
+                         std::numeric_limits<double>::quiet_NaN()};
+      for (auto value : values) {
+          ostringstream expected;
+          expected.precision(1);
+          expected.setf(std::ios::fixed);
+          expected << float(value);
+
+          string result;
+          TextFormat::appendFixed(result, float(value), 1);
+          EQMSG("fixed", expected.str(), result);
+      }
+  }
+
+  void fixed_1() {
+      // the decimal point of a locale that uses a comma, if one is installed
+      std::string saved = setlocale(LC_NUMERIC, nullptr);
+      const char* names[] = {"de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "fr_FR.utf8"};
+      for (auto name : names) {
+          if (setlocale(LC_NUMERIC, name)) {
+              string result;
+              TextFormat::appendFixed(result, -2.5, 1);
+              TextFormat::appendFixed(result, std::numeric_limits<double>::infinity(), 1);
+              setlocale(LC_NUMERIC, saved.c_str());
+              EQMSG(name, string("-2.5inf"), result);
+              break;
+          }
+      }
+  }
+
+    void hexWords_0() {
+      uint8_t data[19];
+      for (size_t i=0; i<sizeof(data); ++i) {
+          data[i] = i*13;
+      }
+
+      ostringstream expected;
+      expected << hex << setfill('0');
+      for (size_t i=0; i+1<sizeof(data); i+=2) {
+          if (i != 0 && (i/2)%8 == 0) {
+              expected << endl;
+          }
+          expected << setw(4) << (uint16_t(data[i+1]) << 8 | data[i]) << " ";
+      }
+      expected << setw(2) << int(data[18]) << " " << endl;
+
+      string result;
+      TextFormat::appendHexWords(result, data, data+sizeof(data));
+      EQMSG("hex words", expected.str(), result);
+  }
+
+  // appendString must append exactly what toString returns
+  void append_0() {
+      CRawRingItem item(PHYSICS_EVENT, NULL_TIMESTAMP, 3, {1,2,3,4,5,6,7,8,9,10,
+                                                           11,12,13,14,15,16,17,18,19});
+      string result("prefix");
+      item.appendString(result);
+      EQMSG("raw item", "prefix" + item.toString(), result);
+  }
+
+  void append_1() {
+      CRingTextItem item(MONITORED_VARIABLES, 12, 1, {"a", "bcd"}, 3, 1000000, 2);
+      string result("prefix");
+      item.appendString(result);
+      EQMSG("text item", "prefix" + item.toString(), result);
+
+      std::string msg = "Elapsed Time : 1.5 seconds\n";
+      ASSERTMSG("elapsed time", item.toString().find(msg) != string::npos);
+  }
+
+  void append_2() {
+      CRingStateChangeItem item(34, 2, END_RUN, 42, 10, 1000000, "a title", 4);
+      string result;
+      item.appendString(result);
+      item.appendString(result);
+      EQMSG("state change", item.toString() + item.toString(), result);
+  }
+
+  void time_0() {
+      time_t stamp = 1485797295;
+      string expected = ctime(&stamp);
+      expected.pop_back();
+
+      string result = "Unix Tstamp  : ";
+      TextFormat::appendTime(result, stamp);
+      EQMSG("matches ctime without the newline", "Unix Tstamp  : " + expected, result);
+  }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TextFormatTests);
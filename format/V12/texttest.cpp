@@ -42,6 +42,11 @@ class texttests : public CppUnit::TestFixture {
   CPPUNIT_TEST(assign_0);
   CPPUNIT_TEST(toRawRingItem_0);
   CPPUNIT_TEST(toString_0);
+  CPPUNIT_TEST(unterminated_0);
+  CPPUNIT_TEST(count_0);
+  CPPUNIT_TEST(count_1);
+  CPPUNIT_TEST(shortBody_0);
+  CPPUNIT_TEST(stringTable_0);
   CPPUNIT_TEST_SUITE_END();
 
 
@@ -75,6 +80,13 @@ protected:
   void assign_0();
   void toRawRingItem_0();
   void toString_0();
+  void unterminated_0();
+  void count_0();
+  void count_1();
+  void shortBody_0();
+  void stringTable_0();
+
+  V12::CRawRingItem makeRawText(uint32_t count, const std::string& strings);
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(texttests);
@@ -485,3 +497,75 @@ void texttests::toString_0() {
 
     EQMSG("toString divisor=1", msg, item.toString());
 }
+
+// A raw text item with the given string count and string table bytes
+V12::CRawRingItem texttests::makeRawText(uint32_t count, const std::string& strings)
+{
+    V12::CRawRingItem raw(V12::PACKET_TYPES, 1, 2);
+    raw.getBody() << uint32_t(3) << uint32_t(4) << count << uint32_t(1);
+    raw.getBody().insert(raw.getBody().end(), strings.begin(), strings.end());
+    return raw;
+}
+
+// The last string is missing its terminator. This used to loop forever.
+void texttests::unterminated_0()
+{
+    V12::CRingTextItem item(makeRawText(2, std::string("ab\0cd", 5)));
+
+    EQMSG("count", uint32_t(2), item.getStringCount());
+    EQMSG("string 0", std::string("ab"), item.getStrings()[0]);
+    EQMSG("string 1 extends to the end", std::string("cd"), item.getStrings()[1]);
+}
+
+// Strings beyond the recorded count are ignored
+void texttests::count_0()
+{
+    V12::CRingTextItem item(makeRawText(1, std::string("ab\0cd\0", 6)));
+
+    EQMSG("count", uint32_t(1), item.getStringCount());
+    EQMSG("string 0", std::string("ab"), item.getStrings()[0]);
+}
+
+// A count larger than what the body holds is bounded by the body
+void texttests::count_1()
+{
+    V12::CRingTextItem item(makeRawText(1000000, std::string("ab\0", 3)));
+
+    EQMSG("count", uint32_t(1), item.getStringCount());
+    EQMSG("string 0", std::string("ab"), item.getStrings()[0]);
+}
+
+void texttests::shortBody_0()
+{
+    V12::CRawRingItem raw(V12::PACKET_TYPES, 1, 2);
+    raw.getBody() << uint32_t(3) << uint32_t(4);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE("body without string count",
+                                 V12::CRingTextItem item(raw),
+                                 std::runtime_error);
+}
+
+void texttests::stringTable_0()
+{
+    V12::CRingTextItem item(V12::MONITORED_VARIABLES, 12, 234, {"a", "", "cd"}, 83, 0, 1);
+    V12::CRawRingItem raw(item);
+
+    auto table = V12::CRingTextItem::getStringTable(raw);
+    EQMSG("expected count", uint32_t(3), table.getExpectedCount());
+    EQMSG("size", size_t(3), table.size());
+
+    auto it = table.begin();
+    EQMSG("string 0", std::string("a"), it->str());
+    ++it;
+    ASSERTMSG("string 1", it->empty());
+    ++it;
+    EQMSG("string 2", std::string("cd"), it->str());
+    ASSERTMSG("references the body",
+              it->data() > reinterpret_cast<const char*>(raw.getBody().data()));
+    ++it;
+    ASSERTMSG("end", it == table.end());
+
+    CPPUNIT_ASSERT_THROW_MESSAGE("not a text item",
+                                 V12::CRingTextItem::getStringTable(V12::CRawRingItem()),
+                                 std::bad_cast);
+}
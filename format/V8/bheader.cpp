@@ -17,6 +17,7 @@
 #include <V8/bheader.h>
 #include <cstdint>
 #include <ctime>
+#include <time.h>
 
 using namespace DAQ::Buffer;
 using namespace DAQ::V8;
@@ -31,10 +32,11 @@ namespace DAQ {
       // start of the epoch
       bftime btime = {1, 1, 1970, 0, 0, 0, 0};
 
-      std::tm* pTime = std::localtime(&time);
+      std::tm localTime;
+      std::tm* pTime = localtime_r(&time, &localTime);
 
       if (pTime != nullptr) {
-        btime.month = pTime->tm_mon;
+        btime.month = pTime->tm_mon+1;
         btime.day = pTime->tm_mday;
         btime.year = pTime->tm_year+1900;
         btime.hours = pTime->tm_hour;
@@ -46,6 +48,20 @@ namespace DAQ {
       return btime;
     }
 
+    std::time_t to_time_t(const bftime& time)
+    {
+      std::tm calTime = {};
+      calTime.tm_mon   = time.month-1;
+      calTime.tm_mday  = time.day;
+      calTime.tm_year  = time.year-1900;
+      calTime.tm_hour  = time.hours;
+      calTime.tm_min   = time.min;
+      calTime.tm_sec   = time.sec;
+      calTime.tm_isdst = -1; // let the library figure out daylight savings
+
+      return std::mktime(&calTime);
+    }
+
     ////////// V8::bheader ////////////////////////////////////////////////////
 
     // Constructors
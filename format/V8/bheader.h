@@ -21,6 +21,7 @@
 #include <ByteBuffer.h>
 
 #include <cstdint>
+#include <ctime>
 #include <iosfwd>
 #include <iomanip>
 
@@ -55,6 +56,17 @@ namespace DAQ
      */
     extern bftime to_bftime(const std::time_t& time);
 
+    /*!
+     * \brief Convert between V8::bftime and std::time_t
+     *
+     * This is the inverse of to_bftime(). The time is interpreted as local time.
+     * Tenths of a second are discarded.
+     *
+     * \param time  a calendar time with month in the range 1-12
+     * \return the equivalent std::time_t value
+     */
+    extern std::time_t to_time_t(const bftime& time);
+
     //////////////////////////////////////////////////////////////////////////
     //////////////////////////////////////////////////////////////////////////
 